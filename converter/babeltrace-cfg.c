@@ -29,6 +29,7 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <inttypes.h>
+#include <limits.h>
 #include <babeltrace/babeltrace.h>
 #include <babeltrace/common-internal.h>
 #include <babeltrace/values.h>
@@ -2085,6 +2086,7 @@ enum {
 	OPT_PARAMS,
 	OPT_PATH,
 	OPT_PLUGIN_PATH,
+	OPT_QUEUE_CAPACITY,
 	OPT_RESET_BASE_PARAMS,
 	OPT_SINK,
 	OPT_SOURCE,
@@ -3194,6 +3196,10 @@ void print_convert_usage(FILE *fp)
 	fprintf(fp, "                                    component instance to PATH\n");
 	fprintf(fp, "      --plugin-path=PATH[:PATH]...  Add PATH to the list of paths from which\n");
 	fprintf(fp, "                                    dynamic plugins can be loaded\n");
+	fprintf(fp, "      --queue-capacity=N            Advance the upstream component of each\n");
+	fprintf(fp, "                                    connection in its own thread, up to N\n");
+	fprintf(fp, "                                    notifications ahead (default: 0, no\n");
+	fprintf(fp, "                                    additional thread)\n");
 	fprintf(fp, "  -r, --reset-base-params           Reset the current base parameters of the\n");
 	fprintf(fp, "                                    following source and sink component\n");
 	fprintf(fp, "                                    instances to an empty map\n");
@@ -3270,6 +3276,7 @@ static struct poptOption convert_long_options[] = {
 	{ "params", 'p', POPT_ARG_STRING, NULL, OPT_PARAMS, NULL, NULL },
 	{ "path", 'P', POPT_ARG_STRING, NULL, OPT_PATH, NULL, NULL },
 	{ "plugin-path", '\0', POPT_ARG_STRING, NULL, OPT_PLUGIN_PATH, NULL, NULL },
+	{ "queue-capacity", '\0', POPT_ARG_STRING, NULL, OPT_QUEUE_CAPACITY, NULL, NULL },
 	{ "reset-base-params", 'r', POPT_ARG_NONE, NULL, OPT_RESET_BASE_PARAMS, NULL, NULL },
 	{ "sink", '\0', POPT_ARG_STRING, NULL, OPT_SINK, NULL, NULL },
 	{ "source", '\0', POPT_ARG_STRING, NULL, OPT_SOURCE, NULL, NULL },
@@ -3755,6 +3762,19 @@ struct bt_config *bt_config_convert_from_args(int argc, const char *argv[],
 		case OPT_STREAM_INTERSECTION:
 			ctf_legacy_opts.stream_intersection = true;
 			break;
+		case OPT_QUEUE_CAPACITY:
+		{
+			int64_t val;
+
+			if (parse_int64(arg, &val) || val < 0 || val > UINT_MAX) {
+				printf_err("Invalid --queue-capacity option's argument:\n    %s\n",
+					arg);
+				goto error;
+			}
+
+			cfg->cmd_data.convert.notification_queue_capacity = val;
+			break;
+		}
 		case OPT_CLOCK_FORCE_CORRELATE:
 			cfg->cmd_data.convert.force_correlate = true;
 			break;
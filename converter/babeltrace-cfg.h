@@ -77,6 +77,12 @@ struct bt_config {
 			bool omit_system_plugin_path;
 			bool omit_home_plugin_path;
 			bool print_ctf_metadata;
+
+			/*
+			 * Capacity of the notification queues of the
+			 * connections (0: no prefetching threads)
+			 */
+			unsigned int notification_queue_capacity;
 		} convert;
 
 		/* BT_CONFIG_COMMAND_LIST_PLUGINS */
@@ -389,6 +389,8 @@ void print_cfg_convert(struct bt_config *cfg)
 	print_plugin_paths(cfg->cmd_data.convert.plugin_paths);
 	printf("  Print CTF metadata: %s\n",
 		cfg->cmd_data.convert.print_ctf_metadata ? "yes" : "no");
+	printf("  Notification queue capacity: %u\n",
+		cfg->cmd_data.convert.notification_queue_capacity);
 	printf("  Source component instances:\n");
 	print_bt_config_components(cfg->cmd_data.convert.sources);
 
@@ -605,6 +607,7 @@ end:
 	bt_put(source_port);
 	bt_put(sink_port);
 	bt_put(to_sink_port);
+	bt_put(trimmer_input_port);
 	bt_put(connection);
 	return ret;
 }
@@ -1145,6 +1148,13 @@ static int cmd_convert(struct bt_config *cfg)
 		goto end;
 	}
 
+	if (bt_graph_set_notification_queue_capacity(graph,
+			cfg->cmd_data.convert.notification_queue_capacity) !=
+			BT_GRAPH_STATUS_OK) {
+		ret = -1;
+		goto end;
+	}
+
 	source = bt_component_create(source_class, "source", source_params);
 	if (!source) {
 		fprintf(stderr, "Failed to instantiate selected source component. Aborting...\n");
@@ -1168,11 +1178,23 @@ static int cmd_convert(struct bt_config *cfg)
 	while (true) {
 		enum bt_graph_status graph_status;
 
+		/*
+		 * bt_graph_run() sleeps until the readiness sources of
+		 * the waiting sinks are ready.
+		 */
 		graph_status = bt_graph_run(graph, NULL);
 		switch (graph_status) {
 		case BT_GRAPH_STATUS_AGAIN:
-			/* Wait for an arbitraty 500 ms. */
-			usleep(500000);
+			/*
+			 * The source has no readiness source: make the
+			 * graph poll it every 500 ms.
+			 */
+			if (bt_graph_set_ready_timeout(graph, source, 500) !=
+					BT_GRAPH_STATUS_OK) {
+				fprintf(stderr, "Failed to wait for the source component, aborting...\n");
+				ret = -1;
+				goto end;
+			}
 			break;
 		case BT_COMPONENT_STATUS_END:
 			goto end;
@@ -30,6 +30,7 @@
 #include <babeltrace/ctf-ir/field-types-internal.h>
 #include <babeltrace/ctf-ir/event-class.h>
 #include <babeltrace/ctf-ir/event-class-internal.h>
+#include <babeltrace/ctf-ir/event-internal.h>
 #include <babeltrace/ctf-ir/stream-class.h>
 #include <babeltrace/ctf-ir/stream-class-internal.h>
 #include <babeltrace/ctf-ir/trace-internal.h>
@@ -59,6 +60,7 @@ struct bt_ctf_event_class *bt_ctf_event_class_create(const char *name)
 	}
 
 	event_class->id = -1;
+	pthread_mutex_init(&event_class->event_pool_lock, NULL);
 	bt_object_init(event_class, bt_ctf_event_class_destroy);
 	event_class->fields = bt_ctf_field_type_structure_create();
 	if (!event_class->fields) {
@@ -555,6 +557,8 @@ void bt_ctf_event_class_destroy(struct bt_object *obj)
 	bt_ctf_attributes_destroy(event_class->attributes);
 	bt_put(event_class->context);
 	bt_put(event_class->fields);
+	bt_ctf_event_pool_destroy(event_class->event_pool);
+	pthread_mutex_destroy(&event_class->event_pool_lock);
 	g_free(event_class);
 }
 
@@ -48,6 +48,176 @@
 static
 void bt_ctf_event_destroy(struct bt_object *obj);
 
+static
+void free_event(struct bt_ctf_event *event)
+{
+	if (event->clock_values) {
+		g_hash_table_destroy(event->clock_values);
+	}
+
+	bt_put(event->event_header);
+	bt_put(event->stream_event_context);
+	bt_put(event->context_payload);
+	bt_put(event->fields_payload);
+	bt_put(event->packet);
+	g_free(event);
+}
+
+static
+int create_missing_field(struct bt_ctf_field **field,
+		struct bt_ctf_field_type *type)
+{
+	int ret = 0;
+
+	if (*field || !type) {
+		goto end;
+	}
+
+	*field = bt_ctf_field_create(type);
+	if (!*field) {
+		ret = -1;
+	}
+end:
+	return ret;
+}
+
+/*
+ * Creates an event of an already validated event class whose stream
+ * class is frozen. Their types will not be replaced anymore, so the
+ * validation is skipped altogether and this path never modifies the
+ * classes: concurrent threads may take it.
+ *
+ * A released event of this class is reused when there's one.
+ */
+static
+struct bt_ctf_event *create_event_from_valid_class(
+		struct bt_ctf_event_class *event_class)
+{
+	int ret;
+	struct bt_ctf_event *event = NULL;
+	struct bt_ctf_stream_class *stream_class;
+	GPtrArray *pool;
+
+	pthread_mutex_lock(&event_class->event_pool_lock);
+	pool = event_class->event_pool;
+	if (pool && pool->len > 0) {
+		event = g_ptr_array_index(pool, pool->len - 1);
+		g_ptr_array_set_size(pool, pool->len - 1);
+	}
+	pthread_mutex_unlock(&event_class->event_pool_lock);
+	if (!event) {
+		event = g_new0(struct bt_ctf_event, 1);
+		if (!event) {
+			goto end;
+		}
+
+		event->clock_values = g_hash_table_new_full(g_direct_hash,
+			g_direct_equal, bt_put, bt_put);
+		if (!event->clock_values) {
+			goto error;
+		}
+	}
+
+	stream_class = (struct bt_ctf_stream_class *) event_class->base.parent;
+	assert(stream_class);
+
+	/*
+	 * Fields which were still shared when the event was released
+	 * were dropped: create them again.
+	 */
+	ret = create_missing_field(&event->event_header,
+		stream_class->event_header_type);
+	ret |= create_missing_field(&event->stream_event_context,
+		stream_class->event_context_type);
+	ret |= create_missing_field(&event->context_payload,
+		event_class->context);
+	ret |= create_missing_field(&event->fields_payload,
+		event_class->fields);
+	if (ret) {
+		goto error;
+	}
+
+	bt_object_init(event, bt_ctf_event_destroy);
+	event->event_class = bt_get(event_class);
+end:
+	return event;
+error:
+	free_event(event);
+	event = NULL;
+	goto end;
+}
+
+static
+void recycle_field(struct bt_ctf_field **field)
+{
+	if (!*field) {
+		return;
+	}
+
+	if (bt_object_get_ref_count(*field) > 1) {
+		/* Someone else still holds this field: leave it to them. */
+		BT_PUT(*field);
+		return;
+	}
+
+	bt_ctf_field_recycle(*field);
+}
+
+/*
+ * Puts a released event back into its class's pool, keeping its field
+ * trees allocated. Returns 0 if the event now belongs to the pool.
+ */
+static
+int recycle_event(struct bt_ctf_event *event)
+{
+	int ret = 0;
+	struct bt_ctf_event_class *event_class = event->event_class;
+
+	if (!event_class->valid) {
+		ret = -1;
+		goto end;
+	}
+
+	recycle_field(&event->event_header);
+	recycle_field(&event->stream_event_context);
+	recycle_field(&event->context_payload);
+	recycle_field(&event->fields_payload);
+	BT_PUT(event->packet);
+	g_hash_table_remove_all(event->clock_values);
+	event->frozen = 0;
+
+	pthread_mutex_lock(&event_class->event_pool_lock);
+	if (!event_class->event_pool) {
+		event_class->event_pool = g_ptr_array_new();
+	}
+
+	if (!event_class->event_pool || event_class->event_pool->len >=
+			BT_CTF_EVENT_CLASS_EVENT_POOL_MAX_SIZE) {
+		ret = -1;
+	} else {
+		g_ptr_array_add(event_class->event_pool, event);
+	}
+	pthread_mutex_unlock(&event_class->event_pool_lock);
+end:
+	return ret;
+}
+
+BT_HIDDEN
+void bt_ctf_event_pool_destroy(GPtrArray *event_pool)
+{
+	size_t i;
+
+	if (!event_pool) {
+		return;
+	}
+
+	for (i = 0; i < event_pool->len; i++) {
+		free_event(g_ptr_array_index(event_pool, i));
+	}
+
+	g_ptr_array_free(event_pool, TRUE);
+}
+
 struct bt_ctf_event *bt_ctf_event_create(struct bt_ctf_event_class *event_class)
 {
 	int ret;
@@ -75,6 +245,12 @@ struct bt_ctf_event *bt_ctf_event_create(struct bt_ctf_event_class *event_class)
 		goto error;
 	}
 
+	if (event_class->valid && event_class->base.parent &&
+			((struct bt_ctf_stream_class *)
+				event_class->base.parent)->frozen) {
+		return create_event_from_valid_class(event_class);
+	}
+
 	stream_class = bt_ctf_event_class_get_stream_class(event_class);
 
 	/*
@@ -546,20 +722,22 @@ void bt_ctf_event_destroy(struct bt_object *obj)
 
 	event = container_of(obj, struct bt_ctf_event, base);
 	if (!event->base.parent) {
+		struct bt_ctf_event_class *event_class = event->event_class;
+		int recycled = !recycle_event(event);
+
 		/*
 		 * Event was keeping a reference to its class since it shared no
 		 * common ancestor with it to guarantee they would both have the
-		 * same lifetime.
+		 * same lifetime. If the event was pooled and this is the
+		 * last reference, the class frees it with its pool.
 		 */
-		bt_put(event->event_class);
+		bt_put(event_class);
+		if (recycled) {
+			return;
+		}
 	}
-	g_hash_table_destroy(event->clock_values);
-	bt_put(event->event_header);
-	bt_put(event->stream_event_context);
-	bt_put(event->context_payload);
-	bt_put(event->fields_payload);
-	bt_put(event->packet);
-	g_free(event);
+
+	free_event(event);
 }
 
 struct bt_ctf_clock_value *bt_ctf_event_get_clock_value(
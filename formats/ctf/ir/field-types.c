@@ -27,6 +27,7 @@
  */
 
 #include <babeltrace/ctf-ir/field-types-internal.h>
+#include <babeltrace/ctf-ir/fields-internal.h>
 #include <babeltrace/ctf-ir/field-path-internal.h>
 #include <babeltrace/ctf-ir/utils.h>
 #include <babeltrace/ref.h>
@@ -2822,6 +2823,7 @@ void bt_ctf_field_type_structure_destroy(struct bt_ctf_field_type *type)
 
 	g_ptr_array_free(structure->fields, TRUE);
 	g_hash_table_destroy(structure->field_name_to_index);
+	bt_ctf_field_structure_plan_destroy(structure->serialize_plan);
 	g_free(structure);
 }
 
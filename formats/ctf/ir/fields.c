@@ -32,6 +32,8 @@
 #include <babeltrace/ref.h>
 #include <babeltrace/compiler.h>
 #include <babeltrace/compat/fcntl.h>
+#include <babeltrace/endian.h>
+#include <pthread.h>
 
 #define PACKET_LEN_INCREMENT	(getpagesize() * 8 * CHAR_BIT)
 
@@ -452,21 +454,64 @@ int bt_ctf_field_sequence_set_length(struct bt_ctf_field *field,
 		bt_put(sequence->length);
 	}
 
-	sequence->elements = g_ptr_array_sized_new((size_t)sequence_length);
-	if (!sequence->elements) {
-		ret = -1;
-		goto end;
+	if (sequence->spare_elements) {
+		/*
+		 * Elements kept by a recycled sequence: nobody else
+		 * references them, reset and reuse them.
+		 */
+		sequence->elements = sequence->spare_elements;
+		sequence->spare_elements = NULL;
+		g_ptr_array_set_size(sequence->elements,
+			(size_t) sequence_length);
+		ret = bt_ctf_field_sequence_reset(field);
+		if (ret) {
+			goto end;
+		}
+	} else {
+		sequence->elements =
+			g_ptr_array_sized_new((size_t) sequence_length);
+		if (!sequence->elements) {
+			ret = -1;
+			goto end;
+		}
+
+		g_ptr_array_set_free_func(sequence->elements,
+			(GDestroyNotify) bt_put);
+		g_ptr_array_set_size(sequence->elements,
+			(size_t) sequence_length);
 	}
 
-	g_ptr_array_set_free_func(sequence->elements,
-		(GDestroyNotify) bt_put);
-	g_ptr_array_set_size(sequence->elements, (size_t) sequence_length);
 	bt_get(length_field);
 	sequence->length = length_field;
 end:
 	return ret;
 }
 
+/*
+ * Copies of frozen fields reference the frozen children of the original
+ * instead of copying them. Before such a child is handed out by a field
+ * which may be modified, it is replaced by a copy of its own, which
+ * itself references the grandchildren until they are handed out.
+ */
+static
+int unshare_child(struct bt_ctf_field *field, struct bt_ctf_field **child)
+{
+	struct bt_ctf_field *copy;
+
+	if (!*child || !(*child)->frozen || field->frozen) {
+		return 0;
+	}
+
+	copy = bt_ctf_field_copy(*child);
+	if (!copy) {
+		return -1;
+	}
+
+	bt_put(*child);
+	*child = copy;
+	return 0;
+}
+
 struct bt_ctf_field *bt_ctf_field_structure_get_field(
 		struct bt_ctf_field *field, const char *name)
 {
@@ -493,6 +538,10 @@ struct bt_ctf_field *bt_ctf_field_structure_get_field(
 	}
 
 	if (structure->fields->pdata[index]) {
+		if (unshare_child(field, (struct bt_ctf_field **)
+				&structure->fields->pdata[index])) {
+			goto error;
+		}
 		new_field = structure->fields->pdata[index];
 		goto end;
 	}
@@ -538,6 +587,11 @@ struct bt_ctf_field *bt_ctf_field_structure_get_field_by_index(
 		goto error;
 	}
 
+	if (unshare_child(field, (struct bt_ctf_field **)
+			&structure->fields->pdata[index])) {
+		goto error;
+	}
+
 	ret_field = structure->fields->pdata[index];
 	if (ret_field) {
 		goto end;
@@ -639,6 +693,10 @@ struct bt_ctf_field *bt_ctf_field_array_get_field(struct bt_ctf_field *field,
 
 	field_type = bt_ctf_field_type_array_get_element_type(field->type);
 	if (array->elements->pdata[(size_t)index]) {
+		if (unshare_child(field, (struct bt_ctf_field **)
+				&array->elements->pdata[(size_t)index])) {
+			goto end;
+		}
 		new_field = array->elements->pdata[(size_t)index];
 		goto end;
 	}
@@ -679,6 +737,10 @@ struct bt_ctf_field *bt_ctf_field_sequence_get_field(struct bt_ctf_field *field,
 
 	field_type = bt_ctf_field_type_sequence_get_element_type(field->type);
 	if (sequence->elements->pdata[(size_t) index]) {
+		if (unshare_child(field, (struct bt_ctf_field **)
+				&sequence->elements->pdata[(size_t) index])) {
+			goto end;
+		}
 		new_field = sequence->elements->pdata[(size_t) index];
 		goto end;
 	}
@@ -737,28 +799,23 @@ struct bt_ctf_field *bt_ctf_field_variant_get_field(struct bt_ctf_field *field,
 	tag_enum_value = tag_enum_integer->definition.value._signed;
 
 	/*
-	 * If the variant currently has a tag and a payload, and if the
-	 * requested tag value is the same as the current one, return
-	 * the current payload instead of creating a fresh one.
+	 * If the variant currently has a payload, and if the requested
+	 * tag value is the same as the current one, return the current
+	 * payload instead of creating a fresh one. A recycled variant
+	 * keeps its payload, but not its tag.
 	 */
-	if (variant->tag && variant->payload) {
-		struct bt_ctf_field *cur_tag_container = NULL;
-		struct bt_ctf_field_integer *cur_tag_enum_integer;
-		int64_t cur_tag_value;
-
-		cur_tag_container =
-			bt_ctf_field_enumeration_get_container(variant->tag);
-		assert(cur_tag_container);
-		cur_tag_enum_integer = container_of(cur_tag_container,
-			struct bt_ctf_field_integer, parent);
-		bt_put(cur_tag_container);
-		cur_tag_value = cur_tag_enum_integer->definition.value._signed;
-
-		if (cur_tag_value == tag_enum_value) {
-			new_field = variant->payload;
-			bt_get(new_field);
+	if (variant->payload && variant->tag_value == tag_enum_value) {
+		if (unshare_child(field, &variant->payload)) {
 			goto end;
 		}
+		new_field = variant->payload;
+		bt_get(new_field);
+
+		if (variant->tag != tag_field && !field->frozen) {
+			bt_put(variant->tag);
+			variant->tag = bt_get(tag_field);
+		}
+		goto end;
 	}
 
 	/* We don't want to modify this field if it's frozen */
@@ -782,6 +839,7 @@ struct bt_ctf_field *bt_ctf_field_variant_get_field(struct bt_ctf_field *field,
 	bt_get(new_field);
 	bt_get(tag_field);
 	variant->tag = tag_field;
+	variant->tag_value = tag_enum_value;
 	variant->payload = new_field;
 end:
 	bt_put(tag_enum);
@@ -803,7 +861,11 @@ struct bt_ctf_field *bt_ctf_field_variant_get_current_field(
 	variant = container_of(variant_field, struct bt_ctf_field_variant,
 		parent);
 
-	if (variant->payload) {
+	/* A recycled variant has no current field until it is tagged. */
+	if (variant->payload && variant->tag) {
+		if (unshare_child(variant_field, &variant->payload)) {
+			goto end;
+		}
 		current_field = variant->payload;
 		bt_get(current_field);
 		goto end;
@@ -1571,6 +1633,9 @@ void bt_ctf_field_sequence_destroy(struct bt_ctf_field *field)
 	if (sequence->elements) {
 		g_ptr_array_free(sequence->elements, TRUE);
 	}
+	if (sequence->spare_elements) {
+		g_ptr_array_free(sequence->spare_elements, TRUE);
+	}
 	bt_put(sequence->length);
 	g_free(sequence);
 }
@@ -1777,6 +1842,12 @@ int bt_ctf_field_structure_reset(struct bt_ctf_field *field)
 			continue;
 		}
 
+		if (member->frozen) {
+			/* May be shared: create it again when needed. */
+			BT_PUT(structure->fields->pdata[i]);
+			continue;
+		}
+
 		ret = bt_ctf_field_reset(member);
 		if (ret) {
 			goto end;
@@ -1798,7 +1869,10 @@ int bt_ctf_field_variant_reset(struct bt_ctf_field *field)
 	}
 
 	variant = container_of(field, struct bt_ctf_field_variant, parent);
-	if (variant->payload) {
+	if (variant->payload && variant->payload->frozen) {
+		/* May be shared: create it again when needed. */
+		BT_PUT(variant->payload);
+	} else if (variant->payload) {
 		ret = bt_ctf_field_reset(variant->payload);
 	}
 end:
@@ -1829,6 +1903,12 @@ int bt_ctf_field_array_reset(struct bt_ctf_field *field)
 			continue;
 		}
 
+		if (member->frozen) {
+			/* May be shared: create it again when needed. */
+			BT_PUT(array->elements->pdata[i]);
+			continue;
+		}
+
 		ret = bt_ctf_field_reset(member);
 		if (ret) {
 			goto end;
@@ -1851,6 +1931,11 @@ int bt_ctf_field_sequence_reset(struct bt_ctf_field *field)
 	}
 
 	sequence = container_of(field, struct bt_ctf_field_sequence, parent);
+	if (!sequence->elements) {
+		/* Length not set yet: nothing to reset. */
+		goto end;
+	}
+
 	for (i = 0; i < sequence->elements->len; i++) {
 		struct bt_ctf_field *member = sequence->elements->pdata[i];
 
@@ -1862,6 +1947,12 @@ int bt_ctf_field_sequence_reset(struct bt_ctf_field *field)
 			continue;
 		}
 
+		if (member->frozen) {
+			/* May be shared: create it again when needed. */
+			BT_PUT(sequence->elements->pdata[i]);
+			continue;
+		}
+
 		ret = bt_ctf_field_reset(member);
 		if (ret) {
 			goto end;
@@ -1963,6 +2054,287 @@ end:
 	return ret;
 }
 
+/*
+ * Serialization plans of valid structure types
+ *
+ * Consecutive integer members which can be stored directly (whole
+ * bytes, native byte order) are grouped in runs: once the beginning of
+ * a run is aligned, each member of the run has a fixed offset from it.
+ * A run is written with direct stores after making room for all of it
+ * at once. The other members are serialized one by one.
+ */
+struct plan_store {
+	/* Index of the member in its structure */
+	unsigned int index;
+	/* Offset from the beginning of the run (bits) */
+	unsigned int offset;
+	/* 1, 2, 4 or 8 bytes */
+	unsigned int size;
+	/* The member is an enumeration: store its container. */
+	bool is_enum;
+};
+
+struct plan_step {
+	/* Index of a member serialized on its own if "store_count" is 0 */
+	unsigned int index;
+	/* Alignment of the beginning of the run, and its length (bits) */
+	unsigned int alignment;
+	uint64_t len;
+	unsigned int first_store;
+	unsigned int store_count;
+};
+
+struct bt_ctf_field_structure_plan {
+	GArray *steps;
+	GArray *stores;
+};
+
+static pthread_mutex_t structure_plan_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Returns the size in bytes of a directly-stored integer, 0 if not. */
+static
+unsigned int get_store_size(struct bt_ctf_field_type *type)
+{
+	struct declaration_integer *declaration;
+
+	if (type->declaration->id == BT_CTF_TYPE_ID_ENUM) {
+		type = container_of(type, struct bt_ctf_field_type_enumeration,
+			parent)->container;
+	}
+
+	if (type->declaration->id != BT_CTF_TYPE_ID_INTEGER) {
+		return 0;
+	}
+
+	declaration = &container_of(type, struct bt_ctf_field_type_integer,
+		parent)->declaration;
+	if (declaration->byte_order != BYTE_ORDER ||
+			declaration->p.alignment % CHAR_BIT) {
+		return 0;
+	}
+
+	switch (declaration->len) {
+	case 8:
+	case 16:
+	case 32:
+	case 64:
+		return declaration->len / CHAR_BIT;
+	default:
+		return 0;
+	}
+}
+
+static
+struct bt_ctf_field_structure_plan *create_structure_plan(
+		struct bt_ctf_field_type_structure *structure_type)
+{
+	struct bt_ctf_field_structure_plan *plan;
+	struct plan_step *run = NULL;
+	size_t i;
+
+	plan = g_new0(struct bt_ctf_field_structure_plan, 1);
+	plan->steps = g_array_new(FALSE, TRUE, sizeof(struct plan_step));
+	plan->stores = g_array_new(FALSE, TRUE, sizeof(struct plan_store));
+
+	for (i = 0; i < structure_type->fields->len; i++) {
+		struct structure_field *member =
+			g_ptr_array_index(structure_type->fields, i);
+		unsigned int alignment = member->type->declaration->alignment;
+		struct plan_store store = {
+			.index = i,
+			.size = get_store_size(member->type),
+			.is_enum = member->type->declaration->id ==
+				BT_CTF_TYPE_ID_ENUM,
+		};
+		struct plan_step step = { .index = i };
+
+		if (!store.size) {
+			g_array_append_val(plan->steps, step);
+			run = NULL;
+			continue;
+		}
+
+		if (!run || alignment > run->alignment) {
+			/* The member's offset depends on what precedes it. */
+			step.alignment = alignment;
+			step.first_store = plan->stores->len;
+			g_array_append_val(plan->steps, step);
+			run = &g_array_index(plan->steps, struct plan_step,
+				plan->steps->len - 1);
+		}
+
+		store.offset = run->len + offset_align(run->len, alignment);
+		run->len = store.offset + store.size * CHAR_BIT;
+		run->store_count++;
+		g_array_append_val(plan->stores, store);
+	}
+
+	return plan;
+}
+
+BT_HIDDEN
+void bt_ctf_field_structure_plan_destroy(
+		struct bt_ctf_field_structure_plan *plan)
+{
+	if (!plan) {
+		return;
+	}
+
+	g_array_free(plan->steps, TRUE);
+	g_array_free(plan->stores, TRUE);
+	g_free(plan);
+}
+
+/* Returns NULL if the type may still change. */
+static
+struct bt_ctf_field_structure_plan *get_structure_plan(
+		struct bt_ctf_field_type *type)
+{
+	struct bt_ctf_field_type_structure *structure_type = container_of(
+		type, struct bt_ctf_field_type_structure, parent);
+	struct bt_ctf_field_structure_plan *plan;
+
+	plan = __atomic_load_n(&structure_type->serialize_plan,
+		__ATOMIC_ACQUIRE);
+	if (plan || !type->valid) {
+		return plan;
+	}
+
+	pthread_mutex_lock(&structure_plan_lock);
+	plan = structure_type->serialize_plan;
+	if (!plan) {
+		plan = create_structure_plan(structure_type);
+		__atomic_store_n(&structure_type->serialize_plan, plan,
+			__ATOMIC_RELEASE);
+	}
+	pthread_mutex_unlock(&structure_plan_lock);
+	return plan;
+}
+
+/* On error, "index" is the index of the member which failed. */
+static
+int write_plan_run(struct bt_ctf_field_structure *structure,
+		struct bt_ctf_field_structure_plan *plan,
+		struct plan_step *run, struct ctf_stream_pos *pos,
+		unsigned int *index)
+{
+	int ret = 0;
+	unsigned int i;
+	char *addr;
+
+	*index = g_array_index(plan->stores, struct plan_store,
+		run->first_store).index;
+	if (bt_ctf_stream_pos_reserve(pos,
+			offset_align(pos->offset, run->alignment) + run->len) ||
+			!ctf_align_pos(pos, run->alignment)) {
+		ret = -1;
+		goto end;
+	}
+
+	addr = ctf_get_pos_addr(pos);
+	for (i = 0; i < run->store_count; i++) {
+		struct plan_store *store = &g_array_index(plan->stores,
+			struct plan_store, run->first_store + i);
+		struct bt_ctf_field *member = g_ptr_array_index(
+			structure->fields, store->index);
+		char *dst = addr + store->offset / CHAR_BIT;
+		uint64_t value;
+
+		if (member && store->is_enum) {
+			member = container_of(member,
+				struct bt_ctf_field_enumeration,
+				parent)->payload;
+		}
+
+		if (!member || !member->payload_set) {
+			*index = store->index;
+			ret = -1;
+			goto end;
+		}
+
+		value = container_of(member, struct bt_ctf_field_integer,
+			parent)->definition.value._unsigned;
+		switch (store->size) {
+		case 1:
+		{
+			uint8_t v = value;
+
+			memcpy(dst, &v, sizeof(v));
+			break;
+		}
+		case 2:
+		{
+			uint16_t v = value;
+
+			memcpy(dst, &v, sizeof(v));
+			break;
+		}
+		case 4:
+		{
+			uint32_t v = value;
+
+			memcpy(dst, &v, sizeof(v));
+			break;
+		}
+		default:
+			memcpy(dst, &value, sizeof(value));
+			break;
+		}
+	}
+
+	if (!ctf_move_pos(pos, run->len)) {
+		ret = -1;
+	}
+end:
+	return ret;
+}
+
+static
+void report_member_error(struct bt_ctf_field *field, size_t index)
+{
+	const char *name;
+	struct bt_ctf_field_type *structure_type =
+			bt_ctf_field_get_type(field);
+
+	(void) bt_ctf_field_type_structure_get_field(
+			structure_type, &name, NULL, index);
+	fprintf(stderr, "Field %s failed to serialize\n",
+			name ? name : "NULL");
+	bt_put(structure_type);
+}
+
+static
+int serialize_structure_plan(struct bt_ctf_field *field,
+		struct bt_ctf_field_structure_plan *plan,
+		struct ctf_stream_pos *pos)
+{
+	int ret = 0;
+	size_t i;
+	struct bt_ctf_field_structure *structure = container_of(
+		field, struct bt_ctf_field_structure, parent);
+
+	for (i = 0; i < plan->steps->len; i++) {
+		struct plan_step *step = &g_array_index(plan->steps,
+			struct plan_step, i);
+
+		unsigned int index = step->index;
+
+		if (step->store_count) {
+			ret = write_plan_run(structure, plan, step, pos,
+				&index);
+		} else {
+			ret = bt_ctf_field_serialize(g_ptr_array_index(
+				structure->fields, step->index), pos);
+		}
+		if (ret) {
+			report_member_error(field, index);
+			break;
+		}
+	}
+
+	return ret;
+}
+
 static
 int bt_ctf_field_structure_serialize(struct bt_ctf_field *field,
 		struct ctf_stream_pos *pos)
@@ -1971,6 +2343,7 @@ int bt_ctf_field_structure_serialize(struct bt_ctf_field *field,
 	int ret = 0;
 	struct bt_ctf_field_structure *structure = container_of(
 		field, struct bt_ctf_field_structure, parent);
+	struct bt_ctf_field_structure_plan *plan;
 
 	while (!ctf_pos_access_ok(pos,
 		offset_align(pos->offset,
@@ -1986,21 +2359,19 @@ int bt_ctf_field_structure_serialize(struct bt_ctf_field *field,
 		goto end;
 	}
 
+	plan = get_structure_plan(field->type);
+	if (plan) {
+		ret = serialize_structure_plan(field, plan, pos);
+		goto end;
+	}
+
 	for (i = 0; i < structure->fields->len; i++) {
 		struct bt_ctf_field *member = g_ptr_array_index(
 			structure->fields, i);
 
 		ret = bt_ctf_field_serialize(member, pos);
 		if (ret) {
-			const char *name;
-			struct bt_ctf_field_type *structure_type =
-					bt_ctf_field_get_type(field);
-
-			(void) bt_ctf_field_type_structure_get_field(
-					structure_type, &name, NULL, i);
-			fprintf(stderr, "Field %s failed to serialize\n",
-					name ? name : "NULL");
-			bt_put(structure_type);
+			report_member_error(field, i);
 			break;
 		}
 	}
@@ -2090,6 +2461,21 @@ end:
 	return ret;
 }
 
+/*
+ * A frozen child can't change anymore: the copy references it, and only
+ * copies it once it is about to be modified (see unshare_child()).
+ */
+static
+struct bt_ctf_field *copy_child(struct bt_ctf_field *child)
+{
+	if (child->frozen) {
+		child->shared = 1;
+		return bt_get(child);
+	}
+
+	return bt_ctf_field_copy(child);
+}
+
 static
 int bt_ctf_field_integer_copy(struct bt_ctf_field *src,
 		struct bt_ctf_field *dst)
@@ -2167,7 +2553,7 @@ int bt_ctf_field_structure_copy(struct bt_ctf_field *src,
 		struct bt_ctf_field *field_copy = NULL;
 
 		if (field) {
-			field_copy = bt_ctf_field_copy(field);
+			field_copy = copy_child(field);
 
 			if (!field_copy) {
 				ret = -1;
@@ -2198,8 +2584,9 @@ int bt_ctf_field_variant_copy(struct bt_ctf_field *src,
 			goto end;
 		}
 	}
+	variant_dst->tag_value = variant_src->tag_value;
 	if (variant_src->payload) {
-		variant_dst->payload = bt_ctf_field_copy(variant_src->payload);
+		variant_dst->payload = copy_child(variant_src->payload);
 		if (!variant_dst->payload) {
 			ret = -1;
 			goto end;
@@ -2226,7 +2613,7 @@ int bt_ctf_field_array_copy(struct bt_ctf_field *src,
 		struct bt_ctf_field *field_copy = NULL;
 
 		if (field) {
-			field_copy = bt_ctf_field_copy(field);
+			field_copy = copy_child(field);
 
 			if (!field_copy) {
 				ret = -1;
@@ -2284,7 +2671,7 @@ int bt_ctf_field_sequence_copy(struct bt_ctf_field *src,
 		struct bt_ctf_field *field_copy = NULL;
 
 		if (field) {
-			field_copy = bt_ctf_field_copy(field);
+			field_copy = copy_child(field);
 
 			if (!field_copy) {
 				ret = -1;
@@ -2320,7 +2707,7 @@ end:
 }
 
 static
-int increase_packet_size(struct ctf_stream_pos *pos)
+int resize_packet(struct ctf_stream_pos *pos, uint64_t packet_size)
 {
 	int ret;
 
@@ -2330,7 +2717,7 @@ int increase_packet_size(struct ctf_stream_pos *pos)
 		goto end;
 	}
 
-	pos->packet_size += PACKET_LEN_INCREMENT;
+	pos->packet_size = packet_size;
 	do {
 		ret = bt_posix_fallocate(pos->fd, pos->mmap_offset,
 			pos->packet_size / CHAR_BIT);
@@ -2350,6 +2737,28 @@ end:
 	return ret;
 }
 
+static
+int increase_packet_size(struct ctf_stream_pos *pos)
+{
+	return resize_packet(pos, pos->packet_size + PACKET_LEN_INCREMENT);
+}
+
+BT_HIDDEN
+int bt_ctf_stream_pos_reserve(struct ctf_stream_pos *pos, uint64_t bit_len)
+{
+	uint64_t packet_size = pos->packet_size;
+
+	if (ctf_pos_access_ok(pos, bit_len)) {
+		return 0;
+	}
+
+	/* Grow once rather than by one increment at a time. */
+	while (pos->offset + bit_len > packet_size) {
+		packet_size += PACKET_LEN_INCREMENT;
+	}
+	return resize_packet(pos, packet_size);
+}
+
 static
 void generic_field_freeze(struct bt_ctf_field *field)
 {
@@ -2450,6 +2859,166 @@ end:
 	return;
 }
 
+/*
+ * Releases the variant tags and sequence lengths which a field tree
+ * borrows from its own fields, so that the reference count of each of
+ * them only counts its parent and its users.
+ */
+static
+void field_put_borrowed(struct bt_ctf_field *field)
+{
+	size_t i;
+	GPtrArray *children = NULL;
+	struct bt_ctf_field *payload = NULL;
+
+	switch (bt_ctf_field_get_type_id(field)) {
+	case BT_CTF_TYPE_ID_STRUCT:
+		children = container_of(field,
+			struct bt_ctf_field_structure, parent)->fields;
+		break;
+	case BT_CTF_TYPE_ID_VARIANT:
+	{
+		struct bt_ctf_field_variant *variant = container_of(field,
+			struct bt_ctf_field_variant, parent);
+
+		BT_PUT(variant->tag);
+		payload = variant->payload;
+		break;
+	}
+	case BT_CTF_TYPE_ID_ARRAY:
+		children = container_of(field,
+			struct bt_ctf_field_array, parent)->elements;
+		break;
+	case BT_CTF_TYPE_ID_SEQUENCE:
+	{
+		struct bt_ctf_field_sequence *sequence = container_of(field,
+			struct bt_ctf_field_sequence, parent);
+
+		BT_PUT(sequence->length);
+		children = sequence->elements;
+		break;
+	}
+	default:
+		break;
+	}
+
+	/* Fields referenced elsewhere are not recycled: skip them. */
+	if (payload && bt_object_get_ref_count(payload) == 1) {
+		field_put_borrowed(payload);
+	}
+
+	for (i = 0; children && i < children->len; i++) {
+		struct bt_ctf_field *child = children->pdata[i];
+
+		if (child && bt_object_get_ref_count(child) == 1) {
+			field_put_borrowed(child);
+		}
+	}
+}
+
+static
+void field_thaw(struct bt_ctf_field *field);
+
+static
+void thaw_child(struct bt_ctf_field **child)
+{
+	if (!*child) {
+		return;
+	}
+
+	if (bt_object_get_ref_count(*child) > 1) {
+		/*
+		 * Still referenced by a copy or by a user: leave it to
+		 * them, the parent creates a new one when needed.
+		 */
+		BT_PUT(*child);
+		return;
+	}
+
+	(*child)->shared = 0;
+	field_thaw(*child);
+}
+
+static
+void field_thaw(struct bt_ctf_field *field)
+{
+	size_t i;
+	GPtrArray *children = NULL;
+
+	if (!field) {
+		goto end;
+	}
+
+	/*
+	 * Variant tags and sequence lengths are borrowed from other
+	 * fields: they are thawed with the field tree owning them.
+	 */
+	switch (bt_ctf_field_get_type_id(field)) {
+	case BT_CTF_TYPE_ID_ENUM:
+		thaw_child(&container_of(field,
+			struct bt_ctf_field_enumeration, parent)->payload);
+		break;
+	case BT_CTF_TYPE_ID_STRUCT:
+		children = container_of(field,
+			struct bt_ctf_field_structure, parent)->fields;
+		break;
+	case BT_CTF_TYPE_ID_VARIANT:
+		thaw_child(&container_of(field,
+			struct bt_ctf_field_variant, parent)->payload);
+		break;
+	case BT_CTF_TYPE_ID_ARRAY:
+		children = container_of(field,
+			struct bt_ctf_field_array, parent)->elements;
+		break;
+	case BT_CTF_TYPE_ID_SEQUENCE:
+		children = container_of(field,
+			struct bt_ctf_field_sequence, parent)->elements;
+		break;
+	default:
+		break;
+	}
+
+	for (i = 0; children && i < children->len; i++) {
+		thaw_child((struct bt_ctf_field **) &children->pdata[i]);
+	}
+
+	if (bt_ctf_field_get_type_id(field) == BT_CTF_TYPE_ID_SEQUENCE) {
+		struct bt_ctf_field_sequence *sequence = container_of(field,
+			struct bt_ctf_field_sequence, parent);
+
+		/*
+		 * The remaining elements are referenced by this sequence
+		 * only: keep them aside for the next length.
+		 */
+		if (sequence->elements) {
+			if (sequence->spare_elements) {
+				g_ptr_array_free(sequence->spare_elements,
+					TRUE);
+			}
+
+			sequence->spare_elements = sequence->elements;
+			sequence->elements = NULL;
+		}
+
+	}
+
+	field->frozen = 0;
+end:
+	return;
+}
+
+BT_HIDDEN
+void bt_ctf_field_recycle(struct bt_ctf_field *field)
+{
+	if (!field) {
+		return;
+	}
+
+	field_put_borrowed(field);
+	field_thaw(field);
+	(void) bt_ctf_field_reset(field);
+}
+
 static
 bool bt_ctf_field_generic_is_set(struct bt_ctf_field *field)
 {
@@ -140,6 +140,71 @@ end:
 	return ret;
 }
 
+int bt_ctf_packet_set_origin(struct bt_ctf_packet *packet,
+		const char *path, uint64_t offset, uint64_t size,
+		uint64_t data_offset)
+{
+	int ret = 0;
+
+	if (!packet || !path) {
+		ret = -1;
+		goto end;
+	}
+
+	if (!packet->origin.path) {
+		packet->origin.path = g_string_new(path);
+		if (!packet->origin.path) {
+			ret = -1;
+			goto end;
+		}
+	} else {
+		g_string_assign(packet->origin.path, path);
+	}
+
+	packet->origin.offset = offset;
+	packet->origin.size = size;
+	packet->origin.data_offset = data_offset;
+	packet->origin.event_count = -1ULL;
+end:
+	return ret;
+}
+
+int bt_ctf_packet_set_origin_event_count(struct bt_ctf_packet *packet,
+		uint64_t event_count)
+{
+	int ret = 0;
+
+	if (!packet || !packet->origin.path) {
+		ret = -1;
+		goto end;
+	}
+
+	packet->origin.event_count = event_count;
+end:
+	return ret;
+}
+
+int bt_ctf_packet_get_origin(struct bt_ctf_packet *packet,
+		const char **path, uint64_t *offset, uint64_t *size,
+		uint64_t *data_offset, uint64_t *event_count)
+{
+	int ret = 0;
+
+	if (!packet || !packet->origin.path || !path || !offset || !size ||
+			!data_offset || !event_count) {
+		ret = -1;
+		goto end;
+	}
+
+	*path = packet->origin.path->str;
+	*offset = packet->origin.offset;
+	*size = packet->origin.size;
+	*data_offset = packet->origin.data_offset;
+	*event_count = packet->origin.event_count;
+end:
+	return ret;
+}
+
 BT_HIDDEN
 void bt_ctf_packet_freeze(struct bt_ctf_packet *packet)
 {
@@ -161,6 +226,9 @@ void bt_ctf_packet_destroy(struct bt_object *obj)
 	bt_put(packet->header);
 	bt_put(packet->context);
 	bt_put(packet->stream);
+	if (packet->origin.path) {
+		g_string_free(packet->origin.path, TRUE);
+	}
 	g_free(packet);
 }
 
@@ -50,6 +50,8 @@ static
 int try_set_structure_field_integer(struct bt_ctf_field *, char *, uint64_t);
 static
 int set_structure_field_integer(struct bt_ctf_field *, char *, uint64_t);
+static
+int get_event_header_timestamp(struct bt_ctf_field *, uint64_t *);
 
 static
 int set_integer_field_value(struct bt_ctf_field* field, uint64_t value)
@@ -296,6 +298,62 @@ void release_event(struct bt_ctf_event *event)
 	}
 }
 
+/*
+ * Advances "offset" (bits) past a field of type "type" serialized there.
+ * Returns -1 if the size of such a field varies.
+ */
+static
+int skip_fixed_size_field(struct bt_ctf_field_type *type, uint64_t *offset)
+{
+	int ret = 0;
+	int64_t i, count;
+	struct bt_ctf_field_type *child = NULL;
+	const char *name;
+
+	*offset += offset_align(*offset, bt_ctf_field_type_get_alignment(type));
+
+	switch (bt_ctf_field_type_get_type_id(type)) {
+	case BT_CTF_TYPE_ID_INTEGER:
+		*offset += bt_ctf_field_type_integer_get_size(type);
+		break;
+	case BT_CTF_TYPE_ID_FLOAT:
+		*offset += bt_ctf_field_type_floating_point_get_exponent_digits(
+				type) +
+			bt_ctf_field_type_floating_point_get_mantissa_digits(
+				type);
+		break;
+	case BT_CTF_TYPE_ID_ENUM:
+		child = bt_ctf_field_type_enumeration_get_container_type(type);
+		ret = skip_fixed_size_field(child, offset);
+		break;
+	case BT_CTF_TYPE_ID_STRUCT:
+		count = bt_ctf_field_type_structure_get_field_count(type);
+		for (i = 0; i < count && !ret; i++) {
+			BT_PUT(child);
+			ret = bt_ctf_field_type_structure_get_field(type, &name,
+					&child, i);
+			if (!ret) {
+				ret = skip_fixed_size_field(child, offset);
+			}
+		}
+		break;
+	case BT_CTF_TYPE_ID_ARRAY:
+		child = bt_ctf_field_type_array_get_element_type(type);
+		count = bt_ctf_field_type_array_get_length(type);
+		for (i = 0; i < count && !ret; i++) {
+			ret = skip_fixed_size_field(child, offset);
+		}
+		break;
+	default:
+		/* Strings, sequences and variants */
+		ret = -1;
+		break;
+	}
+
+	bt_put(child);
+	return ret ? -1 : 0;
+}
+
 static
 int create_stream_file(struct bt_ctf_writer *writer,
 		struct bt_ctf_stream *stream)
@@ -429,6 +487,15 @@ struct bt_ctf_stream *bt_ctf_stream_create(
 			goto error;
 		}
 
+		stream->packet_events_offset = 0;
+		stream->serialize_on_append = !skip_fixed_size_field(
+				trace->packet_header_type,
+				&stream->packet_events_offset) &&
+			(!stream_class->packet_context_type ||
+			 !skip_fixed_size_field(
+				stream_class->packet_context_type,
+				&stream->packet_events_offset));
+
 		/* Create file associated with this stream */
 		fd = create_stream_file(writer, stream);
 		if (fd < 0) {
@@ -678,6 +745,105 @@ end:
 	return ret;
 }
 
+static
+int serialize_event(struct bt_ctf_event *event, struct ctf_stream_pos *pos)
+{
+	int ret;
+
+	/* Write event header */
+	ret = bt_ctf_field_serialize(event->event_header, pos);
+	if (ret) {
+		goto end;
+	}
+
+	/* Write stream event context */
+	if (event->stream_event_context) {
+		ret = bt_ctf_field_serialize(event->stream_event_context, pos);
+		if (ret) {
+			goto end;
+		}
+	}
+
+	/* Write event content */
+	ret = bt_ctf_event_serialize(event, pos);
+end:
+	return ret;
+}
+
+/* Maps the next packet and skips the room for its header and context. */
+static
+int begin_packet(struct bt_ctf_stream *stream)
+{
+	int ret = 0;
+
+	ctf_packet_seek(&stream->pos.parent, 0, SEEK_CUR);
+	if (bt_ctf_stream_pos_reserve(&stream->pos,
+			stream->packet_events_offset) ||
+			!ctf_move_pos(&stream->pos,
+				stream->packet_events_offset)) {
+		ret = -1;
+		goto end;
+	}
+
+	stream->packet_open = true;
+	stream->packet_event_count = 0;
+	stream->has_timestamp_begin = false;
+	stream->has_timestamp_end = false;
+end:
+	return ret;
+}
+
+static
+int append_serialized_event(struct bt_ctf_stream *stream,
+		struct bt_ctf_event *event)
+{
+	int ret = 0;
+	uint64_t offset, timestamp;
+
+	if (!stream->packet_open) {
+		ret = begin_packet(stream);
+		if (ret) {
+			goto end;
+		}
+	}
+
+	offset = stream->pos.offset;
+	ret = serialize_event(event, &stream->pos);
+	if (ret) {
+		/* Drop what was written of the event. */
+		stream->pos.offset = offset;
+		goto end;
+	}
+
+	if (!get_event_header_timestamp(event->event_header, &timestamp)) {
+		if (stream->packet_event_count == 0) {
+			stream->timestamp_begin = timestamp;
+			stream->has_timestamp_begin = true;
+		}
+		stream->timestamp_end = timestamp;
+		stream->has_timestamp_end = true;
+	} else {
+		stream->has_timestamp_end = false;
+	}
+
+	stream->packet_event_count++;
+end:
+	return ret;
+}
+
+/*
+ * Release function of the events which a stream serialized as soon as
+ * they were appended: the stream does not keep them, so they remain
+ * its children only until their last reference is dropped.
+ */
+static
+void release_serialized_event(struct bt_object *obj)
+{
+	BT_PUT(obj->parent);
+	obj->ref_count.release = generic_release;
+	bt_object_release(obj);
+}
+
 int bt_ctf_stream_append_event(struct bt_ctf_stream *stream,
 		struct bt_ctf_event *event)
 {
@@ -715,6 +881,17 @@ int bt_ctf_stream_append_event(struct bt_ctf_stream *stream,
 
 	/* Save the new event and freeze it */
 	bt_ctf_event_freeze(event);
+	if (stream->serialize_on_append) {
+		ret = append_serialized_event(stream, event);
+		if (ret) {
+			goto error;
+		}
+
+		/* Keeps its reference to its class while it lives. */
+		event->base.ref_count.release = release_serialized_event;
+		goto end;
+	}
+
 	g_ptr_array_add(stream->events, event);
 
 	/*
@@ -879,14 +1056,66 @@ void reset_structure_field(struct bt_ctf_field *structure, const char *name)
 	bt_put(member);
 }
 
-int bt_ctf_stream_flush(struct bt_ctf_stream *stream)
+/* Already-encoded events to write instead of the appended ones */
+struct encoded_events {
+	/* Beginning of their packet */
+	const uint8_t *packet;
+	/* Offsets from the beginning of the packet (bits) */
+	uint64_t offset;
+	uint64_t content_size;
+	unsigned int alignment;
+};
+
+/* Whether encoded events can be written at bit "offset" of a packet. */
+static
+bool encoded_events_fit(const struct encoded_events *encoded,
+		uint64_t offset)
+{
+	uint64_t alignment = max_t(uint64_t, encoded->alignment, CHAR_BIT);
+
+	/*
+	 * Fields are aligned relative to the beginning of their packet:
+	 * the events can only move by a multiple of their alignment.
+	 * They are copied byte by byte.
+	 */
+	return encoded->offset % alignment == offset % alignment &&
+		encoded->offset % CHAR_BIT == 0;
+}
+
+static
+int write_encoded_events(struct bt_ctf_stream *stream,
+		const struct encoded_events *encoded)
+{
+	struct ctf_stream_pos *pos = &stream->pos;
+	uint64_t bit_len = encoded->content_size - encoded->offset;
+
+	if (!encoded_events_fit(encoded, pos->offset)) {
+		return 1;
+	}
+
+	if (bt_ctf_stream_pos_reserve(pos, bit_len)) {
+		return -1;
+	}
+
+	memcpy(ctf_get_pos_addr(pos), &encoded->packet[encoded->offset / CHAR_BIT],
+		(bit_len + CHAR_BIT - 1) / CHAR_BIT);
+	if (!ctf_move_pos(pos, bit_len)) {
+		return -1;
+	}
+
+	return 0;
+}
+
+static
+int flush_packet(struct bt_ctf_stream *stream,
+		const struct encoded_events *encoded)
 {
 	int ret = 0;
 	size_t i;
 	uint64_t timestamp_begin, timestamp_end;
+	bool has_timestamp_begin = false, has_timestamp_end = false;
 	struct bt_ctf_field *integer = NULL;
 	struct ctf_stream_pos packet_context_pos;
-	bool empty_packet;
 	uint64_t packet_size_bits;
 	struct {
 		bool timestamp_begin;
@@ -914,20 +1143,44 @@ int bt_ctf_stream_flush(struct bt_ctf_stream *stream)
 		goto end;
 	}
 
-	empty_packet = (stream->events->len == 0);
+	if (stream->serialize_on_append) {
+		/* Only the header and context are left to write. */
+		if (!stream->packet_open) {
+			ret = begin_packet(stream);
+			if (ret) {
+				goto end;
+			}
+		}
 
-	/* mmap the next packet */
-	ctf_packet_seek(&stream->pos.parent, 0, SEEK_CUR);
-	ret = bt_ctf_field_serialize(stream->packet_header, &stream->pos);
-	if (ret) {
-		goto end;
+		has_timestamp_begin = stream->has_timestamp_begin;
+		timestamp_begin = stream->timestamp_begin;
+		has_timestamp_end = stream->has_timestamp_end;
+		timestamp_end = stream->timestamp_end;
+	} else {
+		/* mmap the next packet */
+		ctf_packet_seek(&stream->pos.parent, 0, SEEK_CUR);
+		ret = bt_ctf_field_serialize(stream->packet_header,
+			&stream->pos);
+		if (ret) {
+			goto end;
+		}
+
+		if (stream->events->len > 0) {
+			has_timestamp_begin = !get_event_header_timestamp(
+				((struct bt_ctf_event *) g_ptr_array_index(
+					stream->events, 0))->event_header,
+				&timestamp_begin);
+			has_timestamp_end = !get_event_header_timestamp(
+				((struct bt_ctf_event *) g_ptr_array_index(
+					stream->events,
+					stream->events->len - 1))->event_header,
+				&timestamp_end);
+		}
 	}
 
 	if (stream->packet_context) {
 		/* Set the default context attributes if present and unset. */
-		if (!empty_packet && !get_event_header_timestamp(
-			((struct bt_ctf_event *) g_ptr_array_index(
-				stream->events, 0))->event_header, &timestamp_begin)) {
+		if (has_timestamp_begin) {
 			ret = try_set_structure_field_integer(
 				stream->packet_context,
 				"timestamp_begin", timestamp_begin);
@@ -937,11 +1190,7 @@ int bt_ctf_stream_flush(struct bt_ctf_stream *stream)
 			auto_set_fields.timestamp_begin = ret == 1;
 		}
 
-		if (!empty_packet && !get_event_header_timestamp(
-			((struct bt_ctf_event *) g_ptr_array_index(
-				stream->events, stream->events->len - 1))->event_header,
-				&timestamp_end)) {
-
+		if (has_timestamp_end) {
 			ret = try_set_structure_field_integer(
 				stream->packet_context,
 				"timestamp_end", timestamp_end);
@@ -950,20 +1199,27 @@ int bt_ctf_stream_flush(struct bt_ctf_stream *stream)
 			}
 			auto_set_fields.timestamp_end = ret == 1;
 		}
+
+		/*
+		 * The sizes are only known once the events are written: set
+		 * them to a placeholder which fits any integer size.
+		 */
 		ret = try_set_structure_field_integer(stream->packet_context,
-			"content_size", UINT64_MAX);
+			"content_size", 0);
 		if (ret < 0) {
 			goto end;
 		}
 		auto_set_fields.content_size = ret == 1;
 
 		ret = try_set_structure_field_integer(stream->packet_context,
-			"packet_size", UINT64_MAX);
+			"packet_size", 0);
 		if (ret < 0) {
 			goto end;
 		}
 		auto_set_fields.packet_size = ret == 1;
+	}
 
+	if (stream->packet_context && !stream->serialize_on_append) {
 		/* Write packet context */
 		memcpy(&packet_context_pos, &stream->pos,
 			sizeof(struct ctf_stream_pos));
@@ -974,28 +1230,16 @@ int bt_ctf_stream_flush(struct bt_ctf_stream *stream)
 		}
 	}
 
-	for (i = 0; i < stream->events->len; i++) {
-		struct bt_ctf_event *event = g_ptr_array_index(
-			stream->events, i);
-
-		/* Write event header */
-		ret = bt_ctf_field_serialize(event->event_header,
-			&stream->pos);
+	if (encoded) {
+		ret = write_encoded_events(stream, encoded);
 		if (ret) {
 			goto end;
 		}
+	}
 
-		/* Write stream event context */
-		if (event->stream_event_context) {
-			ret = bt_ctf_field_serialize(
-				event->stream_event_context, &stream->pos);
-			if (ret) {
-				goto end;
-			}
-		}
-
-		/* Write event content */
-		ret = bt_ctf_event_serialize(event, &stream->pos);
+	for (i = 0; !encoded && i < stream->events->len; i++) {
+		ret = serialize_event(g_ptr_array_index(stream->events, i),
+			&stream->pos);
 		if (ret) {
 			goto end;
 		}
@@ -1007,13 +1251,7 @@ int bt_ctf_stream_flush(struct bt_ctf_stream *stream)
 	stream->pos.packet_size = packet_size_bits;
 
 	if (stream->packet_context) {
-		/*
-		 * Update the packet total size and content size and overwrite
-		 * the packet context.
-		 * Copy base_mma as the packet may have been remapped (e.g. when
-		 * a packet is resized).
-		 */
-		packet_context_pos.base_mma = stream->pos.base_mma;
+		/* Update the packet total size and content size. */
 		if (auto_set_fields.content_size) {
 			ret = set_structure_field_integer(
 					stream->packet_context,
@@ -1030,7 +1268,41 @@ int bt_ctf_stream_flush(struct bt_ctf_stream *stream)
 				goto end;
 			}
 		}
+	}
+
+	if (stream->serialize_on_append) {
+		/* Write the header and context in the room left for them. */
+		memcpy(&packet_context_pos, &stream->pos,
+			sizeof(struct ctf_stream_pos));
+		packet_context_pos.offset = 0;
+		ret = bt_ctf_field_serialize(stream->packet_header,
+			&packet_context_pos);
+		if (ret) {
+			goto end;
+		}
+
+		if (stream->packet_context) {
+			ret = bt_ctf_field_serialize(stream->packet_context,
+				&packet_context_pos);
+			if (ret) {
+				goto end;
+			}
+		}
+
+		if (packet_context_pos.offset != stream->packet_events_offset) {
+			ret = -1;
+			goto end;
+		}
 
+		stream->packet_open = false;
+		stream->packet_event_count = 0;
+	} else if (stream->packet_context) {
+		/*
+		 * Overwrite the packet context.
+		 * Copy base_mma as the packet may have been remapped (e.g. when
+		 * a packet is resized).
+		 */
+		packet_context_pos.base_mma = stream->pos.base_mma;
 		ret = bt_ctf_field_serialize(stream->packet_context,
 			&packet_context_pos);
 		if (ret) {
@@ -1061,7 +1333,7 @@ end:
 	}
 	bt_put(integer);
 
-	if (ret < 0) {
+	if (ret && stream && !stream->packet_open) {
 		/*
 		 * We failed to write the packet. Its size is therefore set to 0
 		 * to ensure the next mapping is done in the same place rather
@@ -1073,6 +1345,50 @@ end:
 	return ret;
 }
 
+int bt_ctf_stream_flush(struct bt_ctf_stream *stream)
+{
+	return flush_packet(stream, NULL);
+}
+
+int bt_ctf_stream_flush_encoded_events(struct bt_ctf_stream *stream,
+		const uint8_t *packet, uint64_t offset, uint64_t content_size,
+		unsigned int alignment)
+{
+	struct encoded_events encoded = {
+		.packet = packet,
+		.offset = offset,
+		.content_size = content_size,
+		.alignment = alignment,
+	};
+
+	if (!stream || !packet || offset > content_size ||
+			(alignment & (alignment - 1))) {
+		return -1;
+	}
+
+	/*
+	 * The encoded events replace the appended ones, from which the
+	 * packet's timestamps are still taken.
+	 */
+	if (stream->packet_open) {
+		if (!encoded_events_fit(&encoded,
+				stream->packet_events_offset)) {
+			/* Keep the appended events. */
+			return 1;
+		}
+
+		stream->pos.offset = stream->packet_events_offset;
+		stream->packet_event_count = 0;
+	} else if (stream->serialize_on_append &&
+			!encoded_events_fit(&encoded,
+				stream->packet_events_offset)) {
+		/* Don't begin a packet which the events can't fill. */
+		return 1;
+	}
+
+	return flush_packet(stream, &encoded);
+}
+
 void bt_ctf_stream_get(struct bt_ctf_stream *stream)
 {
 	bt_get(stream);
@@ -71,6 +71,8 @@ struct bt_component_class_iterator_methods {
 	bt_component_class_notification_iterator_get_method get;
 	bt_component_class_notification_iterator_next_method next;
 	bt_component_class_notification_iterator_seek_time_method seek_time;
+	/* Optional: emulated with next and get if missing */
+	bt_component_class_notification_iterator_next_batch_method next_batch;
 };
 
 struct bt_component_class_source {
@@ -53,6 +53,11 @@ int bt_component_class_source_set_notification_iterator_seek_time_method(
 		struct bt_component_class *component_class,
 		bt_component_class_notification_iterator_seek_time_method notification_iterator_seek_time_method);
 
+extern
+int bt_component_class_source_set_notification_iterator_next_batch_method(
+		struct bt_component_class *component_class,
+		bt_component_class_notification_iterator_next_batch_method notification_iterator_next_batch_method);
+
 #ifdef __cplusplus
 }
 #endif
@@ -27,6 +27,7 @@
 
 #include <babeltrace/component/component.h>
 #include <stdint.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -37,6 +38,7 @@ struct bt_component;
 struct bt_port;
 struct bt_connection;
 struct bt_value;
+struct bt_notification;
 struct bt_notification_iterator;
 
 /**
@@ -79,6 +81,19 @@ typedef enum bt_notification_iterator_status
 		(*bt_component_class_notification_iterator_seek_time_method)(
 		struct bt_notification_iterator *iterator, int64_t time);
 
+/*
+ * Fills notifications with up to capacity new references and sets
+ * *count accordingly. A status other than
+ * BT_NOTIFICATION_ITERATOR_STATUS_OK may come with notifications: it is
+ * then reported to the user on the next call instead of calling the
+ * method.
+ */
+typedef enum bt_notification_iterator_status
+		(*bt_component_class_notification_iterator_next_batch_method)(
+		struct bt_notification_iterator *iterator,
+		struct bt_notification **notifications, size_t capacity,
+		size_t *count);
+
 typedef struct bt_value *(*bt_component_class_query_method)(
 		struct bt_component_class *component_class,
 		const char *object, struct bt_value *params);
@@ -47,6 +47,13 @@ extern struct bt_port *bt_component_filter_get_input_port_at_index(
 extern struct bt_port *bt_component_filter_get_default_input_port(
 		struct bt_component *component);
 
+/* Only allowed during the filter's initialization. */
+extern struct bt_port *bt_component_filter_add_input_port(
+		struct bt_component *component, const char *name);
+/* Only allowed during the filter's initialization. */
+extern enum bt_component_status bt_component_filter_remove_input_port(
+		struct bt_component *component, const char *name);
+
 extern enum bt_component_status bt_component_filter_get_output_port_count(
 		struct bt_component *component, uint64_t *count);
 extern struct bt_port *bt_component_filter_get_output_port(
@@ -56,6 +63,13 @@ extern struct bt_port *bt_component_filter_get_output_port_at_index(
 extern struct bt_port *bt_component_filter_get_default_output_port(
 		struct bt_component *component);
 
+/* Only allowed during the filter's initialization. */
+extern struct bt_port *bt_component_filter_add_output_port(
+		struct bt_component *component, const char *name);
+/* Only allowed during the filter's initialization. */
+extern enum bt_component_status bt_component_filter_remove_output_port(
+		struct bt_component *component, const char *name);
+
 #ifdef __cplusplus
 }
 #endif
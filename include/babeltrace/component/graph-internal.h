@@ -31,6 +31,24 @@
 #include <babeltrace/babeltrace-internal.h>
 #include <babeltrace/object-internal.h>
 #include <glib.h>
+#include <stdint.h>
+
+enum bt_graph_ready_source_type {
+	BT_GRAPH_READY_SOURCE_FD,
+	BT_GRAPH_READY_SOURCE_TIMEOUT,
+	BT_GRAPH_READY_SOURCE_WAKE_UP,
+};
+
+/* Readiness source of a component, see bt_graph_add_ready_fd(). */
+struct bt_graph_ready_source {
+	enum bt_graph_ready_source_type type;
+	/* Weak reference */
+	struct bt_component *component;
+	/* File descriptor of a BT_GRAPH_READY_SOURCE_FD source, else -1 */
+	int fd;
+	/* CLOCK_MONOTONIC time (ns) at which a timeout expires */
+	int64_t deadline;
+};
 
 struct bt_graph {
 	/**
@@ -51,6 +69,38 @@ struct bt_graph {
 	GPtrArray *components;
 	/* Queue of pointers (weak references) to sink bt_components. */
 	GQueue *sinks_to_consume;
+	/*
+	 * Queue of pointers (weak references) to sink bt_components which
+	 * returned AGAIN, put back in sinks_to_consume once one of their
+	 * readiness sources is ready or, without any, once the other sinks
+	 * were consumed.
+	 */
+	GQueue *sinks_waiting;
+	/* Number of sinks consumed since the readiness sources were checked */
+	unsigned int consumed_since_check;
+	/* Array of struct bt_graph_ready_source */
+	GArray *ready_sources;
+	/*
+	 * epoll instance watching the file descriptors of ready_sources
+	 * and the read end of wake_pipe; -1 without epoll support.
+	 */
+	int epoll_fd;
+	/*
+	 * bt_graph_wake_up() writes the address of the component to wake
+	 * up to this pipe.
+	 */
+	int wake_pipe[2];
+	/*
+	 * Set when bt_graph_wake_up() finds the pipe full: all the waiting
+	 * sinks are then woken up.
+	 */
+	volatile gint wake_all;
+	/*
+	 * Capacity of the queues fed by the upstream iterators of the
+	 * connections, each advanced by its own thread; 0 if the
+	 * iterators are advanced by their users.
+	 */
+	unsigned int notification_queue_capacity;
 };
 
 #endif /* BABELTRACE_COMPONENT_COMPONENT_GRAPH_INTERNAL_H */
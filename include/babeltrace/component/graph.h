@@ -28,6 +28,7 @@
  */
 
 #include <babeltrace/component/component.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -74,10 +75,70 @@ extern enum bt_graph_status bt_graph_add_component_as_sibling(
 		struct bt_component *new_component);
 
 /**
- * Run graph to completion or until a single sink is left and "AGAIN" is received.
+ * Sets the capacity of the notification queues of the connections created
+ * afterwards.
+ *
+ * With a non-zero capacity, the notification iterator created on a
+ * connection is advanced by its own thread, up to "capacity" notifications
+ * ahead of the downstream component, so that the components of a pipeline
+ * run concurrently. The default, 0, runs them all in the thread consuming
+ * the graph.
+ */
+extern enum bt_graph_status bt_graph_set_notification_queue_capacity(
+		struct bt_graph *graph, unsigned int capacity);
+
+/**
+ * Adds a file descriptor to the readiness sources of a component of a graph.
+ *
+ * A sink returning "AGAIN" is parked: it is not consumed again until one of
+ * the readiness sources of itself or of a component upstream of it is ready.
+ * A file descriptor is ready when it is readable; it stays registered until
+ * it is removed. Periodic timers may be registered as a timerfd.
+ */
+extern enum bt_graph_status bt_graph_add_ready_fd(struct bt_graph *graph,
+		struct bt_component *component, int fd);
+
+extern enum bt_graph_status bt_graph_remove_ready_fd(struct bt_graph *graph,
+		int fd);
+
+/**
+ * Makes a component of a graph ready after at most "timeout_ms"
+ * milliseconds. The timeout is one-shot; the earliest of the pending
+ * timeouts of a component wins.
+ */
+extern enum bt_graph_status bt_graph_set_ready_timeout(
+		struct bt_graph *graph, struct bt_component *component,
+		uint64_t timeout_ms);
+
+/**
+ * Registers a component of a graph as one which makes itself ready with
+ * "bt_graph_wake_up()", typically from another thread.
+ */
+extern enum bt_graph_status bt_graph_add_ready_wake_up(
+		struct bt_graph *graph, struct bt_component *component);
+
+extern enum bt_graph_status bt_graph_remove_ready_wake_up(
+		struct bt_graph *graph, struct bt_component *component);
+
+/**
+ * Makes a component of a graph ready, waking up "bt_graph_run()" if it is
+ * waiting. Unlike the other functions of the graph, this one may be called
+ * from any thread.
+ */
+extern enum bt_graph_status bt_graph_wake_up(struct bt_graph *graph,
+		struct bt_component *component);
+
+/**
+ * Run graph to completion or until all its sinks returned "AGAIN" without a
+ * readiness source to wait for.
  *
  * Runs "bt_component_sink_consume()" on all sinks in round-robin until they all
- * indicate that the end is reached or that an error occured.
+ * indicate that the end is reached or that an error occured. A sink returning
+ * "AGAIN" is parked until one of its readiness sources is ready (see
+ * "bt_graph_add_ready_fd()"); a parked sink without any is retried once the
+ * other sinks had their turn. When all the sinks left are parked, waits for
+ * their readiness sources; without any, returns BT_GRAPH_STATUS_AGAIN and the
+ * caller decides when to run the graph again.
  */
 extern enum bt_graph_status bt_graph_run(struct bt_graph *graph,
 		enum bt_component_status *component_status);
@@ -85,7 +146,9 @@ extern enum bt_graph_status bt_graph_run(struct bt_graph *graph,
 /**
  * Runs "bt_component_sink_consume()" on the graph's sinks. Each invokation will
  * invoke "bt_component_sink_consume()" on the next sink, in round-robin, until
- * they all indicated that the end is reached.
+ * they all indicated that the end is reached. Unlike "bt_graph_run()", it does
+ * not wait for the readiness sources of the parked sinks: it returns
+ * BT_COMPONENT_STATUS_AGAIN if none is ready.
  */
 extern enum bt_component_status bt_graph_consume(struct bt_graph *graph);
 
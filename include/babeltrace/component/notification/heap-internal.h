@@ -34,6 +34,7 @@ struct bt_notification_heap {
 	struct bt_object base;
 	GPtrArray *ptrs;
 	size_t count;
+	/* NULL when the heap is ordered by sort keys. */
 	bt_notification_time_compare_func compare;
 	void *compare_data;
 };
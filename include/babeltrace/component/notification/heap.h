@@ -54,6 +54,20 @@ typedef bool (*bt_notification_time_compare_func)(
 extern struct bt_notification_heap *bt_notification_heap_create(
 		bt_notification_time_compare_func comparator, void *user_data);
 
+/**
+ * bt_notification_heap_create_sort_key - create a new bt_notification heap
+ * ordered by the notifications' sort keys.
+ *
+ * Notifications are compared using the sort key set with
+ * bt_notification_set_sort_key() (timestamp, and then tie-breaker)
+ * instead of calling a user comparator. This avoids any clock value
+ * lookup during heap operations. A notification without a sort key is
+ * ordered as if its timestamp and tie-breaker were 0.
+ *
+ * Returns a new notification heap, NULL on error.
+ */
+extern struct bt_notification_heap *bt_notification_heap_create_sort_key(void);
+
 /**
  * bt_notification_heap_insert - insert an element into the heap
  *
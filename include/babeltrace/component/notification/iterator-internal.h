@@ -27,14 +27,44 @@
  * SOFTWARE.
  */
 
+#include <stdbool.h>
+#include <pthread.h>
 #include <babeltrace/babeltrace-internal.h>
 #include <babeltrace/ref-internal.h>
 #include <babeltrace/component/notification/iterator.h>
 
+struct bt_component_class_iterator_methods;
+struct bt_notification_queue;
+
+/*
+ * State of an iterator whose component's methods are called by a
+ * dedicated thread, ahead of the iterator's user.
+ */
+struct bt_notification_iterator_prefetch {
+	struct bt_notification_queue *queue;
+	pthread_t thread;
+	bool running;
+	/* Last popped notification, returned by the get method */
+	struct bt_notification *current;
+	/* Status which ended the popped sequence of notifications */
+	enum bt_notification_iterator_status end_status;
+	/* AGAIN was popped after the notifications of a batch */
+	bool again_pending;
+};
+
 struct bt_notification_iterator {
 	struct bt_object base;
 	struct bt_component *component;
+	/* Iterator methods of the component's class (weak) */
+	struct bt_component_class_iterator_methods *methods;
 	void *user_data;
+	/*
+	 * Status which ended an emulated batch early, returned by the
+	 * next call instead of advancing the iterator.
+	 */
+	enum bt_notification_iterator_status deferred_status;
+	/* NULL if the iterator's methods are called by its user */
+	struct bt_notification_iterator_prefetch *prefetch;
 };
 
 /**
@@ -57,4 +87,17 @@ BT_HIDDEN
 enum bt_notification_iterator_status bt_notification_iterator_validate(
 		struct bt_notification_iterator *iterator);
 
+/**
+ * Make a dedicated thread advance a notification iterator, up to
+ * "capacity" notifications ahead of its user. The thread is started
+ * by the first call advancing the iterator.
+ *
+ * @param iterator		Notification iterator instance
+ * @param capacity		Maximal number of prefetched notifications
+ * @returns			One of #bt_notification_iterator_status values
+ */
+BT_HIDDEN
+enum bt_notification_iterator_status bt_notification_iterator_enable_prefetch(
+		struct bt_notification_iterator *iterator, size_t capacity);
+
 #endif /* BABELTRACE_COMPONENT_NOTIFICATION_ITERATOR_INTERNAL_H */
@@ -28,6 +28,7 @@
  */
 
 #include <stdint.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -40,6 +41,11 @@ struct bt_notification_iterator;
  * Status code. Errors are always negative.
  */
 enum bt_notification_iterator_status {
+	/**
+	 * No notification available for now (e.g. would block), try
+	 * again later.
+	 */
+	BT_NOTIFICATION_ITERATOR_STATUS_AGAIN = 2,
 	/** No more notifications to be delivered. */
 	BT_NOTIFICATION_ITERATOR_STATUS_END = 1,
 	/** No error, okay. */
@@ -100,6 +106,32 @@ extern struct bt_notification *bt_notification_iterator_get_notification(
 extern enum bt_notification_iterator_status
 bt_notification_iterator_next(struct bt_notification_iterator *iterator);
 
+/**
+ * Advance the iterator's position forward by up to \p capacity
+ * notifications at once.
+ *
+ * On success, \p notifications contains \p *count (at least one) new
+ * notification references, in the order in which
+ * bt_notification_iterator_next() would have delivered them; the caller
+ * must put them. Otherwise, \p *count is 0 and the returned status is
+ * the one bt_notification_iterator_next() would have returned.
+ *
+ * Component classes which do not provide a batch method are handled by
+ * repeatedly advancing the iterator and getting its notification. After
+ * this function returns, the notification returned by
+ * bt_notification_iterator_get_notification() is undefined.
+ *
+ * @param iterator	Iterator instance
+ * @param notifications	Array of at least \p capacity notifications
+ * @param capacity	Maximal number of notifications to return
+ * @param count		Returned number of notifications
+ * @returns		One of #bt_notification_iterator_status values
+ */
+extern enum bt_notification_iterator_status
+bt_notification_iterator_next_batch(struct bt_notification_iterator *iterator,
+		struct bt_notification **notifications, size_t capacity,
+		size_t *count);
+
 /**
  * Seek iterator to time.
  *
@@ -109,6 +141,11 @@ bt_notification_iterator_next(struct bt_notification_iterator *iterator);
  *
  * time is expressed in nanoseconds.
  *
+ * Only #BT_NOTIFICATION_ITERATOR_SEEK_ORIGIN_EPOCH is currently supported.
+ * Once the seek is complete, the next call to
+ * bt_notification_iterator_next() positions the iterator on the first
+ * notification which does not happen prior to the requested time.
+ *
  * @param iterator	Iterator instance
  * @param seek_origin	One of #bt_notification_iterator_seek_type values.
  * @returns		One of #bt_notification_iterator_status values;
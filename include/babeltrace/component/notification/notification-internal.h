@@ -27,6 +27,8 @@
  * SOFTWARE.
  */
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <babeltrace/ref-internal.h>
 #include <babeltrace/babeltrace-internal.h>
 #include <babeltrace/object-internal.h>
@@ -44,6 +46,13 @@ struct bt_notification {
 	struct bt_object base;
 	enum bt_notification_type type;
 	get_stream_func get_stream;
+
+	/* See bt_notification_set_sort_key(). */
+	struct {
+		int64_t timestamp;
+		uint64_t tie_break;
+		bool is_set;
+	} sort_key;
 };
 
 BT_HIDDEN
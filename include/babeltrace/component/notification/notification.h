@@ -27,6 +27,8 @@
  * SOFTWARE.
  */
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -81,6 +83,36 @@ enum bt_notification_type {
 extern enum bt_notification_type bt_notification_get_type(
 		struct bt_notification *notification);
 
+/**
+ * Set a notification's sort key.
+ *
+ * The sort key is meant to be set by the component which creates the
+ * notification, at creation time, so that consumers which need to
+ * order notifications (see heap.h) do not need to look up the
+ * notification's clock values every time they compare two of them.
+ * Notifications are ordered by timestamp, and then by tie-breaker.
+ *
+ * @param notification	Notification instance
+ * @param timestamp	Timestamp (ns from Epoch)
+ * @param tie_break	Tie-breaker between notifications sharing the
+ *			same timestamp
+ * @returns		0 on success, a negative value on error
+ */
+extern int bt_notification_set_sort_key(struct bt_notification *notification,
+		int64_t timestamp, uint64_t tie_break);
+
+/**
+ * Get a notification's sort key.
+ *
+ * @param notification	Notification instance
+ * @param timestamp	Returned timestamp (ns from Epoch)
+ * @param tie_break	Returned tie-breaker
+ * @returns		0 on success, a negative value on error or if the
+ *			notification has no sort key
+ */
+extern int bt_notification_get_sort_key(struct bt_notification *notification,
+		int64_t *timestamp, uint64_t *tie_break);
+
 #ifdef __cplusplus
 }
 #endif
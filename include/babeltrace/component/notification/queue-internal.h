@@ -0,0 +1,86 @@
+#ifndef BABELTRACE_COMPONENT_NOTIFICATION_QUEUE_INTERNAL_H
+#define BABELTRACE_COMPONENT_NOTIFICATION_QUEUE_INTERNAL_H
+
+/*
+ * Babeltrace - Bounded notification queue between two threads
+ *
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <babeltrace/babeltrace-internal.h>
+#include <babeltrace/component/notification/iterator.h>
+#include <babeltrace/component/notification/notification.h>
+#include <babeltrace/component/notification/ring-internal.h>
+
+/*
+ * Bounded single-producer, single-consumer queue of notifications. The
+ * status of an item is OK for a notification; anything else stops the
+ * producer.
+ */
+struct bt_notification_queue {
+	struct bt_notification_ring ring;
+	struct bt_notification_ring_sync sync;
+	/* Set by the consumer to make the producer give up. */
+	int closed;
+};
+
+/* The capacity is rounded up to a power of two. */
+BT_HIDDEN
+struct bt_notification_queue *bt_notification_queue_create(size_t capacity);
+
+BT_HIDDEN
+void bt_notification_queue_destroy(struct bt_notification_queue *queue);
+
+/*
+ * Pushes a notification (the queue takes the caller's reference) or a
+ * status stopping the producer, waiting for room. Returns -1, without
+ * taking the notification, if the queue was closed.
+ */
+BT_HIDDEN
+int bt_notification_queue_push(struct bt_notification_queue *queue,
+		struct bt_notification *notification,
+		enum bt_notification_iterator_status status);
+
+/*
+ * Pops the next item, returning its status; the caller gets the queue's
+ * reference to its notification. If the queue is empty, waits for an
+ * item if "wait" is true; otherwise sets *notification to NULL and
+ * returns BT_NOTIFICATION_ITERATOR_STATUS_OK.
+ */
+BT_HIDDEN
+enum bt_notification_iterator_status bt_notification_queue_pop(
+		struct bt_notification_queue *queue,
+		struct bt_notification **notification, bool wait);
+
+/* Makes the producer's pending and future pushes fail. */
+BT_HIDDEN
+void bt_notification_queue_close(struct bt_notification_queue *queue);
+
+/*
+ * Drops the queued notifications and opens the queue again. Only
+ * valid while there is no producer.
+ */
+BT_HIDDEN
+void bt_notification_queue_reset(struct bt_notification_queue *queue);
+
+#endif /* BABELTRACE_COMPONENT_NOTIFICATION_QUEUE_INTERNAL_H */
@@ -0,0 +1,243 @@
+#ifndef BABELTRACE_COMPONENT_NOTIFICATION_RING_INTERNAL_H
+#define BABELTRACE_COMPONENT_NOTIFICATION_RING_INTERNAL_H
+
+/*
+ * Babeltrace - Bounded ring of notifications between two threads
+ *
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Everything is inline so that plug-ins, which cannot call the hidden
+ * functions of the library, can use the same ring.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <glib.h>
+#include <babeltrace/ref.h>
+#include <babeltrace/component/notification/iterator.h>
+#include <babeltrace/component/notification/notification.h>
+
+struct bt_notification_ring_item {
+	/* Owned by the ring while the item is queued */
+	struct bt_notification *notification;
+	/* Meaning defined by the ring's user */
+	enum bt_notification_iterator_status status;
+};
+
+/*
+ * Bounded single-producer, single-consumer ring of notifications. The
+ * indexes grow forever and are masked when accessing the items; they
+ * are updated without locking.
+ */
+struct bt_notification_ring {
+	struct bt_notification_ring_item *items;
+	/* Power of two */
+	size_t capacity;
+	/* Next item to pop; only written by the consumer. */
+	size_t head;
+	/* Next item to push; only written by the producer. */
+	size_t tail;
+};
+
+/*
+ * Lock and conditions with which the producer and the consumer of one
+ * or more rings wait for each other.
+ *
+ * The indexes and the waiting flags are accessed with sequentially
+ * consistent atomics: a side about to wait sets its flag, then checks
+ * the indexes again, while the other side updates an index, then checks
+ * the flag. One of them is guaranteed to see the other's store, so that
+ * a wake-up cannot be lost.
+ */
+struct bt_notification_ring_sync {
+	pthread_mutex_t lock;
+	/* Signaled when an item is popped, or to stop the producer. */
+	pthread_cond_t space_cond;
+	/* Signaled when an item is pushed. */
+	pthread_cond_t data_cond;
+	int producer_waiting;
+	int consumer_waiting;
+};
+
+/* The capacity is rounded up to a power of two. */
+static inline
+int bt_notification_ring_init(struct bt_notification_ring *ring,
+		size_t capacity)
+{
+	ring->head = ring->tail = 0;
+	ring->capacity = 1;
+	while (ring->capacity < capacity) {
+		ring->capacity <<= 1;
+	}
+
+	ring->items = g_new0(struct bt_notification_ring_item,
+			ring->capacity);
+	return ring->items ? 0 : -1;
+}
+
+static inline
+size_t bt_notification_ring_count(struct bt_notification_ring *ring)
+{
+	return __atomic_load_n(&ring->tail, __ATOMIC_SEQ_CST) -
+		__atomic_load_n(&ring->head, __ATOMIC_SEQ_CST);
+}
+
+static inline
+bool bt_notification_ring_is_full(struct bt_notification_ring *ring)
+{
+	return bt_notification_ring_count(ring) == ring->capacity;
+}
+
+/* Item to fill before bt_notification_ring_push(); producer only. */
+static inline
+struct bt_notification_ring_item *bt_notification_ring_tail(
+		struct bt_notification_ring *ring)
+{
+	return &ring->items[ring->tail & (ring->capacity - 1)];
+}
+
+/* Publishes the tail item, which the ring must have room for. */
+static inline
+void bt_notification_ring_push(struct bt_notification_ring *ring,
+		struct bt_notification_ring_sync *sync)
+{
+	__atomic_store_n(&ring->tail, ring->tail + 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&sync->consumer_waiting, __ATOMIC_SEQ_CST)) {
+		pthread_mutex_lock(&sync->lock);
+		pthread_cond_signal(&sync->data_cond);
+		pthread_mutex_unlock(&sync->lock);
+	}
+}
+
+/* Item to read before bt_notification_ring_pop(); consumer only. */
+static inline
+struct bt_notification_ring_item *bt_notification_ring_head(
+		struct bt_notification_ring *ring)
+{
+	return &ring->items[ring->head & (ring->capacity - 1)];
+}
+
+/* Releases the head item, whose notification was taken. */
+static inline
+void bt_notification_ring_pop(struct bt_notification_ring *ring,
+		struct bt_notification_ring_sync *sync)
+{
+	bt_notification_ring_head(ring)->notification = NULL;
+	__atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&sync->producer_waiting, __ATOMIC_SEQ_CST)) {
+		pthread_mutex_lock(&sync->lock);
+		pthread_cond_signal(&sync->space_cond);
+		pthread_mutex_unlock(&sync->lock);
+	}
+}
+
+/* Drops the queued notifications. Only valid while there is no producer. */
+static inline
+void bt_notification_ring_reset(struct bt_notification_ring *ring)
+{
+	for (; ring->head != ring->tail; ring->head++) {
+		BT_PUT(bt_notification_ring_head(ring)->notification);
+	}
+
+	ring->head = ring->tail = 0;
+}
+
+static inline
+void bt_notification_ring_fini(struct bt_notification_ring *ring)
+{
+	if (!ring->items) {
+		return;
+	}
+
+	bt_notification_ring_reset(ring);
+	g_free(ring->items);
+	ring->items = NULL;
+}
+
+static inline
+void bt_notification_ring_sync_init(struct bt_notification_ring_sync *sync)
+{
+	pthread_mutex_init(&sync->lock, NULL);
+	pthread_cond_init(&sync->space_cond, NULL);
+	pthread_cond_init(&sync->data_cond, NULL);
+	sync->producer_waiting = sync->consumer_waiting = 0;
+}
+
+static inline
+void bt_notification_ring_sync_fini(struct bt_notification_ring_sync *sync)
+{
+	pthread_cond_destroy(&sync->data_cond);
+	pthread_cond_destroy(&sync->space_cond);
+	pthread_mutex_destroy(&sync->lock);
+}
+
+/* Consumer: waits until the ring is not empty. */
+static inline
+void bt_notification_ring_wait_data(struct bt_notification_ring *ring,
+		struct bt_notification_ring_sync *sync)
+{
+	if (bt_notification_ring_count(ring) > 0) {
+		return;
+	}
+
+	pthread_mutex_lock(&sync->lock);
+	__atomic_store_n(&sync->consumer_waiting, 1, __ATOMIC_SEQ_CST);
+	while (bt_notification_ring_count(ring) == 0) {
+		pthread_cond_wait(&sync->data_cond, &sync->lock);
+	}
+	__atomic_store_n(&sync->consumer_waiting, 0, __ATOMIC_SEQ_CST);
+	pthread_mutex_unlock(&sync->lock);
+}
+
+/*
+ * Producer: waits while must_wait(data) is true. must_wait() checks
+ * the rings' room (with bt_notification_ring_is_full()) and whatever
+ * stops the producer.
+ */
+static inline
+void bt_notification_ring_wait_space(struct bt_notification_ring_sync *sync,
+		bool (*must_wait)(void *), void *data)
+{
+	pthread_mutex_lock(&sync->lock);
+	__atomic_store_n(&sync->producer_waiting, 1, __ATOMIC_SEQ_CST);
+	while (must_wait(data)) {
+		pthread_cond_wait(&sync->space_cond, &sync->lock);
+	}
+	__atomic_store_n(&sync->producer_waiting, 0, __ATOMIC_SEQ_CST);
+	pthread_mutex_unlock(&sync->lock);
+}
+
+/*
+ * Wakes up the producer, once whatever must stop it is set (with a
+ * sequentially consistent store).
+ */
+static inline
+void bt_notification_ring_wake_producer(struct bt_notification_ring_sync *sync)
+{
+	pthread_mutex_lock(&sync->lock);
+	pthread_cond_signal(&sync->space_cond);
+	pthread_mutex_unlock(&sync->lock);
+}
+
+#endif /* BABELTRACE_COMPONENT_NOTIFICATION_RING_INTERNAL_H */
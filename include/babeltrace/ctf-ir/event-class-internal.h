@@ -36,10 +36,14 @@
 #include <babeltrace/ctf-ir/stream.h>
 #include <babeltrace/object-internal.h>
 #include <glib.h>
+#include <pthread.h>
 
 #define BT_CTF_EVENT_CLASS_ATTR_ID_INDEX	0
 #define BT_CTF_EVENT_CLASS_ATTR_NAME_INDEX	1
 
+/* Maximal number of released events kept for reuse per event class */
+#define BT_CTF_EVENT_CLASS_EVENT_POOL_MAX_SIZE	32
+
 struct bt_ctf_event_class {
 	struct bt_object base;
 	struct bt_value *attributes;
@@ -60,6 +64,20 @@ struct bt_ctf_event_class {
 	/* Cached values */
 	const char *name;
 	int64_t id;
+
+	/*
+	 * Released events of this class, with their fields reset but
+	 * still allocated, waiting to be handed out again by
+	 * bt_ctf_event_create() (owned by this; NULL until the first
+	 * event is released). Pooled events hold no reference to this
+	 * event class.
+	 */
+	GPtrArray *event_pool;
+	/*
+	 * Protects event_pool: events may be created and released by
+	 * different threads.
+	 */
+	pthread_mutex_t event_pool_lock;
 };
 
 BT_HIDDEN
@@ -61,4 +61,8 @@ int bt_ctf_event_serialize(struct bt_ctf_event *event,
 BT_HIDDEN
 void bt_ctf_event_freeze(struct bt_ctf_event *event);
 
+/* Frees the released events of an event class's pool. */
+BT_HIDDEN
+void bt_ctf_event_pool_destroy(GPtrArray *event_pool);
+
 #endif /* BABELTRACE_CTF_IR_EVENT_INTERNAL_H */
@@ -147,6 +147,8 @@ struct bt_ctf_field_type_structure {
 	GHashTable *field_name_to_index;
 	GPtrArray *fields; /* Array of pointers to struct structure_field */
 	struct declaration_struct declaration;
+	/* Built when a valid structure is first serialized (see fields.c) */
+	struct bt_ctf_field_structure_plan *serialize_plan;
 };
 
 struct bt_ctf_field_type_variant {
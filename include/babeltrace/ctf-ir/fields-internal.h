@@ -38,6 +38,11 @@ struct bt_ctf_field {
 	struct bt_ctf_field_type *type;
 	int payload_set;
 	int frozen;
+	/*
+	 * A copy of the field's parent references this field instead of
+	 * copying it (see bt_ctf_field_copy()).
+	 */
+	int shared;
 };
 
 struct bt_ctf_field_integer {
@@ -65,6 +70,11 @@ struct bt_ctf_field_structure {
 struct bt_ctf_field_variant {
 	struct bt_ctf_field parent;
 	struct bt_ctf_field *tag;
+	/*
+	 * Tag value which selected the current payload. The tag field
+	 * itself may be updated in place once the payload is selected.
+	 */
+	int64_t tag_value;
 	struct bt_ctf_field *payload;
 };
 
@@ -77,6 +87,8 @@ struct bt_ctf_field_sequence {
 	struct bt_ctf_field parent;
 	struct bt_ctf_field *length;
 	GPtrArray *elements; /* Array of pointers to struct bt_ctf_field */
+	/* Elements of a recycled sequence, reused by the next length */
+	GPtrArray *spare_elements;
 };
 
 struct bt_ctf_field_string {
@@ -106,7 +118,28 @@ int bt_ctf_field_serialize(struct bt_ctf_field *field,
 BT_HIDDEN
 void bt_ctf_field_freeze(struct bt_ctf_field *field);
 
+struct bt_ctf_field_structure_plan;
+
+BT_HIDDEN
+void bt_ctf_field_structure_plan_destroy(
+		struct bt_ctf_field_structure_plan *plan);
+
+/*
+ * Grows the packet being written at "pos", if needed, so that "bit_len"
+ * more bits fit in it.
+ */
+BT_HIDDEN
+int bt_ctf_stream_pos_reserve(struct ctf_stream_pos *pos, uint64_t bit_len);
+
 BT_HIDDEN
 bool bt_ctf_field_is_set(struct bt_ctf_field *field);
 
+/*
+ * Mark field payload as unset and thaw the field and its children so
+ * that the field may be decoded or set again. Children are kept
+ * allocated, except those which are still referenced elsewhere.
+ */
+BT_HIDDEN
+void bt_ctf_field_recycle(struct bt_ctf_field *field);
+
 #endif /* BABELTRACE_CTF_IR_FIELDS_INTERNAL_H */
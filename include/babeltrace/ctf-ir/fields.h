@@ -361,6 +361,12 @@ extern int bt_ctf_field_is_variant(struct bt_ctf_field *field);
 @brief	Creates a \em deep copy of the @field \p field.
 
 You can copy a frozen field: the resulting copy is <em>not frozen</em>.
+The copy of a frozen field does not copy its contained fields right
+away: it copies each of them, on demand, when you get it with one of the
+getters which can return a field to modify, for example
+bt_ctf_field_structure_get_field(). Copying a frozen field, and then
+setting one of its contained fields, is therefore cheap regardless of
+the size of the original field.
 
 @param[in] field	Field to copy.
 @returns		Deep copy of \p field on success,
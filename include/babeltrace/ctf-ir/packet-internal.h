@@ -29,6 +29,7 @@
 #include <babeltrace/ctf-ir/stream.h>
 #include <babeltrace/object-internal.h>
 #include <babeltrace/babeltrace-internal.h>
+#include <glib.h>
 
 struct bt_ctf_packet {
 	struct bt_object base;
@@ -36,6 +37,16 @@ struct bt_ctf_packet {
 	struct bt_ctf_field *context;
 	struct bt_ctf_stream *stream;
 	int frozen;
+	/* Where the packet is decoded from; path is NULL if unknown. */
+	struct {
+		GString *path;
+		uint64_t offset;
+		uint64_t size;
+		/* Offset of the first event (bits) */
+		uint64_t data_offset;
+		/* -1ULL if unknown */
+		uint64_t event_count;
+	} origin;
 };
 
 BT_HIDDEN
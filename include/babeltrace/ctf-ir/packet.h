@@ -240,6 +240,92 @@ extern int bt_ctf_packet_set_context(
 
 /** @} */
 
+/**
+@name Origin functions
+@{
+*/
+
+/**
+@brief	Sets the origin of the CTF IR packet \p packet: the \p size
+	bytes at offset \p offset of the CTF data stream file \p path
+	from which it is decoded, its events starting at bit
+	\p data_offset of those bytes.
+
+A sink which produces CTF can copy those bytes instead of encoding the
+packet's events again, provided it gets all of them (see
+bt_ctf_packet_set_origin_event_count()).
+
+The origin is not part of the packet's content: you can set it even
+if \p packet is frozen.
+
+@param[in] packet	Packet of which to set the origin.
+@param[in] path		Path of the data stream file (copied).
+@param[in] offset	Offset of the packet in \p path (bytes).
+@param[in] size		Size of the packet (bytes).
+@param[in] data_offset	Offset of the first event from the beginning
+			of the packet (bits).
+@returns		0 on success, or a negative value on error.
+
+@prenotnull{packet}
+@prenotnull{path}
+@postrefcountsame{packet}
+
+@sa bt_ctf_packet_get_origin(): Returns the origin of a given packet.
+*/
+extern int bt_ctf_packet_set_origin(struct bt_ctf_packet *packet,
+		const char *path, uint64_t offset, uint64_t size,
+		uint64_t data_offset);
+
+/**
+@brief	Sets the number of events which the origin of the CTF IR packet
+	\p packet contains.
+
+Call this once all the events of the packet are decoded, that is,
+before creating its packet end notification.
+
+@param[in] packet	Packet of which to set the origin's event count.
+@param[in] event_count	Number of events in the origin of \p packet.
+@returns		0 on success, or a negative value on error.
+
+@prenotnull{packet}
+@pre The origin of \p packet is set with bt_ctf_packet_set_origin().
+@postrefcountsame{packet}
+*/
+extern int bt_ctf_packet_set_origin_event_count(struct bt_ctf_packet *packet,
+		uint64_t event_count);
+
+/**
+@brief	Returns the origin of the CTF IR packet \p packet.
+
+\p *event_count is set to <code>-1ULL</code> while the number of
+events of the origin is unknown.
+
+@param[in] packet	Packet of which to get the origin.
+@param[out] path	Returned path of the data stream file, valid as
+			long as \p packet exists.
+@param[out] offset	Returned offset of the packet (bytes).
+@param[out] size	Returned size of the packet (bytes).
+@param[out] data_offset	Returned offset of the first event (bits).
+@param[out] event_count	Returned number of events of the origin.
+@returns		0 on success, or a negative value on error,
+			including if the origin of \p packet is not set.
+
+@prenotnull{packet}
+@prenotnull{path}
+@prenotnull{offset}
+@prenotnull{size}
+@prenotnull{data_offset}
+@prenotnull{event_count}
+@postrefcountsame{packet}
+
+@sa bt_ctf_packet_set_origin(): Sets the origin of a given packet.
+*/
+extern int bt_ctf_packet_get_origin(struct bt_ctf_packet *packet,
+		const char **path, uint64_t *offset, uint64_t *size,
+		uint64_t *data_offset, uint64_t *event_count);
+
+/** @} */
+
 /** @} */
 
 #ifdef __cplusplus
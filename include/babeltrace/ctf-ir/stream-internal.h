@@ -35,6 +35,7 @@
 #include <babeltrace/babeltrace-internal.h>
 #include <babeltrace/ctf/types.h>
 #include <glib.h>
+#include <stdbool.h>
 
 struct bt_ctf_stream {
 	struct bt_object base;
@@ -47,6 +48,23 @@ struct bt_ctf_stream {
 	/* Writer-specific members. */
 	/* Array of pointers to bt_ctf_event for the current packet */
 	GPtrArray *events;
+	/*
+	 * The packet header and context have a fixed size: events are
+	 * serialized when they are appended, after room for the header
+	 * and context, which are written when the packet is flushed.
+	 * "events" is then unused.
+	 */
+	bool serialize_on_append;
+	/* Offset of the first event of a packet (bits) */
+	uint64_t packet_events_offset;
+	/* The current packet is mapped and has room for its header */
+	bool packet_open;
+	uint64_t packet_event_count;
+	/* Timestamps of the first and last events of the current packet */
+	bool has_timestamp_begin;
+	bool has_timestamp_end;
+	uint64_t timestamp_begin;
+	uint64_t timestamp_end;
 	struct ctf_stream_pos pos;
 	unsigned int flushed_packet_count;
 	uint64_t size;
@@ -152,6 +152,37 @@ extern int bt_ctf_stream_set_packet_context(
  */
 extern int bt_ctf_stream_flush(struct bt_ctf_stream *stream);
 
+/*
+ * bt_ctf_stream_flush_encoded_events: flush a stream with already-encoded
+ * events.
+ *
+ * Closes the current packet like bt_ctf_stream_flush(), except that its
+ * events are the bits ["offset", "content_size") of "packet", an encoded
+ * packet of an equivalent stream class (same event class IDs, field types
+ * and byte order). They replace the events appended to the current
+ * packet, if any, which should be the same: the "timestamp_begin" and
+ * "timestamp_end" packet context fields are still set automatically from
+ * the appended events.
+ *
+ * Fields are aligned relative to the beginning of their packet, so that
+ * the events may only start at the same offset modulo "alignment", the
+ * largest alignment of their fields (a power of two).
+ *
+ * @param stream Stream instance.
+ * @param packet Beginning of the encoded packet.
+ * @param offset Offset of the first event in "packet" (bits).
+ * @param content_size Content size of "packet" (bits).
+ * @param alignment Largest alignment of the events' fields (bits).
+ *
+ * Returns 0 on success, 1 if the events cannot start at the required
+ * offset (nothing is written, and the appended events are kept so that
+ * the packet may be flushed with bt_ctf_stream_flush()), a negative value
+ * on error.
+ */
+extern int bt_ctf_stream_flush_encoded_events(struct bt_ctf_stream *stream,
+		const uint8_t *packet, uint64_t offset, uint64_t content_size,
+		unsigned int alignment);
+
 extern int bt_ctf_stream_is_writer(struct bt_ctf_stream *stream);
 
 /*
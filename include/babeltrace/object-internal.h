@@ -49,7 +49,7 @@ long bt_object_get_ref_count(const void *ptr)
 {
 	const struct bt_object *obj = ptr;
 
-	return obj->ref_count.count;
+	return bt_ref_get_count(&obj->ref_count);
 }
 
 static inline
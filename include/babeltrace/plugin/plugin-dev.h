@@ -173,6 +173,7 @@ enum __bt_plugin_component_class_descriptor_attribute_type {
 	BT_PLUGIN_COMPONENT_CLASS_DESCRIPTOR_ATTRIBUTE_TYPE_NOTIF_ITER_INIT_METHOD	= 6,
 	BT_PLUGIN_COMPONENT_CLASS_DESCRIPTOR_ATTRIBUTE_TYPE_NOTIF_ITER_DESTROY_METHOD	= 7,
 	BT_PLUGIN_COMPONENT_CLASS_DESCRIPTOR_ATTRIBUTE_TYPE_NOTIF_ITER_SEEK_TIME_METHOD	= 8,
+	BT_PLUGIN_COMPONENT_CLASS_DESCRIPTOR_ATTRIBUTE_TYPE_NOTIF_ITER_NEXT_BATCH_METHOD	= 9,
 };
 
 /* Component class attribute (internal use) */
@@ -217,6 +218,9 @@ struct __bt_plugin_component_class_descriptor_attribute {
 
 		/* BT_PLUGIN_COMPONENT_CLASS_DESCRIPTOR_ATTRIBUTE_TYPE_NOTIF_ITER_SEEK_TIME_METHOD */
 		bt_component_class_notification_iterator_seek_time_method notif_iter_seek_time_method;
+
+		/* BT_PLUGIN_COMPONENT_CLASS_DESCRIPTOR_ATTRIBUTE_TYPE_NOTIF_ITER_NEXT_BATCH_METHOD */
+		bt_component_class_notification_iterator_next_batch_method notif_iter_next_batch_method;
 	} value;
 } __attribute__((packed));
 
@@ -691,6 +695,18 @@ struct __bt_plugin_component_class_descriptor_attribute {
 #define BT_PLUGIN_SOURCE_COMPONENT_CLASS_NOTIFICATION_ITERATOR_SEEK_TIME_METHOD_WITH_ID(_id, _comp_class_id, _x) \
 	__BT_PLUGIN_COMPONENT_CLASS_DESCRIPTOR_ATTRIBUTE(notif_iter_seek_time_method, BT_PLUGIN_COMPONENT_CLASS_DESCRIPTOR_ATTRIBUTE_TYPE_NOTIF_ITER_SEEK_TIME_METHOD, _id, _comp_class_id, source, _x)
 
+/*
+ * Defines an iterator batch next method attribute attached to a
+ * specific source component class descriptor.
+ *
+ * _id:            Plugin descriptor ID (C identifier).
+ * _comp_class_id: Component class descriptor ID (C identifier).
+ * _x:             Iterator batch next method
+ *                 (bt_component_class_notification_iterator_next_batch_method).
+ */
+#define BT_PLUGIN_SOURCE_COMPONENT_CLASS_NOTIFICATION_ITERATOR_NEXT_BATCH_METHOD_WITH_ID(_id, _comp_class_id, _x) \
+	__BT_PLUGIN_COMPONENT_CLASS_DESCRIPTOR_ATTRIBUTE(notif_iter_next_batch_method, BT_PLUGIN_COMPONENT_CLASS_DESCRIPTOR_ATTRIBUTE_TYPE_NOTIF_ITER_NEXT_BATCH_METHOD, _id, _comp_class_id, source, _x)
+
 /*
  * Defines an iterator initialization method attribute attached to a
  * specific filter component class descriptor.
@@ -727,6 +743,18 @@ struct __bt_plugin_component_class_descriptor_attribute {
 #define BT_PLUGIN_FILTER_COMPONENT_CLASS_NOTIFICATION_ITERATOR_SEEK_TIME_METHOD_WITH_ID(_id, _comp_class_id, _x) \
 	__BT_PLUGIN_COMPONENT_CLASS_DESCRIPTOR_ATTRIBUTE(notif_iter_seek_time_method, BT_PLUGIN_COMPONENT_CLASS_DESCRIPTOR_ATTRIBUTE_TYPE_NOTIF_ITER_SEEK_TIME_METHOD, _id, _comp_class_id, filter, _x)
 
+/*
+ * Defines an iterator batch next method attribute attached to a
+ * specific filter component class descriptor.
+ *
+ * _id:            Plugin descriptor ID (C identifier).
+ * _comp_class_id: Component class descriptor ID (C identifier).
+ * _x:             Iterator batch next method
+ *                 (bt_component_class_notification_iterator_next_batch_method).
+ */
+#define BT_PLUGIN_FILTER_COMPONENT_CLASS_NOTIFICATION_ITERATOR_NEXT_BATCH_METHOD_WITH_ID(_id, _comp_class_id, _x) \
+	__BT_PLUGIN_COMPONENT_CLASS_DESCRIPTOR_ATTRIBUTE(notif_iter_next_batch_method, BT_PLUGIN_COMPONENT_CLASS_DESCRIPTOR_ATTRIBUTE_TYPE_NOTIF_ITER_NEXT_BATCH_METHOD, _id, _comp_class_id, filter, _x)
+
 /*
  * Defines a plugin descriptor with an automatic ID.
  *
@@ -1049,6 +1077,18 @@ struct __bt_plugin_component_class_descriptor_attribute {
 #define BT_PLUGIN_SOURCE_COMPONENT_CLASS_NOTIFICATION_ITERATOR_SEEK_TIME_METHOD(_name, _x) \
 	BT_PLUGIN_SOURCE_COMPONENT_CLASS_NOTIFICATION_ITERATOR_SEEK_TIME_METHOD_WITH_ID(auto, _name, _x)
 
+/*
+ * Defines an iterator batch next method attribute attached to a source
+ * component class descriptor which is attached to the automatic plugin
+ * descriptor.
+ *
+ * _name: Component class name (C identifier).
+ * _x:    Iterator batch next method
+ *        (bt_component_class_notification_iterator_next_batch_method).
+ */
+#define BT_PLUGIN_SOURCE_COMPONENT_CLASS_NOTIFICATION_ITERATOR_NEXT_BATCH_METHOD(_name, _x) \
+	BT_PLUGIN_SOURCE_COMPONENT_CLASS_NOTIFICATION_ITERATOR_NEXT_BATCH_METHOD_WITH_ID(auto, _name, _x)
+
 /*
  * Defines an iterator initialization method attribute attached to a
  * filter component class descriptor which is attached to the automatic
@@ -1085,6 +1125,18 @@ struct __bt_plugin_component_class_descriptor_attribute {
 #define BT_PLUGIN_FILTER_COMPONENT_CLASS_NOTIFICATION_ITERATOR_SEEK_TIME_METHOD(_name, _x) \
 	BT_PLUGIN_FILTER_COMPONENT_CLASS_NOTIFICATION_ITERATOR_SEEK_TIME_METHOD_WITH_ID(auto, _name, _x)
 
+/*
+ * Defines an iterator batch next method attribute attached to a filter
+ * component class descriptor which is attached to the automatic plugin
+ * descriptor.
+ *
+ * _name: Component class name (C identifier).
+ * _x:    Iterator batch next method
+ *        (bt_component_class_notification_iterator_next_batch_method).
+ */
+#define BT_PLUGIN_FILTER_COMPONENT_CLASS_NOTIFICATION_ITERATOR_NEXT_BATCH_METHOD(_name, _x) \
+	BT_PLUGIN_FILTER_COMPONENT_CLASS_NOTIFICATION_ITERATOR_NEXT_BATCH_METHOD_WITH_ID(auto, _name, _x)
+
 #ifdef __cplusplus
 }
 #endif
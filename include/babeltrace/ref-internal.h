@@ -29,6 +29,7 @@
 
 #include <babeltrace/babeltrace-internal.h>
 #include <assert.h>
+#include <stdbool.h>
 
 struct bt_object;
 typedef void (*bt_object_release_func)(struct bt_object *);
@@ -38,6 +39,25 @@ struct bt_ref {
 	bt_object_release_func release;
 };
 
+/*
+ * Non-zero once objects may be shared between threads (see
+ * bt_ref_enable_thread_safety()): reference counts are then updated
+ * atomically. Until then, the single thread owning all the objects
+ * updates them with plain increments and decrements.
+ */
+BT_HIDDEN
+extern int bt_ref_thread_safe;
+
+static inline
+bool bt_ref_is_thread_safe(void)
+{
+#ifdef BT_ATOMIC_REFCOUNT
+	return true;
+#else
+	return bt_ref_thread_safe;
+#endif
+}
+
 static inline
 void bt_ref_init(struct bt_ref *ref, bt_object_release_func release)
 {
@@ -46,26 +66,55 @@ void bt_ref_init(struct bt_ref *ref, bt_object_release_func release)
 	ref->release = release;
 }
 
+static inline
+unsigned long bt_ref_get_count(const struct bt_ref *ref)
+{
+	assert(ref);
+	return __atomic_load_n(&ref->count, __ATOMIC_RELAXED);
+}
+
 static inline
 void bt_ref_get(struct bt_ref *ref)
 {
+	unsigned long count;
+
 	assert(ref);
 
 	if (unlikely(!ref->release)) {
 		return;
 	}
 
-	ref->count++;
+	if (likely(!bt_ref_is_thread_safe())) {
+		count = ++ref->count;
+	} else {
+		count = __atomic_add_fetch(&ref->count, 1, __ATOMIC_RELAXED);
+	}
+
 	/* Overflow check. */
-	assert(ref->count);
+	assert(count);
+	(void) count;
 }
 
 static inline
 void bt_ref_put(struct bt_ref *ref)
 {
+	unsigned long count;
+
 	assert(ref);
+
+	if (likely(!bt_ref_is_thread_safe())) {
+		count = --ref->count;
+	} else {
+		/*
+		 * Release ordering publishes this thread's accesses to the
+		 * object to the thread which releases it; acquire ordering
+		 * makes the other threads' accesses visible to the latter.
+		 */
+		count = __atomic_sub_fetch(&ref->count, 1, __ATOMIC_ACQ_REL);
+	}
+
 	/* Only assert if the object has opted-in for reference counting. */
-	if (unlikely((--ref->count) == 0 && ref->release)) {
+	if (unlikely(count == 0 && ref->release)) {
 		ref->release((struct bt_object *) ref);
 	}
 }
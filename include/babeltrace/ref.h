@@ -206,6 +206,29 @@ former is generally safer.
 */
 void bt_put(void *obj);
 
+/**
+@brief	Makes the reference counting of all the Babeltrace objects
+	thread-safe from now on.
+
+Until this function is called, the reference count of an object is
+updated with plain, non-atomic operations, which is only safe when all
+the objects are accessed by a single thread. Call this function before
+Babeltrace objects are shared with other threads (for example, before
+starting a thread which gets or puts references to existing objects);
+from then on, reference counts are updated atomically.
+
+There is no way to make the reference counting non-thread-safe again.
+
+@remarks
+If Babeltrace was configured with the \c --enable-atomic-refcount
+option, the reference counting is always thread-safe and this function
+has no effect.
+
+@sa bt_get(): Increments the reference count of a Babeltrace object.
+@sa bt_put(): Decrements the reference count of a Babeltrace object.
+*/
+void bt_ref_enable_thread_safety(void);
+
 /**
 @}
 */
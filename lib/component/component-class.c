@@ -348,6 +348,29 @@ end:
 	return ret;
 }
 
+int bt_component_class_source_set_notification_iterator_next_batch_method(
+		struct bt_component_class *component_class,
+		bt_component_class_notification_iterator_next_batch_method notification_iterator_next_batch_method)
+{
+	struct bt_component_class_source *source_class;
+	int ret = 0;
+
+	if (!component_class || component_class->frozen ||
+			!notification_iterator_next_batch_method ||
+			component_class->type != BT_COMPONENT_CLASS_TYPE_SOURCE) {
+		ret = -1;
+		goto end;
+	}
+
+	source_class = container_of(component_class,
+		struct bt_component_class_source, parent);
+	source_class->methods.iterator.next_batch =
+		notification_iterator_next_batch_method;
+
+end:
+	return ret;
+}
+
 int bt_component_class_filter_set_notification_iterator_init_method(
 		struct bt_component_class *component_class,
 		bt_component_class_notification_iterator_init_method notification_iterator_init_method)
@@ -416,6 +439,29 @@ end:
 	return ret;
 }
 
+int bt_component_class_filter_set_notification_iterator_next_batch_method(
+		struct bt_component_class *component_class,
+		bt_component_class_notification_iterator_next_batch_method notification_iterator_next_batch_method)
+{
+	struct bt_component_class_filter *filter_class;
+	int ret = 0;
+
+	if (!component_class || component_class->frozen ||
+			!notification_iterator_next_batch_method ||
+			component_class->type != BT_COMPONENT_CLASS_TYPE_FILTER) {
+		ret = -1;
+		goto end;
+	}
+
+	filter_class = container_of(component_class,
+		struct bt_component_class_filter, parent);
+	filter_class->methods.iterator.next_batch =
+		notification_iterator_next_batch_method;
+
+end:
+	return ret;
+}
+
 int bt_component_class_set_description(
 		struct bt_component_class *component_class,
 		const char *description)
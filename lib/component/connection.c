@@ -31,6 +31,7 @@
 #include <babeltrace/component/port-internal.h>
 #include <babeltrace/component/component-source-internal.h>
 #include <babeltrace/component/component-filter-internal.h>
+#include <babeltrace/component/notification/iterator-internal.h>
 #include <babeltrace/object-internal.h>
 #include <babeltrace/compiler.h>
 #include <glib.h>
@@ -95,6 +96,7 @@ bt_connection_create_notification_iterator(struct bt_connection *connection)
 {
 	struct bt_component *upstream_component = NULL;
 	struct bt_notification_iterator *it = NULL;
+	struct bt_graph *graph;
 
 	if (!connection) {
 		goto end;
@@ -115,6 +117,20 @@ bt_connection_create_notification_iterator(struct bt_connection *connection)
 	default:
 		goto end;
 	}
+
+	if (!it) {
+		goto end;
+	}
+
+	/* The graph is the connection's parent. */
+	graph = container_of(connection->base.parent, struct bt_graph, base);
+	assert(graph);
+	if (graph->notification_queue_capacity > 0 &&
+			bt_notification_iterator_enable_prefetch(it,
+				graph->notification_queue_capacity) !=
+			BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+		BT_PUT(it);
+	}
 end:
 	bt_put(upstream_component);
 	return it;
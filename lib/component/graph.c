@@ -32,9 +32,22 @@
 #include <babeltrace/component/component-sink-internal.h>
 #include <babeltrace/component/component-source.h>
 #include <babeltrace/component/component-filter.h>
-#include <babeltrace/component/port.h>
+#include <babeltrace/component/port-internal.h>
 #include <babeltrace/compiler.h>
 #include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <time.h>
+
+#ifdef BABELTRACE_HAVE_EPOLL
+#include <sys/epoll.h>
+#else
+#include <poll.h>
+#endif
+
+/* Largest number of readable file descriptors gotten from one wait */
+#define READY_FDS_MAX	16
 
 static
 void bt_graph_destroy(struct bt_object *obj)
@@ -51,9 +64,76 @@ void bt_graph_destroy(struct bt_object *obj)
 	if (graph->sinks_to_consume) {
 		g_queue_free(graph->sinks_to_consume);
 	}
+	if (graph->sinks_waiting) {
+		g_queue_free(graph->sinks_waiting);
+	}
+	if (graph->ready_sources) {
+		g_array_free(graph->ready_sources, TRUE);
+	}
+	if (graph->epoll_fd >= 0) {
+		(void) close(graph->epoll_fd);
+	}
+	if (graph->wake_pipe[0] >= 0) {
+		(void) close(graph->wake_pipe[0]);
+	}
+	if (graph->wake_pipe[1] >= 0) {
+		(void) close(graph->wake_pipe[1]);
+	}
 	g_free(graph);
 }
 
+#ifdef BABELTRACE_HAVE_EPOLL
+static
+int epoll_ctl_fd(struct bt_graph *graph, int op, int fd)
+{
+	struct epoll_event event = { 0 };
+
+	event.events = EPOLLIN;
+	event.data.fd = fd;
+	return epoll_ctl(graph->epoll_fd, op, fd, &event);
+}
+#endif
+
+/*
+ * Creates the wake-up pipe of a graph and, with epoll support, the epoll
+ * instance in which the graph waits for its readiness sources.
+ */
+static
+int init_ready_wait(struct bt_graph *graph)
+{
+	int ret, i;
+
+	ret = pipe(graph->wake_pipe);
+	if (ret) {
+		graph->wake_pipe[0] = graph->wake_pipe[1] = -1;
+		goto end;
+	}
+
+	for (i = 0; i < 2; i++) {
+		int flags = fcntl(graph->wake_pipe[i], F_GETFL);
+
+		if (flags < 0 || fcntl(graph->wake_pipe[i], F_SETFL,
+				flags | O_NONBLOCK) < 0 ||
+				fcntl(graph->wake_pipe[i], F_SETFD,
+					FD_CLOEXEC) < 0) {
+			ret = -1;
+			goto end;
+		}
+	}
+
+#ifdef BABELTRACE_HAVE_EPOLL
+	graph->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (graph->epoll_fd < 0) {
+		ret = -1;
+		goto end;
+	}
+
+	ret = epoll_ctl_fd(graph, EPOLL_CTL_ADD, graph->wake_pipe[0]);
+#endif
+end:
+	return ret;
+}
+
 struct bt_graph *bt_graph_create(void)
 {
 	struct bt_graph *graph;
@@ -64,6 +144,8 @@ struct bt_graph *bt_graph_create(void)
 	}
 
 	bt_object_init(graph, bt_graph_destroy);
+	graph->epoll_fd = -1;
+	graph->wake_pipe[0] = graph->wake_pipe[1] = -1;
 
 	graph->connections = g_ptr_array_new_with_free_func(bt_object_release);
 	if (!graph->connections) {
@@ -77,6 +159,18 @@ struct bt_graph *bt_graph_create(void)
 	if (!graph->sinks_to_consume) {
 		goto error;
 	}
+	graph->sinks_waiting = g_queue_new();
+	if (!graph->sinks_waiting) {
+		goto error;
+	}
+	graph->ready_sources = g_array_new(FALSE, TRUE,
+			sizeof(struct bt_graph_ready_source));
+	if (!graph->ready_sources) {
+		goto error;
+	}
+	if (init_ready_wait(graph)) {
+		goto error;
+	}
 end:
 	return graph;
 error:
@@ -332,6 +426,21 @@ struct bt_port *get_output_port(struct bt_component *component, int index)
 	return port;
 }
 
+enum bt_graph_status bt_graph_set_notification_queue_capacity(
+		struct bt_graph *graph, unsigned int capacity)
+{
+	enum bt_graph_status status = BT_GRAPH_STATUS_OK;
+
+	if (!graph) {
+		status = BT_GRAPH_STATUS_INVALID;
+		goto end;
+	}
+
+	graph->notification_queue_capacity = capacity;
+end:
+	return status;
+}
+
 enum bt_graph_status bt_graph_add_component_as_sibling(struct bt_graph *graph,
 		struct bt_component *origin,
 		struct bt_component *new_component)
@@ -504,6 +613,516 @@ error_disconnect:
 	goto end;
 }
 
+/* Puts the sinks which returned AGAIN back in the consumption queue. */
+static
+void requeue_waiting_sinks(struct bt_graph *graph)
+{
+	graph->consumed_since_check = 0;
+	while (!g_queue_is_empty(graph->sinks_waiting)) {
+		g_queue_push_tail_link(graph->sinks_to_consume,
+			g_queue_pop_head_link(graph->sinks_waiting));
+	}
+}
+
+static
+int64_t get_monotonic_time_ns(void)
+{
+	struct timespec ts;
+
+	(void) clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static inline
+struct bt_component *borrow_port_component(struct bt_port *port)
+{
+	return (struct bt_component *) port->base.parent;
+}
+
+static inline
+bool graph_has_component(struct bt_graph *graph,
+		struct bt_component *component)
+{
+	return component->base.parent == &graph->base;
+}
+
+/* Whether "component" is "sink" or one of the components upstream of it. */
+static
+bool component_feeds_sink(struct bt_graph *graph,
+		struct bt_component *component, struct bt_component *sink,
+		unsigned int depth)
+{
+	guint i;
+
+	if (component == sink) {
+		return true;
+	}
+
+	/* A graph has no cycle: no path is longer than its connections. */
+	if (depth >= graph->connections->len) {
+		return false;
+	}
+
+	for (i = 0; i < graph->connections->len; i++) {
+		struct bt_connection *connection =
+			g_ptr_array_index(graph->connections, i);
+
+		if (!connection->output_port || !connection->input_port ||
+				borrow_port_component(connection->output_port) !=
+					component) {
+			continue;
+		}
+
+		if (component_feeds_sink(graph,
+				borrow_port_component(connection->input_port),
+				sink, depth + 1)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static
+bool sink_has_ready_sources(struct bt_graph *graph, struct bt_component *sink)
+{
+	guint i;
+
+	for (i = 0; i < graph->ready_sources->len; i++) {
+		struct bt_graph_ready_source *source = &g_array_index(
+			graph->ready_sources, struct bt_graph_ready_source, i);
+
+		if (component_feeds_sink(graph, source->component, sink, 0)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/* Whether one of the waiting sinks has a readiness source to wait for. */
+static
+bool waiting_sinks_have_ready_sources(struct bt_graph *graph)
+{
+	GList *node;
+
+	if (graph->ready_sources->len == 0) {
+		return false;
+	}
+
+	for (node = graph->sinks_waiting->head; node; node = node->next) {
+		if (sink_has_ready_sources(graph, node->data)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Puts the waiting sinks which "component" feeds, or all of them if
+ * "component" is NULL, back in the consumption queue.
+ */
+static
+void wake_up_fed_sinks(struct bt_graph *graph, struct bt_component *component)
+{
+	GList *node = graph->sinks_waiting->head;
+
+	while (node) {
+		GList *next = node->next;
+
+		if (!component || component_feeds_sink(graph, component,
+				node->data, 0)) {
+			g_queue_unlink(graph->sinks_waiting, node);
+			g_queue_push_tail_link(graph->sinks_to_consume, node);
+		}
+		node = next;
+	}
+}
+
+/* Puts the waiting sinks without readiness sources back in the queue. */
+static
+void requeue_sourceless_sinks(struct bt_graph *graph)
+{
+	GList *node = graph->sinks_waiting->head;
+
+	while (node) {
+		GList *next = node->next;
+
+		if (!sink_has_ready_sources(graph, node->data)) {
+			g_queue_unlink(graph->sinks_waiting, node);
+			g_queue_push_tail_link(graph->sinks_to_consume, node);
+		}
+		node = next;
+	}
+}
+
+/* Wakes up the components written to the wake-up pipe. */
+static
+void drain_wake_pipe(struct bt_graph *graph)
+{
+	struct bt_component *components[64];
+	ssize_t len;
+
+	while ((len = read(graph->wake_pipe[0], components,
+			sizeof(components))) > 0) {
+		size_t i;
+
+		for (i = 0; i < len / sizeof(components[0]); i++) {
+			wake_up_fed_sinks(graph, components[i]);
+		}
+	}
+}
+
+/* Returns the index of a readiness source of a graph, or -1. */
+static
+int find_ready_source(struct bt_graph *graph,
+		enum bt_graph_ready_source_type type,
+		struct bt_component *component, int fd)
+{
+	guint i;
+
+	for (i = 0; i < graph->ready_sources->len; i++) {
+		struct bt_graph_ready_source *source = &g_array_index(
+			graph->ready_sources, struct bt_graph_ready_source, i);
+
+		if (source->type != type) {
+			continue;
+		}
+
+		if (type == BT_GRAPH_READY_SOURCE_FD ?
+				source->fd == fd : source->component == component) {
+			return (int) i;
+		}
+	}
+
+	return -1;
+}
+
+/*
+ * Waits at most "timeout_ms" milliseconds (forever if negative) for the
+ * file descriptors of the readiness sources and the wake-up pipe to be
+ * readable, and appends the readable ones to "ready_fds". Returns -1 on
+ * error.
+ */
+static
+int wait_ready_fds(struct bt_graph *graph, int timeout_ms, GArray *ready_fds)
+{
+	int ret, i;
+#ifdef BABELTRACE_HAVE_EPOLL
+	struct epoll_event events[READY_FDS_MAX];
+
+	do {
+		ret = epoll_wait(graph->epoll_fd, events, READY_FDS_MAX,
+			timeout_ms);
+	} while (ret < 0 && errno == EINTR);
+	if (ret < 0) {
+		perror("epoll_wait");
+		goto end;
+	}
+
+	/* Level-triggered: the others are reported next time. */
+	for (i = 0; i < ret; i++) {
+		g_array_append_val(ready_fds, events[i].data.fd);
+	}
+#else
+	GArray *pollfds;
+	struct pollfd pollfd = { 0 };
+	guint j;
+
+	pollfds = g_array_new(FALSE, TRUE, sizeof(struct pollfd));
+	if (!pollfds) {
+		ret = -1;
+		goto end;
+	}
+
+	pollfd.fd = graph->wake_pipe[0];
+	pollfd.events = POLLIN;
+	g_array_append_val(pollfds, pollfd);
+	for (j = 0; j < graph->ready_sources->len; j++) {
+		struct bt_graph_ready_source *source = &g_array_index(
+			graph->ready_sources, struct bt_graph_ready_source, j);
+
+		if (source->type == BT_GRAPH_READY_SOURCE_FD) {
+			pollfd.fd = source->fd;
+			g_array_append_val(pollfds, pollfd);
+		}
+	}
+
+	do {
+		ret = poll((struct pollfd *) pollfds->data, pollfds->len,
+			timeout_ms);
+	} while (ret < 0 && errno == EINTR);
+	if (ret < 0) {
+		perror("poll");
+	}
+
+	for (i = 0; ret > 0 && i < (int) pollfds->len; i++) {
+		struct pollfd *cur = &g_array_index(pollfds, struct pollfd, i);
+
+		if (cur->revents) {
+			g_array_append_val(ready_fds, cur->fd);
+		}
+	}
+
+	g_array_free(pollfds, TRUE);
+#endif
+end:
+	return ret < 0 ? -1 : 0;
+}
+
+/*
+ * Puts the waiting sinks back in the consumption queue once one of
+ * their readiness sources is ready, waiting for it if "block" is true.
+ * The waiting sinks without readiness sources, retried once per round
+ * of the other sinks, are put back too.
+ */
+static
+int check_ready_sources(struct bt_graph *graph, bool block)
+{
+	int ret;
+	int timeout_ms = block ? -1 : 0;
+	int64_t now = get_monotonic_time_ns();
+	GArray *ready_fds = NULL;
+	guint i;
+
+	graph->consumed_since_check = 0;
+	for (i = 0; block && i < graph->ready_sources->len; i++) {
+		struct bt_graph_ready_source *source = &g_array_index(
+			graph->ready_sources, struct bt_graph_ready_source, i);
+		int64_t delay_ms;
+
+		if (source->type != BT_GRAPH_READY_SOURCE_TIMEOUT) {
+			continue;
+		}
+
+		/* Round up, not to wake up before the deadline. */
+		delay_ms = MAX(source->deadline - now + 999999, 0) / 1000000;
+		if (timeout_ms < 0 || delay_ms < timeout_ms) {
+			timeout_ms = (int) MIN(delay_ms, (int64_t) INT_MAX);
+		}
+	}
+
+	ready_fds = g_array_new(FALSE, FALSE, sizeof(int));
+	if (!ready_fds) {
+		ret = -1;
+		goto end;
+	}
+
+	ret = wait_ready_fds(graph, timeout_ms, ready_fds);
+	if (ret) {
+		goto end;
+	}
+
+	for (i = 0; i < ready_fds->len; i++) {
+		int fd = g_array_index(ready_fds, int, i);
+		int index;
+
+		if (fd == graph->wake_pipe[0]) {
+			drain_wake_pipe(graph);
+			continue;
+		}
+
+		index = find_ready_source(graph, BT_GRAPH_READY_SOURCE_FD,
+			NULL, fd);
+		if (index >= 0) {
+			wake_up_fed_sinks(graph, g_array_index(
+				graph->ready_sources,
+				struct bt_graph_ready_source, index).component);
+		}
+	}
+
+	/* Timeouts are one-shot: remove the expired ones. */
+	now = get_monotonic_time_ns();
+	for (i = 0; i < graph->ready_sources->len;) {
+		struct bt_graph_ready_source *source = &g_array_index(
+			graph->ready_sources, struct bt_graph_ready_source, i);
+
+		if (source->type == BT_GRAPH_READY_SOURCE_TIMEOUT &&
+				source->deadline <= now) {
+			wake_up_fed_sinks(graph, source->component);
+			g_array_remove_index_fast(graph->ready_sources, i);
+			continue;
+		}
+		i++;
+	}
+
+	if (g_atomic_int_compare_and_exchange(&graph->wake_all, 1, 0)) {
+		wake_up_fed_sinks(graph, NULL);
+	}
+
+	requeue_sourceless_sinks(graph);
+end:
+	if (ready_fds) {
+		g_array_free(ready_fds, TRUE);
+	}
+	return ret;
+}
+
+enum bt_graph_status bt_graph_add_ready_fd(struct bt_graph *graph,
+		struct bt_component *component, int fd)
+{
+	enum bt_graph_status status = BT_GRAPH_STATUS_OK;
+	struct bt_graph_ready_source source = {
+		.type = BT_GRAPH_READY_SOURCE_FD,
+		.component = component,
+		.fd = fd,
+	};
+
+	if (!graph || !component || fd < 0 ||
+			!graph_has_component(graph, component) ||
+			find_ready_source(graph, BT_GRAPH_READY_SOURCE_FD,
+				NULL, fd) >= 0) {
+		status = BT_GRAPH_STATUS_INVALID;
+		goto end;
+	}
+
+#ifdef BABELTRACE_HAVE_EPOLL
+	if (epoll_ctl_fd(graph, EPOLL_CTL_ADD, fd)) {
+		perror("epoll_ctl");
+		status = BT_GRAPH_STATUS_ERROR;
+		goto end;
+	}
+#endif
+
+	g_array_append_val(graph->ready_sources, source);
+end:
+	return status;
+}
+
+enum bt_graph_status bt_graph_remove_ready_fd(struct bt_graph *graph, int fd)
+{
+	enum bt_graph_status status = BT_GRAPH_STATUS_OK;
+	int index;
+
+	if (!graph || fd < 0) {
+		status = BT_GRAPH_STATUS_INVALID;
+		goto end;
+	}
+
+	index = find_ready_source(graph, BT_GRAPH_READY_SOURCE_FD, NULL, fd);
+	if (index < 0) {
+		status = BT_GRAPH_STATUS_INVALID;
+		goto end;
+	}
+
+#ifdef BABELTRACE_HAVE_EPOLL
+	/* A closed file descriptor already left the epoll instance. */
+	(void) epoll_ctl_fd(graph, EPOLL_CTL_DEL, fd);
+#endif
+
+	g_array_remove_index_fast(graph->ready_sources, index);
+end:
+	return status;
+}
+
+enum bt_graph_status bt_graph_set_ready_timeout(struct bt_graph *graph,
+		struct bt_component *component, uint64_t timeout_ms)
+{
+	enum bt_graph_status status = BT_GRAPH_STATUS_OK;
+	struct bt_graph_ready_source source = {
+		.type = BT_GRAPH_READY_SOURCE_TIMEOUT,
+		.component = component,
+		.fd = -1,
+	};
+	int index;
+
+	if (!graph || !component || !graph_has_component(graph, component) ||
+			timeout_ms > INT64_MAX / 1000000 / 2) {
+		status = BT_GRAPH_STATUS_INVALID;
+		goto end;
+	}
+
+	source.deadline = get_monotonic_time_ns() +
+		(int64_t) timeout_ms * 1000000;
+	index = find_ready_source(graph, BT_GRAPH_READY_SOURCE_TIMEOUT,
+		component, -1);
+	if (index < 0) {
+		g_array_append_val(graph->ready_sources, source);
+	} else {
+		struct bt_graph_ready_source *cur = &g_array_index(
+			graph->ready_sources, struct bt_graph_ready_source,
+			index);
+
+		cur->deadline = MIN(cur->deadline, source.deadline);
+	}
+end:
+	return status;
+}
+
+enum bt_graph_status bt_graph_add_ready_wake_up(struct bt_graph *graph,
+		struct bt_component *component)
+{
+	enum bt_graph_status status = BT_GRAPH_STATUS_OK;
+	struct bt_graph_ready_source source = {
+		.type = BT_GRAPH_READY_SOURCE_WAKE_UP,
+		.component = component,
+		.fd = -1,
+	};
+
+	if (!graph || !component || !graph_has_component(graph, component) ||
+			find_ready_source(graph, BT_GRAPH_READY_SOURCE_WAKE_UP,
+				component, -1) >= 0) {
+		status = BT_GRAPH_STATUS_INVALID;
+		goto end;
+	}
+
+	g_array_append_val(graph->ready_sources, source);
+end:
+	return status;
+}
+
+enum bt_graph_status bt_graph_remove_ready_wake_up(struct bt_graph *graph,
+		struct bt_component *component)
+{
+	enum bt_graph_status status = BT_GRAPH_STATUS_OK;
+	int index;
+
+	if (!graph || !component) {
+		status = BT_GRAPH_STATUS_INVALID;
+		goto end;
+	}
+
+	index = find_ready_source(graph, BT_GRAPH_READY_SOURCE_WAKE_UP,
+		component, -1);
+	if (index < 0) {
+		status = BT_GRAPH_STATUS_INVALID;
+		goto end;
+	}
+
+	g_array_remove_index_fast(graph->ready_sources, index);
+end:
+	return status;
+}
+
+enum bt_graph_status bt_graph_wake_up(struct bt_graph *graph,
+		struct bt_component *component)
+{
+	enum bt_graph_status status = BT_GRAPH_STATUS_OK;
+	ssize_t ret;
+
+	if (!graph || !component) {
+		status = BT_GRAPH_STATUS_INVALID;
+		goto end;
+	}
+
+	/* Writes of a pointer to a pipe are atomic. */
+	do {
+		ret = write(graph->wake_pipe[1], &component, sizeof(component));
+	} while (ret < 0 && errno == EINTR);
+
+	if (ret < 0) {
+		if (errno == EAGAIN || errno == EWOULDBLOCK) {
+			/* A full pipe wakes up the graph anyway. */
+			g_atomic_int_set(&graph->wake_all, 1);
+		} else {
+			status = BT_GRAPH_STATUS_ERROR;
+		}
+	}
+end:
+	return status;
+}
+
 enum bt_component_status bt_graph_consume(struct bt_graph *graph)
 {
 	struct bt_component *sink;
@@ -516,25 +1135,59 @@ enum bt_component_status bt_graph_consume(struct bt_graph *graph)
 	}
 
 	if (g_queue_is_empty(graph->sinks_to_consume)) {
-		status = BT_COMPONENT_STATUS_END;
-		goto end;
+		if (g_queue_is_empty(graph->sinks_waiting)) {
+			status = BT_COMPONENT_STATUS_END;
+			goto end;
+		}
+
+		if (!waiting_sinks_have_ready_sources(graph)) {
+			/* All the sinks are waiting: the caller retries them. */
+			requeue_waiting_sinks(graph);
+		} else if (check_ready_sources(graph, false)) {
+			status = BT_COMPONENT_STATUS_ERROR;
+			goto end;
+		} else if (g_queue_is_empty(graph->sinks_to_consume)) {
+			/* Only the sinks whose sources are ready are consumed. */
+			status = BT_COMPONENT_STATUS_AGAIN;
+			goto end;
+		}
 	}
 
 	current_node = g_queue_pop_head_link(graph->sinks_to_consume);
 	sink = current_node->data;
 	status = bt_component_sink_consume(sink);
-	if (status != BT_COMPONENT_STATUS_END) {
+	switch (status) {
+	case BT_COMPONENT_STATUS_END:
+		/* End reached, the node is not added back to the queue and free'd. */
+		g_queue_delete_link(graph->sinks_to_consume, current_node);
+
+		/* Don't forward an END status if there are sinks left to consume. */
+		if (!g_queue_is_empty(graph->sinks_to_consume) ||
+				!g_queue_is_empty(graph->sinks_waiting)) {
+			status = BT_COMPONENT_STATUS_OK;
+		}
+		break;
+	case BT_COMPONENT_STATUS_AGAIN:
+		/* Not consumed again until a readiness source is ready. */
+		g_queue_push_tail_link(graph->sinks_waiting, current_node);
+		break;
+	default:
 		g_queue_push_tail_link(graph->sinks_to_consume, current_node);
-		goto end;
+		break;
 	}
 
-	/* End reached, the node is not added back to the queue and free'd. */
-	g_queue_delete_link(graph->sinks_to_consume, current_node);
-
-	/* Don't forward an END status if there are sinks left to consume. */
-	if (!g_queue_is_empty(graph->sinks_to_consume)) {
-		status = BT_GRAPH_STATUS_OK;
-		goto end;
+	/*
+	 * Check the readiness sources, without waiting, once per round
+	 * of the sinks which make progress. bt_graph_run() waits for them
+	 * when no sink is left to consume.
+	 */
+	if (!g_queue_is_empty(graph->sinks_waiting) &&
+			!g_queue_is_empty(graph->sinks_to_consume) &&
+			++graph->consumed_since_check >=
+				graph->sinks_to_consume->length) {
+		if (check_ready_sources(graph, false)) {
+			status = BT_COMPONENT_STATUS_ERROR;
+		}
 	}
 end:
 	return status;
@@ -553,20 +1206,23 @@ enum bt_graph_status bt_graph_run(struct bt_graph *graph,
 
 	do {
 		component_status = bt_graph_consume(graph);
-		if (component_status == BT_COMPONENT_STATUS_AGAIN) {
+		if (component_status != BT_COMPONENT_STATUS_AGAIN) {
+			continue;
+		}
+
+		if (!g_queue_is_empty(graph->sinks_to_consume)) {
+			/* Other sinks can make progress meanwhile. */
+			component_status = BT_COMPONENT_STATUS_OK;
+		} else if (waiting_sinks_have_ready_sources(graph)) {
 			/*
-			 * If AGAIN is received and there are multiple sinks,
-			 * go ahead and consume from the next sink.
-			 *
-			 * However, in the case where a single sink is left,
-			 * the caller can decide to busy-wait and call
-			 * bt_graph_run continuously until the source is ready
-			 * or it can decide to sleep for an arbitrary amount of
-			 * time.
+			 * All the sinks are waiting: sleep until one of
+			 * their readiness sources is ready instead of
+			 * making the caller busy-wait or sleep for an
+			 * arbitrary amount of time.
 			 */
-			if (graph->sinks_to_consume->length > 1) {
-				component_status = BT_COMPONENT_STATUS_OK;
-			}
+			component_status = check_ready_sources(graph, true) ?
+				BT_COMPONENT_STATUS_ERROR :
+				BT_COMPONENT_STATUS_OK;
 		}
 	} while (component_status == BT_COMPONENT_STATUS_OK);
 
@@ -574,7 +1230,8 @@ enum bt_graph_status bt_graph_run(struct bt_graph *graph,
 		*_component_status = component_status;
 	}
 
-	if (g_queue_is_empty(graph->sinks_to_consume)) {
+	if (g_queue_is_empty(graph->sinks_to_consume) &&
+			g_queue_is_empty(graph->sinks_waiting)) {
 		graph_status = BT_GRAPH_STATUS_END;
 	} else if (component_status == BT_COMPONENT_STATUS_AGAIN) {
 		graph_status = BT_GRAPH_STATUS_AGAIN;
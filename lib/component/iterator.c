@@ -26,6 +26,9 @@
  * SOFTWARE.
  */
 
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
 #include <babeltrace/compiler.h>
 #include <babeltrace/ref.h>
 #include <babeltrace/component/component.h>
@@ -33,30 +36,57 @@
 #include <babeltrace/component/component-class-internal.h>
 #include <babeltrace/component/notification/iterator.h>
 #include <babeltrace/component/notification/iterator-internal.h>
+#include <babeltrace/component/notification/queue-internal.h>
+
+/* Number of notifications a prefetching thread asks for at once. */
+#define PREFETCH_BATCH_SIZE	64
+
+static
+void prefetch_stop(struct bt_notification_iterator *iterator);
 
 static
 void bt_notification_iterator_destroy(struct bt_object *obj)
 {
 	struct bt_notification_iterator *iterator;
-	struct bt_component_class *comp_class;
 
 	assert(obj);
 	iterator = container_of(obj, struct bt_notification_iterator,
 			base);
 	assert(iterator->component);
-	comp_class = iterator->component->class;
+	assert(iterator->methods);
+
+	if (iterator->prefetch) {
+		prefetch_stop(iterator);
+		bt_notification_queue_destroy(iterator->prefetch->queue);
+		g_free(iterator->prefetch);
+	}
 
 	/* Call user-defined destroy method */
+	if (iterator->methods->destroy) {
+		iterator->methods->destroy(iterator);
+	}
+
+	BT_PUT(iterator->component);
+	g_free(iterator);
+}
+
+/*
+ * Resolves the iterator methods of a component class once, so that
+ * advancing an iterator does not dispatch on its class type.
+ */
+static
+struct bt_component_class_iterator_methods *get_iterator_methods(
+		struct bt_component_class *comp_class)
+{
+	struct bt_component_class_iterator_methods *methods = NULL;
+
 	switch (comp_class->type) {
 	case BT_COMPONENT_CLASS_TYPE_SOURCE:
 	{
 		struct bt_component_class_source *source_class;
 
 		source_class = container_of(comp_class, struct bt_component_class_source, parent);
-
-		if (source_class->methods.iterator.destroy) {
-			source_class->methods.iterator.destroy(iterator);
-		}
+		methods = &source_class->methods.iterator;
 		break;
 	}
 	case BT_COMPONENT_CLASS_TYPE_FILTER:
@@ -64,47 +94,42 @@ void bt_notification_iterator_destroy(struct bt_object *obj)
 		struct bt_component_class_filter *filter_class;
 
 		filter_class = container_of(comp_class, struct bt_component_class_filter, parent);
-
-		if (filter_class->methods.iterator.destroy) {
-			filter_class->methods.iterator.destroy(iterator);
-		}
+		methods = &filter_class->methods.iterator;
 		break;
 	}
 	default:
-		/* Unreachable */
-		assert(0);
+		break;
 	}
 
-	BT_PUT(iterator->component);
-	g_free(iterator);
+	return methods;
 }
 
 BT_HIDDEN
 struct bt_notification_iterator *bt_notification_iterator_create(
 		struct bt_component *component)
 {
-	enum bt_component_class_type type;
+	struct bt_component_class_iterator_methods *methods;
 	struct bt_notification_iterator *iterator = NULL;
 
 	if (!component) {
 		goto end;
 	}
 
-	type = bt_component_get_class_type(component);
-	switch (type) {
-	case BT_COMPONENT_CLASS_TYPE_SOURCE:
-	case BT_COMPONENT_CLASS_TYPE_FILTER:
-		break;
-	default:
+	methods = get_iterator_methods(component->class);
+	if (!methods) {
 		goto end;
 	}
 
+	assert(methods->get);
+	assert(methods->next);
 	iterator = g_new0(struct bt_notification_iterator, 1);
 	if (!iterator) {
 		goto end;
 	}
 
 	iterator->component = bt_get(component);
+	iterator->methods = methods;
+	iterator->deferred_status = BT_NOTIFICATION_ITERATOR_STATUS_OK;
 	bt_object_init(iterator, bt_notification_iterator_destroy);
 end:
 	return iterator;
@@ -148,82 +173,325 @@ end:
 	return ret;
 }
 
-struct bt_notification *bt_notification_iterator_get_notification(
-		struct bt_notification_iterator *iterator)
+/*
+ * Gathers the next notifications by calling the component's methods,
+ * emulating the batch with the single-step methods if needed.
+ */
+static
+enum bt_notification_iterator_status next_batch_direct(
+		struct bt_notification_iterator *iterator,
+		struct bt_notification **notifications, size_t capacity,
+		size_t *count)
 {
-	bt_component_class_notification_iterator_get_method get_method = NULL;
+	size_t i;
+	enum bt_notification_iterator_status ret =
+			BT_NOTIFICATION_ITERATOR_STATUS_OK;
 
-	assert(iterator);
-	assert(iterator->component);
-	assert(iterator->component->class);
+	*count = 0;
 
-	switch (iterator->component->class->type) {
-	case BT_COMPONENT_CLASS_TYPE_SOURCE:
-	{
-		struct bt_component_class_source *source_class =
-			container_of(iterator->component->class,
-				struct bt_component_class_source, parent);
+	if (unlikely(iterator->deferred_status !=
+			BT_NOTIFICATION_ITERATOR_STATUS_OK)) {
+		ret = iterator->deferred_status;
+		iterator->deferred_status = BT_NOTIFICATION_ITERATOR_STATUS_OK;
+		goto end;
+	}
 
-		assert(source_class->methods.iterator.get);
-		get_method = source_class->methods.iterator.get;
-		break;
+	if (iterator->methods->next_batch) {
+		ret = iterator->methods->next_batch(iterator, notifications,
+				capacity, count);
+		assert(*count <= capacity);
+		assert(ret != BT_NOTIFICATION_ITERATOR_STATUS_OK || *count > 0);
+	} else {
+		/* Emulate the batch with the single-step methods. */
+		for (i = 0; i < capacity; i++) {
+			ret = iterator->methods->next(iterator);
+			if (ret != BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+				break;
+			}
+
+			notifications[i] = iterator->methods->get(iterator);
+			if (!notifications[i]) {
+				ret = BT_NOTIFICATION_ITERATOR_STATUS_ERROR;
+				break;
+			}
+		}
+
+		*count = i;
 	}
-	case BT_COMPONENT_CLASS_TYPE_FILTER:
-	{
-		struct bt_component_class_filter *filter_class =
-			container_of(iterator->component->class,
-				struct bt_component_class_filter, parent);
 
-		assert(filter_class->methods.iterator.get);
-		get_method = filter_class->methods.iterator.get;
-		break;
+	if (*count > 0 && ret != BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+		/* Deliver what was gathered; report the status next time. */
+		iterator->deferred_status = ret;
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_OK;
 	}
-	default:
-		assert(false);
-		break;
+end:
+	return ret;
+}
+
+/*
+ * Advances the iterator in batches, pushing the notifications to the
+ * queue until the sequence ends, the upstream iterator has nothing to
+ * give yet (BT_NOTIFICATION_ITERATOR_STATUS_AGAIN), or the user closes
+ * the queue. The status which stopped the thread is pushed last.
+ */
+static
+void *prefetch_thread(void *data)
+{
+	struct bt_notification_iterator *iterator = data;
+	struct bt_notification_queue *queue = iterator->prefetch->queue;
+	struct bt_notification *notifications[PREFETCH_BATCH_SIZE];
+	enum bt_notification_iterator_status ret;
+
+	do {
+		size_t i, count;
+
+		ret = next_batch_direct(iterator, notifications,
+				PREFETCH_BATCH_SIZE, &count);
+		for (i = 0; i < count; i++) {
+			if (bt_notification_queue_push(queue,
+					notifications[i],
+					BT_NOTIFICATION_ITERATOR_STATUS_OK)) {
+				/* Closed by the user */
+				for (; i < count; i++) {
+					bt_put(notifications[i]);
+				}
+				goto end;
+			}
+		}
+	} while (ret == BT_NOTIFICATION_ITERATOR_STATUS_OK);
+
+	(void) bt_notification_queue_push(queue, NULL, ret);
+end:
+	return NULL;
+}
+
+static
+int prefetch_start(struct bt_notification_iterator *iterator)
+{
+	struct bt_notification_iterator_prefetch *prefetch =
+			iterator->prefetch;
+	int ret = 0;
+
+	if (likely(prefetch->running)) {
+		goto end;
+	}
+
+	/* Notifications are handed over from the prefetching thread. */
+	bt_ref_enable_thread_safety();
+
+	ret = pthread_create(&prefetch->thread, NULL, prefetch_thread,
+			iterator);
+	if (ret) {
+		fprintf(stderr, "Cannot create notification iterator thread: %s\n",
+				strerror(ret));
+		ret = -1;
+		goto end;
+	}
+
+	prefetch->running = true;
+end:
+	return ret;
+}
+
+/*
+ * Stops and joins the prefetching thread, dropping what it gathered
+ * ahead of the user.
+ */
+static
+void prefetch_stop(struct bt_notification_iterator *iterator)
+{
+	struct bt_notification_iterator_prefetch *prefetch =
+			iterator->prefetch;
+
+	if (prefetch->running) {
+		bt_notification_queue_close(prefetch->queue);
+		pthread_join(prefetch->thread, NULL);
+		prefetch->running = false;
+	}
+
+	bt_notification_queue_reset(prefetch->queue);
+	BT_PUT(prefetch->current);
+	prefetch->end_status = BT_NOTIFICATION_ITERATOR_STATUS_OK;
+	prefetch->again_pending = false;
+}
+
+/*
+ * Pops the next prefetched notification, waiting for it if "wait" is
+ * true. Returns BT_NOTIFICATION_ITERATOR_STATUS_OK with a NULL
+ * notification if there's none yet and "wait" is false.
+ */
+static
+enum bt_notification_iterator_status prefetch_pop(
+		struct bt_notification_iterator *iterator,
+		struct bt_notification **notification, bool wait)
+{
+	struct bt_notification_iterator_prefetch *prefetch =
+			iterator->prefetch;
+	enum bt_notification_iterator_status ret;
+
+	*notification = NULL;
+	if (prefetch->end_status != BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+		ret = prefetch->end_status;
+		goto end;
+	}
+
+	if (prefetch->again_pending) {
+		prefetch->again_pending = false;
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_AGAIN;
+		goto end;
+	}
+
+	if (prefetch_start(iterator)) {
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_ERROR;
+		goto end;
+	}
+
+	ret = bt_notification_queue_pop(prefetch->queue, notification, wait);
+	if (ret != BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+		/* The thread is done. */
+		pthread_join(prefetch->thread, NULL);
+		prefetch->running = false;
+
+		/*
+		 * AGAIN does not end the sequence: the next pop starts
+		 * the thread again to retry.
+		 */
+		if (ret != BT_NOTIFICATION_ITERATOR_STATUS_AGAIN) {
+			prefetch->end_status = ret;
+		}
+	}
+end:
+	return ret;
+}
+
+BT_HIDDEN
+enum bt_notification_iterator_status bt_notification_iterator_enable_prefetch(
+		struct bt_notification_iterator *iterator, size_t capacity)
+{
+	enum bt_notification_iterator_status ret =
+			BT_NOTIFICATION_ITERATOR_STATUS_OK;
+	struct bt_notification_iterator_prefetch *prefetch;
+
+	if (!iterator || capacity == 0) {
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_INVAL;
+		goto end;
+	}
+
+	if (iterator->prefetch) {
+		goto end;
+	}
+
+	prefetch = g_new0(struct bt_notification_iterator_prefetch, 1);
+	if (!prefetch) {
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_NOMEM;
+		goto end;
+	}
+
+	prefetch->queue = bt_notification_queue_create(capacity);
+	if (!prefetch->queue) {
+		g_free(prefetch);
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_NOMEM;
+		goto end;
 	}
 
-	assert(get_method);
-	return get_method(iterator);
+	prefetch->end_status = BT_NOTIFICATION_ITERATOR_STATUS_OK;
+	iterator->prefetch = prefetch;
+end:
+	return ret;
+}
+
+struct bt_notification *bt_notification_iterator_get_notification(
+		struct bt_notification_iterator *iterator)
+{
+	assert(iterator);
+	assert(iterator->methods);
+
+	if (iterator->prefetch) {
+		if (!iterator->prefetch->current) {
+			(void) bt_notification_iterator_next(iterator);
+		}
+
+		return bt_get(iterator->prefetch->current);
+	}
+
+	return iterator->methods->get(iterator);
 }
 
 enum bt_notification_iterator_status
 bt_notification_iterator_next(struct bt_notification_iterator *iterator)
 {
-	bt_component_class_notification_iterator_next_method next_method = NULL;
+	enum bt_notification_iterator_status ret;
 
 	assert(iterator);
-	assert(iterator->component);
-	assert(iterator->component->class);
+	assert(iterator->methods);
 
-	switch (iterator->component->class->type) {
-	case BT_COMPONENT_CLASS_TYPE_SOURCE:
-	{
-		struct bt_component_class_source *source_class =
-			container_of(iterator->component->class,
-				struct bt_component_class_source, parent);
+	if (iterator->prefetch) {
+		BT_PUT(iterator->prefetch->current);
+		return prefetch_pop(iterator, &iterator->prefetch->current,
+				true);
+	}
 
-		assert(source_class->methods.iterator.next);
-		next_method = source_class->methods.iterator.next;
-		break;
+	if (unlikely(iterator->deferred_status !=
+			BT_NOTIFICATION_ITERATOR_STATUS_OK)) {
+		ret = iterator->deferred_status;
+		iterator->deferred_status = BT_NOTIFICATION_ITERATOR_STATUS_OK;
+		return ret;
 	}
-	case BT_COMPONENT_CLASS_TYPE_FILTER:
-	{
-		struct bt_component_class_filter *filter_class =
-			container_of(iterator->component->class,
-				struct bt_component_class_filter, parent);
 
-		assert(filter_class->methods.iterator.next);
-		next_method = filter_class->methods.iterator.next;
-		break;
+	return iterator->methods->next(iterator);
+}
+
+enum bt_notification_iterator_status
+bt_notification_iterator_next_batch(struct bt_notification_iterator *iterator,
+		struct bt_notification **notifications, size_t capacity,
+		size_t *count)
+{
+	enum bt_notification_iterator_status ret =
+			BT_NOTIFICATION_ITERATOR_STATUS_OK;
+
+	if (!iterator || !notifications || capacity == 0 || !count) {
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_INVAL;
+		goto end;
 	}
-	default:
-		assert(false);
-		break;
+
+	assert(iterator->methods);
+
+	if (!iterator->prefetch) {
+		ret = next_batch_direct(iterator, notifications, capacity,
+				count);
+		goto end;
 	}
 
-	assert(next_method);
-	return next_method(iterator);
+	/*
+	 * Wait for the first notification only, then take whatever the
+	 * thread already gathered.
+	 */
+	*count = 0;
+	BT_PUT(iterator->prefetch->current);
+	ret = prefetch_pop(iterator, &notifications[0], true);
+	while (ret == BT_NOTIFICATION_ITERATOR_STATUS_OK &&
+			notifications[*count]) {
+		(*count)++;
+		if (*count == capacity) {
+			break;
+		}
+
+		ret = prefetch_pop(iterator, &notifications[*count], false);
+	}
+
+	if (*count > 0) {
+		/*
+		 * An ending status is kept by prefetch_pop(), but AGAIN
+		 * is not: report it on the next call.
+		 */
+		if (ret == BT_NOTIFICATION_ITERATOR_STATUS_AGAIN) {
+			iterator->prefetch->again_pending = true;
+		}
+
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_OK;
+	}
+end:
+	return ret;
 }
 
 struct bt_component *bt_notification_iterator_get_component(
@@ -237,7 +505,36 @@ enum bt_notification_iterator_status bt_notification_iterator_seek_time(
 		enum bt_notification_iterator_seek_origin seek_origin,
 		int64_t time)
 {
+	bt_component_class_notification_iterator_seek_time_method seek_method =
+			NULL;
 	enum bt_notification_iterator_status ret =
 			BT_NOTIFICATION_ITERATOR_STATUS_UNSUPPORTED;
+
+	if (!iterator) {
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_INVAL;
+		goto end;
+	}
+
+	/* Seek methods only handle absolute times for the moment. */
+	if (seek_origin != BT_NOTIFICATION_ITERATOR_SEEK_ORIGIN_EPOCH) {
+		goto end;
+	}
+
+	assert(iterator->methods);
+	seek_method = iterator->methods->seek_time;
+	if (!seek_method) {
+		goto end;
+	}
+
+	if (iterator->prefetch) {
+		prefetch_stop(iterator);
+	}
+
+	ret = seek_method(iterator, time);
+	if (ret == BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+		/* Whatever ended the last batch is behind. */
+		iterator->deferred_status = BT_NOTIFICATION_ITERATOR_STATUS_OK;
+	}
+end:
 	return ret;
 }
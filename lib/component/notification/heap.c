@@ -30,6 +30,28 @@
 #include <stddef.h>
 #include <babeltrace/compiler.h>
 #include <babeltrace/component/notification/heap-internal.h>
+#include <babeltrace/component/notification/notification-internal.h>
+
+static inline
+bool sort_key_is_before(struct bt_notification *a, struct bt_notification *b)
+{
+	if (a->sort_key.timestamp != b->sort_key.timestamp) {
+		return a->sort_key.timestamp < b->sort_key.timestamp;
+	}
+
+	return a->sort_key.tie_break < b->sort_key.tie_break;
+}
+
+static inline
+bool is_before(struct bt_notification_heap *heap,
+		struct bt_notification *a, struct bt_notification *b)
+{
+	if (likely(!heap->compare)) {
+		return sort_key_is_before(a, b);
+	}
+
+	return heap->compare(a, b, heap->compare_data);
+}
 
 #ifdef DEBUG_HEAP
 static
@@ -42,9 +64,8 @@ void check_heap(struct bt_notification_heap *heap)
 	}
 
 	for (i = 1; i < heap->count; i++) {
-		assert(!heap->compare(g_ptr_array_index(heap->ptrs, i),
-				g_ptr_array_index(heap->ptrs, 0),
-				heap->compare_data));
+		assert(!is_before(heap, g_ptr_array_index(heap->ptrs, i),
+				g_ptr_array_index(heap->ptrs, 0)));
 	}
 }
 #else
@@ -115,14 +136,13 @@ void heapify(struct bt_notification_heap *heap, size_t i)
 
 		l = left(i);
 		r = right(i);
-		if (l < heap->count && heap->compare(ptrs[l], ptrs[i],
-				heap->compare_data)) {
+		if (l < heap->count && is_before(heap, ptrs[l], ptrs[i])) {
 			largest = l;
 		} else {
 			largest = i;
 		}
-		if (r < heap->count && heap->compare(ptrs[r], ptrs[largest],
-				heap->compare_data)) {
+		if (r < heap->count && is_before(heap, ptrs[r],
+				ptrs[largest])) {
 			largest = r;
 		}
 		if (unlikely(largest == i)) {
@@ -174,14 +194,11 @@ void bt_notification_heap_destroy(struct bt_object *obj)
 	g_free(heap);
 }
 
-struct bt_notification_heap *bt_notification_heap_create(
+static
+struct bt_notification_heap *heap_create(
 		bt_notification_time_compare_func comparator, void *user_data)
 {
-	struct bt_notification_heap *heap = NULL;
-
-	if (!comparator) {
-		goto end;
-	}
+	struct bt_notification_heap *heap;
 
 	heap = g_new0(struct bt_notification_heap, 1);
 	if (!heap) {
@@ -201,6 +218,25 @@ end:
 	return heap;
 }
 
+struct bt_notification_heap *bt_notification_heap_create(
+		bt_notification_time_compare_func comparator, void *user_data)
+{
+	struct bt_notification_heap *heap = NULL;
+
+	if (!comparator) {
+		goto end;
+	}
+
+	heap = heap_create(comparator, user_data);
+end:
+	return heap;
+}
+
+struct bt_notification_heap *bt_notification_heap_create_sort_key(void)
+{
+	return heap_create(NULL, NULL);
+}
+
 struct bt_notification *bt_notification_heap_peek(
 		struct bt_notification_heap *heap)
 {
@@ -223,8 +259,7 @@ int bt_notification_heap_insert(struct bt_notification_heap *heap,
 
 	ptrs = (struct bt_notification **) heap->ptrs->pdata;
 	pos = heap->count - 1;
-	while (pos > 0 && heap->compare(notification, ptrs[parent(pos)],
-		        heap->compare_data)) {
+	while (pos > 0 && is_before(heap, notification, ptrs[parent(pos)])) {
 		/* Move parent down until we find the right spot. */
 		ptrs[pos] = ptrs[parent(pos)];
 		pos = parent(pos);
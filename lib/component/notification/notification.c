@@ -56,3 +56,41 @@ struct bt_ctf_stream *bt_notification_get_stream(
 end:
 	return stream;
 }
+
+int bt_notification_set_sort_key(struct bt_notification *notification,
+		int64_t timestamp, uint64_t tie_break)
+{
+	int ret = 0;
+
+	if (!notification) {
+		ret = -1;
+		goto end;
+	}
+
+	notification->sort_key.timestamp = timestamp;
+	notification->sort_key.tie_break = tie_break;
+	notification->sort_key.is_set = true;
+end:
+	return ret;
+}
+
+int bt_notification_get_sort_key(struct bt_notification *notification,
+		int64_t *timestamp, uint64_t *tie_break)
+{
+	int ret = 0;
+
+	if (!notification || !notification->sort_key.is_set) {
+		ret = -1;
+		goto end;
+	}
+
+	if (timestamp) {
+		*timestamp = notification->sort_key.timestamp;
+	}
+
+	if (tie_break) {
+		*tie_break = notification->sort_key.tie_break;
+	}
+end:
+	return ret;
+}
@@ -0,0 +1,136 @@
+/*
+ * Babeltrace - Bounded notification queue between two threads
+ *
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <glib.h>
+#include <babeltrace/compiler.h>
+#include <babeltrace/component/notification/queue-internal.h>
+
+static inline
+bool queue_is_closed(struct bt_notification_queue *queue)
+{
+	return __atomic_load_n(&queue->closed, __ATOMIC_SEQ_CST);
+}
+
+static
+bool producer_must_wait(void *data)
+{
+	struct bt_notification_queue *queue = data;
+
+	return !queue_is_closed(queue) &&
+		bt_notification_ring_is_full(&queue->ring);
+}
+
+BT_HIDDEN
+struct bt_notification_queue *bt_notification_queue_create(size_t capacity)
+{
+	struct bt_notification_queue *queue;
+
+	queue = g_new0(struct bt_notification_queue, 1);
+	if (!queue) {
+		goto end;
+	}
+
+	if (bt_notification_ring_init(&queue->ring, capacity)) {
+		g_free(queue);
+		queue = NULL;
+		goto end;
+	}
+
+	bt_notification_ring_sync_init(&queue->sync);
+end:
+	return queue;
+}
+
+BT_HIDDEN
+void bt_notification_queue_destroy(struct bt_notification_queue *queue)
+{
+	if (!queue) {
+		return;
+	}
+
+	bt_notification_ring_fini(&queue->ring);
+	bt_notification_ring_sync_fini(&queue->sync);
+	g_free(queue);
+}
+
+BT_HIDDEN
+int bt_notification_queue_push(struct bt_notification_queue *queue,
+		struct bt_notification *notification,
+		enum bt_notification_iterator_status status)
+{
+	struct bt_notification_ring_item *item;
+
+	if (unlikely(bt_notification_ring_is_full(&queue->ring))) {
+		bt_notification_ring_wait_space(&queue->sync,
+				producer_must_wait, queue);
+	}
+
+	if (unlikely(queue_is_closed(queue))) {
+		return -1;
+	}
+
+	item = bt_notification_ring_tail(&queue->ring);
+	item->notification = notification;
+	item->status = status;
+	bt_notification_ring_push(&queue->ring, &queue->sync);
+	return 0;
+}
+
+BT_HIDDEN
+enum bt_notification_iterator_status bt_notification_queue_pop(
+		struct bt_notification_queue *queue,
+		struct bt_notification **notification, bool wait)
+{
+	struct bt_notification_ring_item *item;
+	enum bt_notification_iterator_status status;
+
+	if (bt_notification_ring_count(&queue->ring) == 0) {
+		if (!wait) {
+			*notification = NULL;
+			return BT_NOTIFICATION_ITERATOR_STATUS_OK;
+		}
+
+		bt_notification_ring_wait_data(&queue->ring, &queue->sync);
+	}
+
+	item = bt_notification_ring_head(&queue->ring);
+	*notification = item->notification;
+	status = item->status;
+	bt_notification_ring_pop(&queue->ring, &queue->sync);
+	return status;
+}
+
+BT_HIDDEN
+void bt_notification_queue_close(struct bt_notification_queue *queue)
+{
+	__atomic_store_n(&queue->closed, 1, __ATOMIC_SEQ_CST);
+	bt_notification_ring_wake_producer(&queue->sync);
+}
+
+BT_HIDDEN
+void bt_notification_queue_reset(struct bt_notification_queue *queue)
+{
+	bt_notification_ring_reset(&queue->ring);
+	queue->closed = 0;
+}
@@ -27,6 +27,9 @@
 #include <babeltrace/ref-internal.h>
 #include <babeltrace/object-internal.h>
 
+BT_HIDDEN
+int bt_ref_thread_safe;
+
 void *bt_get(void *ptr)
 {
 	struct bt_object *obj = ptr;
@@ -53,3 +56,12 @@ void bt_put(void *ptr)
 
 	bt_ref_put(&obj->ref_count);
 }
+
+void bt_ref_enable_thread_safety(void)
+{
+	/*
+	 * The objects are not shared yet: the threads which will share
+	 * them see this store once they are created.
+	 */
+	bt_ref_thread_safe = 1;
+}
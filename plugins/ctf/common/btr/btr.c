@@ -33,6 +33,7 @@
 #include <babeltrace/ctf-ir/field-types.h>
 #include <babeltrace/ref.h>
 #include <babeltrace/align.h>
+#include <babeltrace/endian.h>
 #include <glib.h>
 
 #include "btr.h"
@@ -47,19 +48,68 @@
 #define BITS_TO_BYTES_CEIL(_x)		DIV8((_x) + 7)
 #define IN_BYTE_OFFSET(_at)		((_at) & 7)
 
+/*
+ * Decoding information of a field type.
+ *
+ * This is computed once per field type, the first time it is decoded,
+ * so that decoding a field does not need to query the CTF IR field
+ * type API (and get/put references) over and over again.
+ */
+struct type_info {
+	/* Field type (weak: the reader's type info table owns it) */
+	struct bt_ctf_field_type *type;
+
+	/* Type ID of the field type */
+	enum bt_ctf_type_id id;
+
+	/* Alignment (bits, at least 1) */
+	size_t alignment;
+
+	/* Basic field types only (supporting integer's for enumerations) */
+	struct {
+		/* Size (bits) */
+		int64_t size;
+
+		/* Byte order */
+		enum bt_ctf_byte_order bo;
+
+		/* True if the integer is signed */
+		bool is_signed;
+
+		/*
+		 * True if a byte-aligned value of this type may be
+		 * loaded directly from the buffer: 8-, 16-, 32-, or
+		 * 64-bit integer with the host's byte order.
+		 */
+		bool direct;
+	} basic;
+
+	/*
+	 * Structure field types only: field decoding informations, in
+	 * order. Array and sequence field types only: element decoding
+	 * information (single entry). NULL otherwise. Entries are
+	 * borrowed from the reader's type info table.
+	 */
+	GPtrArray *children;
+
+	/* Field count for structures, length for arrays, -1 otherwise */
+	int64_t len;
+};
+
 /* A visit stack entry */
 struct stack_entry {
 	/*
-	 * Current type of base field, one of:
+	 * Decoding information of the current type of base field, one
+	 * of:
 	 *
 	 *   * Structure
 	 *   * Array
 	 *   * Sequence
 	 *   * Variant
 	 *
-	 * Owned by this.
+	 * Borrowed from the reader's type info table.
 	 */
-	struct bt_ctf_field_type *base_type;
+	struct type_info *base_info;
 
 	/* Length of base field (always 1 for variant types) */
 	int64_t base_len;
@@ -92,8 +142,8 @@ struct bt_ctf_btr {
 	/* Error stream */
 	FILE *err_stream;
 
-	/* Current basic field type */
-	struct bt_ctf_field_type *cur_basic_field_type;
+	/* Decoding information of current basic field type (borrowed) */
+	struct type_info *cur_basic;
 
 	/* Current state */
 	enum btr_state state;
@@ -154,15 +204,18 @@ struct bt_ctf_btr {
 		/* Private data */
 		void *data;
 	} user;
+
+	/*
+	 * Table of decoding informations: bt_ctf_field_type (owned
+	 * reference) to struct type_info (owned by this).
+	 */
+	GHashTable *type_infos;
 };
 
 static
 void stack_entry_free_func(gpointer data)
 {
-	struct stack_entry *entry = data;
-
-	BT_PUT(entry->base_type);
-	g_free(entry);
+	g_free(data);
 }
 
 static
@@ -201,29 +254,26 @@ void stack_destroy(struct stack *stack)
 
 static inline
 int64_t get_compound_field_type_length(struct bt_ctf_btr *btr,
-	struct bt_ctf_field_type *field_type)
+	struct type_info *info)
 {
 	int64_t length;
 
-	switch (bt_ctf_field_type_get_type_id(field_type)) {
+	switch (info->id) {
 	case BT_CTF_TYPE_ID_STRUCT:
-		length = (int64_t) bt_ctf_field_type_structure_get_field_count(
-			field_type);
+	case BT_CTF_TYPE_ID_ARRAY:
+		length = info->len;
 		break;
 	case BT_CTF_TYPE_ID_VARIANT:
 		/* Variant field types always "contain" a single type */
 		length = 1;
 		break;
-	case BT_CTF_TYPE_ID_ARRAY:
-		length = bt_ctf_field_type_array_get_length(field_type);
-		break;
 	case BT_CTF_TYPE_ID_SEQUENCE:
-		length = btr->user.cbs.query.get_sequence_length(field_type,
+		length = btr->user.cbs.query.get_sequence_length(info->type,
 			btr->user.data);
 		break;
 	default:
 		PERR("Cannot get length of field type with type ID %d\n",
-			bt_ctf_field_type_get_type_id(field_type));
+			info->id);
 		length = BT_CTF_BTR_STATUS_ERROR;
 	}
 
@@ -231,14 +281,14 @@ int64_t get_compound_field_type_length(struct bt_ctf_btr *btr,
 }
 
 static
-int stack_push(struct stack *stack, struct bt_ctf_field_type *base_type,
+int stack_push(struct stack *stack, struct type_info *base_info,
 	size_t base_len)
 {
 	int ret = 0;
 	struct stack_entry *entry;
 
 	assert(stack);
-	assert(base_type);
+	assert(base_info);
 
 	entry = g_new0(struct stack_entry, 1);
 	if (!entry) {
@@ -246,8 +296,7 @@ int stack_push(struct stack *stack, struct bt_ctf_field_type *base_type,
 		goto end;
 	}
 
-	entry->base_type = base_type;
-	bt_get(entry->base_type);
+	entry->base_info = base_info;
 	entry->base_len = base_len;
 	g_ptr_array_add(stack->entries, entry);
 
@@ -257,10 +306,10 @@ end:
 
 static
 int stack_push_with_len(struct bt_ctf_btr *btr,
-	struct bt_ctf_field_type *base_type)
+	struct type_info *base_info)
 {
 	int ret = 0;
-	int64_t base_len = get_compound_field_type_length(btr, base_type);
+	int64_t base_len = get_compound_field_type_length(btr, base_info);
 
 	if (base_len < 0) {
 		PERR("Failed to get compound field type's length\n");
@@ -268,7 +317,7 @@ int stack_push_with_len(struct bt_ctf_btr *btr,
 		goto end;
 	}
 
-	ret = stack_push(btr->stack, base_type, (size_t) base_len);
+	ret = stack_push(btr->stack, base_info, (size_t) base_len);
 
 end:
 	return ret;
@@ -367,14 +416,57 @@ size_t buf_at_from_addr(struct bt_ctf_btr *btr)
 }
 
 static inline
-int get_basic_field_type_size(struct bt_ctf_btr *btr,
-	struct bt_ctf_field_type *field_type)
+bool is_native_byte_order(enum bt_ctf_byte_order bo)
+{
+#if (BYTE_ORDER == LITTLE_ENDIAN)
+	return bo == BT_CTF_BYTE_ORDER_LITTLE_ENDIAN;
+#else
+	return bo == BT_CTF_BYTE_ORDER_BIG_ENDIAN ||
+		bo == BT_CTF_BYTE_ORDER_NETWORK;
+#endif
+}
+
+static inline
+bool is_compound_type_id(enum bt_ctf_type_id id)
+{
+	return id == BT_CTF_TYPE_ID_STRUCT || id == BT_CTF_TYPE_ID_ARRAY ||
+		id == BT_CTF_TYPE_ID_SEQUENCE || id == BT_CTF_TYPE_ID_VARIANT;
+}
+
+static
+void type_info_destroy(gpointer data)
+{
+	struct type_info *info = data;
+
+	if (info->children) {
+		g_ptr_array_free(info->children, TRUE);
+	}
+
+	g_free(info);
+}
+
+static
+struct type_info *get_type_info(struct bt_ctf_btr *btr,
+	struct bt_ctf_field_type *field_type);
+
+static
+int init_basic_type_info(struct bt_ctf_btr *btr, struct type_info *info)
 {
-	int size;
+	int ret = 0;
+	struct bt_ctf_field_type *int_type = NULL;
 
-	switch (bt_ctf_field_type_get_type_id(field_type)) {
+	switch (info->id) {
 	case BT_CTF_TYPE_ID_INTEGER:
-		size = bt_ctf_field_type_integer_get_size(field_type);
+		int_type = bt_get(info->type);
+		break;
+	case BT_CTF_TYPE_ID_ENUM:
+		int_type = bt_ctf_field_type_enumeration_get_container_type(
+			info->type);
+		if (!int_type) {
+			PERR("Failed to get enumeration type's container type\n");
+			ret = -1;
+			goto end;
+		}
 		break;
 	case BT_CTF_TYPE_ID_FLOAT:
 	{
@@ -382,41 +474,222 @@ int get_basic_field_type_size(struct bt_ctf_btr *btr,
 
 		exp_dig =
 			bt_ctf_field_type_floating_point_get_exponent_digits(
-				field_type);
+				info->type);
 		mant_dig =
 			bt_ctf_field_type_floating_point_get_mantissa_digits(
-				field_type);
+				info->type);
 		if (exp_dig < 0 || mant_dig < 0) {
 			PERR("Failed to get floating point number type's sizes\n");
-			size = BT_CTF_BTR_STATUS_ERROR;
+			ret = -1;
+			goto end;
 		}
 
-		size = exp_dig + mant_dig;
+		assert(exp_dig + mant_dig != 32 ||
+			(exp_dig == 8 && mant_dig == 24));
+		assert(exp_dig + mant_dig != 64 ||
+			(exp_dig == 11 && mant_dig == 53));
+		info->basic.size = exp_dig + mant_dig;
+		info->basic.bo = bt_ctf_field_type_get_byte_order(info->type);
+		goto end;
+	}
+	case BT_CTF_TYPE_ID_STRING:
+		goto end;
+	default:
+		PERR("Unexpected basic field type with type ID %d\n",
+			info->id);
+		ret = -1;
+		goto end;
+	}
+
+	info->basic.size = bt_ctf_field_type_integer_get_size(int_type);
+	if (info->basic.size < 1) {
+		PERR("Failed to get basic field type's size\n");
+		ret = -1;
+		goto end;
+	}
+
+	info->basic.bo = bt_ctf_field_type_get_byte_order(int_type);
+	info->basic.is_signed =
+		bt_ctf_field_type_integer_get_signed(int_type) == 1;
+
+	switch (info->basic.size) {
+	case 8:
+	case 16:
+	case 32:
+	case 64:
+		info->basic.direct = is_native_byte_order(info->basic.bo);
+		break;
+	default:
 		break;
 	}
-	case BT_CTF_TYPE_ID_ENUM:
+
+end:
+	BT_PUT(int_type);
+
+	return ret;
+}
+
+static
+int add_child_type_info(struct bt_ctf_btr *btr, struct type_info *info,
+	struct bt_ctf_field_type *child_type)
+{
+	int ret = 0;
+	struct type_info *child_info;
+
+	if (!child_type) {
+		ret = -1;
+		goto end;
+	}
+
+	child_info = get_type_info(btr, child_type);
+	if (!child_info) {
+		ret = -1;
+		goto end;
+	}
+
+	g_ptr_array_add(info->children, child_info);
+
+end:
+	return ret;
+}
+
+static
+struct type_info *create_type_info(struct bt_ctf_btr *btr,
+	struct bt_ctf_field_type *field_type)
+{
+	int ret;
+	int alignment;
+	struct type_info *info;
+	struct bt_ctf_field_type *child_type = NULL;
+
+	info = g_new0(struct type_info, 1);
+	if (!info) {
+		goto error;
+	}
+
+	info->type = field_type;
+	info->id = bt_ctf_field_type_get_type_id(field_type);
+	info->len = -1;
+	alignment = bt_ctf_field_type_get_alignment(field_type);
+	if (alignment < 0) {
+		PERR("Failed to get type alignment\n");
+		goto error;
+	}
+
+	/*
+	 * 0 means "undefined" for variants; what we really want is 1
+	 * (always aligned)
+	 */
+	info->alignment = alignment == 0 ? 1 : (size_t) alignment;
+
+	switch (info->id) {
+	case BT_CTF_TYPE_ID_STRUCT:
 	{
-		struct bt_ctf_field_type *int_type;
+		int64_t i;
 
-		int_type = bt_ctf_field_type_enumeration_get_container_type(
+		info->len = bt_ctf_field_type_structure_get_field_count(
 			field_type);
-		if (!int_type) {
-			PERR("Failed to get enumeration type's container type\n");
-			size = BT_CTF_BTR_STATUS_ERROR;
-			goto end;
+		if (info->len < 0) {
+			PERR("Failed to get structure field type's field count\n");
+			goto error;
+		}
+
+		info->children = g_ptr_array_sized_new((guint) info->len);
+		if (!info->children) {
+			goto error;
 		}
 
-		size = get_basic_field_type_size(btr, int_type);
-		BT_PUT(int_type);
+		for (i = 0; i < info->len; i++) {
+			ret = bt_ctf_field_type_structure_get_field(field_type,
+				NULL, &child_type, (int) i);
+			if (ret) {
+				child_type = NULL;
+			}
+
+			ret = add_child_type_info(btr, info, child_type);
+			BT_PUT(child_type);
+			if (ret) {
+				PERR("Failed to get structure field's type\n");
+				goto error;
+			}
+		}
 		break;
 	}
+	case BT_CTF_TYPE_ID_ARRAY:
+	case BT_CTF_TYPE_ID_SEQUENCE:
+		if (info->id == BT_CTF_TYPE_ID_ARRAY) {
+			info->len = bt_ctf_field_type_array_get_length(
+				field_type);
+			if (info->len < 0) {
+				PERR("Failed to get array field type's length\n");
+				goto error;
+			}
+
+			child_type = bt_ctf_field_type_array_get_element_type(
+				field_type);
+		} else {
+			child_type =
+				bt_ctf_field_type_sequence_get_element_type(
+					field_type);
+		}
+
+		info->children = g_ptr_array_sized_new(1);
+		if (!info->children) {
+			goto error;
+		}
+
+		ret = add_child_type_info(btr, info, child_type);
+		BT_PUT(child_type);
+		if (ret) {
+			PERR("Failed to get element type\n");
+			goto error;
+		}
+		break;
+	case BT_CTF_TYPE_ID_VARIANT:
+		/* Selected type is only known when decoding */
+		break;
 	default:
-		size = BT_CTF_BTR_STATUS_ERROR;
+		if (init_basic_type_info(btr, info)) {
+			goto error;
+		}
 		break;
 	}
 
+	return info;
+
+error:
+	if (info) {
+		type_info_destroy(info);
+	}
+
+	return NULL;
+}
+
+/*
+ * Returns the decoding information of a field type, creating it (and
+ * the ones of its nested field types) the first time.
+ */
+static
+struct type_info *get_type_info(struct bt_ctf_btr *btr,
+	struct bt_ctf_field_type *field_type)
+{
+	struct type_info *info;
+
+	info = g_hash_table_lookup(btr->type_infos, field_type);
+	if (likely(info)) {
+		goto end;
+	}
+
+	info = create_type_info(btr, field_type);
+	if (!info) {
+		PERR("Failed to create field type's decoding information\n");
+		goto end;
+	}
+
+	g_hash_table_insert(btr->type_infos, bt_get(field_type), info);
+
 end:
-	return size;
+	return info;
 }
 
 static
@@ -560,17 +833,13 @@ static
 enum bt_ctf_btr_status read_basic_float_and_call_cb(struct bt_ctf_btr *btr,
 	const uint8_t *buf, size_t at)
 {
-	int ret;
 	double dblval;
-	int64_t field_size;
-	enum bt_ctf_byte_order bo;
+	struct type_info *info = btr->cur_basic;
 	enum bt_ctf_btr_status status = BT_CTF_BTR_STATUS_OK;
 
-	field_size = get_basic_field_type_size(btr, btr->cur_basic_field_type);
-	bo = bt_ctf_field_type_get_byte_order(btr->cur_basic_field_type);
-	btr->cur_bo = bo;
+	btr->cur_bo = info->basic.bo;
 
-	switch (field_size) {
+	switch (info->basic.size) {
 	case 32:
 	{
 		uint64_t v;
@@ -579,13 +848,8 @@ enum bt_ctf_btr_status read_basic_float_and_call_cb(struct bt_ctf_btr *btr,
 			float f;
 		} f32;
 
-		ret = bt_ctf_field_type_floating_point_get_mantissa_digits(
-			btr->cur_basic_field_type);
-		assert(ret == 24);
-		ret = bt_ctf_field_type_floating_point_get_exponent_digits(
-			btr->cur_basic_field_type);
-		assert(ret == 8);
-		status = read_unsigned_bitfield(buf, at, field_size, bo, &v);
+		status = read_unsigned_bitfield(buf, at, info->basic.size,
+			info->basic.bo, &v);
 		if (status != BT_CTF_BTR_STATUS_OK) {
 			PERR("Failed to reader unsigned bitfield\n");
 			goto end;
@@ -602,14 +866,8 @@ enum bt_ctf_btr_status read_basic_float_and_call_cb(struct bt_ctf_btr *btr,
 			double d;
 		} f64;
 
-		ret = bt_ctf_field_type_floating_point_get_mantissa_digits(
-			btr->cur_basic_field_type);
-		assert(ret == 53);
-		ret = bt_ctf_field_type_floating_point_get_exponent_digits(
-			btr->cur_basic_field_type);
-		assert(ret == 11);
-		status = read_unsigned_bitfield(buf, at, field_size, bo,
-			&f64.u);
+		status = read_unsigned_bitfield(buf, at, info->basic.size,
+			info->basic.bo, &f64.u);
 		if (status != BT_CTF_BTR_STATUS_OK) {
 			PERR("Failed to reader unsigned bitfield\n");
 			goto end;
@@ -626,65 +884,121 @@ enum bt_ctf_btr_status read_basic_float_and_call_cb(struct bt_ctf_btr *btr,
 
 	if (btr->user.cbs.types.floating_point) {
 		status = btr->user.cbs.types.floating_point(dblval,
-			btr->cur_basic_field_type, btr->user.data);
+			info->type, btr->user.data);
 	}
 
 end:
 	return status;
 }
 
+/*
+ * Loads a byte-aligned, native byte order integer directly (fast path
+ * of read_unsigned_bitfield()).
+ */
 static inline
-enum bt_ctf_btr_status read_basic_int_and_call(struct bt_ctf_btr *btr,
-	const uint8_t *buf, size_t at, struct bt_ctf_field_type *int_type,
-	struct bt_ctf_field_type *orig_type)
+uint64_t read_direct_unsigned(const uint8_t *buf, int64_t field_size)
 {
-	int signd;
-	int64_t field_size;
-	enum bt_ctf_byte_order bo;
-	enum bt_ctf_btr_status status = BT_CTF_BTR_STATUS_OK;
+	switch (field_size) {
+	case 8:
+		return *buf;
+	case 16:
+	{
+		uint16_t v;
 
-	signd = bt_ctf_field_type_integer_get_signed(int_type);
-	field_size = get_basic_field_type_size(btr, int_type);
-	if (field_size < 1) {
-		PERR("Failed to get basic field type's size\n");
-		status = BT_CTF_BTR_STATUS_ERROR;
-		goto end;
+		memcpy(&v, buf, sizeof(v));
+		return v;
 	}
+	case 32:
+	{
+		uint32_t v;
 
-	bo = bt_ctf_field_type_get_byte_order(int_type);
+		memcpy(&v, buf, sizeof(v));
+		return v;
+	}
+	default:
+	{
+		uint64_t v;
 
-	/*
-	 * Update current byte order now because we could be reading
-	 * the integer value of an enumeration type, and thus we know
-	 * here the actual supporting integer type's byte order.
-	 */
-	btr->cur_bo = bo;
+		assert(field_size == 64);
+		memcpy(&v, buf, sizeof(v));
+		return v;
+	}
+	}
+}
 
-	if (signd) {
+/*
+ * Loads a byte-aligned, native byte order integer directly (fast path
+ * of read_signed_bitfield()).
+ */
+static inline
+int64_t read_direct_signed(const uint8_t *buf, int64_t field_size)
+{
+	uint64_t v = read_direct_unsigned(buf, field_size);
+
+	switch (field_size) {
+	case 8:
+		return (int8_t) v;
+	case 16:
+		return (int16_t) v;
+	case 32:
+		return (int32_t) v;
+	default:
+		return (int64_t) v;
+	}
+}
+
+/*
+ * Reads an integer, or the supporting integer of an enumeration (the
+ * current basic type's decoding information already points to the
+ * supporting integer's properties).
+ */
+static
+enum bt_ctf_btr_status read_basic_int_and_call_cb(struct bt_ctf_btr *btr,
+	const uint8_t *buf, size_t at)
+{
+	struct type_info *info = btr->cur_basic;
+	bool direct = info->basic.direct && IN_BYTE_OFFSET(at) == 0;
+	enum bt_ctf_btr_status status = BT_CTF_BTR_STATUS_OK;
+
+	btr->cur_bo = info->basic.bo;
+
+	if (info->basic.is_signed) {
 		int64_t v;
 
-		status = read_signed_bitfield(buf, at, field_size, bo, &v);
-		if (status != BT_CTF_BTR_STATUS_OK) {
-			PERR("Failed to reader signed bitfield\n");
-			goto end;
+		if (direct) {
+			v = read_direct_signed(&buf[DIV8(at)],
+				info->basic.size);
+		} else {
+			status = read_signed_bitfield(buf, at,
+				info->basic.size, info->basic.bo, &v);
+			if (status != BT_CTF_BTR_STATUS_OK) {
+				PERR("Failed to reader signed bitfield\n");
+				goto end;
+			}
 		}
 
 		if (btr->user.cbs.types.signed_int) {
 			status = btr->user.cbs.types.signed_int(v,
-				btr->cur_basic_field_type, btr->user.data);
+				info->type, btr->user.data);
 		}
 	} else {
 		uint64_t v;
 
-		status = read_unsigned_bitfield(buf, at, field_size, bo, &v);
-		if (status != BT_CTF_BTR_STATUS_OK) {
-			PERR("Failed to reader unsigned bitfield\n");
-			goto end;
+		if (direct) {
+			v = read_direct_unsigned(&buf[DIV8(at)],
+				info->basic.size);
+		} else {
+			status = read_unsigned_bitfield(buf, at,
+				info->basic.size, info->basic.bo, &v);
+			if (status != BT_CTF_BTR_STATUS_OK) {
+				PERR("Failed to reader unsigned bitfield\n");
+				goto end;
+			}
 		}
 
 		if (btr->user.cbs.types.unsigned_int) {
 			status = btr->user.cbs.types.unsigned_int(v,
-				btr->cur_basic_field_type, btr->user.data);
+				info->type, btr->user.data);
 		}
 	}
 
@@ -692,44 +1006,11 @@ end:
 	return status;
 }
 
-static
-enum bt_ctf_btr_status read_basic_int_and_call_cb(struct bt_ctf_btr *btr,
-	const uint8_t *buf, size_t at)
-{
-	return read_basic_int_and_call(btr, buf, at, btr->cur_basic_field_type,
-		btr->cur_basic_field_type);
-}
-
-static
-enum bt_ctf_btr_status read_basic_enum_and_call_cb(struct bt_ctf_btr *btr,
-	const uint8_t *buf, size_t at)
-{
-	struct bt_ctf_field_type *int_field_type;
-	enum bt_ctf_btr_status status = BT_CTF_BTR_STATUS_OK;
-
-	int_field_type = bt_ctf_field_type_enumeration_get_container_type(
-		btr->cur_basic_field_type);
-	if (!int_field_type) {
-		PERR("Failed to get enumeration type's container type\n");
-		status = BT_CTF_BTR_STATUS_ERROR;
-		goto end;
-	}
-
-	status = read_basic_int_and_call(btr, buf, at,
-		int_field_type, btr->cur_basic_field_type);
-
-end:
-	BT_PUT(int_field_type);
-
-	return status;
-}
-
 static inline
 enum bt_ctf_btr_status read_basic_type_and_call_continue(struct bt_ctf_btr *btr,
 	read_basic_and_call_cb_t read_basic_and_call_cb)
 {
 	size_t available;
-	int64_t field_size;
 	int64_t needed_bits;
 	enum bt_ctf_btr_status status = BT_CTF_BTR_STATUS_OK;
 
@@ -738,15 +1019,8 @@ enum bt_ctf_btr_status read_basic_type_and_call_continue(struct bt_ctf_btr *btr,
 		goto end;
 	}
 
-	field_size = get_basic_field_type_size(btr, btr->cur_basic_field_type);
-	if (field_size < 1) {
-		PERR("Failed to get basic field type's size\n");
-		status = BT_CTF_BTR_STATUS_ERROR;
-		goto end;
-	}
-
 	available = available_bits(btr);
-	needed_bits = field_size - btr->stitch.at;
+	needed_bits = btr->cur_basic->basic.size - btr->stitch.at;
 	if (needed_bits <= available) {
 		/* We have all the bits; append to stitch, then decode */
 		stitch_append_from_buf(btr, needed_bits);
@@ -783,7 +1057,6 @@ enum bt_ctf_btr_status read_basic_type_and_call_begin(struct bt_ctf_btr *btr,
 {
 	size_t available;
 	int64_t field_size;
-	enum bt_ctf_byte_order bo;
 	enum bt_ctf_btr_status status = BT_CTF_BTR_STATUS_OK;
 
 	if (!at_least_one_bit_left(btr)) {
@@ -791,16 +1064,8 @@ enum bt_ctf_btr_status read_basic_type_and_call_begin(struct bt_ctf_btr *btr,
 		goto end;
 	}
 
-	field_size = get_basic_field_type_size(btr, btr->cur_basic_field_type);
-
-	if (field_size < 1) {
-		PERR("Failed to get basic field type's size\n");
-		status = BT_CTF_BTR_STATUS_ERROR;
-		goto end;
-	}
-
-	bo = bt_ctf_field_type_get_byte_order(btr->cur_basic_field_type);
-	status = validate_contiguous_bo(btr, bo);
+	field_size = btr->cur_basic->basic.size;
+	status = validate_contiguous_bo(btr, btr->cur_basic->basic.bo);
 
 	if (status != BT_CTF_BTR_STATUS_OK) {
 		PERR("Invalid contiguous byte orders\n");
@@ -874,22 +1139,6 @@ enum bt_ctf_btr_status read_basic_float_type_and_call_continue(
 		read_basic_float_and_call_cb);
 }
 
-static inline
-enum bt_ctf_btr_status read_basic_enum_type_and_call_begin(
-	struct bt_ctf_btr *btr)
-{
-	return read_basic_type_and_call_begin(btr,
-		read_basic_enum_and_call_cb);
-}
-
-static inline
-enum bt_ctf_btr_status read_basic_enum_type_and_call_continue(
-	struct bt_ctf_btr *btr)
-{
-	return read_basic_type_and_call_continue(btr,
-		read_basic_enum_and_call_cb);
-}
-
 static inline
 enum bt_ctf_btr_status read_basic_string_type_and_call(
 	struct bt_ctf_btr *btr, bool begin)
@@ -913,7 +1162,7 @@ enum bt_ctf_btr_status read_basic_string_type_and_call(
 
 	if (begin && btr->user.cbs.types.string_begin) {
 		status = btr->user.cbs.types.string_begin(
-			btr->cur_basic_field_type, btr->user.data);
+			btr->cur_basic->type, btr->user.data);
 
 		if (status != BT_CTF_BTR_STATUS_OK) {
 			PERR("string_begin() user callback function failed\n");
@@ -926,7 +1175,7 @@ enum bt_ctf_btr_status read_basic_string_type_and_call(
 		if (btr->user.cbs.types.string) {
 			status = btr->user.cbs.types.string(
 				(const char *) first_chr,
-				available_bytes, btr->cur_basic_field_type,
+				available_bytes, btr->cur_basic->type,
 				btr->user.data);
 			if (status != BT_CTF_BTR_STATUS_OK) {
 				PERR("string() user callback function failed\n");
@@ -944,7 +1193,7 @@ enum bt_ctf_btr_status read_basic_string_type_and_call(
 		if (btr->user.cbs.types.string && result_len) {
 			status = btr->user.cbs.types.string(
 				(const char *) first_chr,
-				result_len, btr->cur_basic_field_type,
+				result_len, btr->cur_basic->type,
 				btr->user.data);
 			if (status != BT_CTF_BTR_STATUS_OK) {
 				PERR("string() user callback function failed\n");
@@ -954,7 +1203,7 @@ enum bt_ctf_btr_status read_basic_string_type_and_call(
 
 		if (btr->user.cbs.types.string_end) {
 			status = btr->user.cbs.types.string_end(
-				btr->cur_basic_field_type, btr->user.data);
+				btr->cur_basic->type, btr->user.data);
 			if (status != BT_CTF_BTR_STATUS_OK) {
 				PERR("string_end() user callback function failed\n");
 				goto end;
@@ -983,18 +1232,16 @@ enum bt_ctf_btr_status read_basic_begin_state(struct bt_ctf_btr *btr)
 {
 	enum bt_ctf_btr_status status;
 
-	assert(btr->cur_basic_field_type);
+	assert(btr->cur_basic);
 
-	switch (bt_ctf_field_type_get_type_id(btr->cur_basic_field_type)) {
+	switch (btr->cur_basic->id) {
 	case BT_CTF_TYPE_ID_INTEGER:
+	case BT_CTF_TYPE_ID_ENUM:
 		status = read_basic_int_type_and_call_begin(btr);
 		break;
 	case BT_CTF_TYPE_ID_FLOAT:
 		status = read_basic_float_type_and_call_begin(btr);
 		break;
-	case BT_CTF_TYPE_ID_ENUM:
-		status = read_basic_enum_type_and_call_begin(btr);
-		break;
 	case BT_CTF_TYPE_ID_STRING:
 		status = read_basic_string_type_and_call(btr, true);
 		break;
@@ -1010,18 +1257,16 @@ enum bt_ctf_btr_status read_basic_continue_state(struct bt_ctf_btr *btr)
 {
 	enum bt_ctf_btr_status status;
 
-	assert(btr->cur_basic_field_type);
+	assert(btr->cur_basic);
 
-	switch (bt_ctf_field_type_get_type_id(btr->cur_basic_field_type)) {
+	switch (btr->cur_basic->id) {
 	case BT_CTF_TYPE_ID_INTEGER:
+	case BT_CTF_TYPE_ID_ENUM:
 		status = read_basic_int_type_and_call_continue(btr);
 		break;
 	case BT_CTF_TYPE_ID_FLOAT:
 		status = read_basic_float_type_and_call_continue(btr);
 		break;
-	case BT_CTF_TYPE_ID_ENUM:
-		status = read_basic_enum_type_and_call_continue(btr);
-		break;
 	case BT_CTF_TYPE_ID_STRING:
 		status = read_basic_string_type_and_call(btr, false);
 		break;
@@ -1044,28 +1289,12 @@ size_t bits_to_skip_to_align_to(struct bt_ctf_btr *btr, size_t align)
 
 static inline
 enum bt_ctf_btr_status align_type_state(struct bt_ctf_btr *btr,
-	struct bt_ctf_field_type *field_type, enum btr_state next_state)
+	struct type_info *info, enum btr_state next_state)
 {
-	int field_alignment;
+	size_t field_alignment = info->alignment;
 	size_t skip_bits;
 	enum bt_ctf_btr_status status = BT_CTF_BTR_STATUS_OK;
 
-	/* Get field's alignment */
-	field_alignment = bt_ctf_field_type_get_alignment(field_type);
-	if (field_alignment < 0) {
-		PERR("Failed to get type alignment\n");
-		status = BT_CTF_BTR_STATUS_ERROR;
-		goto end;
-	}
-
-	/*
-	 * 0 means "undefined" for variants; what we really want is 1
-	 * (always aligned)
-	 */
-	if (field_alignment == 0) {
-		field_alignment = 1;
-	}
-
 	/* Compute how many bits we need to skip */
 	skip_bits = bits_to_skip_to_align_to(btr, field_alignment);
 
@@ -1100,20 +1329,12 @@ end:
 	return status;
 }
 
-static inline
-bool is_compound_type(struct bt_ctf_field_type *field_type)
-{
-	enum bt_ctf_type_id id = bt_ctf_field_type_get_type_id(field_type);
-
-	return id == BT_CTF_TYPE_ID_STRUCT || id == BT_CTF_TYPE_ID_ARRAY ||
-		id == BT_CTF_TYPE_ID_SEQUENCE || id == BT_CTF_TYPE_ID_VARIANT;
-}
-
 static inline
 enum bt_ctf_btr_status next_field_state(struct bt_ctf_btr *btr)
 {
 	int ret;
 	struct stack_entry *top;
+	struct type_info *next_info = NULL;
 	struct bt_ctf_field_type *next_field_type = NULL;
 	enum bt_ctf_btr_status status = BT_CTF_BTR_STATUS_OK;
 
@@ -1127,7 +1348,7 @@ enum bt_ctf_btr_status next_field_state(struct bt_ctf_btr *btr)
 	while (top->index == top->base_len) {
 		if (btr->user.cbs.types.compound_end) {
 			status = btr->user.cbs.types.compound_end(
-				top->base_type, btr->user.data);
+				top->base_info->type, btr->user.data);
 			if (status != BT_CTF_BTR_STATUS_OK) {
 				PERR("compound_end() user callback function failed\n");
 				goto end;
@@ -1147,52 +1368,45 @@ enum bt_ctf_btr_status next_field_state(struct bt_ctf_btr *btr)
 	}
 
 	/* Get next field's type */
-	switch (bt_ctf_field_type_get_type_id(top->base_type)) {
+	switch (top->base_info->id) {
 	case BT_CTF_TYPE_ID_STRUCT:
-		ret = bt_ctf_field_type_structure_get_field(
-			top->base_type, NULL, &next_field_type,
+		next_info = g_ptr_array_index(top->base_info->children,
 			top->index);
-		if (ret) {
-			next_field_type = NULL;
-		}
 		break;
 	case BT_CTF_TYPE_ID_ARRAY:
-		next_field_type =
-			bt_ctf_field_type_array_get_element_type(
-				top->base_type);
-		break;
 	case BT_CTF_TYPE_ID_SEQUENCE:
-		next_field_type =
-			bt_ctf_field_type_sequence_get_element_type(
-				top->base_type);
+		next_info = g_ptr_array_index(top->base_info->children, 0);
 		break;
 	case BT_CTF_TYPE_ID_VARIANT:
 		/* Variant types are dynamic: query the user, he should know! */
 		next_field_type =
 			btr->user.cbs.query.get_variant_type(
-				top->base_type, btr->user.data);
+				top->base_info->type, btr->user.data);
+		if (next_field_type) {
+			next_info = get_type_info(btr, next_field_type);
+		}
 		break;
 	default:
 		break;
 	}
 
-	if (!next_field_type) {
+	if (!next_info) {
 		PERR("Failed to get next field's type\n");
 		status = BT_CTF_BTR_STATUS_ERROR;
 		goto end;
 	}
 
-	if (is_compound_type(next_field_type)) {
+	if (is_compound_type_id(next_info->id)) {
 		if (btr->user.cbs.types.compound_begin) {
 			status = btr->user.cbs.types.compound_begin(
-				next_field_type, btr->user.data);
+				next_info->type, btr->user.data);
 			if (status != BT_CTF_BTR_STATUS_OK) {
 				PERR("compound_begin() user callback function failed\n");
 				goto end;
 			}
 		}
 
-		ret = stack_push_with_len(btr, next_field_type);
+		ret = stack_push_with_len(btr, next_info);
 		if (ret) {
 			PERR("Failed to push compound type onto the stack\n");
 			status = BT_CTF_BTR_STATUS_ERROR;
@@ -1203,7 +1417,7 @@ enum bt_ctf_btr_status next_field_state(struct bt_ctf_btr *btr)
 		btr->state = BTR_STATE_ALIGN_COMPOUND;
 	} else {
 		/* Replace current basic field type */
-		BT_MOVE(btr->cur_basic_field_type, next_field_type);
+		btr->cur_basic = next_info;
 
 		/* Next state: align a basic type */
 		btr->state = BTR_STATE_ALIGN_BASIC;
@@ -1225,11 +1439,11 @@ enum bt_ctf_btr_status handle_state(struct bt_ctf_btr *btr)
 		status = next_field_state(btr);
 		break;
 	case BTR_STATE_ALIGN_BASIC:
-		status = align_type_state(btr, btr->cur_basic_field_type,
+		status = align_type_state(btr, btr->cur_basic,
 			BTR_STATE_READ_BASIC_BEGIN);
 		break;
 	case BTR_STATE_ALIGN_COMPOUND:
-		status = align_type_state(btr, stack_top(btr->stack)->base_type,
+		status = align_type_state(btr, stack_top(btr->stack)->base_info,
 			BTR_STATE_NEXT_FIELD);
 		break;
 	case BTR_STATE_READ_BASIC_BEGIN:
@@ -1264,6 +1478,15 @@ struct bt_ctf_btr *bt_ctf_btr_create(struct bt_ctf_btr_cbs cbs, void *data,
 		goto end;
 	}
 
+	btr->type_infos = g_hash_table_new_full(g_direct_hash,
+		g_direct_equal, (GDestroyNotify) bt_put, type_info_destroy);
+	if (!btr->type_infos) {
+		PERR("Failed to create type info table\n");
+		bt_ctf_btr_destroy(btr);
+		btr = NULL;
+		goto end;
+	}
+
 	btr->state = BTR_STATE_NEXT_FIELD;
 	btr->user.cbs = cbs;
 	btr->user.data = data;
@@ -1279,7 +1502,10 @@ void bt_ctf_btr_destroy(struct bt_ctf_btr *btr)
 		stack_destroy(btr->stack);
 	}
 
-	BT_PUT(btr->cur_basic_field_type);
+	if (btr->type_infos) {
+		g_hash_table_destroy(btr->type_infos);
+	}
+
 	g_free(btr);
 }
 
@@ -1287,7 +1513,7 @@ static
 void reset(struct bt_ctf_btr *btr)
 {
 	stack_clear(btr->stack);
-	BT_PUT(btr->cur_basic_field_type);
+	btr->cur_basic = NULL;
 	stitch_reset(btr);
 	btr->buf.addr = NULL;
 	btr->last_bo = BT_CTF_BYTE_ORDER_UNKNOWN;
@@ -1298,6 +1524,8 @@ size_t bt_ctf_btr_start(struct bt_ctf_btr *btr,
 	size_t offset, size_t packet_offset, size_t sz,
 	enum bt_ctf_btr_status *status)
 {
+	struct type_info *info;
+
 	assert(btr);
 	assert(buf);
 	assert(sz > 0);
@@ -1310,9 +1538,14 @@ size_t bt_ctf_btr_start(struct bt_ctf_btr *btr,
 	btr->buf.buf_sz = sz;
 	btr->buf.sz = BYTES_TO_BITS(sz) - offset;
 	*status = BT_CTF_BTR_STATUS_OK;
+	info = get_type_info(btr, type);
+	if (!info) {
+		*status = BT_CTF_BTR_STATUS_ERROR;
+		goto end;
+	}
 
 	/* Set root type */
-	if (is_compound_type(type)) {
+	if (is_compound_type_id(info->id)) {
 		/* Compound type: push on visit stack */
 		int stack_ret;
 
@@ -1325,7 +1558,7 @@ size_t bt_ctf_btr_start(struct bt_ctf_btr *btr,
 			}
 		}
 
-		stack_ret = stack_push_with_len(btr, type);
+		stack_ret = stack_push_with_len(btr, info);
 		if (stack_ret) {
 			PERR("Failed to push initial compound type onto the stack\n");
 			*status = BT_CTF_BTR_STATUS_ERROR;
@@ -1335,8 +1568,7 @@ size_t bt_ctf_btr_start(struct bt_ctf_btr *btr,
 		btr->state = BTR_STATE_ALIGN_COMPOUND;
 	} else {
 		/* Basic type: set as current basic type */
-		btr->cur_basic_field_type = type;
-		bt_get(btr->cur_basic_field_type);
+		btr->cur_basic = info;
 		btr->state = BTR_STATE_ALIGN_BASIC;
 	}
 
@@ -39,6 +39,7 @@
 #include <babeltrace/ctf-ir/clock-class.h>
 #include <babeltrace/ctf-ir/event-class.h>
 #include <babeltrace/component/notification/packet.h>
+#include <babeltrace/component/notification/notification.h>
 #include <babeltrace/component/notification/event.h>
 #include <babeltrace/component/notification/stream.h>
 #include <babeltrace/ref.h>
@@ -113,6 +114,17 @@ struct trace_field_path_cache {
 	int stream_instance_id;
 };
 
+/* Option of the LTTng "v" event header variant. */
+struct v_option {
+	/* Weak: owned by the stream class */
+	struct bt_ctf_field_type *type;
+	/* Index of the id field in this option structure, -1 if unset */
+	int id;
+};
+
+/* Largest event ID for which an event class is kept in a dense array. */
+#define EVENT_CLASSES_MAX_DENSE_ID	65535
+
 struct stream_class_field_path_cache {
 	/*
 	 * Indexes of the v and id fields in the stream event header structure,
@@ -121,6 +133,15 @@ struct stream_class_field_path_cache {
 	int v;
 	int id;
 
+	/* Options of the v variant (struct v_option) */
+	GArray *v_options;
+
+	/*
+	 * Event classes (owned by this, may be NULL) indexed by ID, filled
+	 * as they are found.
+	 */
+	GPtrArray *event_classes;
+
 	/*
 	 * index of the timestamp_end, packet_size and content_size fields in
 	 * the stream packet context structure. Set to -1 if the fields were
@@ -131,10 +152,58 @@ struct stream_class_field_path_cache {
 	int content_size;
 };
 
+/*
+ * Field which the length of a sequence or the tag of a variant refers
+ * to, saved when it is decoded.
+ */
+struct field_slot {
+	enum bt_ctf_scope root;
+	/* Indexes of the structure fields leading to it from its root (int) */
+	GArray *indexes;
+	/* Last field decoded at this position (owned by this, may be NULL) */
+	struct bt_ctf_field *field;
+};
+
+/* Called with the notification iterator as "data". */
 struct field_cb_override {
 	enum bt_ctf_btr_status (* func)(void *value,
 			struct bt_ctf_field_type *type, void *data);
-	void *data;
+};
+
+/*
+ * Decoding tables of a trace, built once and only read afterwards, so
+ * that all the notification iterators of the trace share them.
+ */
+struct bt_ctf_notif_iter_decoder {
+	/* Owned by this */
+	struct bt_ctf_trace *trace;
+
+	/*
+	 * Cache of the trace-constant field paths (event header type)
+	 * associated to the trace.
+	 */
+	struct trace_field_path_cache trace_field_path_cache;
+
+	/*
+	 * bt_ctf_stream_class to struct stream_class_field_path_cache,
+	 * for all the stream classes of the trace.
+	 */
+	GHashTable *sc_field_path_caches;
+
+	/*
+	 * Special field overrides.
+	 *
+	 * Overrides are used to implement the behaviours of special fields such
+	 * as "timestamp_end" (which must be ignored until the end of the
+	 * packet), "id" (event id) which can be present multiple times and must
+	 * be updated multiple time.
+	 *
+	 * This should be used to implement the behaviour of integer fields
+	 * mapped to clocks and other "tagged" fields (in CTF 2).
+	 *
+	 * bt_ctf_field_type to struct field_cb_override
+	 */
+	GHashTable *field_overrides;
 };
 
 /* CTF notification iterator */
@@ -154,6 +223,9 @@ struct bt_ctf_notif_iter {
 	 */
 	struct bt_ctf_field **cur_dscope_field;
 
+	/* Scope of the current dynamic scope field. */
+	enum bt_ctf_scope cur_scope;
+
 	/* Trace and classes (owned by this) */
 	struct {
 		struct bt_ctf_trace *trace;
@@ -164,6 +236,20 @@ struct bt_ctf_notif_iter {
 	/* Current packet (NULL if not created yet) */
 	struct bt_ctf_packet *packet;
 
+	/*
+	 * Current event (NULL until its class is known). The event
+	 * context and payload dynamic scopes are decoded directly into
+	 * its fields.
+	 */
+	struct bt_ctf_event *event;
+
+	/*
+	 * Event header field taken from the last (possibly recycled)
+	 * event, into which the next event header is decoded (owned by
+	 * this, may be NULL).
+	 */
+	struct bt_ctf_field *spare_event_header;
+
 	/*
 	 * Current timestamp_end field (to consider before switching packets).
 	 */
@@ -179,20 +265,8 @@ struct bt_ctf_notif_iter {
 		struct bt_ctf_field *event_payload;
 	} dscopes;
 
-	/*
-	 * Special field overrides.
-	 *
-	 * Overrides are used to implement the behaviours of special fields such
-	 * as "timestamp_end" (which must be ignored until the end of the
-	 * packet), "id" (event id) which can be present multiple times and must
-	 * be updated multiple time.
-	 *
-	 * This should be used to implement the behaviour of integer fields
-	 * mapped to clocks and other "tagged" fields (in CTF 2).
-	 *
-	 * bt_ctf_field_type to struct field_cb_override
-	 */
-	GHashTable *field_overrides;
+	/* Shared decoding tables of the trace (weak) */
+	struct bt_ctf_notif_iter_decoder *decoder;
 
 	/* Current state */
 	enum state state;
@@ -232,19 +306,43 @@ struct bt_ctf_notif_iter {
 	GHashTable *clock_states;
 
 	/*
-	 * Cache of the trace-constant field paths (event header type)
-	 * associated to the current trace.
+	 * Clock class used to compute the notifications' sort keys (the
+	 * trace's first clock class, owned by this).
 	 */
-	struct trace_field_path_cache trace_field_path_cache;
+	struct bt_ctf_clock_class *sort_clock_class;
+
+	/* Current event's sort key timestamp (ns from Epoch) */
+	struct {
+		int64_t value;
+		bool is_set;
+	} cur_sort_ts;
 
 	/*
 	 * Field path cache associated with the current stream class.
-	 * Ownership of this structure belongs to the field_path_caches HT.
+	 * Ownership of this structure belongs to the decoder.
 	 */
 	struct stream_class_field_path_cache *cur_sc_field_path_cache;
 
-	/* bt_ctf_stream_class to struct stream_class_field_path_cache. */
-	GHashTable *sc_field_path_caches;
+	/*
+	 * Fields which sequence lengths and variant tags refer to, saved
+	 * as they are decoded instead of being looked up from their scope
+	 * root for each sequence and variant.
+	 */
+	struct {
+		/* struct field_slot* (owned by this) */
+		GPtrArray *slots;
+		/*
+		 * bt_ctf_field_type (sequence or variant) to slot index + 1,
+		 * or to 0 if its length or tag is looked up each time.
+		 */
+		GHashTable *users;
+		/*
+		 * bt_ctf_field_type (integer or enumeration) to GArray of
+		 * the indexes (guint) of the slots which may be at a field
+		 * of this type.
+		 */
+		GHashTable *targets;
+	} field_slots;
 };
 
 static
@@ -254,6 +352,22 @@ static
 enum bt_ctf_btr_status btr_timestamp_end_cb(void *value,
 		struct bt_ctf_field_type *type, void *data);
 
+static
+void field_slot_free_func(gpointer data)
+{
+	struct field_slot *slot = data;
+
+	g_array_free(slot->indexes, TRUE);
+	bt_put(slot->field);
+	g_free(slot);
+}
+
+static
+void slot_indexes_free_func(gpointer data)
+{
+	g_array_free(data, TRUE);
+}
+
 static
 void stack_entry_free_func(gpointer data)
 {
@@ -460,6 +574,26 @@ enum bt_ctf_notif_iter_status buf_ensure_available_bits(
 	return status;
 }
 
+static
+enum bt_ctf_scope get_dscope_scope(struct bt_ctf_notif_iter *notit,
+		struct bt_ctf_field **dscope_field)
+{
+	if (dscope_field == &notit->dscopes.trace_packet_header) {
+		return BT_CTF_SCOPE_TRACE_PACKET_HEADER;
+	} else if (dscope_field == &notit->dscopes.stream_packet_context) {
+		return BT_CTF_SCOPE_STREAM_PACKET_CONTEXT;
+	} else if (dscope_field == &notit->dscopes.stream_event_header) {
+		return BT_CTF_SCOPE_STREAM_EVENT_HEADER;
+	} else if (dscope_field == &notit->dscopes.stream_event_context) {
+		return BT_CTF_SCOPE_STREAM_EVENT_CONTEXT;
+	} else if (dscope_field == &notit->dscopes.event_context) {
+		return BT_CTF_SCOPE_EVENT_CONTEXT;
+	}
+
+	assert(dscope_field == &notit->dscopes.event_payload);
+	return BT_CTF_SCOPE_EVENT_FIELDS;
+}
+
 static
 enum bt_ctf_notif_iter_status read_dscope_begin_state(
 		struct bt_ctf_notif_iter *notit,
@@ -476,8 +610,8 @@ enum bt_ctf_notif_iter_status read_dscope_begin_state(
 		goto end;
 	}
 
-	bt_put(*dscope_field);
 	notit->cur_dscope_field = dscope_field;
+	notit->cur_scope = get_dscope_scope(notit, dscope_field);
 	consumed_bits = bt_ctf_btr_start(notit->btr, dscope_field_type,
 		notit->buf.addr, notit->buf.at, packet_at(notit),
 		notit->buf.sz, &btr_status);
@@ -542,10 +676,24 @@ end:
 static
 void put_event_dscopes(struct bt_ctf_notif_iter *notit)
 {
+	guint i;
+
+	/* Event fields saved in slots would keep them from being recycled */
+	for (i = 0; notit->field_slots.slots &&
+			i < notit->field_slots.slots->len; i++) {
+		struct field_slot *slot = g_ptr_array_index(
+			notit->field_slots.slots, i);
+
+		if (slot->root >= BT_CTF_SCOPE_STREAM_EVENT_HEADER) {
+			BT_PUT(slot->field);
+		}
+	}
+
 	BT_PUT(notit->dscopes.stream_event_header);
 	BT_PUT(notit->dscopes.stream_event_context);
 	BT_PUT(notit->dscopes.event_context);
 	BT_PUT(notit->dscopes.event_payload);
+	BT_PUT(notit->event);
 }
 
 static
@@ -607,10 +755,133 @@ bool is_variant_type(struct bt_ctf_field_type *field_type)
 			BT_CTF_TYPE_ID_VARIANT;
 }
 
+static
+void stream_class_field_path_cache_destroy(gpointer data)
+{
+	struct stream_class_field_path_cache *cache_entry = data;
+
+	if (cache_entry->v_options) {
+		g_array_free(cache_entry->v_options, TRUE);
+	}
+
+	if (cache_entry->event_classes) {
+		g_ptr_array_free(cache_entry->event_classes, TRUE);
+	}
+
+	g_free(cache_entry);
+}
+
+/* Returns the index of a structure type's field, -1 if not found. */
+static
+int get_struct_field_index(struct bt_ctf_field_type *struct_type,
+		const char *name)
+{
+	int i, count;
+
+	count = bt_ctf_field_type_structure_get_field_count(struct_type);
+	for (i = 0; i < count; i++) {
+		const char *field_name;
+
+		if (bt_ctf_field_type_structure_get_field(struct_type,
+				&field_name, NULL, i)) {
+			break;
+		}
+
+		if (!strcmp(field_name, name)) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+/*
+ * Finds the index of the id field in each option structure of the
+ * event header's v variant.
+ */
+static
+int init_v_options(GArray *v_options, struct bt_ctf_field_type *v_type)
+{
+	int i, count;
+
+	if (!is_variant_type(v_type)) {
+		return 0;
+	}
+
+	count = bt_ctf_field_type_variant_get_field_count(v_type);
+	if (count < 0) {
+		return -1;
+	}
+
+	for (i = 0; i < count; i++) {
+		struct v_option option = { .id = -1 };
+		struct bt_ctf_field_type *option_type;
+		int ret;
+
+		ret = bt_ctf_field_type_variant_get_field(v_type, NULL,
+			&option_type, i);
+		if (ret) {
+			return -1;
+		}
+
+		if (bt_ctf_field_type_is_structure(option_type)) {
+			option.id = get_struct_field_index(option_type, "id");
+		}
+
+		option.type = option_type;
+		bt_put(option_type);
+		g_array_append_val(v_options, option);
+	}
+
+	return 0;
+}
+
+/*
+ * Keeps the event classes of a stream class in an array indexed by ID,
+ * except for IDs above EVENT_CLASSES_MAX_DENSE_ID.
+ */
+static
+int init_event_classes(GPtrArray *event_classes,
+		struct bt_ctf_stream_class *stream_class)
+{
+	int i, count;
+
+	count = bt_ctf_stream_class_get_event_class_count(stream_class);
+	if (count < 0) {
+		return -1;
+	}
+
+	for (i = 0; i < count; i++) {
+		struct bt_ctf_event_class *event_class;
+		int64_t event_id;
+
+		event_class = bt_ctf_stream_class_get_event_class(stream_class,
+			i);
+		if (!event_class) {
+			return -1;
+		}
+
+		event_id = bt_ctf_event_class_get_id(event_class);
+		if (event_id < 0 || event_id > EVENT_CLASSES_MAX_DENSE_ID) {
+			bt_put(event_class);
+			continue;
+		}
+
+		if (event_id >= event_classes->len) {
+			g_ptr_array_set_size(event_classes, event_id + 1);
+		}
+
+		BT_MOVE(g_ptr_array_index(event_classes, event_id),
+			event_class);
+	}
+
+	return 0;
+}
+
 static
 struct stream_class_field_path_cache *
 create_stream_class_field_path_cache_entry(
-		struct bt_ctf_notif_iter *notit,
+		struct bt_ctf_notif_iter_decoder *decoder,
 		struct bt_ctf_stream_class *stream_class)
 {
 	int v = -1;
@@ -626,6 +897,22 @@ create_stream_class_field_path_cache_entry(
 		goto end;
 	}
 
+	cache_entry->v_options = g_array_new(FALSE, FALSE,
+			sizeof(struct v_option));
+	if (!cache_entry->v_options) {
+		goto error;
+	}
+
+	cache_entry->event_classes = g_ptr_array_new_with_free_func(
+			(GDestroyNotify) bt_put);
+	if (!cache_entry->event_classes) {
+		goto error;
+	}
+
+	if (init_event_classes(cache_entry->event_classes, stream_class)) {
+		goto error;
+	}
+
 	event_header = bt_ctf_stream_class_get_event_header_type(stream_class);
 	if (event_header && bt_ctf_field_type_is_structure(event_header)) {
 		int i, count;
@@ -638,21 +925,30 @@ create_stream_class_field_path_cache_entry(
 		for (i = 0; i < count; i++) {
 			int ret;
 			const char *name;
+			struct bt_ctf_field_type *field_type;
+
+			if (v != -1 && id != -1) {
+				break;
+			}
 
 			ret = bt_ctf_field_type_structure_get_field(
-					event_header, &name, NULL, i);
+					event_header, &name, &field_type, i);
 			if (ret) {
 				goto error;
 			}
 
-			if (v != -1 && id != -1) {
-				break;
-			}
 			if (v == -1 && !strcmp(name, "v")) {
+				ret = init_v_options(cache_entry->v_options,
+					field_type);
+				BT_PUT(field_type);
+				if (ret) {
+					goto error;
+				}
 				v = i;
 			} else if (id == -1 && !strcmp(name, "id")) {
 				id = i;
 			}
+			BT_PUT(field_type);
 		}
 	}
 
@@ -693,9 +989,7 @@ create_stream_class_field_path_cache_entry(
 				}
 
 				override->func = btr_timestamp_end_cb;
-				override->data = notit;
-
-				g_hash_table_insert(notit->field_overrides,
+				g_hash_table_insert(decoder->field_overrides,
 						bt_get(field_type), override);
 
 				timestamp_end = i;
@@ -720,7 +1014,9 @@ end:
 	BT_PUT(packet_context);
 	return cache_entry;
 error:
-	g_free(cache_entry);
+	if (cache_entry) {
+		stream_class_field_path_cache_destroy(cache_entry);
+	}
 	cache_entry = NULL;
 	goto end;
 }
@@ -730,20 +1026,8 @@ struct stream_class_field_path_cache *get_stream_class_field_path_cache(
 		struct bt_ctf_notif_iter *notit,
 		struct bt_ctf_stream_class *stream_class)
 {
-	bool cache_entry_found;
-	struct stream_class_field_path_cache *cache_entry;
-
-	cache_entry_found = g_hash_table_lookup_extended(
-			notit->sc_field_path_caches,
-			stream_class, NULL, (gpointer) &cache_entry);
-	if (unlikely(!cache_entry_found)) {
-		cache_entry = create_stream_class_field_path_cache_entry(notit,
-				stream_class);
-		g_hash_table_insert(notit->sc_field_path_caches,
-				bt_get(stream_class), (gpointer) cache_entry);
-	}
-
-	return cache_entry;
+	return g_hash_table_lookup(notit->decoder->sc_field_path_caches,
+			stream_class);
 }
 
 static inline
@@ -805,10 +1089,7 @@ enum bt_ctf_notif_iter_status set_current_stream_class(
 		goto end;
 	}
 
-	/*
-	 * Retrieve (or lazily create) the current stream class field path
-	 * cache.
-	 */
+	/* Retrieve the current stream class field path cache. */
 	notit->cur_sc_field_path_cache = get_stream_class_field_path_cache(
 			notit, notit->meta.stream_class);
 	if (!notit->cur_sc_field_path_cache) {
@@ -964,6 +1245,22 @@ enum bt_ctf_notif_iter_status read_event_header_begin_state(
 	}
 
 	put_event_dscopes(notit);
+
+	/* Decode into the last event's header field if it fits */
+	if (notit->spare_event_header) {
+		struct bt_ctf_field_type *spare_type =
+			bt_ctf_field_get_type(notit->spare_event_header);
+
+		if (spare_type == event_header_type) {
+			BT_MOVE(notit->dscopes.stream_event_header,
+				notit->spare_event_header);
+		} else {
+			BT_PUT(notit->spare_event_header);
+		}
+
+		bt_put(spare_type);
+	}
+
 	status = read_dscope_begin_state(notit, event_header_type,
 		STATE_AFTER_STREAM_EVENT_HEADER,
 		STATE_DSCOPE_STREAM_EVENT_HEADER_CONTINUE,
@@ -982,6 +1279,49 @@ enum bt_ctf_notif_iter_status read_event_header_continue_state(
 		STATE_AFTER_STREAM_EVENT_HEADER);
 }
 
+/* Returns the index of the id field in the selected v option, or -1. */
+static inline
+int get_v_option_id(struct stream_class_field_path_cache *cache,
+		struct bt_ctf_field *v_struct_field)
+{
+	struct bt_ctf_field_type *type = bt_ctf_field_get_type(v_struct_field);
+	int id = -1;
+	guint i;
+
+	for (i = 0; i < cache->v_options->len; i++) {
+		struct v_option *option = &g_array_index(cache->v_options,
+			struct v_option, i);
+
+		if (option->type == type) {
+			id = option->id;
+			break;
+		}
+	}
+
+	bt_put(type);
+	return id;
+}
+
+/* Returns the event class with the ID "event_id" of the current stream class. */
+static inline
+struct bt_ctf_event_class *get_event_class(struct bt_ctf_notif_iter *notit,
+		uint64_t event_id)
+{
+	GPtrArray *event_classes =
+		notit->cur_sc_field_path_cache->event_classes;
+	struct bt_ctf_event_class *event_class;
+
+	if (likely(event_id < event_classes->len)) {
+		event_class = g_ptr_array_index(event_classes, event_id);
+		if (likely(event_class)) {
+			return bt_get(event_class);
+		}
+	}
+
+	return bt_ctf_stream_class_get_event_class_by_id(
+		notit->meta.stream_class, event_id);
+}
+
 static inline
 enum bt_ctf_notif_iter_status set_current_event_class(struct bt_ctf_notif_iter *notit)
 {
@@ -992,28 +1332,15 @@ enum bt_ctf_notif_iter_status set_current_event_class(struct bt_ctf_notif_iter *
 	 */
 
 	enum bt_ctf_notif_iter_status status = BT_CTF_NOTIF_ITER_STATUS_OK;
-	struct bt_ctf_field_type *event_header_type;
-	struct bt_ctf_field_type *id_field_type = NULL;
-	struct bt_ctf_field_type *v_field_type = NULL;
+	struct stream_class_field_path_cache *cache =
+		notit->cur_sc_field_path_cache;
 	uint64_t event_id = -1ULL;
 	int ret;
 
-	event_header_type = bt_ctf_stream_class_get_event_header_type(
-		notit->meta.stream_class);
-	if (!event_header_type) {
-		PERR("Failed to retrieve stream class's event header type\n");
-		status = BT_CTF_NOTIF_ITER_STATUS_ERROR;
-		goto end;
-	}
-
 	/* Is there any "id"/"v" field in the event header? */
-	assert(is_struct_type(event_header_type));
-	id_field_type = bt_ctf_field_type_structure_get_field_type_by_name(
-		event_header_type, "id");
-	v_field_type = bt_ctf_field_type_structure_get_field_type_by_name(
-		event_header_type, "v");
+	assert(cache);
 	assert(notit->dscopes.stream_event_header);
-	if (v_field_type) {
+	if (cache->v != -1) {
 		/*
 		 *  _   _____ _____
 		 * | | |_   _|_   _| __   __ _
@@ -1025,10 +1352,10 @@ enum bt_ctf_notif_iter_status set_current_event_class(struct bt_ctf_notif_iter *
 		struct bt_ctf_field *v_field = NULL;
 		struct bt_ctf_field *v_struct_field = NULL;
 		struct bt_ctf_field *v_struct_id_field = NULL;
+		int v_struct_id;
 
-		// TODO: optimalize!
-		v_field = bt_ctf_field_structure_get_field(
-			notit->dscopes.stream_event_header, "v");
+		v_field = bt_ctf_field_structure_get_field_by_index(
+			notit->dscopes.stream_event_header, cache->v);
 		assert(v_field);
 
 		v_struct_field =
@@ -1037,9 +1364,13 @@ enum bt_ctf_notif_iter_status set_current_event_class(struct bt_ctf_notif_iter *
 			goto end_v_field_type;
 		}
 
-		// TODO: optimalize!
-		v_struct_id_field =
-			bt_ctf_field_structure_get_field(v_struct_field, "id");
+		v_struct_id = get_v_option_id(cache, v_struct_field);
+		if (v_struct_id == -1) {
+			goto end_v_field_type;
+		}
+
+		v_struct_id_field = bt_ctf_field_structure_get_field_by_index(
+			v_struct_field, v_struct_id);
 		if (!v_struct_id_field) {
 			goto end_v_field_type;
 		}
@@ -1056,14 +1387,12 @@ end_v_field_type:
 		BT_PUT(v_struct_id_field);
 	}
 
-	if (id_field_type && event_id == -1ULL) {
+	if (cache->id != -1 && event_id == -1ULL) {
 		/* Check "id" field */
 		struct bt_ctf_field *id_field = NULL;
-		int ret;
 
-		// TODO: optimalize!
-		id_field = bt_ctf_field_structure_get_field(
-			notit->dscopes.stream_event_header, "id");
+		id_field = bt_ctf_field_structure_get_field_by_index(
+			notit->dscopes.stream_event_header, cache->id);
 		assert(id_field);
 		assert(bt_ctf_field_is_integer(id_field) ||
 			bt_ctf_field_is_enumeration(id_field));
@@ -1093,8 +1422,7 @@ end_v_field_type:
 	}
 
 	BT_PUT(notit->meta.event_class);
-	notit->meta.event_class = bt_ctf_stream_class_get_event_class_by_id(
-		notit->meta.stream_class, event_id);
+	notit->meta.event_class = get_event_class(notit, event_id);
 	if (!notit->meta.event_class) {
 		PERR("Cannot find event class with ID %" PRIu64 "\n", event_id);
 		status = BT_CTF_NOTIF_ITER_STATUS_ERROR;
@@ -1102,9 +1430,54 @@ end_v_field_type:
 	}
 
 end:
-	BT_PUT(event_header_type);
-	BT_PUT(id_field_type);
-	BT_PUT(v_field_type);
+	return status;
+}
+
+static
+enum bt_ctf_notif_iter_status set_current_event(
+		struct bt_ctf_notif_iter *notit)
+{
+	int ret;
+	enum bt_ctf_notif_iter_status status = BT_CTF_NOTIF_ITER_STATUS_OK;
+	struct bt_ctf_field *header = NULL;
+
+	/* This is likely a recycled event with allocated fields. */
+	BT_PUT(notit->event);
+	notit->event = bt_ctf_event_create(notit->meta.event_class);
+	if (!notit->event) {
+		status = BT_CTF_NOTIF_ITER_STATUS_ERROR;
+		goto end;
+	}
+
+	/*
+	 * Swap the decoded header with the event's own header field,
+	 * which becomes the decoding target of the next event header.
+	 */
+	if (notit->dscopes.stream_event_header) {
+		header = bt_ctf_event_get_header(notit->event);
+		ret = bt_ctf_event_set_header(notit->event,
+			notit->dscopes.stream_event_header);
+		if (ret) {
+			status = BT_CTF_NOTIF_ITER_STATUS_ERROR;
+			goto end;
+		}
+
+		BT_MOVE(notit->spare_event_header, header);
+	}
+
+	/* Decode the remaining dynamic scopes into the event's fields */
+	BT_PUT(notit->dscopes.stream_event_context);
+	notit->dscopes.stream_event_context =
+		bt_ctf_event_get_stream_event_context(notit->event);
+	BT_PUT(notit->dscopes.event_context);
+	notit->dscopes.event_context =
+		bt_ctf_event_get_event_context(notit->event);
+	BT_PUT(notit->dscopes.event_payload);
+	notit->dscopes.event_payload =
+		bt_ctf_event_get_payload_field(notit->event);
+
+end:
+	BT_PUT(header);
 
 	return status;
 }
@@ -1121,6 +1494,12 @@ enum bt_ctf_notif_iter_status after_event_header_state(
 		goto end;
 	}
 
+	status = set_current_event(notit);
+	if (status != BT_CTF_NOTIF_ITER_STATUS_OK) {
+		PERR("Failed to create event\n");
+		goto end;
+	}
+
 	notit->state = STATE_DSCOPE_STREAM_EVENT_CONTEXT_BEGIN;
 
 end:
@@ -1333,7 +1712,7 @@ enum bt_ctf_notif_iter_status handle_state(struct bt_ctf_notif_iter *notit)
 /**
  * Resets the internal state of a CTF notification iterator.
  */
-static
+BT_HIDDEN
 void bt_ctf_notif_iter_reset(struct bt_ctf_notif_iter *notit)
 {
 	assert(notit);
@@ -1341,6 +1720,7 @@ void bt_ctf_notif_iter_reset(struct bt_ctf_notif_iter *notit)
 	BT_PUT(notit->meta.stream_class);
 	BT_PUT(notit->meta.event_class);
 	BT_PUT(notit->packet);
+	BT_PUT(notit->cur_timestamp_end);
 	put_all_dscopes(notit);
 	notit->buf.addr = NULL;
 	notit->buf.sz = 0;
@@ -1351,6 +1731,35 @@ void bt_ctf_notif_iter_reset(struct bt_ctf_notif_iter *notit)
 	notit->cur_packet_size = -1;
 }
 
+BT_HIDDEN
+int bt_ctf_notif_iter_set_clock_value(struct bt_ctf_notif_iter *notit,
+		struct bt_ctf_clock_class *clock_class, uint64_t value)
+{
+	int ret = 0;
+	uint64_t *clock_state;
+
+	assert(notit);
+	if (!g_hash_table_lookup_extended(notit->clock_states, clock_class,
+			NULL, (gpointer) &clock_state)) {
+		ret = -1;
+		goto end;
+	}
+
+	if (!clock_state) {
+		clock_state = g_new0(uint64_t, 1);
+		if (!clock_state) {
+			ret = -1;
+			goto end;
+		}
+		g_hash_table_insert(notit->clock_states, bt_get(clock_class),
+				clock_state);
+	}
+
+	*clock_state = value;
+end:
+	return ret;
+}
+
 static
 int bt_ctf_notif_iter_switch_packet(struct bt_ctf_notif_iter *notit)
 {
@@ -1531,6 +1940,55 @@ end_no_clock:
 	return ret;
 }
 
+/* Whether the field being decoded is at the position of a slot. */
+static inline
+bool slot_is_at_current_field(struct bt_ctf_notif_iter *notit,
+		struct field_slot *slot)
+{
+	guint i;
+
+	if (slot->root != notit->cur_scope ||
+			slot->indexes->len != stack_size(notit->stack)) {
+		return false;
+	}
+
+	for (i = 0; i < slot->indexes->len; i++) {
+		struct stack_entry *entry =
+			g_ptr_array_index(notit->stack->entries, i);
+
+		if (entry->index != g_array_index(slot->indexes, int, i)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/* Saves an integer or enumeration field in the slots at its position. */
+static inline
+void save_slot_field(struct bt_ctf_notif_iter *notit,
+		struct bt_ctf_field_type *type, struct bt_ctf_field *field)
+{
+	GArray *slot_indexes;
+	guint i;
+
+	slot_indexes = g_hash_table_lookup(notit->field_slots.targets, type);
+	if (!slot_indexes) {
+		return;
+	}
+
+	for (i = 0; i < slot_indexes->len; i++) {
+		struct field_slot *slot = g_ptr_array_index(
+			notit->field_slots.slots,
+			g_array_index(slot_indexes, guint, i));
+
+		if (slot_is_at_current_field(notit, slot)) {
+			BT_PUT(slot->field);
+			slot->field = bt_get(field);
+		}
+	}
+}
+
 static
 enum bt_ctf_btr_status btr_unsigned_int_common(uint64_t value,
 		struct bt_ctf_field_type *type, void *data,
@@ -1550,6 +2008,8 @@ enum bt_ctf_btr_status btr_unsigned_int_common(uint64_t value,
 		goto end_no_put;
 	}
 
+	save_slot_field(notit, type, field);
+
 	switch(bt_ctf_field_type_get_type_id(type)) {
 	case BT_CTF_TYPE_ID_INTEGER:
 		/* Integer field is created field */
@@ -1609,10 +2069,10 @@ enum bt_ctf_btr_status btr_unsigned_int_cb(uint64_t value,
 	struct bt_ctf_field *field = NULL;
 	struct field_cb_override *override;
 
-	override = g_hash_table_lookup(notit->field_overrides,
+	override = g_hash_table_lookup(notit->decoder->field_overrides,
 			type);
 	if (unlikely(override)) {
-		status = override->func(&value, type, override->data);
+		status = override->func(&value, type, notit);
 		goto end;
 	}
 
@@ -1645,6 +2105,8 @@ enum bt_ctf_btr_status btr_signed_int_cb(int64_t value,
 		goto end_no_put;
 	}
 
+	save_slot_field(notit, type, field);
+
 	switch(bt_ctf_field_type_get_type_id(type)) {
 	case BT_CTF_TYPE_ID_INTEGER:
 		/* Integer field is created field */
@@ -1803,9 +2265,13 @@ enum bt_ctf_btr_status btr_compound_begin_cb(
 
 	/* Create field */
 	if (stack_empty(notit->stack)) {
-		/* Root: create dynamic scope field */
-		*notit->cur_dscope_field = bt_ctf_field_create(type);
-		field = *notit->cur_dscope_field;
+		/*
+		 * Root: create dynamic scope field, unless a (recycled)
+		 * field to decode into is already provided.
+		 */
+		if (!*notit->cur_dscope_field) {
+			*notit->cur_dscope_field = bt_ctf_field_create(type);
+		}
 
 		/*
 		 * Field will be put at the end of this function
@@ -1813,7 +2279,7 @@ enum bt_ctf_btr_status btr_compound_begin_cb(
 		 * reference is lost upon the equivalent stack_pop()
 		 * later), so also get it for our context to own it.
 		 */
-		bt_get(*notit->cur_dscope_field);
+		field = bt_get(*notit->cur_dscope_field);
 	} else {
 		field = get_next_field(notit);
 	}
@@ -1856,9 +2322,13 @@ enum bt_ctf_btr_status btr_compound_end_cb(
 	return BT_CTF_BTR_STATUS_OK;
 }
 
+/*
+ * Looks up the field at "path" from its scope root. "through_variant",
+ * if not NULL, is set if a variant was crossed to reach it.
+ */
 static
 struct bt_ctf_field *resolve_field(struct bt_ctf_notif_iter *notit,
-		struct bt_ctf_field_path *path)
+		struct bt_ctf_field_path *path, bool *through_variant)
 {
 	struct bt_ctf_field *field = NULL;
 	unsigned int i;
@@ -1909,6 +2379,9 @@ struct bt_ctf_field *resolve_field(struct bt_ctf_notif_iter *notit,
 		} else if (is_variant_type(field_type)) {
 			next_field =
 				bt_ctf_field_variant_get_current_field(field);
+			if (through_variant) {
+				*through_variant = true;
+			}
 		}
 
 		BT_PUT(field);
@@ -1926,22 +2399,170 @@ end:
 	return field;
 }
 
+static
+struct field_slot *get_slot(struct bt_ctf_notif_iter *notit,
+		struct bt_ctf_field_path *path)
+{
+	struct field_slot *slot;
+	int i, count = bt_ctf_field_path_get_index_count(path);
+	guint slot_index;
+
+	for (slot_index = 0; slot_index < notit->field_slots.slots->len;
+			slot_index++) {
+		slot = g_ptr_array_index(notit->field_slots.slots, slot_index);
+		if (slot->root != bt_ctf_field_path_get_root_scope(path) ||
+				slot->indexes->len != count) {
+			continue;
+		}
+
+		for (i = 0; i < count; i++) {
+			if (g_array_index(slot->indexes, int, i) !=
+					bt_ctf_field_path_get_index(path, i)) {
+				break;
+			}
+		}
+
+		if (i == count) {
+			return slot;
+		}
+	}
+
+	slot = g_new0(struct field_slot, 1);
+	if (!slot) {
+		goto end;
+	}
+
+	slot->root = bt_ctf_field_path_get_root_scope(path);
+	slot->indexes = g_array_sized_new(FALSE, FALSE, sizeof(int), count);
+	if (!slot->indexes) {
+		g_free(slot);
+		slot = NULL;
+		goto end;
+	}
+
+	for (i = 0; i < count; i++) {
+		int index = bt_ctf_field_path_get_index(path, i);
+
+		g_array_append_val(slot->indexes, index);
+	}
+
+	g_ptr_array_add(notit->field_slots.slots, slot);
+end:
+	return slot;
+}
+
+/*
+ * Makes the field which the length or tag of "user_type" refers to,
+ * just looked up as "field", saved in a slot when it is decoded. It is
+ * left to be looked up each time if a variant leads to it, since a
+ * slot only matches structure field indexes.
+ */
+static
+void add_slot_user(struct bt_ctf_notif_iter *notit,
+		struct bt_ctf_field_type *user_type,
+		struct bt_ctf_field_path *path, struct bt_ctf_field *field,
+		bool through_variant)
+{
+	struct field_slot *slot = NULL;
+	struct bt_ctf_field_type *type = NULL;
+	GArray *slot_indexes;
+	guint slot_index, i;
+
+	if (!through_variant) {
+		slot = get_slot(notit, path);
+	}
+
+	if (!slot) {
+		g_hash_table_insert(notit->field_slots.users,
+			bt_get(user_type), GUINT_TO_POINTER(0));
+		goto end;
+	}
+
+	BT_PUT(slot->field);
+	slot->field = bt_get(field);
+	for (slot_index = 0; g_ptr_array_index(notit->field_slots.slots,
+			slot_index) != slot; slot_index++) {
+	}
+
+	type = bt_ctf_field_get_type(field);
+	slot_indexes = g_hash_table_lookup(notit->field_slots.targets, type);
+	if (!slot_indexes) {
+		slot_indexes = g_array_new(FALSE, FALSE, sizeof(guint));
+		g_hash_table_insert(notit->field_slots.targets, bt_get(type),
+			slot_indexes);
+	}
+
+	for (i = 0; i < slot_indexes->len; i++) {
+		if (g_array_index(slot_indexes, guint, i) == slot_index) {
+			break;
+		}
+	}
+
+	if (i == slot_indexes->len) {
+		g_array_append_val(slot_indexes, slot_index);
+	}
+
+	g_hash_table_insert(notit->field_slots.users, bt_get(user_type),
+		GUINT_TO_POINTER(slot_index + 1));
+end:
+	bt_put(type);
+}
+
+/*
+ * Returns the field which the length of a sequence type or the tag of
+ * a variant type refers to: the one saved in its slot, or the one
+ * looked up from its scope root until its slot is filled.
+ */
+static
+struct bt_ctf_field *get_referred_field(struct bt_ctf_notif_iter *notit,
+		struct bt_ctf_field_type *user_type)
+{
+	gpointer value;
+	struct bt_ctf_field *field;
+	struct bt_ctf_field_path *path;
+	bool known, through_variant = false;
+
+	known = g_hash_table_lookup_extended(notit->field_slots.users,
+		user_type, NULL, &value);
+	if (likely(known && value)) {
+		struct field_slot *slot = g_ptr_array_index(
+			notit->field_slots.slots, GPOINTER_TO_UINT(value) - 1);
+
+		if (likely(slot->field)) {
+			return bt_get(slot->field);
+		}
+	}
+
+	if (bt_ctf_field_type_is_sequence(user_type)) {
+		path = bt_ctf_field_type_sequence_get_length_field_path(
+			user_type);
+	} else {
+		path = bt_ctf_field_type_variant_get_tag_field_path(user_type);
+	}
+
+	if (!path) {
+		return NULL;
+	}
+
+	field = resolve_field(notit, path, &through_variant);
+	if (field && !known) {
+		add_slot_user(notit, user_type, path, field, through_variant);
+	}
+
+	bt_put(path);
+	return field;
+}
+
 static
 int64_t btr_get_sequence_length_cb(struct bt_ctf_field_type *type, void *data)
 {
 	int64_t ret = -1;
 	int iret;
-	struct bt_ctf_field_path *field_path;
 	struct bt_ctf_notif_iter *notit = data;
 	struct bt_ctf_field *length_field = NULL;
 	uint64_t length;
 
-	field_path = bt_ctf_field_type_sequence_get_length_field_path(type);
-	if (!field_path) {
-		goto end;
-	}
-
-	length_field = resolve_field(notit, field_path);
+	length_field = get_referred_field(notit, type);
 	if (!length_field) {
 		goto end;
 	}
@@ -1960,7 +2581,6 @@ int64_t btr_get_sequence_length_cb(struct bt_ctf_field_type *type, void *data)
 
 end:
 	BT_PUT(length_field);
-	BT_PUT(field_path);
 
 	return ret;
 }
@@ -1969,18 +2589,12 @@ static
 struct bt_ctf_field_type *btr_get_variant_type_cb(
 		struct bt_ctf_field_type *type, void *data)
 {
-	struct bt_ctf_field_path *path;
 	struct bt_ctf_notif_iter *notit = data;
 	struct bt_ctf_field *tag_field = NULL;
 	struct bt_ctf_field *selected_field = NULL;
 	struct bt_ctf_field_type *selected_field_type = NULL;
 
-	path = bt_ctf_field_type_variant_get_tag_field_path(type);
-	if (!path) {
-		goto end;
-	}
-
-	tag_field = resolve_field(notit, path);
+	tag_field = get_referred_field(notit, type);
 	if (!tag_field) {
 		goto end;
 	}
@@ -2008,7 +2622,6 @@ struct bt_ctf_field_type *btr_get_variant_type_cb(
 end:
 	BT_PUT(tag_field);
 	BT_PUT(selected_field);
-	BT_PUT(path);
 
 	return selected_field_type;
 }
@@ -2023,6 +2636,7 @@ int set_event_clocks(struct bt_ctf_event *event,
 	uint64_t *clock_state;
 
 	g_hash_table_iter_init(&iter, notit->clock_states);
+	notit->cur_sort_ts.is_set = false;
 
 	while (g_hash_table_iter_next(&iter, (gpointer) &clock_class,
 		        (gpointer) &clock_state)) {
@@ -2034,6 +2648,13 @@ int set_event_clocks(struct bt_ctf_event *event,
 			ret = -1;
 			goto end;
 		}
+
+		if (clock_class == notit->sort_clock_class) {
+			notit->cur_sort_ts.is_set =
+				!bt_ctf_clock_value_get_value_ns_from_epoch(
+					clock_value, &notit->cur_sort_ts.value);
+		}
+
 		ret = bt_ctf_event_set_clock_value(event, clock_value);
 		bt_put(clock_value);
 		if (ret) {
@@ -2051,37 +2672,16 @@ struct bt_ctf_event *create_event(struct bt_ctf_notif_iter *notit)
 	int ret;
 	struct bt_ctf_event *event;
 
-	/* Create event object. */
-	event = bt_ctf_event_create(notit->meta.event_class);
+	/*
+	 * The event's fields were decoded in place; it only needs its
+	 * clock values and packet now.
+	 */
+	event = notit->event;
+	notit->event = NULL;
 	if (!event) {
 		goto error;
 	}
 
-	/* Set header, stream event context, context, and payload fields. */
-	ret = bt_ctf_event_set_header(event,
-		notit->dscopes.stream_event_header);
-	if (ret) {
-		goto error;
-	}
-
-	ret = bt_ctf_event_set_stream_event_context(event,
-		notit->dscopes.stream_event_context);
-	if (ret) {
-		goto error;
-	}
-
-	ret = bt_ctf_event_set_event_context(event,
-		notit->dscopes.event_context);
-	if (ret) {
-		goto error;
-	}
-
-	ret = bt_ctf_event_set_payload_field(event,
-		notit->dscopes.event_payload);
-	if (ret) {
-		goto error;
-	}
-
 	ret = set_event_clocks(event, notit);
 	if (ret) {
 		goto error;
@@ -2191,6 +2791,12 @@ void notify_event(struct bt_ctf_notif_iter *notit,
 
 	/* Create event */
 	event = create_event(notit);
+
+	/*
+	 * Drop our references to the event's fields so that it can be
+	 * recycled as soon as the user releases it.
+	 */
+	put_event_dscopes(notit);
 	if (!event) {
 		goto end;
 	}
@@ -2199,6 +2805,15 @@ void notify_event(struct bt_ctf_notif_iter *notit,
 	if (!ret) {
 		goto end;
 	}
+
+	/*
+	 * Cache the event's timestamp within the notification so that
+	 * consumers don't have to look it up every time they order it.
+	 */
+	if (notit->cur_sort_ts.is_set) {
+		(void) bt_notification_set_sort_key(ret,
+			notit->cur_sort_ts.value, 0);
+	}
 	*notification = ret;
 end:
 	BT_PUT(event);
@@ -2301,14 +2916,107 @@ end:
 	BT_PUT(packet_header);
 }
 
+static
+int init_sc_field_path_caches(struct bt_ctf_notif_iter_decoder *decoder)
+{
+	int i, count;
+
+	count = bt_ctf_trace_get_stream_class_count(decoder->trace);
+	if (count < 0) {
+		return -1;
+	}
+
+	for (i = 0; i < count; i++) {
+		struct stream_class_field_path_cache *cache_entry;
+		struct bt_ctf_stream_class *stream_class =
+			bt_ctf_trace_get_stream_class(decoder->trace, i);
+
+		if (!stream_class) {
+			return -1;
+		}
+
+		cache_entry = create_stream_class_field_path_cache_entry(
+				decoder, stream_class);
+		if (!cache_entry) {
+			bt_put(stream_class);
+			return -1;
+		}
+
+		g_hash_table_insert(decoder->sc_field_path_caches,
+				stream_class, cache_entry);
+	}
+
+	return 0;
+}
+
+BT_HIDDEN
+struct bt_ctf_notif_iter_decoder *bt_ctf_notif_iter_decoder_create(
+		struct bt_ctf_trace *trace)
+{
+	struct bt_ctf_notif_iter_decoder *decoder;
+
+	assert(trace);
+	decoder = g_new0(struct bt_ctf_notif_iter_decoder, 1);
+	if (!decoder) {
+		goto end;
+	}
+
+	decoder->trace = bt_get(trace);
+	init_trace_field_path_cache(trace, &decoder->trace_field_path_cache);
+	decoder->sc_field_path_caches = g_hash_table_new_full(g_direct_hash,
+			g_direct_equal, bt_put, stream_class_field_path_cache_destroy);
+	if (!decoder->sc_field_path_caches) {
+		goto error;
+	}
+
+	decoder->field_overrides = g_hash_table_new_full(g_direct_hash,
+			g_direct_equal, bt_put, g_free);
+	if (!decoder->field_overrides) {
+		goto error;
+	}
+
+	if (init_sc_field_path_caches(decoder)) {
+		goto error;
+	}
+
+end:
+	return decoder;
+error:
+	bt_ctf_notif_iter_decoder_destroy(decoder);
+	decoder = NULL;
+	goto end;
+}
+
+BT_HIDDEN
+void bt_ctf_notif_iter_decoder_destroy(
+		struct bt_ctf_notif_iter_decoder *decoder)
+{
+	if (!decoder) {
+		return;
+	}
+
+	BT_PUT(decoder->trace);
+
+	if (decoder->sc_field_path_caches) {
+		g_hash_table_destroy(decoder->sc_field_path_caches);
+	}
+
+	if (decoder->field_overrides) {
+		g_hash_table_destroy(decoder->field_overrides);
+	}
+	g_free(decoder);
+}
+
 BT_HIDDEN
-struct bt_ctf_notif_iter *bt_ctf_notif_iter_create(struct bt_ctf_trace *trace,
+struct bt_ctf_notif_iter *bt_ctf_notif_iter_create(
+		struct bt_ctf_notif_iter_decoder *decoder,
 		size_t max_request_sz,
 		struct bt_ctf_notif_iter_medium_ops medops,
 		void *data, FILE *err_stream)
 {
 	int ret;
 	struct bt_ctf_notif_iter *notit = NULL;
+	struct bt_ctf_trace *trace = decoder->trace;
 	struct bt_ctf_btr_cbs cbs = {
 		.types = {
 			.signed_int = btr_signed_int_cb,
@@ -2344,7 +3052,9 @@ struct bt_ctf_notif_iter *bt_ctf_notif_iter_create(struct bt_ctf_trace *trace,
 		PERR("Failed to initialize stream clock states\n");
 		goto error;
 	}
+	notit->sort_clock_class = bt_ctf_trace_get_clock_class(trace, 0);
 	notit->meta.trace = bt_get(trace);
+	notit->decoder = decoder;
 	notit->medium.medops = medops;
 	notit->medium.max_request_sz = max_request_sz;
 	notit->medium.data = data;
@@ -2363,17 +3073,21 @@ struct bt_ctf_notif_iter *bt_ctf_notif_iter_create(struct bt_ctf_trace *trace,
 
 	bt_ctf_notif_iter_reset(notit);
 
-	init_trace_field_path_cache(trace, &notit->trace_field_path_cache);
-	notit->sc_field_path_caches = g_hash_table_new_full(g_direct_hash,
-			g_direct_equal, bt_put, g_free);
-	if (!notit->sc_field_path_caches) {
-		PERR("Failed to create stream class field path caches\n");
+	notit->field_slots.slots =
+		g_ptr_array_new_with_free_func(field_slot_free_func);
+	if (!notit->field_slots.slots) {
 		goto error;
 	}
 
-	notit->field_overrides = g_hash_table_new_full(g_direct_hash,
-			g_direct_equal, bt_put, g_free);
-	if (!notit->field_overrides) {
+	notit->field_slots.users = g_hash_table_new_full(g_direct_hash,
+			g_direct_equal, bt_put, NULL);
+	if (!notit->field_slots.users) {
+		goto error;
+	}
+
+	notit->field_slots.targets = g_hash_table_new_full(g_direct_hash,
+			g_direct_equal, bt_put, slot_indexes_free_func);
+	if (!notit->field_slots.targets) {
 		goto error;
 	}
 
@@ -2392,6 +3106,8 @@ void bt_ctf_notif_iter_destroy(struct bt_ctf_notif_iter *notit)
 	BT_PUT(notit->meta.event_class);
 	BT_PUT(notit->packet);
 	BT_PUT(notit->cur_timestamp_end);
+	BT_PUT(notit->spare_event_header);
+	BT_PUT(notit->sort_clock_class);
 	put_all_dscopes(notit);
 
 	if (notit->stack) {
@@ -2406,12 +3122,16 @@ void bt_ctf_notif_iter_destroy(struct bt_ctf_notif_iter *notit)
 		g_hash_table_destroy(notit->clock_states);
 	}
 
-	if (notit->sc_field_path_caches) {
-		g_hash_table_destroy(notit->sc_field_path_caches);
+	if (notit->field_slots.users) {
+		g_hash_table_destroy(notit->field_slots.users);
 	}
 
-	if (notit->field_overrides) {
-		g_hash_table_destroy(notit->field_overrides);
+	if (notit->field_slots.targets) {
+		g_hash_table_destroy(notit->field_slots.targets);
+	}
+
+	if (notit->field_slots.slots) {
+		g_ptr_array_free(notit->field_slots.slots, TRUE);
 	}
 	g_free(notit);
 }
@@ -2484,3 +3204,58 @@ enum bt_ctf_notif_iter_status bt_ctf_notif_iter_get_next_notification(
 end:
 	return status;
 }
+
+enum bt_ctf_notif_iter_status bt_ctf_notif_iter_get_packet_header_context_fields(
+		struct bt_ctf_notif_iter *notit,
+		struct bt_ctf_field **packet_header_field,
+		struct bt_ctf_field **packet_context_field)
+{
+	enum bt_ctf_notif_iter_status status = BT_CTF_NOTIF_ITER_STATUS_OK;
+
+	assert(notit);
+	assert(packet_header_field);
+	assert(packet_context_field);
+
+	while (true) {
+		switch (notit->state) {
+		case STATE_EMIT_NOTIF_NEW_PACKET:
+			/* Packet header and context are decoded. */
+			goto set_fields;
+		case STATE_INIT:
+		case STATE_DSCOPE_TRACE_PACKET_HEADER_BEGIN:
+		case STATE_DSCOPE_TRACE_PACKET_HEADER_CONTINUE:
+		case STATE_AFTER_TRACE_PACKET_HEADER:
+		case STATE_DSCOPE_STREAM_PACKET_CONTEXT_BEGIN:
+		case STATE_DSCOPE_STREAM_PACKET_CONTEXT_CONTINUE:
+		case STATE_AFTER_STREAM_PACKET_CONTEXT:
+			break;
+		default:
+			PERR("Packet header and context are not available after the packet's first event\n");
+			status = BT_CTF_NOTIF_ITER_STATUS_ERROR;
+			goto end;
+		}
+
+		status = handle_state(notit);
+		if (status != BT_CTF_NOTIF_ITER_STATUS_OK) {
+			if (status != BT_CTF_NOTIF_ITER_STATUS_EOF) {
+				PERR("Failed to handle state:\n");
+				PERR("\tState: %d\n", notit->state);
+			}
+			goto end;
+		}
+	}
+
+set_fields:
+	*packet_header_field = bt_get(notit->dscopes.trace_packet_header);
+	*packet_context_field = bt_get(notit->dscopes.stream_packet_context);
+end:
+	return status;
+}
+
+BT_HIDDEN
+uint64_t bt_ctf_notif_iter_get_packet_data_offset(
+		struct bt_ctf_notif_iter *notit)
+{
+	assert(notit);
+	return packet_at(notit);
+}
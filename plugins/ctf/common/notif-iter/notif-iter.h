@@ -32,6 +32,7 @@
 #include <babeltrace/ctf-ir/trace.h>
 #include <babeltrace/ctf-ir/fields.h>
 #include <babeltrace/ctf-ir/event.h>
+#include <babeltrace/ctf-ir/clock-class.h>
 #include <babeltrace/babeltrace-internal.h>
 
 /**
@@ -200,6 +201,12 @@ struct bt_ctf_notif_iter_medium_ops {
 /** CTF notification iterator. */
 struct bt_ctf_notif_iter;
 
+/**
+ * Decoding tables of a trace, shared by all its CTF notification
+ * iterators.
+ */
+struct bt_ctf_notif_iter_decoder;
+
 // TODO: Replace by the real thing
 enum bt_ctf_notif_iter_notif_type {
 	BT_CTF_NOTIF_ITER_NOTIF_NEW_PACKET,
@@ -227,12 +234,44 @@ struct bt_ctf_notif_iter_notif_event {
 };
 
 /**
- * Creates a CTF notification iterator.
+ * Creates the decoding tables of a trace.
+ *
+ * The tables are built from the trace's stream classes at creation
+ * time and only read afterwards: they can be shared by CTF
+ * notification iterators running on different threads. Stream classes
+ * added to \p trace afterwards are not known to the decoder.
  *
  * Upon successful completion, the reference count of \p trace is
  * incremented.
  *
  * @param trace			Trace to read
+ * @returns			New decoder on success, or \c NULL on
+ *				error
+ */
+BT_HIDDEN
+struct bt_ctf_notif_iter_decoder *bt_ctf_notif_iter_decoder_create(
+	struct bt_ctf_trace *trace);
+
+/**
+ * Destroys decoding tables, which must not be used by CTF notification
+ * iterators anymore.
+ *
+ * The trace's reference count is decremented.
+ *
+ * @param decoder		Decoder
+ */
+BT_HIDDEN
+void bt_ctf_notif_iter_decoder_destroy(
+	struct bt_ctf_notif_iter_decoder *decoder);
+
+/**
+ * Creates a CTF notification iterator.
+ *
+ * Upon successful completion, the reference count of the decoder's
+ * trace is incremented.
+ *
+ * @param decoder		Decoding tables of the trace to read
+ *				(weak: must outlive the iterator)
  * @param max_request_sz	Maximum buffer size, in bytes, to
  *				request to
  *				bt_ctf_notif_iter_medium_ops::request_bytes()
@@ -244,8 +283,8 @@ struct bt_ctf_notif_iter_notif_event {
  *				success, or \c NULL on error
  */
 BT_HIDDEN
-struct bt_ctf_notif_iter *bt_ctf_notif_iter_create(struct bt_ctf_trace *trace,
-	size_t max_request_sz, struct bt_ctf_notif_iter_medium_ops medops,
+struct bt_ctf_notif_iter *bt_ctf_notif_iter_create(
+	struct bt_ctf_notif_iter_decoder *decoder, size_t max_request_sz, struct bt_ctf_notif_iter_medium_ops medops,
 	void *medops_data, FILE *err_stream);
 
 /**
@@ -280,4 +319,67 @@ enum bt_ctf_notif_iter_status bt_ctf_notif_iter_get_next_notification(
 		struct bt_ctf_notif_iter *notit,
 		struct bt_notification **notification);
 
+/**
+ * Resets a CTF notification iterator so that it decodes a new packet
+ * from its medium's current position.
+ *
+ * The medium must be positioned at the beginning of a packet before
+ * the next call to bt_ctf_notif_iter_get_next_notification() or
+ * bt_ctf_notif_iter_get_packet_header_context_fields().
+ *
+ * @param notif_iter		CTF notification iterator
+ */
+BT_HIDDEN
+void bt_ctf_notif_iter_reset(struct bt_ctf_notif_iter *notit);
+
+/**
+ * Sets the current value of one of the trace's clocks, from which the
+ * next clock fields are decoded, typically before decoding a packet
+ * without having decoded the ones which precede it.
+ *
+ * @param notif_iter		CTF notification iterator
+ * @param clock_class		Clock class of the trace
+ * @param value			Clock value (cycles)
+ * @returns			0 on success, or a negative value if
+ *				\p clock_class is not a clock class of
+ *				the trace
+ */
+BT_HIDDEN
+int bt_ctf_notif_iter_set_clock_value(struct bt_ctf_notif_iter *notit,
+		struct bt_ctf_clock_class *clock_class, uint64_t value);
+
+/**
+ * Decodes the current packet's header and context, without decoding
+ * any of its events, and returns the resulting fields.
+ *
+ * This function may only be called before the current packet's first
+ * event is decoded. Upon successful completion, the caller is
+ * responsible for calling bt_put() on the returned fields, which are
+ * set to \c NULL if the packet has no such scope.
+ *
+ * @param notif_iter		CTF notification iterator
+ * @param packet_header_field	Returned packet header field
+ * @param packet_context_field	Returned packet context field
+ * @returns			One of #bt_ctf_notif_iter_status values
+ */
+BT_HIDDEN
+enum bt_ctf_notif_iter_status bt_ctf_notif_iter_get_packet_header_context_fields(
+		struct bt_ctf_notif_iter *notit,
+		struct bt_ctf_field **packet_header_field,
+		struct bt_ctf_field **packet_context_field);
+
+/**
+ * Returns the offset, in bits from the beginning of the current packet,
+ * of the end of its context, where its events begin.
+ *
+ * This function may only be called right after the current packet's
+ * beginning notification is returned.
+ *
+ * @param notif_iter		CTF notification iterator
+ * @returns			Offset of the packet's events (bits)
+ */
+BT_HIDDEN
+uint64_t bt_ctf_notif_iter_get_packet_data_offset(
+		struct bt_ctf_notif_iter *notit);
+
 #endif /* CTF_NOTIF_ITER_H */
@@ -28,7 +28,14 @@
 #include <stdbool.h>
 #include <glib.h>
 #include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
 #include <sys/mman.h>
+#include <babeltrace/endian.h>
+#include <babeltrace/ctf-ir/fields.h>
+#include <babeltrace/ctf-ir/clock-class.h>
+#include <babeltrace/ctf-ir/trace.h>
 #include <babeltrace/ctf-ir/stream.h>
 #include <babeltrace/component/notification/iterator.h>
 #include "file.h"
@@ -53,6 +60,11 @@ int stream_munmap(struct ctf_fs_stream *stream)
 	int ret = 0;
 	struct ctf_fs_component *ctf_fs = stream->file->ctf_fs;
 
+	if (ctf_fs->options.io_backend == CTF_FS_IO_BACKEND_READ) {
+		/* The buffer is reused by the next window. */
+		goto end;
+	}
+
 	if (munmap(stream->mmap_addr, stream->mmap_len)) {
 		PERR("Cannot memory-unmap address %p (size %zu) of file \"%s\" (%p): %s\n",
 			stream->mmap_addr, stream->mmap_len,
@@ -65,37 +77,129 @@ end:
 	return ret;
 }
 
+/*
+ * Maximum length of a stream's mapping: its share of the component's
+ * mapping budget, within [1, 2048] pages.
+ */
+static
+size_t get_mmap_max_len(struct ctf_fs_component *ctf_fs)
+{
+	unsigned int stream_count = __atomic_load_n(&ctf_fs->files.stream_count,
+			__ATOMIC_RELAXED);
+	size_t len = ctf_fs->options.max_mapped_size / MAX(stream_count, 1);
+
+	len &= ~(ctf_fs->page_size - 1);
+	return MIN(MAX(len, ctf_fs->page_size), ctf_fs->page_size * 2048);
+}
+
+/*
+ * Length of the next window, from the current mapping offset: up to
+ * the end of the last indexed packet which fits in "mmap_max_len", so
+ * that the next window, which is read ahead, starts with a packet.
+ */
+static
+size_t get_window_len(struct ctf_fs_stream *stream)
+{
+	GArray *entries = stream->parent ? stream->parent->index.entries :
+			stream->index.entries;
+	off_t max_end = MIN(stream->end_offset,
+			stream->mmap_offset + (off_t) stream->mmap_max_len);
+	off_t min_end = stream->mmap_offset + stream->request_offset;
+	size_t low = 0, high;
+
+	if (!entries || max_end == stream->end_offset) {
+		goto end;
+	}
+
+	/* Number of packets ending in the window. */
+	high = entries->len;
+	while (low < high) {
+		size_t mid = low + (high - low) / 2;
+		struct index_entry *entry = &g_array_index(entries,
+				struct index_entry, mid);
+
+		if (entry->offset + entry->packet_size <= max_end) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	if (low > 0) {
+		struct index_entry *entry = &g_array_index(entries,
+				struct index_entry, low - 1);
+		off_t packet_end = entry->offset + entry->packet_size;
+
+		if (packet_end > min_end) {
+			return packet_end - stream->mmap_offset;
+		}
+	}
+end:
+	return max_end - stream->mmap_offset;
+}
+
+static
+int read_window(struct ctf_fs_stream *stream, size_t readahead_len)
+{
+	if (stream->read_buf_size < stream->mmap_valid_len) {
+		g_free(stream->read_buf);
+		stream->read_buf = g_malloc(stream->mmap_valid_len);
+		stream->read_buf_size = stream->mmap_valid_len;
+	}
+
+	stream->mmap_addr = stream->read_buf;
+	return ctf_fs_file_pread(stream->file, stream->read_buf,
+			stream->mmap_valid_len, stream->mmap_offset,
+			readahead_len);
+}
+
 static
 enum bt_ctf_notif_iter_medium_status mmap_next(struct ctf_fs_stream *stream)
 {
 	enum bt_ctf_notif_iter_medium_status ret =
 			BT_CTF_NOTIF_ITER_MEDIUM_STATUS_OK;
 	struct ctf_fs_component *ctf_fs = stream->file->ctf_fs;
+	size_t readahead_len;
 
 	/* Unmap old region */
 	if (stream->mmap_addr) {
+		off_t next_offset = stream->mmap_offset +
+				stream->mmap_valid_len;
+
 		if (stream_munmap(stream)) {
 			goto error;
 		}
 
-		stream->mmap_offset += stream->mmap_valid_len;
-		stream->request_offset = 0;
+		/* Windows may end within a page, at a packet's end. */
+		stream->mmap_offset = next_offset &
+				~((off_t) ctf_fs->page_size - 1);
+		stream->request_offset = next_offset - stream->mmap_offset;
 	}
 
-	stream->mmap_valid_len = MIN(stream->file->size - stream->mmap_offset,
-			stream->mmap_max_len);
-	if (stream->mmap_valid_len == 0) {
+	stream->mmap_max_len = get_mmap_max_len(ctf_fs);
+	stream->mmap_valid_len = get_window_len(stream);
+	if (stream->mmap_valid_len <= stream->request_offset) {
+		/* Already unmapped. */
+		stream->mmap_addr = NULL;
 		ret = BT_CTF_NOTIF_ITER_MEDIUM_STATUS_EOF;
 		goto end;
 	}
 	/* Round up to next page, assuming page size being a power of 2. */
 	stream->mmap_len = (stream->mmap_valid_len + ctf_fs->page_size - 1)
 			& ~(ctf_fs->page_size - 1);
-	/* Map new region */
+	readahead_len = MIN(stream->end_offset - stream->mmap_offset -
+			stream->mmap_valid_len, stream->mmap_max_len);
 	assert(stream->mmap_len);
-	stream->mmap_addr = mmap((void *) 0, stream->mmap_len,
-			PROT_READ, MAP_PRIVATE, fileno(stream->file->fp),
-			stream->mmap_offset);
+	if (ctf_fs->options.io_backend == CTF_FS_IO_BACKEND_READ) {
+		if (read_window(stream, readahead_len)) {
+			goto error;
+		}
+		goto end;
+	}
+
+	/* Map new region */
+	stream->mmap_addr = ctf_fs_file_mmap(stream->file, stream->mmap_len,
+			stream->mmap_offset, readahead_len);
 	if (stream->mmap_addr == MAP_FAILED) {
 		PERR("Cannot memory-map address (size %zu) of file \"%s\" (%p) at offset %zu: %s\n",
 				stream->mmap_len, stream->file->path->str,
@@ -104,6 +208,9 @@ enum bt_ctf_notif_iter_medium_status mmap_next(struct ctf_fs_stream *stream)
 		goto error;
 	}
 
+	/* Only a hint: the window is read once, front to back. */
+	(void) madvise(stream->mmap_addr, stream->mmap_len, MADV_SEQUENTIAL);
+
 	goto end;
 error:
 	stream_munmap(stream);
@@ -112,6 +219,50 @@ end:
 	return ret;
 }
 
+/*
+ * Position the stream so that the next medium request returns data
+ * starting at "offset" (bytes) within the stream file.
+ */
+static
+int stream_seek(struct ctf_fs_stream *stream, off_t offset)
+{
+	int ret = 0;
+	struct ctf_fs_component *ctf_fs = stream->file->ctf_fs;
+
+	if (stream->mmap_addr) {
+		if (stream_munmap(stream)) {
+			ret = -1;
+			goto end;
+		}
+
+		stream->mmap_addr = NULL;
+	}
+
+	/* Seeks are always done to the beginning of a packet. */
+	stream->packet_offset = offset;
+	stream->mmap_len = 0;
+	stream->mmap_valid_len = 0;
+	if (offset >= stream->end_offset) {
+		stream->mmap_offset = stream->end_offset;
+		stream->request_offset = 0;
+		goto end;
+	}
+
+	/* mmap() offsets must be page-aligned. */
+	stream->mmap_offset = offset & ~((off_t) ctf_fs->page_size - 1);
+	stream->request_offset = offset - stream->mmap_offset;
+	if (mmap_next(stream) != BT_CTF_NOTIF_ITER_MEDIUM_STATUS_OK) {
+		PERR("Cannot seek to offset %jd of file \"%s\" (%p)\n",
+				(intmax_t) offset, stream->file->path->str,
+				stream->file->fp);
+		stream->mmap_addr = NULL;
+		ret = -1;
+		goto end;
+	}
+end:
+	return ret;
+}
+
 static
 enum bt_ctf_notif_iter_medium_status medop_request_bytes(
 		size_t request_sz, uint8_t **buffer_addr,
@@ -129,7 +280,8 @@ enum bt_ctf_notif_iter_medium_status medop_request_bytes(
 	/* Check if we have at least one memory-mapped byte left */
 	if (remaining_mmap_bytes(stream) == 0) {
 		/* Are we at the end of the file? */
-		if (stream->mmap_offset >= stream->file->size) {
+		if (stream->mmap_offset + stream->request_offset >=
+				stream->end_offset) {
 			PDBG("Reached end of file \"%s\" (%p)\n",
 				stream->file->path->str, stream->file->fp);
 			status = BT_CTF_NOTIF_ITER_MEDIUM_STATUS_EOF;
@@ -167,18 +319,31 @@ struct bt_ctf_stream *medop_get_stream(
 		struct bt_ctf_stream_class *stream_class, void *data)
 {
 	struct ctf_fs_stream *fs_stream = data;
+	/* The parts of a stream share its stream object. */
+	struct ctf_fs_stream *owner = fs_stream->parent ? : fs_stream;
 	struct ctf_fs_component *ctf_fs = fs_stream->file->ctf_fs;
 
 	if (!fs_stream->stream) {
 		int64_t id = bt_ctf_stream_class_get_id(stream_class);
 
-		PDBG("Creating stream out of stream class %" PRId64 "\n", id);
-		fs_stream->stream = bt_ctf_stream_create(stream_class,
-				fs_stream->file->path->str);
+		/* Streams of the same trace may be decoded concurrently. */
+		pthread_mutex_lock(&ctf_fs->stream_lock);
+		if (!owner->stream) {
+			PDBG("Creating stream out of stream class %" PRId64 "\n",
+					id);
+			owner->stream = bt_ctf_stream_create(stream_class,
+					fs_stream->file->path->str);
+			owner->stream_class_id = id;
+		}
+		if (owner != fs_stream) {
+			fs_stream->stream = bt_get(owner->stream);
+		}
+		pthread_mutex_unlock(&ctf_fs->stream_lock);
 		if (!fs_stream->stream) {
 			PERR("Cannot create stream (stream class %" PRId64 ")\n",
 					id);
 		}
+		fs_stream->stream_class_id = id;
 	}
 
 	return fs_stream->stream;
@@ -190,12 +355,37 @@ static struct bt_ctf_notif_iter_medium_ops medops = {
 };
 
 static
-int build_index_from_idx_file(struct ctf_fs_stream *stream)
+gchar *get_index_file_path(struct ctf_fs_stream *stream)
 {
-	int ret = 0;
 	gchar *directory = NULL;
 	gchar *basename = NULL;
-	GString *index_basename = NULL;
+	gchar *index_basename = NULL;
+	gchar *index_file_path = NULL;
+
+	basename = g_path_get_basename(stream->file->path->str);
+	directory = g_path_get_dirname(stream->file->path->str);
+	if (!basename || !directory) {
+		goto end;
+	}
+
+	index_basename = g_strconcat(basename, ".idx", NULL);
+	if (!index_basename) {
+		goto end;
+	}
+
+	index_file_path = g_build_filename(directory, "index",
+			index_basename, NULL);
+end:
+	g_free(directory);
+	g_free(basename);
+	g_free(index_basename);
+	return index_file_path;
+}
+
+static
+int build_index_from_idx_file(struct ctf_fs_stream *stream)
+{
+	int ret = 0;
 	gchar *index_file_path = NULL;
 	GMappedFile *mapped_file = NULL;
 	gsize filesize;
@@ -208,27 +398,12 @@ int build_index_from_idx_file(struct ctf_fs_stream *stream)
 	size_t i;
 
 	/* Look for index file in relative path index/name.idx. */
-	basename = g_path_get_basename(stream->file->path->str);
-	if (!basename) {
-		ret = -1;
-		goto end;
-	}
-
-	directory = g_path_get_dirname(stream->file->path->str);
-	if (!directory) {
-		ret = -1;
-		goto end;
-	}
-
-	index_basename = g_string_new(basename);
-	if (!index_basename) {
+	index_file_path = get_index_file_path(stream);
+	if (!index_file_path) {
 		ret = -1;
 		goto end;
 	}
 
-	g_string_append(index_basename, ".idx");
-	index_file_path = g_build_filename(directory, "index",
-			index_basename->str, NULL);
 	mapped_file = g_mapped_file_new(index_file_path, FALSE, NULL);
 	if (!mapped_file) {
 		ret = -1;
@@ -265,6 +440,7 @@ int build_index_from_idx_file(struct ctf_fs_stream *stream)
 		ret = -1;
 		goto end;
 	}
+	g_array_set_size(stream->index.entries, file_entry_count);
 	index = (struct index_entry *) stream->index.entries->data;
 	for (i = 0; i < file_entry_count; i++) {
 		struct ctf_packet_index *file_index =
@@ -307,30 +483,635 @@ int build_index_from_idx_file(struct ctf_fs_stream *stream)
 		ret = -1;
 		goto invalid_index;
 	}
+	stream->index.has_timestamps = true;
 end:
-	g_free(directory);
-	g_free(basename);
 	g_free(index_file_path);
-	if (index_basename) {
-		g_string_free(index_basename, TRUE);
-	}
 	if (mapped_file) {
 		g_mapped_file_unref(mapped_file);
 	}
 	return ret;
 invalid_index:
 	g_array_free(stream->index.entries, TRUE);
+	stream->index.entries = NULL;
 	goto end;
 }
 
+/*
+ * Write an LTTng-compatible index file (index/name.idx) so that the
+ * next opening of this stream does not need to scan it.
+ */
+static
+int write_idx_file(struct ctf_fs_stream *stream, GArray *file_entries)
+{
+	int ret = 0;
+	FILE *fp = NULL;
+	gchar *index_file_path = NULL;
+	gchar *index_dir_path = NULL;
+	GString *tmp_path = NULL;
+	struct ctf_packet_index_file_hdr header;
+	struct ctf_fs_component *ctf_fs = stream->file->ctf_fs;
+
+	index_file_path = get_index_file_path(stream);
+	if (!index_file_path) {
+		ret = -1;
+		goto end;
+	}
+
+	index_dir_path = g_path_get_dirname(index_file_path);
+	if (!index_dir_path || g_mkdir_with_parents(index_dir_path, 0755)) {
+		PERR("Cannot create index directory of file \"%s\"\n",
+				stream->file->path->str);
+		ret = -1;
+		goto end;
+	}
+
+	/* Write to a temporary file, then rename it once complete. */
+	tmp_path = g_string_new(index_file_path);
+	if (!tmp_path) {
+		ret = -1;
+		goto end;
+	}
+
+	g_string_append(tmp_path, ".tmp");
+	fp = fopen(tmp_path->str, "wb");
+	if (!fp) {
+		PERR("Cannot open index file \"%s\": %s\n", tmp_path->str,
+				strerror(errno));
+		ret = -1;
+		goto end;
+	}
+
+	header.magic = htobe32(CTF_INDEX_MAGIC);
+	header.index_major = htobe32(CTF_INDEX_MAJOR);
+	header.index_minor = htobe32(CTF_INDEX_MINOR);
+	header.packet_index_len = htobe32(sizeof(struct ctf_packet_index));
+	if (fwrite(&header, sizeof(header), 1, fp) != 1 ||
+			fwrite(file_entries->data, sizeof(struct ctf_packet_index),
+				file_entries->len, fp) != file_entries->len) {
+		PERR("Cannot write index file \"%s\"\n", tmp_path->str);
+		ret = -1;
+		goto end;
+	}
+
+	ret = fclose(fp);
+	fp = NULL;
+	if (ret) {
+		PERR("Cannot close index file \"%s\": %s\n", tmp_path->str,
+				strerror(errno));
+		goto end;
+	}
+
+	ret = rename(tmp_path->str, index_file_path);
+	if (ret) {
+		PERR("Cannot rename index file \"%s\": %s\n", tmp_path->str,
+				strerror(errno));
+		goto end;
+	}
+
+	PDBG("Wrote index file \"%s\" (%u packets)\n", index_file_path,
+			file_entries->len);
+end:
+	if (fp) {
+		fclose(fp);
+	}
+
+	if (ret && tmp_path) {
+		(void) unlink(tmp_path->str);
+	}
+
+	g_free(index_file_path);
+	g_free(index_dir_path);
+	if (tmp_path) {
+		g_string_free(tmp_path, TRUE);
+	}
+	return ret;
+}
+
+static
+int get_field_unsigned_value(struct bt_ctf_field *scope, const char *name,
+		uint64_t *value)
+{
+	int ret = -1;
+	struct bt_ctf_field *field;
+
+	if (!scope) {
+		goto end;
+	}
+
+	field = bt_ctf_field_structure_get_field(scope, name);
+	if (!field) {
+		goto end;
+	}
+
+	ret = bt_ctf_field_unsigned_integer_get_value(field, value);
+	bt_put(field);
+end:
+	return ret;
+}
+
+/*
+ * Decode the header and context of the packet located at "offset" (bytes)
+ * and fill its index entry (and LTTng index file entry, if not NULL).
+ */
+static
+int index_packet(struct ctf_fs_stream *stream, off_t offset,
+		struct index_entry *entry, struct ctf_packet_index *file_entry,
+		bool *has_timestamps)
+{
+	int ret = 0;
+	enum bt_ctf_notif_iter_status status;
+	struct bt_ctf_field *packet_header = NULL;
+	struct bt_ctf_field *packet_context = NULL;
+	uint64_t packet_size, content_size, value;
+	struct ctf_fs_component *ctf_fs = stream->file->ctf_fs;
+
+	ret = stream_seek(stream, offset);
+	if (ret) {
+		goto end;
+	}
+
+	bt_ctf_notif_iter_reset(stream->notif_iter);
+	status = bt_ctf_notif_iter_get_packet_header_context_fields(
+			stream->notif_iter, &packet_header, &packet_context);
+	if (status != BT_CTF_NOTIF_ITER_STATUS_OK) {
+		PERR("Cannot decode header and context of packet at offset %jd of file \"%s\"\n",
+				(intmax_t) offset, stream->file->path->str);
+		ret = -1;
+		goto end;
+	}
+
+	/* Without a packet size, the packet spans the rest of the file. */
+	if (get_field_unsigned_value(packet_context, "packet_size",
+			&packet_size)) {
+		packet_size = (stream->file->size - offset) * CHAR_BIT;
+	}
+
+	if (packet_size == 0 || packet_size % CHAR_BIT ||
+			packet_size / CHAR_BIT > stream->file->size - offset) {
+		PERR("Invalid packet size (%" PRIu64 " bits) at offset %jd of file \"%s\"\n",
+				packet_size, (intmax_t) offset,
+				stream->file->path->str);
+		ret = -1;
+		goto end;
+	}
+
+	if (get_field_unsigned_value(packet_context, "content_size",
+			&content_size)) {
+		content_size = packet_size;
+	}
+
+	entry->offset = offset;
+	entry->packet_size = packet_size / CHAR_BIT;
+	if (get_field_unsigned_value(packet_context, "timestamp_begin",
+			&entry->timestamp_begin) ||
+			get_field_unsigned_value(packet_context,
+				"timestamp_end", &entry->timestamp_end)) {
+		*has_timestamps = false;
+	}
+
+	if (entry->timestamp_end < entry->timestamp_begin) {
+		PERR("Invalid packet time bounds at offset %jd of file \"%s\"\n",
+				(intmax_t) offset, stream->file->path->str);
+		ret = -1;
+		goto end;
+	}
+
+	if (!file_entry) {
+		goto end;
+	}
+
+	file_entry->offset = htobe64(entry->offset);
+	file_entry->packet_size = htobe64(packet_size);
+	file_entry->content_size = htobe64(content_size);
+	file_entry->timestamp_begin = htobe64(entry->timestamp_begin);
+	file_entry->timestamp_end = htobe64(entry->timestamp_end);
+	value = 0;
+	(void) get_field_unsigned_value(packet_context, "events_discarded",
+			&value);
+	file_entry->events_discarded = htobe64(value);
+	value = 0;
+	(void) get_field_unsigned_value(packet_header, "stream_id", &value);
+	file_entry->stream_id = htobe64(value);
+	value = 0;
+	(void) get_field_unsigned_value(packet_header, "stream_instance_id",
+			&value);
+	file_entry->stream_instance_id = htobe64(value);
+	value = 0;
+	(void) get_field_unsigned_value(packet_context, "packet_seq_num",
+			&value);
+	file_entry->packet_seq_num = htobe64(value);
+end:
+	bt_put(packet_header);
+	bt_put(packet_context);
+	return ret;
+}
+
+/*
+ * Build the stream's index by decoding only its packet headers and
+ * contexts, jumping from packet to packet using their size.
+ *
+ * The stream is rewound to its beginning afterwards; this must not be
+ * called while its notification iterator is in use.
+ */
 static
 int build_index_from_stream(struct ctf_fs_stream *stream)
 {
 	int ret = 0;
+	off_t offset = 0;
+	bool has_timestamps = true;
+	GArray *entries = NULL;
+	GArray *file_entries = NULL;
+	struct ctf_fs_component *ctf_fs = stream->file->ctf_fs;
+
+	entries = g_array_new(FALSE, TRUE, sizeof(struct index_entry));
+	if (!entries) {
+		ret = -1;
+		goto end;
+	}
+
+	if (ctf_fs->options.write_index) {
+		file_entries = g_array_new(FALSE, TRUE,
+				sizeof(struct ctf_packet_index));
+		if (!file_entries) {
+			ret = -1;
+			goto end;
+		}
+	}
+
+	while (offset < stream->file->size) {
+		struct index_entry *entry;
+		struct ctf_packet_index *file_entry = NULL;
+
+		g_array_set_size(entries, entries->len + 1);
+		entry = &g_array_index(entries, struct index_entry,
+				entries->len - 1);
+		if (file_entries) {
+			g_array_set_size(file_entries, file_entries->len + 1);
+			file_entry = &g_array_index(file_entries,
+					struct ctf_packet_index,
+					file_entries->len - 1);
+		}
+
+		ret = index_packet(stream, offset, entry, file_entry,
+				&has_timestamps);
+		if (ret) {
+			goto end;
+		}
+
+		offset += entry->packet_size;
+	}
+
+	/* Rewind the stream for regular decoding. */
+	ret = stream_seek(stream, 0);
+	if (ret) {
+		goto end;
+	}
+
+	bt_ctf_notif_iter_reset(stream->notif_iter);
+	stream->index.entries = entries;
+	stream->index.has_timestamps = has_timestamps;
+	entries = NULL;
+	PDBG("Indexed %u packets of file \"%s\"\n",
+			stream->index.entries->len, stream->file->path->str);
+
+	if (file_entries && write_idx_file(stream, file_entries)) {
+		/* Not fatal: the index is still available in memory. */
+		PWARN("Cannot write index file of \"%s\"\n",
+				stream->file->path->str);
+	}
+end:
+	if (entries) {
+		g_array_free(entries, TRUE);
+	}
+
+	if (file_entries) {
+		g_array_free(file_entries, TRUE);
+	}
+	return ret;
+}
+
+BT_HIDDEN
+int ctf_fs_stream_build_index(struct ctf_fs_stream *stream)
+{
+	int ret = 0;
+
+	if (stream->index.entries) {
+		goto end;
+	}
+
+	ret = build_index_from_stream(stream);
 end:
 	return ret;
 }
 
+static
+int clock_cycles_to_ns(struct bt_ctf_clock_class *clock_class,
+		uint64_t cycles, int64_t *ns)
+{
+	int ret = -1;
+	struct bt_ctf_clock_value *clock_value;
+
+	clock_value = bt_ctf_clock_value_create(clock_class, cycles);
+	if (!clock_value) {
+		goto end;
+	}
+
+	ret = bt_ctf_clock_value_get_value_ns_from_epoch(clock_value, ns);
+	bt_put(clock_value);
+end:
+	return ret;
+}
+
+/*
+ * Groups the stream's packets, from "first_packet", in chunks of about
+ * "options.chunk_size" bytes.
+ */
+static
+void build_chunks(struct ctf_fs_stream *stream, guint first_packet)
+{
+	GArray *entries = stream->index.entries;
+	uint64_t chunk_size = stream->file->ctf_fs->options.chunk_size;
+	uint64_t chunk_offset = 0;
+	guint i;
+
+	g_array_set_size(stream->chunks, 0);
+	for (i = first_packet; i < entries->len; i++) {
+		struct index_entry *entry = &g_array_index(entries,
+				struct index_entry, i);
+
+		if (i == first_packet ||
+				entry->offset - chunk_offset >= chunk_size) {
+			g_array_append_val(stream->chunks, i);
+			chunk_offset = entry->offset;
+		}
+	}
+
+	g_array_append_val(stream->chunks, i);
+}
+
+/*
+ * Positions a part at the beginning of its chunk, with the clock value
+ * of its first packet, since the packets which precede it are not
+ * decoded by this part.
+ */
+static
+int position_part(struct ctf_fs_stream *part)
+{
+	int ret = 0;
+	struct ctf_fs_stream *stream = part->parent;
+	GArray *entries = stream->index.entries;
+	struct bt_ctf_clock_class *clock_class = NULL;
+	struct index_entry *entry;
+	guint first_packet, end_packet;
+
+	if (part->chunk >= stream->chunks->len - 1) {
+		/* Nothing left to decode. */
+		part->end_reached = true;
+		goto end;
+	}
+
+	first_packet = g_array_index(stream->chunks, guint, part->chunk);
+	end_packet = g_array_index(stream->chunks, guint, part->chunk + 1);
+	entry = &g_array_index(entries, struct index_entry, first_packet);
+	part->end_offset = end_packet < entries->len ?
+			g_array_index(entries, struct index_entry,
+				end_packet).offset :
+			stream->end_offset;
+	ret = stream_seek(part, entry->offset);
+	if (ret) {
+		goto end;
+	}
+
+	bt_ctf_notif_iter_reset(part->notif_iter);
+	part->end_reached = false;
+	if (!stream->index.has_timestamps) {
+		goto end;
+	}
+
+	// FIXME - assumes only one clock
+	clock_class = bt_ctf_trace_get_clock_class(
+			stream->file->ctf_fs->metadata->trace, 0);
+	if (clock_class) {
+		ret = bt_ctf_notif_iter_set_clock_value(part->notif_iter,
+				clock_class, entry->timestamp_begin);
+	}
+end:
+	bt_put(clock_class);
+	return ret;
+}
+
+/* Makes the parts decode the chunks of packets from "first_packet". */
+static
+int position_parts(struct ctf_fs_stream *stream, guint first_packet)
+{
+	int ret = 0;
+	guint i;
+
+	build_chunks(stream, first_packet);
+	stream->current_part = 0;
+	for (i = 0; i < stream->parts->len; i++) {
+		struct ctf_fs_stream *part = g_ptr_array_index(stream->parts, i);
+
+		part->chunk = i;
+		part->seek = stream->seek;
+		ret = position_part(part);
+		if (ret) {
+			break;
+		}
+	}
+
+	return ret;
+}
+
+BT_HIDDEN
+bool ctf_fs_stream_part_has_last_chunk(struct ctf_fs_stream *part)
+{
+	return part->chunk == part->parent->chunks->len - 2;
+}
+
+BT_HIDDEN
+int ctf_fs_stream_part_next_chunk(struct ctf_fs_stream *part)
+{
+	part->chunk += part->parent->parts->len;
+	return position_part(part);
+}
+
+static
+void part_destroy(void *part)
+{
+	ctf_fs_stream_destroy((struct ctf_fs_stream *) part);
+}
+
+static
+struct ctf_fs_stream *part_create(struct ctf_fs_stream *stream)
+{
+	struct ctf_fs_component *ctf_fs = stream->file->ctf_fs;
+	struct ctf_fs_stream *part = g_new0(struct ctf_fs_stream, 1);
+
+	if (!part) {
+		goto end;
+	}
+
+	part->parent = stream;
+	part->notif_iter = bt_ctf_notif_iter_create(ctf_fs->metadata->decoder,
+			ctf_fs->page_size, medops, part, ctf_fs->error_fp);
+	if (!part->notif_iter) {
+		ctf_fs_stream_destroy(part);
+		part = NULL;
+		goto end;
+	}
+
+	/* Borrowed, but its mappings count in the budget. */
+	part->file = stream->file;
+	part->end_offset = stream->end_offset;
+	__atomic_add_fetch(&ctf_fs->files.stream_count, 1, __ATOMIC_RELAXED);
+end:
+	return part;
+}
+
+BT_HIDDEN
+int ctf_fs_stream_split(struct ctf_fs_stream *stream, unsigned int nr_parts)
+{
+	int ret;
+	unsigned int i;
+	struct ctf_fs_component *ctf_fs = stream->file->ctf_fs;
+
+	assert(!stream->parts);
+	ret = ctf_fs_stream_build_index(stream);
+	if (ret) {
+		goto end;
+	}
+
+	stream->chunks = g_array_new(FALSE, FALSE, sizeof(guint));
+	if (!stream->chunks) {
+		goto error;
+	}
+
+	build_chunks(stream, 0);
+	nr_parts = MIN(nr_parts, stream->chunks->len - 1);
+	if (nr_parts < 2) {
+		/* Decoded as a whole. */
+		g_array_free(stream->chunks, TRUE);
+		stream->chunks = NULL;
+		goto end;
+	}
+
+	stream->parts = g_ptr_array_new_with_free_func(part_destroy);
+	if (!stream->parts) {
+		goto error;
+	}
+
+	for (i = 0; i < nr_parts; i++) {
+		struct ctf_fs_stream *part = part_create(stream);
+
+		if (!part) {
+			goto error;
+		}
+
+		g_ptr_array_add(stream->parts, part);
+	}
+
+	ret = position_parts(stream, 0);
+	if (ret) {
+		goto error;
+	}
+
+	/* The stream itself does not decode anything anymore. */
+	ret = stream_seek(stream, stream->end_offset);
+	if (ret) {
+		goto error;
+	}
+
+	PDBG("Decoding %u chunks of file \"%s\" with %u parts\n",
+			stream->chunks->len - 1, stream->file->path->str,
+			nr_parts);
+	goto end;
+error:
+	PERR("Cannot split stream file \"%s\"\n", stream->file->path->str);
+	if (stream->parts) {
+		g_ptr_array_free(stream->parts, TRUE);
+		stream->parts = NULL;
+	}
+
+	if (stream->chunks) {
+		g_array_free(stream->chunks, TRUE);
+		stream->chunks = NULL;
+	}
+	ret = -1;
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int ctf_fs_stream_seek_time(struct ctf_fs_stream *stream, int64_t time)
+{
+	int ret;
+	off_t offset = 0;
+	guint first_packet = 0;
+	GArray *entries;
+	struct bt_ctf_clock_class *clock_class = NULL;
+	struct ctf_fs_component *ctf_fs = stream->file->ctf_fs;
+
+	ret = ctf_fs_stream_build_index(stream);
+	if (ret) {
+		goto end;
+	}
+
+	entries = stream->index.entries;
+	// FIXME - assumes only one clock
+	clock_class = bt_ctf_trace_get_clock_class(ctf_fs->metadata->trace, 0);
+	if (clock_class && stream->index.has_timestamps && entries->len) {
+		size_t low = 0, high = entries->len;
+
+		/* Find the first packet which ends at or after "time". */
+		while (low < high) {
+			size_t mid = low + (high - low) / 2;
+			int64_t end_ns;
+
+			ret = clock_cycles_to_ns(clock_class,
+					g_array_index(entries,
+						struct index_entry, mid).timestamp_end,
+					&end_ns);
+			if (ret) {
+				goto end;
+			}
+
+			if (end_ns < time) {
+				low = mid + 1;
+			} else {
+				high = mid;
+			}
+		}
+
+		/*
+		 * Past the stream's end, position on its last packet: its
+		 * events are skipped but its packet and stream end are
+		 * still delivered.
+		 */
+		first_packet = MIN(low, entries->len - 1);
+		offset = g_array_index(entries, struct index_entry,
+				first_packet).offset;
+	}
+
+	if (stream->parts) {
+		ret = position_parts(stream, first_packet);
+		goto end;
+	}
+
+	PDBG("Seeking stream file \"%s\" to offset %jd\n",
+			stream->file->path->str, (intmax_t) offset);
+	ret = stream_seek(stream, offset);
+	if (ret) {
+		goto end;
+	}
+
+	bt_ctf_notif_iter_reset(stream->notif_iter);
+	stream->end_reached = false;
+end:
+	bt_put(clock_class);
+	return ret;
+}
+
 static
 int init_stream_index(struct ctf_fs_stream *stream)
 {
@@ -341,7 +1122,15 @@ int init_stream_index(struct ctf_fs_stream *stream)
 		goto end;
 	}
 
-	ret = build_index_from_stream(stream);
+	/*
+	 * Without an LTTng index, the stream is only scanned when its
+	 * index is first needed (see ctf_fs_stream_build_index()), unless
+	 * the index file is to be written.
+	 */
+	ret = 0;
+	if (stream->file->ctf_fs->options.write_index) {
+		ret = build_index_from_stream(stream);
+	}
 end:
 	return ret;
 }
@@ -358,17 +1147,24 @@ struct ctf_fs_stream *ctf_fs_stream_create(
 	}
 
 	stream->file = file;
-	stream->notif_iter = bt_ctf_notif_iter_create(ctf_fs->metadata->trace,
+	stream->end_offset = file->size;
+	if (!ctf_fs->metadata->decoder) {
+		goto error;
+	}
+
+	stream->notif_iter = bt_ctf_notif_iter_create(ctf_fs->metadata->decoder,
 			ctf_fs->page_size, medops, stream, ctf_fs->error_fp);
 	if (!stream->notif_iter) {
 		goto error;
 	}
 
-	stream->mmap_max_len = ctf_fs->page_size * 2048;
 	ret = init_stream_index(stream);
 	if (ret) {
 		goto error;
 	}
+
+	/* Counted as long as it owns its file. */
+	__atomic_add_fetch(&ctf_fs->files.stream_count, 1, __ATOMIC_RELAXED);
 	goto end;
 error:
 	/* Do not touch "borrowed" file. */
@@ -386,8 +1182,21 @@ void ctf_fs_stream_destroy(struct ctf_fs_stream *stream)
 		return;
 	}
 
+	/* Before the file they borrow. */
+	if (stream->parts) {
+		g_ptr_array_free(stream->parts, TRUE);
+	}
+
+	if (stream->chunks) {
+		g_array_free(stream->chunks, TRUE);
+	}
+
 	if (stream->file) {
-		ctf_fs_file_destroy(stream->file);
+		__atomic_sub_fetch(&stream->file->ctf_fs->files.stream_count, 1,
+				__ATOMIC_RELAXED);
+		if (!stream->parent) {
+			ctf_fs_file_destroy(stream->file);
+		}
 	}
 
 	if (stream->stream) {
@@ -402,5 +1211,6 @@ void ctf_fs_stream_destroy(struct ctf_fs_stream *stream)
 		g_array_free(stream->index.entries, TRUE);
 	}
 
+	g_free(stream->read_buf);
 	g_free(stream);
 }
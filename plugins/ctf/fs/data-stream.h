@@ -24,6 +24,7 @@
  */
 
 #include <stdio.h>
+#include <stdbool.h>
 #include <glib.h>
 #include <babeltrace/babeltrace-internal.h>
 #include <babeltrace/ctf-ir/trace.h>
@@ -35,6 +36,12 @@ struct ctf_fs_component;
 struct ctf_fs_file;
 struct ctf_fs_stream;
 
+/*
+ * Default approximate size of the chunks of packets decoded by a
+ * stream's parts.
+ */
+#define CTF_FS_CHUNK_SIZE	(1024 * 1024)
+
 struct index_entry {
 	uint64_t offset; /* in bytes. */
 	uint64_t packet_size; /* in bytes. */
@@ -44,6 +51,8 @@ struct index_entry {
 
 struct index {
 	GArray *entries; /* Array of struct index_entry. */
+	/* Whether the entries' time bounds are known. */
+	bool has_timestamps;
 };
 
 BT_HIDDEN
@@ -53,6 +62,39 @@ struct ctf_fs_stream *ctf_fs_stream_create(
 BT_HIDDEN
 void ctf_fs_stream_destroy(struct ctf_fs_stream *stream);
 
+/*
+ * Build the stream's packet index from its packet headers and contexts
+ * if it could not be loaded from an LTTng index file. The stream is
+ * rewound to its beginning when the index is built.
+ */
+BT_HIDDEN
+int ctf_fs_stream_build_index(struct ctf_fs_stream *stream);
+
+/*
+ * Position the stream at the beginning of the first packet which ends
+ * at or after "time" (ns from Epoch), building its index if needed.
+ * The stream is positioned at its beginning if its index has no time
+ * bounds.
+ */
+BT_HIDDEN
+int ctf_fs_stream_seek_time(struct ctf_fs_stream *stream, int64_t time);
+
+/*
+ * Splits a stream in at most "nr_parts" parts decoding its chunks of
+ * packets in parallel, building its index if needed. The stream is left
+ * whole if it has a single chunk.
+ */
+BT_HIDDEN
+int ctf_fs_stream_split(struct ctf_fs_stream *stream, unsigned int nr_parts);
+
+/* Whether a part decodes the last chunk of its stream. */
+BT_HIDDEN
+bool ctf_fs_stream_part_has_last_chunk(struct ctf_fs_stream *part);
+
+/* Positions a part, at the end of its chunk, on its next one, if any. */
+BT_HIDDEN
+int ctf_fs_stream_part_next_chunk(struct ctf_fs_stream *part);
+
 BT_HIDDEN
 int ctf_fs_data_stream_open_streams(struct ctf_fs_component *ctf_fs);
 
@@ -23,6 +23,8 @@
 #include <stdio.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <glib.h>
 
@@ -32,6 +34,19 @@
 
 #include "file.h"
 
+static
+void close_file(struct ctf_fs_file *file)
+{
+	struct ctf_fs_component *ctf_fs = file->ctf_fs;
+
+	PDBG("Closing file \"%s\" (%p)\n", file->path->str, file->fp);
+	if (fclose(file->fp)) {
+		PERR("Cannot close file \"%s\": %s\n", file->path->str,
+			strerror(errno));
+	}
+	file->fp = NULL;
+}
+
 BT_HIDDEN
 void ctf_fs_file_destroy(struct ctf_fs_file *file)
 {
@@ -41,13 +56,14 @@ void ctf_fs_file_destroy(struct ctf_fs_file *file)
 		return;
 	}
 
-	if (file->fp) {
-		PDBG("Closing file \"%s\" (%p)\n", file->path->str, file->fp);
+	if (file->open_link.data) {
+		pthread_mutex_lock(&ctf_fs->files.lock);
+		g_queue_unlink(&ctf_fs->files.open_files, &file->open_link);
+		pthread_mutex_unlock(&ctf_fs->files.lock);
+	}
 
-		if (fclose(file->fp)) {
-			PERR("Cannot close file \"%s\": %s\n", file->path->str,
-				strerror(errno));
-		}
+	if (file->fp) {
+		close_file(file);
 	}
 
 	if (file->path) {
@@ -121,3 +137,172 @@ error:
 end:
 	return ret;
 }
+
+BT_HIDDEN
+int ctf_fs_file_stat(struct ctf_fs_component *ctf_fs, struct ctf_fs_file *file)
+{
+	struct stat stat_buf;
+
+	if (stat(file->path->str, &stat_buf)) {
+		PERR("Cannot get file informations of \"%s\": %s\n",
+			file->path->str, strerror(errno));
+		return -1;
+	}
+
+	file->size = stat_buf.st_size;
+	PDBG("File \"%s\" is %jd bytes\n", file->path->str,
+		(intmax_t) file->size);
+	return 0;
+}
+
+/*
+ * Makes sure that a data stream file is open, closing the least
+ * recently used unpinned ones to stay within the component's budget,
+ * marks it as the most recently used and pins it. Called with the
+ * files lock held; the caller may then use the file without it until
+ * release_file().
+ */
+static
+int acquire_file(struct ctf_fs_file *file)
+{
+	struct ctf_fs_component *ctf_fs = file->ctf_fs;
+	GQueue *open_files = &ctf_fs->files.open_files;
+
+	if (file->open_link.data) {
+		g_queue_unlink(open_files, &file->open_link);
+	} else {
+		GList *link = open_files->tail;
+
+		/*
+		 * Pinned files are being read by other threads: go over
+		 * the budget rather than waiting for them.
+		 */
+		while (link && open_files->length >=
+				ctf_fs->options.max_open_files) {
+			GList *prev = link->prev;
+			struct ctf_fs_file *lru_file = link->data;
+
+			if (lru_file->pins == 0) {
+				/* Its mappings remain valid. */
+				g_queue_unlink(open_files, link);
+				close_file(lru_file);
+				link->data = NULL;
+			}
+
+			link = prev;
+		}
+
+		PDBG("Opening file \"%s\"\n", file->path->str);
+		file->fp = fopen(file->path->str, "rb");
+		if (!file->fp) {
+			PERR("Cannot open file \"%s\": %s\n", file->path->str,
+				strerror(errno));
+			return -1;
+		}
+
+		file->open_link.data = file;
+	}
+
+	g_queue_push_head_link(open_files, &file->open_link);
+	file->pins++;
+	return 0;
+}
+
+/* Unpins a file acquired with acquire_file(). */
+static
+void release_file(struct ctf_fs_file *file)
+{
+	struct ctf_fs_component *ctf_fs = file->ctf_fs;
+
+	pthread_mutex_lock(&ctf_fs->files.lock);
+	file->pins--;
+	pthread_mutex_unlock(&ctf_fs->files.lock);
+}
+
+/* Asks the kernel to start reading a range of an acquired file. */
+static
+void prefetch_file(int fd, off_t offset, size_t len)
+{
+	if (len == 0) {
+		return;
+	}
+
+	(void) posix_fadvise(fd, offset, len, POSIX_FADV_WILLNEED);
+}
+
+BT_HIDDEN
+void *ctf_fs_file_mmap(struct ctf_fs_file *file, size_t len, off_t offset,
+		size_t readahead_len)
+{
+	struct ctf_fs_component *ctf_fs = file->ctf_fs;
+	void *addr = MAP_FAILED;
+	int flags = MAP_PRIVATE;
+	int fd;
+	int ret;
+
+#ifdef MAP_POPULATE
+	if (ctf_fs->options.populate) {
+		flags |= MAP_POPULATE;
+	}
+#endif
+
+	pthread_mutex_lock(&ctf_fs->files.lock);
+	ret = acquire_file(file);
+	pthread_mutex_unlock(&ctf_fs->files.lock);
+	if (ret) {
+		goto end;
+	}
+
+	fd = fileno(file->fp);
+	addr = mmap(NULL, len, PROT_READ, flags, fd, offset);
+	if (addr != MAP_FAILED) {
+		prefetch_file(fd, offset + len, readahead_len);
+	}
+
+	release_file(file);
+end:
+	return addr;
+}
+
+BT_HIDDEN
+int ctf_fs_file_pread(struct ctf_fs_file *file, void *buf, size_t len,
+		off_t offset, size_t readahead_len)
+{
+	int ret;
+	struct ctf_fs_component *ctf_fs = file->ctf_fs;
+	size_t done = 0;
+	int fd;
+
+	pthread_mutex_lock(&ctf_fs->files.lock);
+	ret = acquire_file(file);
+	pthread_mutex_unlock(&ctf_fs->files.lock);
+	if (ret) {
+		goto end;
+	}
+
+	fd = fileno(file->fp);
+	while (done < len) {
+		ssize_t read_len = pread(fd, (char *) buf + done, len - done,
+			offset + done);
+
+		if (read_len < 0 && errno == EINTR) {
+			continue;
+		}
+
+		if (read_len <= 0) {
+			PERR("Cannot read %zu bytes of file \"%s\" at offset %jd: %s\n",
+				len, file->path->str, (intmax_t) offset,
+				read_len ? strerror(errno) : "unexpected end of file");
+			ret = -1;
+			goto release;
+		}
+
+		done += read_len;
+	}
+
+	prefetch_file(fd, offset + len, readahead_len);
+release:
+	release_file(file);
+end:
+	return ret;
+}
@@ -38,4 +38,23 @@ BT_HIDDEN
 int ctf_fs_file_open(struct ctf_fs_component *ctf_fs, struct ctf_fs_file *file,
 		const char *mode);
 
+/* Gets the size of a data stream file without opening it. */
+BT_HIDDEN
+int ctf_fs_file_stat(struct ctf_fs_component *ctf_fs, struct ctf_fs_file *file);
+
+/*
+ * Maps "len" bytes of a data stream file from "offset", opening it
+ * first if needed, within the component's budget of open files. The
+ * kernel is asked to read the next "readahead_len" bytes in the
+ * background. Returns MAP_FAILED on error.
+ */
+BT_HIDDEN
+void *ctf_fs_file_mmap(struct ctf_fs_file *file, size_t len, off_t offset,
+		size_t readahead_len);
+
+/* Same as ctf_fs_file_mmap(), but reads into "buf". */
+BT_HIDDEN
+int ctf_fs_file_pread(struct ctf_fs_file *file, void *buf, size_t len,
+		off_t offset, size_t readahead_len);
+
 #endif /* CTF_FS_FILE_H */
@@ -27,7 +27,12 @@
  */
 
 #include <babeltrace/ctf-ir/packet.h>
+#include <babeltrace/ctf-ir/fields.h>
 #include <babeltrace/ctf-ir/clock-class.h>
+#include <babeltrace/ctf-ir/event.h>
+#include <babeltrace/ctf-ir/event-class.h>
+#include <babeltrace/ctf-ir/stream-class.h>
+#include <babeltrace/ctf-ir/trace.h>
 #include <babeltrace/component/notification/iterator.h>
 #include <babeltrace/component/notification/stream.h>
 #include <babeltrace/component/notification/event.h>
@@ -37,10 +42,12 @@
 #include <glib.h>
 #include <assert.h>
 #include <unistd.h>
+#include <sys/resource.h>
 #include "fs.h"
 #include "metadata.h"
 #include "data-stream.h"
 #include "file.h"
+#include "worker.h"
 
 #define PRINT_ERR_STREAM	ctf_fs->error_fp
 #define PRINT_PREFIX		"ctf-fs"
@@ -66,15 +73,160 @@ struct bt_notification *ctf_fs_iterator_get(
 	return bt_get(ctf_it->current_notification);
 }
 
+/*
+ * Set the sort key by which the pending notifications heap orders a
+ * stream's notification.
+ *
+ * Stream-associated notifications other than events are delivered as
+ * soon as they are reached, by type and then by stream class ID. Events
+ * are ordered by the timestamp cached by the CTF notification iterator,
+ * and then by stream class ID.
+ */
 static
-enum bt_notification_iterator_status ctf_fs_iterator_get_next_notification(
-		struct ctf_fs_iterator *it,
+int set_notification_sort_key(struct ctf_fs_stream *stream,
+		struct bt_notification *notification)
+{
+	static uint64_t notification_priorities[] = {
+		[BT_NOTIFICATION_TYPE_STREAM_END] = 0,
+		[BT_NOTIFICATION_TYPE_PACKET_BEGIN] = 3,
+		[BT_NOTIFICATION_TYPE_PACKET_END] = 4,
+		[BT_NOTIFICATION_TYPE_EVENT] = 5,
+	};
+	enum bt_notification_type type;
+	int64_t timestamp = INT64_MIN;
+	uint64_t tie_break;
+
+	type = bt_notification_get_type(notification);
+	assert(type > BT_NOTIFICATION_TYPE_ALL);
+	assert(type <= BT_NOTIFICATION_TYPE_STREAM_END);
+
+	if (type == BT_NOTIFICATION_TYPE_EVENT) {
+		int ret;
+
+		// FIXME - assumes only one clock
+		ret = bt_notification_get_sort_key(notification, &timestamp,
+				NULL);
+		assert(!ret);
+	}
+
+	tie_break = (notification_priorities[type] << 56) |
+			((uint64_t) stream->stream_class_id & ((1ULL << 56) - 1));
+	return bt_notification_set_sort_key(notification, timestamp,
+			tie_break);
+}
+
+/*
+ * After a seek, the events which precede the seek time within the
+ * stream's first packet are skipped. Packet notifications are kept so
+ * that the packets of delivered events are always announced.
+ */
+static
+bool skip_notification(struct ctf_fs_stream *stream,
+		struct bt_notification *notification)
+{
+	bool skip = false;
+	int64_t timestamp;
+
+	if (!stream->seek.active || bt_notification_get_type(notification) !=
+			BT_NOTIFICATION_TYPE_EVENT) {
+		goto end;
+	}
+
+	if (!bt_notification_get_sort_key(notification, &timestamp, NULL) &&
+			timestamp < stream->seek.time) {
+		skip = true;
+		goto end;
+	}
+
+	stream->seek.active = false;
+end:
+	return skip;
+}
+
+static
+uint64_t get_packet_size(struct ctf_fs_stream *stream,
+		struct bt_ctf_packet *packet)
+{
+	struct bt_ctf_field *context, *size_field = NULL;
+	uint64_t size;
+
+	context = bt_ctf_packet_get_context(packet);
+	if (context) {
+		size_field = bt_ctf_field_structure_get_field(context,
+				"packet_size");
+	}
+	if (!size_field || bt_ctf_field_unsigned_integer_get_value(
+			size_field, &size)) {
+		/* Without a packet size, the stream has a single packet. */
+		size = (stream->file->size - stream->packet_offset) * CHAR_BIT;
+	}
+	bt_put(size_field);
+	bt_put(context);
+	return size / CHAR_BIT;
+}
+
+/*
+ * Records where each packet comes from in the stream's file, so that a
+ * sink producing CTF may copy it instead of encoding its events again.
+ * All the decoded events are counted, including the ones skipped after
+ * a seek, which the sink does not get.
+ */
+static
+int set_packet_origin(struct ctf_fs_stream *stream,
+		struct bt_notification *notification)
+{
+	int ret = 0;
+	struct bt_ctf_packet *packet = NULL;
+	uint64_t size;
+
+	switch (bt_notification_get_type(notification)) {
+	case BT_NOTIFICATION_TYPE_PACKET_BEGIN:
+		packet = bt_notification_packet_begin_get_packet(notification);
+		if (!packet) {
+			ret = -1;
+			goto end;
+		}
+		size = get_packet_size(stream, packet);
+		ret = bt_ctf_packet_set_origin(packet, stream->file->path->str,
+				stream->packet_offset, size,
+				bt_ctf_notif_iter_get_packet_data_offset(
+					stream->notif_iter));
+		stream->packet_offset += size;
+		stream->packet_event_count = 0;
+		break;
+	case BT_NOTIFICATION_TYPE_EVENT:
+		stream->packet_event_count++;
+		break;
+	case BT_NOTIFICATION_TYPE_PACKET_END:
+		packet = bt_notification_packet_end_get_packet(notification);
+		if (!packet) {
+			ret = -1;
+			goto end;
+		}
+		ret = bt_ctf_packet_set_origin_event_count(packet,
+				stream->packet_event_count);
+		break;
+	default:
+		break;
+	}
+end:
+	bt_put(packet);
+	return ret;
+}
+
+/*
+ * Decodes the next notification of a stream. This runs in the stream's
+ * worker thread, if any.
+ */
+BT_HIDDEN
+enum bt_notification_iterator_status ctf_fs_stream_decode_next_notification(
 		struct ctf_fs_stream *stream,
 		struct bt_notification **notification)
 {
 	enum bt_ctf_notif_iter_status status;
 	enum bt_notification_iterator_status ret;
 
+next:
 	if (stream->end_reached) {
 		status = BT_CTF_NOTIF_ITER_STATUS_EOF;
 		goto end;
@@ -87,6 +239,19 @@ enum bt_notification_iterator_status ctf_fs_iterator_get_next_notification(
 		goto end;
 	}
 
+	/*
+	 * The end of a part's chunk is marked by an OK status without a
+	 * notification, for the consumer to continue with the next part.
+	 */
+	if (status == BT_CTF_NOTIF_ITER_STATUS_EOF && stream->parent &&
+			!ctf_fs_stream_part_has_last_chunk(stream)) {
+		*notification = NULL;
+		status = ctf_fs_stream_part_next_chunk(stream) ?
+			BT_CTF_NOTIF_ITER_STATUS_ERROR :
+			BT_CTF_NOTIF_ITER_STATUS_OK;
+		goto end;
+	}
+
 	/* Should be handled in bt_ctf_notif_iter_get_next_notification. */
 	if (status == BT_CTF_NOTIF_ITER_STATUS_EOF) {
 		*notification = bt_notification_stream_end_create(
@@ -97,6 +262,23 @@ enum bt_notification_iterator_status ctf_fs_iterator_get_next_notification(
 		status = BT_CTF_NOTIF_ITER_STATUS_OK;
 		stream->end_reached = true;
 	}
+
+	if (*notification && set_packet_origin(stream, *notification)) {
+		BT_PUT(*notification);
+		status = BT_CTF_NOTIF_ITER_STATUS_ERROR;
+		goto end;
+	}
+
+	if (*notification && set_notification_sort_key(stream, *notification)) {
+		BT_PUT(*notification);
+		status = BT_CTF_NOTIF_ITER_STATUS_ERROR;
+		goto end;
+	}
+
+	if (*notification && skip_notification(stream, *notification)) {
+		BT_PUT(*notification);
+		goto next;
+	}
 end:
 	switch (status) {
 	case BT_CTF_NOTIF_ITER_STATUS_EOF:
@@ -122,6 +304,19 @@ end:
 	return ret;
 }
 
+static
+enum bt_notification_iterator_status ctf_fs_iterator_get_next_notification(
+		struct ctf_fs_iterator *it,
+		struct ctf_fs_stream *stream,
+		struct bt_notification **notification)
+{
+	if (stream->worker || stream->parts) {
+		return ctf_fs_worker_pop_notification(stream, notification);
+	}
+
+	return ctf_fs_stream_decode_next_notification(stream, notification);
+}
+
 /*
  * Remove me. This is a temporary work-around due to our inhability to use
  * libbabeltrace-ctf from libbabeltrace-plugin.
@@ -228,13 +423,6 @@ enum bt_notification_iterator_status populate_heap(struct ctf_fs_iterator *it)
 				goto end;
 			}
 		} while (!stream && ret != BT_NOTIFICATION_ITERATOR_STATUS_END);
-		/*
-		 * Set NULL so the destruction callback registered with the
-		 * array is not invoked on the stream (its ownership was
-		 * transferred to the streams hashtable).
-		 */
-		g_ptr_array_index(it->pending_streams,
-				pending_stream_index) = NULL;
 		g_ptr_array_remove_index(it->pending_streams,
 				pending_stream_index);
 	}
@@ -348,12 +536,104 @@ end:
 	return ret;
 }
 
+enum bt_notification_iterator_status ctf_fs_iterator_next_batch(
+		struct bt_notification_iterator *iterator,
+		struct bt_notification **notifications, size_t capacity,
+		size_t *count)
+{
+	size_t i;
+	enum bt_notification_iterator_status ret =
+			BT_NOTIFICATION_ITERATOR_STATUS_OK;
+	struct ctf_fs_iterator *ctf_it =
+			bt_notification_iterator_get_private_data(iterator);
+
+	for (i = 0; i < capacity; i++) {
+		ret = ctf_fs_iterator_next(iterator);
+		if (ret != BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+			break;
+		}
+
+		/* Hand the iterator's reference over to the caller. */
+		notifications[i] = ctf_it->current_notification;
+		ctf_it->current_notification = NULL;
+		if (!notifications[i]) {
+			ret = BT_NOTIFICATION_ITERATOR_STATUS_ERROR;
+			break;
+		}
+	}
+
+	*count = i;
+	return ret;
+}
+
+enum bt_notification_iterator_status ctf_fs_iterator_seek_time(
+		struct bt_notification_iterator *iterator, int64_t time)
+{
+	size_t i;
+	struct bt_notification_heap *pending_notifications;
+	enum bt_notification_iterator_status ret =
+			BT_NOTIFICATION_ITERATOR_STATUS_OK;
+	struct ctf_fs_iterator *ctf_it =
+			bt_notification_iterator_get_private_data(iterator);
+
+	/* The streams are repositioned from this thread. */
+	ctf_fs_workers_stop(ctf_it);
+
+	/* Drop the notifications decoded before the seek. */
+	pending_notifications = bt_notification_heap_create_sort_key();
+	if (!pending_notifications) {
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_NOMEM;
+		goto end;
+	}
+
+	BT_MOVE(ctf_it->pending_notifications, pending_notifications);
+	BT_PUT(ctf_it->current_notification);
+	g_hash_table_remove_all(ctf_it->stream_ht);
+	if (!ctf_it->pending_streams) {
+		ctf_it->pending_streams = g_ptr_array_new();
+		if (!ctf_it->pending_streams) {
+			ret = BT_NOTIFICATION_ITERATOR_STATUS_NOMEM;
+			goto end;
+		}
+	}
+	g_ptr_array_set_size(ctf_it->pending_streams, 0);
+
+	/*
+	 * Position each stream on its packet containing "time"; the heap
+	 * is populated again on the next call to ctf_fs_iterator_next().
+	 */
+	for (i = 0; i < ctf_it->streams->len; i++) {
+		struct ctf_fs_stream *fs_stream =
+				g_ptr_array_index(ctf_it->streams, i);
+		struct ctf_fs_component *ctf_fs = fs_stream->file->ctf_fs;
+
+		/* Also for its parts, if any. */
+		fs_stream->seek.time = time;
+		fs_stream->seek.active = true;
+		if (ctf_fs_stream_seek_time(fs_stream, time)) {
+			PERR("Cannot seek stream file \"%s\"\n",
+					fs_stream->file->path->str);
+			ret = BT_NOTIFICATION_ITERATOR_STATUS_ERROR;
+			goto end;
+		}
+
+		g_ptr_array_add(ctf_it->pending_streams, fs_stream);
+	}
+
+	if (ctf_fs_workers_start(ctf_it)) {
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_ERROR;
+	}
+end:
+	return ret;
+}
+
 static
 void ctf_fs_iterator_destroy_data(struct ctf_fs_iterator *ctf_it)
 {
 	if (!ctf_it) {
 		return;
 	}
+	ctf_fs_workers_destroy(ctf_it);
 	bt_put(ctf_it->current_notification);
 	bt_put(ctf_it->pending_notifications);
 	if (ctf_it->pending_streams) {
@@ -362,6 +642,9 @@ void ctf_fs_iterator_destroy_data(struct ctf_fs_iterator *ctf_it)
 	if (ctf_it->stream_ht) {
 		g_hash_table_destroy(ctf_it->stream_ht);
 	}
+	if (ctf_it->streams) {
+		g_ptr_array_free(ctf_it->streams, TRUE);
+	}
 	g_free(ctf_it);
 }
 
@@ -372,127 +655,6 @@ void ctf_fs_iterator_destroy(struct bt_notification_iterator *it)
 	ctf_fs_iterator_destroy_data(data);
 }
 
-static
-bool compare_event_notifications(struct bt_notification *a,
-		struct bt_notification *b)
-{
-	int ret;
-	struct bt_ctf_clock_class *clock_class;
-	struct bt_ctf_clock_value *a_clock_value, *b_clock_value;
-	struct bt_ctf_stream_class *a_stream_class;
-	struct bt_ctf_stream *a_stream;
-	struct bt_ctf_event *a_event, *b_event;
-	struct bt_ctf_trace *trace;
-	int64_t a_ts, b_ts;
-
-	// FIXME - assumes only one clock
-	a_event = bt_notification_event_get_event(a);
-	b_event = bt_notification_event_get_event(b);
-	assert(a_event);
-	assert(b_event);
-
-	a_stream = bt_ctf_event_get_stream(a_event);
-	assert(a_stream);
-	a_stream_class = bt_ctf_stream_get_class(a_stream);
-	assert(a_stream_class);
-	trace = bt_ctf_stream_class_get_trace(a_stream_class);
-	assert(trace);
-
-	clock_class = bt_ctf_trace_get_clock_class(trace, 0);
-	a_clock_value = bt_ctf_event_get_clock_value(a_event, clock_class);
-	b_clock_value = bt_ctf_event_get_clock_value(b_event, clock_class);
-	assert(a_clock_value);
-	assert(b_clock_value);
-
-	ret = bt_ctf_clock_value_get_value_ns_from_epoch(a_clock_value, &a_ts);
-	assert(!ret);
-	ret = bt_ctf_clock_value_get_value_ns_from_epoch(b_clock_value, &b_ts);
-	assert(!ret);
-
-	bt_put(a_event);
-	bt_put(b_event);
-	bt_put(a_clock_value);
-	bt_put(b_clock_value);
-	bt_put(a_stream);
-	bt_put(a_stream_class);
-	bt_put(clock_class);
-	bt_put(trace);
-	return a_ts < b_ts;
-}
-
-static
-bool compare_notifications(struct bt_notification *a, struct bt_notification *b,
-		void *unused)
-{
-	static int notification_priorities[] = {
-		[BT_NOTIFICATION_TYPE_NEW_TRACE] = 0,
-		[BT_NOTIFICATION_TYPE_NEW_STREAM_CLASS] = 1,
-		[BT_NOTIFICATION_TYPE_NEW_EVENT_CLASS] = 2,
-		[BT_NOTIFICATION_TYPE_PACKET_BEGIN] = 3,
-		[BT_NOTIFICATION_TYPE_PACKET_END] = 4,
-		[BT_NOTIFICATION_TYPE_EVENT] = 5,
-		[BT_NOTIFICATION_TYPE_END_OF_TRACE] = 6,
-	};
-	int a_prio, b_prio;
-	enum bt_notification_type a_type, b_type;
-
-	assert(a && b);
-	a_type = bt_notification_get_type(a);
-	b_type = bt_notification_get_type(b);
-	assert(a_type > BT_NOTIFICATION_TYPE_ALL);
-	assert(a_type < BT_NOTIFICATION_TYPE_NR);
-	assert(b_type > BT_NOTIFICATION_TYPE_ALL);
-	assert(b_type < BT_NOTIFICATION_TYPE_NR);
-
-	a_prio = notification_priorities[a_type];
-	b_prio = notification_priorities[b_type];
-
-	if (likely((a_type == b_type) && a_type == BT_NOTIFICATION_TYPE_EVENT)) {
-		return compare_event_notifications(a, b);
-	}
-
-	if (unlikely(a_prio != b_prio)) {
-		return a_prio < b_prio;
-	}
-
-	/* Notification types are equal, but not of type "event". */
-	switch (a_type) {
-	case BT_NOTIFICATION_TYPE_PACKET_BEGIN:
-	case BT_NOTIFICATION_TYPE_PACKET_END:
-	case BT_NOTIFICATION_TYPE_STREAM_END:
-	{
-		int64_t a_sc_id, b_sc_id;
-		struct bt_ctf_stream *a_stream, *b_stream;
-		struct bt_ctf_stream_class *a_sc, *b_sc;
-
-		a_stream = internal_bt_notification_get_stream(a);
-		b_stream = internal_bt_notification_get_stream(b);
-		assert(a_stream && b_stream);
-
-		a_sc = bt_ctf_stream_get_class(a_stream);
-		b_sc = bt_ctf_stream_get_class(b_stream);
-		assert(a_sc && b_sc);
-
-		a_sc_id = bt_ctf_stream_class_get_id(a_sc);
-		b_sc_id = bt_ctf_stream_class_get_id(b_sc);
-		assert(a_sc_id >= 0 && b_sc_id >= 0);
-		bt_put(a_sc);
-		bt_put(a_stream);
-		bt_put(b_sc);
-		bt_put(b_stream);
-		return a_sc_id < b_sc_id;
-	}
-	case BT_NOTIFICATION_TYPE_NEW_TRACE:
-	case BT_NOTIFICATION_TYPE_END_OF_TRACE:
-		/* Impossible to have two separate traces. */
-	default:
-		assert(0);
-	}
-
-	assert(0);
-	return a < b;
-}
-
 static
 void stream_destroy(void *stream)
 {
@@ -548,8 +710,8 @@ int open_trace_streams(struct ctf_fs_component *ctf_fs,
 			continue;
 		}
 
-		/* Open the file. */
-		if (ctf_fs_file_open(ctf_fs, file, "rb")) {
+		/* Opened when first mapped. */
+		if (ctf_fs_file_stat(ctf_fs, file)) {
 			ctf_fs_file_destroy(file);
 			goto error;
 		}
@@ -567,6 +729,7 @@ int open_trace_streams(struct ctf_fs_component *ctf_fs,
 			goto error;
 		}
 
+		g_ptr_array_add(ctf_it->streams, stream);
 		g_ptr_array_add(ctf_it->pending_streams, stream);
 	}
 
@@ -584,6 +747,39 @@ end:
 	return ret;
 }
 
+/*
+ * The first event created out of an event class validates it and may
+ * replace the field types of its class and stream class. Do it now for
+ * all the event classes of the trace, so that the decoding threads only
+ * take the event creation path which leaves the classes untouched.
+ */
+static
+void prepare_event_classes(struct ctf_fs_component *ctf_fs)
+{
+	int i, j, sc_count;
+	struct bt_ctf_trace *trace = ctf_fs->metadata->trace;
+
+	sc_count = bt_ctf_trace_get_stream_class_count(trace);
+	for (i = 0; i < sc_count; i++) {
+		int ec_count;
+		struct bt_ctf_stream_class *stream_class =
+			bt_ctf_trace_get_stream_class(trace, i);
+
+		ec_count = bt_ctf_stream_class_get_event_class_count(
+				stream_class);
+		for (j = 0; j < ec_count; j++) {
+			struct bt_ctf_event_class *event_class =
+				bt_ctf_stream_class_get_event_class(
+					stream_class, j);
+
+			bt_put(bt_ctf_event_create(event_class));
+			bt_put(event_class);
+		}
+
+		bt_put(stream_class);
+	}
+}
+
 enum bt_notification_iterator_status ctf_fs_iterator_init(struct bt_component *source,
 		struct bt_notification_iterator *it,
 		UNUSED_VAR void *init_method_data)
@@ -606,18 +802,21 @@ enum bt_notification_iterator_status ctf_fs_iterator_init(struct bt_component *s
 		goto end;
 	}
 
+	ctf_it->streams = g_ptr_array_new_with_free_func(stream_destroy);
+	if (!ctf_it->streams) {
+		goto error;
+	}
 	ctf_it->stream_ht = g_hash_table_new_full(g_direct_hash,
-			g_direct_equal, bt_put, stream_destroy);
+			g_direct_equal, bt_put, NULL);
 	if (!ctf_it->stream_ht) {
 		goto error;
 	}
-	ctf_it->pending_streams = g_ptr_array_new_with_free_func(
-			stream_destroy);
+	ctf_it->pending_streams = g_ptr_array_new();
 	if (!ctf_it->pending_streams) {
 		goto error;
 	}
-	ctf_it->pending_notifications = bt_notification_heap_create(
-			compare_notifications, NULL);
+	ctf_it->pending_notifications =
+			bt_notification_heap_create_sort_key();
 	if (!ctf_it->pending_notifications) {
 		goto error;
 	}
@@ -627,6 +826,20 @@ enum bt_notification_iterator_status ctf_fs_iterator_init(struct bt_component *s
 		goto error;
 	}
 
+	if (ctf_fs->options.threads > 1) {
+		prepare_event_classes(ctf_fs);
+		ret = ctf_fs_workers_create(ctf_it, ctf_fs,
+				ctf_fs->options.threads);
+		if (ret) {
+			goto error;
+		}
+
+		ret = ctf_fs_workers_start(ctf_it);
+		if (ret) {
+			goto error;
+		}
+	}
+
 	ret = bt_notification_iterator_set_private_data(it, ctf_it);
 	if (ret) {
 		goto error;
@@ -653,6 +866,8 @@ void ctf_fs_destroy_data(struct ctf_fs_component *ctf_fs)
 		ctf_fs_metadata_fini(ctf_fs->metadata);
 		g_free(ctf_fs->metadata);
 	}
+	pthread_mutex_destroy(&ctf_fs->stream_lock);
+	pthread_mutex_destroy(&ctf_fs->files.lock);
 	g_free(ctf_fs);
 }
 
@@ -663,6 +878,23 @@ void ctf_fs_destroy(struct bt_component *component)
 	ctf_fs_destroy_data(data);
 }
 
+/*
+ * Half of the process's descriptors, leaving the others to the rest of
+ * the graph.
+ */
+static
+unsigned int get_default_max_open_files(void)
+{
+	struct rlimit limit;
+
+	if (getrlimit(RLIMIT_NOFILE, &limit) ||
+			limit.rlim_cur == RLIM_INFINITY) {
+		return 1024;
+	}
+
+	return MAX(MIN(limit.rlim_cur / 2, UINT_MAX), 1);
+}
+
 static
 struct ctf_fs_component *ctf_fs_create(struct bt_value *params)
 {
@@ -676,6 +908,10 @@ struct ctf_fs_component *ctf_fs_create(struct bt_value *params)
 		goto end;
 	}
 
+	pthread_mutex_init(&ctf_fs->stream_lock, NULL);
+	pthread_mutex_init(&ctf_fs->files.lock, NULL);
+	g_queue_init(&ctf_fs->files.open_files);
+
 	/* FIXME: should probably look for a source URI */
 	value = bt_value_map_get(params, "path");
 	if (!value || bt_value_is_null(value) || !bt_value_is_string(value)) {
@@ -691,6 +927,137 @@ struct ctf_fs_component *ctf_fs_create(struct bt_value *params)
 	if (!ctf_fs->trace_path) {
 		goto error;
 	}
+
+	BT_PUT(value);
+	value = bt_value_map_get(params, "write-index");
+	if (value) {
+		bool write_index;
+
+		if (!bt_value_is_bool(value)) {
+			goto error;
+		}
+
+		ret = bt_value_bool_get(value, &write_index);
+		if (ret != BT_VALUE_STATUS_OK) {
+			goto error;
+		}
+
+		ctf_fs->options.write_index = write_index;
+	}
+
+	BT_PUT(value);
+	value = bt_value_map_get(params, "threads");
+	if (value) {
+		int64_t threads;
+
+		if (!bt_value_is_integer(value)) {
+			goto error;
+		}
+
+		ret = bt_value_integer_get(value, &threads);
+		if (ret != BT_VALUE_STATUS_OK || threads < 0) {
+			goto error;
+		}
+
+		ctf_fs->options.threads = (unsigned int) threads;
+	}
+
+	BT_PUT(value);
+	ctf_fs->options.chunk_size = CTF_FS_CHUNK_SIZE;
+	value = bt_value_map_get(params, "chunk-size");
+	if (value) {
+		int64_t chunk_size;
+
+		if (!bt_value_is_integer(value)) {
+			goto error;
+		}
+
+		ret = bt_value_integer_get(value, &chunk_size);
+		if (ret != BT_VALUE_STATUS_OK || chunk_size <= 0) {
+			goto error;
+		}
+
+		ctf_fs->options.chunk_size = (uint64_t) chunk_size;
+	}
+
+	BT_PUT(value);
+	ctf_fs->options.max_open_files = get_default_max_open_files();
+	value = bt_value_map_get(params, "max-open-files");
+	if (value) {
+		int64_t max_open_files;
+
+		if (!bt_value_is_integer(value)) {
+			goto error;
+		}
+
+		ret = bt_value_integer_get(value, &max_open_files);
+		if (ret != BT_VALUE_STATUS_OK || max_open_files <= 0 ||
+				max_open_files > UINT_MAX) {
+			goto error;
+		}
+
+		ctf_fs->options.max_open_files = (unsigned int) max_open_files;
+	}
+
+	BT_PUT(value);
+	ctf_fs->options.max_mapped_size = sizeof(void *) >= 8 ?
+		(1024 * 1024 * 1024) : (256 * 1024 * 1024);
+	value = bt_value_map_get(params, "max-mapped-size");
+	if (value) {
+		int64_t max_mapped_size;
+
+		if (!bt_value_is_integer(value)) {
+			goto error;
+		}
+
+		ret = bt_value_integer_get(value, &max_mapped_size);
+		if (ret != BT_VALUE_STATUS_OK || max_mapped_size <= 0 ||
+				max_mapped_size > SIZE_MAX) {
+			goto error;
+		}
+
+		ctf_fs->options.max_mapped_size = (size_t) max_mapped_size;
+	}
+
+	BT_PUT(value);
+	value = bt_value_map_get(params, "io-backend");
+	if (value) {
+		const char *io_backend;
+
+		if (!bt_value_is_string(value)) {
+			goto error;
+		}
+
+		ret = bt_value_string_get(value, &io_backend);
+		if (ret != BT_VALUE_STATUS_OK) {
+			goto error;
+		}
+
+		if (!strcmp(io_backend, "mmap")) {
+			ctf_fs->options.io_backend = CTF_FS_IO_BACKEND_MMAP;
+		} else if (!strcmp(io_backend, "read")) {
+			ctf_fs->options.io_backend = CTF_FS_IO_BACKEND_READ;
+		} else {
+			goto error;
+		}
+	}
+
+	BT_PUT(value);
+	value = bt_value_map_get(params, "populate");
+	if (value) {
+		bool populate;
+
+		if (!bt_value_is_bool(value)) {
+			goto error;
+		}
+
+		ret = bt_value_bool_get(value, &populate);
+		if (ret != BT_VALUE_STATUS_OK) {
+			goto error;
+		}
+
+		ctf_fs->options.populate = populate;
+	}
 	ctf_fs->error_fp = stderr;
 	ctf_fs->page_size = (size_t) getpagesize();
 
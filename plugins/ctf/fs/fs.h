@@ -30,7 +30,9 @@
 
 #include <babeltrace/babeltrace-internal.h>
 #include <babeltrace/component/component.h>
+#include <pthread.h>
 #include "data-stream.h"
+#include "worker.h"
 
 #define CTF_FS_COMPONENT_DESCRIPTION \
 	"Component used to read a CTF trace located on a file system."
@@ -45,10 +47,22 @@ struct ctf_fs_file {
 	GString *path;
 	FILE *fp;
 	off_t size;
+	/*
+	 * Link in the component's open data stream files, whose data is
+	 * this file (NULL data if not linked).
+	 */
+	GList open_link;
+	/*
+	 * Number of threads using the open file without the files lock;
+	 * the file is not closed to open another one meanwhile.
+	 */
+	unsigned int pins;
 };
 
 struct ctf_fs_metadata {
 	struct bt_ctf_trace *trace;
+	/* Decoding tables of the trace, shared by its streams */
+	struct bt_ctf_notif_iter_decoder *decoder;
 	uint8_t uuid[16];
 	bool is_uuid_set;
 	int bo;
@@ -58,11 +72,20 @@ struct ctf_fs_metadata {
 struct ctf_fs_stream {
 	struct ctf_fs_file *file;
 	struct bt_ctf_stream *stream;
+	/* ID of the stream's class, valid once stream is created. */
+	int64_t stream_class_id;
 	/* FIXME There should be many and ctf_fs_stream should not own them. */
 	struct bt_ctf_notif_iter *notif_iter;
 	/* A stream is assumed to be indexed. */
 	struct index index;
+	/*
+	 * Current mapping, or "read_buf" holding the current window with
+	 * the "read" I/O backend.
+	 */
 	void *mmap_addr;
+	/* Buffer reused by the windows read with the "read" I/O backend. */
+	uint8_t *read_buf;
+	size_t read_buf_size;
 	/* Max length of chunk to mmap() when updating the current mapping. */
 	size_t mmap_max_len;
 	/* Length of the current mapping. */
@@ -76,10 +99,44 @@ struct ctf_fs_stream {
 	 * request.
 	 */
 	off_t request_offset;
+	/* Offset in the file of the next packet to decode. */
+	off_t packet_offset;
+	/*
+	 * Offset in the file where the decoding stops: its size, or the
+	 * end of the chunk of packets decoded by a part.
+	 */
+	off_t end_offset;
+	/* Events decoded so far from the current packet. */
+	uint64_t packet_event_count;
 	bool end_reached;
+	/* Events prior to this time (ns from Epoch) are skipped after a seek. */
+	struct {
+		int64_t time;
+		bool active;
+	} seek;
+	/* Decoding thread of this stream, NULL if decoded on demand. */
+	struct ctf_fs_worker *worker;
+	/* Notifications decoded ahead by the worker. */
+	struct ctf_fs_ring ring;
+	/*
+	 * With packet-parallel decoding, struct ctf_fs_stream* (owned by
+	 * this): part i decodes chunks i, i + parts->len, and so on, and
+	 * this stream decodes nothing itself. NULL otherwise.
+	 */
+	GPtrArray *parts;
+	/* Index of the first packet of each chunk, then the packet count. */
+	GArray *chunks;
+	/* Part decoding the chunk being consumed. */
+	unsigned int current_part;
+	/* Stream this part belongs to, NULL if not a part. */
+	struct ctf_fs_stream *parent;
+	/* Chunk decoded by this part. */
+	unsigned int chunk;
 };
 
 struct ctf_fs_iterator {
+	/* struct ctf_fs_stream* (owned by this) */
+	GPtrArray *streams;
 	struct bt_notification_heap *pending_notifications;
 	struct bt_notification *current_notification;
 	/*
@@ -91,10 +148,35 @@ struct ctf_fs_iterator {
 	GPtrArray *pending_streams;
 	/* bt_ctf_stream -> ctf_fs_stream */
 	GHashTable *stream_ht;
+	/*
+	 * struct ctf_fs_worker* (owned by this), NULL if the streams are
+	 * decoded on demand by the iterator's thread.
+	 */
+	GPtrArray *workers;
+};
+
+enum ctf_fs_io_backend {
+	/* Data stream files are mapped. */
+	CTF_FS_IO_BACKEND_MMAP,
+	/* Data stream files are read into a buffer per stream. */
+	CTF_FS_IO_BACKEND_READ,
 };
 
 struct ctf_fs_component_options {
 	bool opt_dummy : 1;
+	/* Write index/name.idx files for streams which lack one. */
+	bool write_index : 1;
+	/* Number of threads decoding the streams; 0 or 1: none. */
+	unsigned int threads;
+	/* Approximate size of the chunks of packets of a stream's parts */
+	uint64_t chunk_size;
+	/* Data stream files open at once */
+	unsigned int max_open_files;
+	/* Total size of the data stream mappings or buffers (bytes) */
+	size_t max_mapped_size;
+	enum ctf_fs_io_backend io_backend;
+	/* Map the windows with MAP_POPULATE, where available. */
+	bool populate : 1;
 };
 
 struct ctf_fs_component {
@@ -103,8 +185,30 @@ struct ctf_fs_component {
 	size_t page_size;
 	struct ctf_fs_component_options options;
 	struct ctf_fs_metadata *metadata;
+	/* Serializes the creation of the trace's streams by the workers. */
+	pthread_mutex_t stream_lock;
+	/*
+	 * Data stream files are only opened to map or read them, and
+	 * closed, least recently used first, to keep at most
+	 * "options.max_open_files" open, unless they are pinned by a
+	 * thread mapping or reading them. Their mapping windows shrink as
+	 * streams are added so that they map about
+	 * "options.max_mapped_size" bytes together.
+	 */
+	struct {
+		/* Protects open_files and the files' "fp" and "pins". */
+		pthread_mutex_t lock;
+		/* struct ctf_fs_file*, most recently used first */
+		GQueue open_files;
+		unsigned int stream_count;
+	} files;
 };
 
+BT_HIDDEN
+enum bt_notification_iterator_status ctf_fs_stream_decode_next_notification(
+		struct ctf_fs_stream *stream,
+		struct bt_notification **notification);
+
 BT_HIDDEN
 enum bt_component_status ctf_fs_init(struct bt_component *source,
 		struct bt_value *params, void *init_method_data);
@@ -126,6 +230,14 @@ enum bt_notification_iterator_status ctf_fs_iterator_next(
 struct bt_notification *ctf_fs_iterator_get(
 		struct bt_notification_iterator *iterator);
 
+enum bt_notification_iterator_status ctf_fs_iterator_next_batch(
+		struct bt_notification_iterator *iterator,
+		struct bt_notification **notifications, size_t capacity,
+		size_t *count);
+
+enum bt_notification_iterator_status ctf_fs_iterator_seek_time(
+		struct bt_notification_iterator *iterator, int64_t time);
+
 BT_HIDDEN
 struct bt_value *ctf_fs_query(struct bt_component_class *comp_class,
 		const char *object, struct bt_value *params);
@@ -404,6 +404,13 @@ void ctf_fs_metadata_set_trace(struct ctf_fs_component *ctf_fs)
 		goto error;
 	}
 
+	ctf_fs->metadata->decoder = bt_ctf_notif_iter_decoder_create(
+		ctf_fs->metadata->trace);
+	if (!ctf_fs->metadata->decoder) {
+		PERR("Cannot create the trace's decoding tables\n");
+		goto error;
+	}
+
 	goto end;
 
 error:
@@ -434,6 +441,9 @@ void ctf_fs_metadata_fini(struct ctf_fs_metadata *metadata)
 		free(metadata->text);
 	}
 
+	bt_ctf_notif_iter_decoder_destroy(metadata->decoder);
+	metadata->decoder = NULL;
+
 	if (metadata->trace) {
 		BT_PUT(metadata->trace);
 	}
@@ -0,0 +1,424 @@
+/*
+ * Copyright 2026 - agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include <glib.h>
+#include <babeltrace/ref.h>
+
+#define PRINT_ERR_STREAM	ctf_fs->error_fp
+#define PRINT_PREFIX		"ctf-fs-worker"
+#include "print.h"
+
+#include "fs.h"
+#include "data-stream.h"
+#include "worker.h"
+
+static
+bool ring_has_room(struct ctf_fs_ring *ring)
+{
+	return !ring->done &&
+		!bt_notification_ring_is_full(&ring->notifications);
+}
+
+/*
+ * Decodes the next notification of a stream into its ring. Returns
+ * false if there's no room for it.
+ */
+static
+bool decode_next_notification(struct ctf_fs_worker *worker,
+		struct ctf_fs_stream *stream)
+{
+	struct ctf_fs_ring *ring = &stream->ring;
+	struct bt_notification_ring_item *item;
+
+	if (!ring_has_room(ring)) {
+		return false;
+	}
+
+	item = bt_notification_ring_tail(&ring->notifications);
+	item->notification = NULL;
+	item->status = ctf_fs_stream_decode_next_notification(stream,
+			&item->notification);
+	if (item->status != BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+		BT_PUT(item->notification);
+		ring->done = true;
+	}
+
+	bt_notification_ring_push(&ring->notifications, &worker->sync);
+	return true;
+}
+
+/* Whether the worker must sleep: it is not stopped and all its rings are full. */
+static
+bool worker_must_wait(void *data)
+{
+	struct ctf_fs_worker *worker = data;
+	size_t i;
+
+	if (__atomic_load_n(&worker->stop, __ATOMIC_SEQ_CST)) {
+		return false;
+	}
+
+	for (i = 0; i < worker->streams->len; i++) {
+		if (ring_has_room(&((struct ctf_fs_stream *)
+				g_ptr_array_index(worker->streams, i))->ring)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Decodes the worker's streams in a round-robin fashion, one
+ * notification at a time, until they all reached their end, sleeping
+ * while all their rings are full.
+ */
+static
+void *worker_thread(void *data)
+{
+	struct ctf_fs_worker *worker = data;
+
+	while (!__atomic_load_n(&worker->stop, __ATOMIC_SEQ_CST)) {
+		size_t i;
+		bool progress = false;
+		bool all_done = true;
+
+		for (i = 0; i < worker->streams->len; i++) {
+			struct ctf_fs_stream *stream =
+				g_ptr_array_index(worker->streams, i);
+
+			progress |= decode_next_notification(worker, stream);
+			all_done &= stream->ring.done;
+		}
+
+		if (all_done) {
+			break;
+		}
+
+		if (progress) {
+			continue;
+		}
+
+		bt_notification_ring_wait_space(&worker->sync,
+				worker_must_wait, worker);
+	}
+
+	return NULL;
+}
+
+static
+enum bt_notification_iterator_status pop_notification(
+		struct ctf_fs_stream *stream,
+		struct bt_notification **notification)
+{
+	struct ctf_fs_ring *ring = &stream->ring;
+	struct bt_notification_ring_item *item;
+	enum bt_notification_iterator_status status;
+
+	*notification = NULL;
+	if (ring->end_status != BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+		/* The worker is done with this stream. */
+		status = ring->end_status;
+		goto end;
+	}
+
+	bt_notification_ring_wait_data(&ring->notifications,
+			&stream->worker->sync);
+	item = bt_notification_ring_head(&ring->notifications);
+	*notification = item->notification;
+	status = item->status;
+	ring->end_status = status;
+	bt_notification_ring_pop(&ring->notifications, &stream->worker->sync);
+end:
+	return status;
+}
+
+BT_HIDDEN
+enum bt_notification_iterator_status ctf_fs_worker_pop_notification(
+		struct ctf_fs_stream *stream,
+		struct bt_notification **notification)
+{
+	enum bt_notification_iterator_status status;
+
+	if (!stream->parts) {
+		return pop_notification(stream, notification);
+	}
+
+	for (;;) {
+		struct ctf_fs_stream *part = g_ptr_array_index(stream->parts,
+				stream->current_part);
+
+		status = pop_notification(part, notification);
+		if (status != BT_NOTIFICATION_ITERATOR_STATUS_OK ||
+				*notification) {
+			break;
+		}
+
+		/* End of the part's chunk: the next one is the next part's. */
+		stream->current_part = (stream->current_part + 1) %
+				stream->parts->len;
+	}
+
+	return status;
+}
+
+static
+void worker_destroy(void *data)
+{
+	struct ctf_fs_worker *worker = data;
+
+	if (!worker) {
+		return;
+	}
+
+	assert(!worker->running);
+	if (worker->streams) {
+		g_ptr_array_free(worker->streams, TRUE);
+	}
+	bt_notification_ring_sync_fini(&worker->sync);
+	g_free(worker);
+}
+
+static
+struct ctf_fs_worker *worker_create(struct ctf_fs_component *ctf_fs)
+{
+	struct ctf_fs_worker *worker = g_new0(struct ctf_fs_worker, 1);
+
+	if (!worker) {
+		goto end;
+	}
+
+	worker->ctf_fs = ctf_fs;
+	bt_notification_ring_sync_init(&worker->sync);
+	worker->streams = g_ptr_array_new();
+	if (!worker->streams) {
+		worker_destroy(worker);
+		worker = NULL;
+	}
+end:
+	return worker;
+}
+
+static
+int assign_stream(struct ctf_fs_iterator *it, struct ctf_fs_stream *stream,
+		size_t capacity, size_t *next_worker)
+{
+	if (bt_notification_ring_init(&stream->ring.notifications, capacity)) {
+		return -1;
+	}
+
+	stream->ring.end_status = BT_NOTIFICATION_ITERATOR_STATUS_OK;
+	stream->worker = g_ptr_array_index(it->workers,
+			(*next_worker)++ % it->workers->len);
+	g_ptr_array_add(stream->worker->streams, stream);
+	return 0;
+}
+
+BT_HIDDEN
+int ctf_fs_workers_create(struct ctf_fs_iterator *it,
+		struct ctf_fs_component *ctf_fs, unsigned int nr_threads)
+{
+	int ret = 0;
+	size_t i, j;
+	size_t nr_decoders = 0, next_worker = 0;
+	unsigned int nr_parts;
+
+	assert(!it->workers);
+	if (it->streams->len == 0) {
+		goto end;
+	}
+
+	/* Spare threads decode parts of the streams in parallel. */
+	nr_parts = nr_threads / it->streams->len;
+	for (i = 0; i < it->streams->len; i++) {
+		struct ctf_fs_stream *stream =
+			g_ptr_array_index(it->streams, i);
+
+		if (nr_parts > 1 && ctf_fs_stream_split(stream, nr_parts)) {
+			goto error;
+		}
+
+		nr_decoders += stream->parts ? stream->parts->len : 1;
+	}
+
+	if (nr_threads > nr_decoders) {
+		nr_threads = nr_decoders;
+	}
+
+	if (nr_threads == 0) {
+		goto end;
+	}
+
+	it->workers = g_ptr_array_new_with_free_func(worker_destroy);
+	if (!it->workers) {
+		goto error;
+	}
+
+	for (i = 0; i < nr_threads; i++) {
+		struct ctf_fs_worker *worker = worker_create(ctf_fs);
+
+		if (!worker) {
+			goto error;
+		}
+
+		g_ptr_array_add(it->workers, worker);
+	}
+
+	for (i = 0; i < it->streams->len; i++) {
+		struct ctf_fs_stream *stream =
+			g_ptr_array_index(it->streams, i);
+
+		if (!stream->parts) {
+			if (assign_stream(it, stream, CTF_FS_RING_CAPACITY,
+					&next_worker)) {
+				goto error;
+			}
+			continue;
+		}
+
+		for (j = 0; j < stream->parts->len; j++) {
+			if (assign_stream(it, g_ptr_array_index(stream->parts, j),
+					CTF_FS_PART_RING_CAPACITY,
+					&next_worker)) {
+				goto error;
+			}
+		}
+	}
+
+	PDBG("Decoding %u streams with %u threads\n", it->streams->len,
+			nr_threads);
+	goto end;
+error:
+	PERR("Cannot create decoding threads\n");
+	ctf_fs_workers_destroy(it);
+	ret = -1;
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int ctf_fs_workers_start(struct ctf_fs_iterator *it)
+{
+	int ret = 0;
+	size_t i;
+
+	if (!it->workers) {
+		goto end;
+	}
+
+	/* The decoded objects are handed over to the iterator's thread. */
+	bt_ref_enable_thread_safety();
+
+	for (i = 0; i < it->workers->len; i++) {
+		struct ctf_fs_worker *worker =
+			g_ptr_array_index(it->workers, i);
+		struct ctf_fs_component *ctf_fs = worker->ctf_fs;
+
+		assert(!worker->running);
+		worker->stop = 0;
+		ret = pthread_create(&worker->thread, NULL, worker_thread,
+				worker);
+		if (ret) {
+			PERR("Cannot create decoding thread: %s\n",
+					strerror(ret));
+			ctf_fs_workers_stop(it);
+			ret = -1;
+			goto end;
+		}
+
+		worker->running = true;
+	}
+end:
+	return ret;
+}
+
+BT_HIDDEN
+void ctf_fs_workers_stop(struct ctf_fs_iterator *it)
+{
+	size_t i, j;
+
+	if (!it->workers) {
+		return;
+	}
+
+	for (i = 0; i < it->workers->len; i++) {
+		struct ctf_fs_worker *worker =
+			g_ptr_array_index(it->workers, i);
+
+		if (!worker->running) {
+			continue;
+		}
+
+		__atomic_store_n(&worker->stop, 1, __ATOMIC_SEQ_CST);
+		bt_notification_ring_wake_producer(&worker->sync);
+		pthread_join(worker->thread, NULL);
+		worker->running = false;
+	}
+
+	/* Drop what was decoded ahead of the consumer. */
+	for (i = 0; i < it->workers->len; i++) {
+		struct ctf_fs_worker *worker =
+			g_ptr_array_index(it->workers, i);
+
+		for (j = 0; j < worker->streams->len; j++) {
+			struct ctf_fs_stream *stream =
+				g_ptr_array_index(worker->streams, j);
+			struct ctf_fs_ring *ring = &stream->ring;
+
+			bt_notification_ring_reset(&ring->notifications);
+			ring->done = false;
+			ring->end_status = BT_NOTIFICATION_ITERATOR_STATUS_OK;
+		}
+	}
+}
+
+BT_HIDDEN
+void ctf_fs_workers_destroy(struct ctf_fs_iterator *it)
+{
+	size_t i, j;
+
+	if (!it->workers) {
+		return;
+	}
+
+	ctf_fs_workers_stop(it);
+
+	for (i = 0; i < it->workers->len; i++) {
+		struct ctf_fs_worker *worker =
+			g_ptr_array_index(it->workers, i);
+
+		for (j = 0; j < worker->streams->len; j++) {
+			struct ctf_fs_stream *stream =
+				g_ptr_array_index(worker->streams, j);
+
+			bt_notification_ring_fini(&stream->ring.notifications);
+			stream->worker = NULL;
+		}
+	}
+
+	g_ptr_array_free(it->workers, TRUE);
+	it->workers = NULL;
+}
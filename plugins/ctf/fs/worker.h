@@ -0,0 +1,105 @@
+#ifndef CTF_FS_WORKER_H
+#define CTF_FS_WORKER_H
+
+/*
+ * Copyright 2026 - agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <glib.h>
+#include <babeltrace/babeltrace-internal.h>
+#include <babeltrace/component/notification/iterator.h>
+#include <babeltrace/component/notification/ring-internal.h>
+
+struct ctf_fs_component;
+struct ctf_fs_iterator;
+struct ctf_fs_stream;
+
+/* Number of notifications a worker may decode ahead, per stream. */
+#define CTF_FS_RING_CAPACITY	256
+
+/*
+ * Same, per part of a stream decoded in parallel: a part decodes its
+ * next chunk while the chunks of the other parts are consumed.
+ */
+#define CTF_FS_PART_RING_CAPACITY	4096
+
+/*
+ * Decoded notifications of a stream, from its worker (the producer) to
+ * the iterator's thread (the consumer). The status of an item is
+ * anything but OK for the last item of the stream; OK without a
+ * notification ends the chunk of a part.
+ */
+struct ctf_fs_ring {
+	struct bt_notification_ring notifications;
+	/* The last item was pushed; only accessed by the producer. */
+	bool done;
+	/* Status of the last item, once popped; only accessed by the consumer. */
+	enum bt_notification_iterator_status end_status;
+};
+
+/* Thread decoding a subset of the iterator's streams. */
+struct ctf_fs_worker {
+	struct ctf_fs_component *ctf_fs;
+	pthread_t thread;
+	bool running;
+	/* struct ctf_fs_stream* (weak) */
+	GPtrArray *streams;
+	/* Shared by the rings of the streams */
+	struct bt_notification_ring_sync sync;
+	int stop;
+};
+
+/*
+ * Creates at most "nr_threads" workers and assigns the iterator's streams
+ * to them. With more threads than streams, the streams are split in
+ * parts decoded by different workers. The workers are not started.
+ */
+BT_HIDDEN
+int ctf_fs_workers_create(struct ctf_fs_iterator *it,
+		struct ctf_fs_component *ctf_fs, unsigned int nr_threads);
+
+BT_HIDDEN
+int ctf_fs_workers_start(struct ctf_fs_iterator *it);
+
+/*
+ * Stops and joins the workers, dropping the notifications they decoded
+ * ahead. The streams may then be repositioned and the workers started
+ * again.
+ */
+BT_HIDDEN
+void ctf_fs_workers_stop(struct ctf_fs_iterator *it);
+
+BT_HIDDEN
+void ctf_fs_workers_destroy(struct ctf_fs_iterator *it);
+
+/*
+ * Pops the next notification of a stream, waiting for its worker, or
+ * for the worker of the part decoding its current chunk.
+ */
+BT_HIDDEN
+enum bt_notification_iterator_status ctf_fs_worker_pop_notification(
+		struct ctf_fs_stream *stream,
+		struct bt_notification **notification);
+
+#endif /* CTF_FS_WORKER_H */
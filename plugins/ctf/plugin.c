@@ -46,6 +46,10 @@ BT_PLUGIN_SOURCE_COMPONENT_CLASS_NOTIFICATION_ITERATOR_INIT_METHOD(fs,
 	ctf_fs_iterator_init);
 BT_PLUGIN_SOURCE_COMPONENT_CLASS_NOTIFICATION_ITERATOR_DESTROY_METHOD(fs,
 	ctf_fs_iterator_destroy);
+BT_PLUGIN_SOURCE_COMPONENT_CLASS_NOTIFICATION_ITERATOR_SEEK_TIME_METHOD(fs,
+	ctf_fs_iterator_seek_time);
+BT_PLUGIN_SOURCE_COMPONENT_CLASS_NOTIFICATION_ITERATOR_NEXT_BATCH_METHOD(fs,
+	ctf_fs_iterator_next_batch);
 
 BT_PLUGIN_SOURCE_COMPONENT_CLASS_WITH_ID(auto, lttng_live, "lttng-live",
 	lttng_live_iterator_get, lttng_live_iterator_next);
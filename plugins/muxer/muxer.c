@@ -29,10 +29,19 @@
 #include <babeltrace/plugin/plugin-dev.h>
 #include <babeltrace/component/component.h>
 #include <babeltrace/component/component-filter.h>
+#include <babeltrace/component/port.h>
+#include <babeltrace/component/connection.h>
 #include <babeltrace/component/notification/notification.h>
 #include <babeltrace/component/notification/iterator.h>
 #include <babeltrace/component/notification/event.h>
+#include <babeltrace/ctf-ir/event.h>
+#include <babeltrace/ctf-ir/stream.h>
+#include <babeltrace/ctf-ir/stream-class.h>
+#include <babeltrace/ctf-ir/clock-class.h>
+#include <babeltrace/ctf-ir/trace.h>
 #include <plugins-common.h>
+#include <inttypes.h>
+#include <assert.h>
 #include "muxer.h"
 
 static
@@ -62,6 +71,60 @@ void destroy_muxer(struct bt_component *component)
 	destroy_muxer_data(data);
 }
 
+/*
+ * The default input port always exists; the "input-port-count"
+ * parameter, if set, adds ports named "input-1" to "input-(N-1)" so
+ * that one upstream component can be connected to each of them.
+ */
+static
+enum bt_component_status init_input_ports(struct muxer *muxer,
+		struct bt_component *component, struct bt_value *params)
+{
+	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
+	struct bt_value *value = NULL;
+	GString *port_name = NULL;
+	int64_t count = 1;
+	uint64_t i;
+
+	value = bt_value_map_get(params, "input-port-count");
+	if (value) {
+		if (!bt_value_is_integer(value) ||
+				bt_value_integer_get(value, &count) ||
+				count < 1) {
+			printf_error("Invalid \"input-port-count\" parameter: expecting a strictly positive integer");
+			ret = BT_COMPONENT_STATUS_INVALID;
+			goto end;
+		}
+	}
+
+	port_name = g_string_new(NULL);
+	if (!port_name) {
+		ret = BT_COMPONENT_STATUS_NOMEM;
+		goto end;
+	}
+
+	for (i = 1; i < (uint64_t) count; i++) {
+		struct bt_port *port;
+
+		g_string_printf(port_name, "input-%" PRIu64, i);
+		port = bt_component_filter_add_input_port(component,
+				port_name->str);
+		if (!port) {
+			ret = BT_COMPONENT_STATUS_ERROR;
+			goto end;
+		}
+		bt_put(port);
+	}
+
+	muxer->input_port_count = (uint64_t) count;
+end:
+	if (port_name) {
+		g_string_free(port_name, TRUE);
+	}
+	bt_put(value);
+	return ret;
+}
+
 enum bt_component_status muxer_component_init(
 	struct bt_component *component, struct bt_value *params,
 	UNUSED_VAR void *init_method_data)
@@ -78,6 +141,8 @@ enum bt_component_status muxer_component_init(
 	if (ret != BT_COMPONENT_STATUS_OK) {
 		goto error;
 	}
+
+	ret = init_input_ports(muxer, component, params);
 end:
 	return ret;
 error:
@@ -86,17 +151,405 @@ error:
 }
 
 static
+void muxer_iterator_destroy_data(struct muxer_iterator *muxer_it)
+{
+	if (!muxer_it) {
+		return;
+	}
+
+	if (muxer_it->upstreams) {
+		guint i;
+
+		for (i = 0; i < muxer_it->upstreams->len; i++) {
+			struct muxer_upstream *upstream = &g_array_index(
+					muxer_it->upstreams,
+					struct muxer_upstream, i);
+
+			bt_put(upstream->notification);
+			bt_put(upstream->iterator);
+		}
+		g_array_free(muxer_it->upstreams, TRUE);
+	}
+	bt_put(muxer_it->current_notification);
+	g_free(muxer_it->tree);
+	g_free(muxer_it);
+}
+
+BT_HIDDEN
+void muxer_iterator_destroy(struct bt_notification_iterator *iterator)
+{
+	void *data = bt_notification_iterator_get_private_data(iterator);
+
+	muxer_iterator_destroy_data(data);
+}
+
+/*
+ * Creates an iterator on each connection of an input port. A port
+ * whose connections cannot be listed, or an upstream iterator which
+ * cannot be created (its initialization failed), is an error.
+ */
+static
+enum bt_notification_iterator_status add_port_upstreams(
+		struct muxer_iterator *muxer_it, struct bt_port *port)
+{
+	enum bt_notification_iterator_status ret =
+			BT_NOTIFICATION_ITERATOR_STATUS_OK;
+	uint64_t i, count;
+
+	if (bt_port_get_connection_count(port, &count) != BT_PORT_STATUS_OK) {
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_ERROR;
+		goto end;
+	}
+
+	for (i = 0; i < count; i++) {
+		struct bt_connection *connection;
+		struct muxer_upstream upstream = {
+			.ts = INT64_MIN,
+		};
+
+		connection = bt_port_get_connection(port, (int) i);
+		if (!connection) {
+			ret = BT_NOTIFICATION_ITERATOR_STATUS_ERROR;
+			goto end;
+		}
+
+		upstream.iterator = bt_connection_create_notification_iterator(
+				connection);
+		bt_put(connection);
+		if (!upstream.iterator) {
+			ret = BT_NOTIFICATION_ITERATOR_STATUS_ERROR;
+			goto end;
+		}
+
+		g_array_append_val(muxer_it->upstreams, upstream);
+	}
+end:
+	return ret;
+}
+
+BT_HIDDEN
+enum bt_notification_iterator_status muxer_iterator_init(
+		struct bt_component *component,
+		struct bt_notification_iterator *iterator,
+		UNUSED_VAR void *init_method_data)
+{
+	enum bt_notification_iterator_status ret =
+			BT_NOTIFICATION_ITERATOR_STATUS_OK;
+	struct muxer_iterator *muxer_it;
+	uint64_t i, port_count;
+
+	muxer_it = g_new0(struct muxer_iterator, 1);
+	if (!muxer_it) {
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_NOMEM;
+		goto end;
+	}
+
+	muxer_it->upstreams = g_array_new(FALSE, TRUE,
+			sizeof(struct muxer_upstream));
+	if (!muxer_it->upstreams) {
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_NOMEM;
+		goto error;
+	}
+
+	if (bt_component_filter_get_input_port_count(component,
+			&port_count) != BT_COMPONENT_STATUS_OK) {
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_ERROR;
+		goto error;
+	}
+
+	/* Create one iterator per upstream connection, in port order. */
+	for (i = 0; i < port_count; i++) {
+		struct bt_port *port;
+
+		port = bt_component_filter_get_input_port_at_index(component,
+				(int) i);
+		if (!port) {
+			ret = BT_NOTIFICATION_ITERATOR_STATUS_ERROR;
+			goto error;
+		}
+
+		ret = add_port_upstreams(muxer_it, port);
+		bt_put(port);
+		if (ret != BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+			goto error;
+		}
+	}
+
+	muxer_it->tree = g_new0(guint, MAX(muxer_it->upstreams->len, 1));
+	if (!muxer_it->tree) {
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_NOMEM;
+		goto error;
+	}
+
+	ret = bt_notification_iterator_set_private_data(iterator, muxer_it);
+	if (ret) {
+		goto error;
+	}
+end:
+	return ret;
+error:
+	muxer_iterator_destroy_data(muxer_it);
+	goto end;
+}
+
+BT_HIDDEN
 struct bt_notification *muxer_iterator_get(
 		struct bt_notification_iterator *iterator)
 {
-	return NULL;
+	struct muxer_iterator *muxer_it;
+
+	muxer_it = bt_notification_iterator_get_private_data(iterator);
+	assert(muxer_it);
+
+	if (!muxer_it->current_notification) {
+		enum bt_notification_iterator_status it_ret;
+
+		it_ret = muxer_iterator_next(iterator);
+		if (it_ret) {
+			goto end;
+		}
+	}
+end:
+	return bt_get(muxer_it->current_notification);
 }
 
+/*
+ * Fallback for event notifications created without a sort key: the
+ * event's value of its trace's first clock class, which is also the
+ * clock class that the CTF sources base their sort keys on.
+ */
+static
+int get_event_notification_clock_ts(struct bt_notification *notification,
+		int64_t *ts)
+{
+	int ret = -1;
+	struct bt_ctf_event *event = NULL;
+	struct bt_ctf_stream *stream = NULL;
+	struct bt_ctf_stream_class *stream_class = NULL;
+	struct bt_ctf_trace *trace = NULL;
+	struct bt_ctf_clock_class *clock_class = NULL;
+	struct bt_ctf_clock_value *clock_value = NULL;
+
+	event = bt_notification_event_get_event(notification);
+	assert(event);
+	stream = bt_ctf_event_get_stream(event);
+	assert(stream);
+	stream_class = bt_ctf_stream_get_class(stream);
+	assert(stream_class);
+	trace = bt_ctf_stream_class_get_trace(stream_class);
+	assert(trace);
+
+	clock_class = bt_ctf_trace_get_clock_class(trace, 0);
+	if (!clock_class) {
+		goto end;
+	}
+
+	clock_value = bt_ctf_event_get_clock_value(event, clock_class);
+	if (!clock_value) {
+		goto end;
+	}
+
+	ret = bt_ctf_clock_value_get_value_ns_from_epoch(clock_value, ts);
+end:
+	bt_put(clock_value);
+	bt_put(clock_class);
+	bt_put(trace);
+	bt_put(stream_class);
+	bt_put(stream);
+	bt_put(event);
+	return ret;
+}
+
+/*
+ * Uses the timestamp cached in the notification's sort key by its
+ * source, if any.
+ */
+static inline
+int get_event_notification_ts(struct bt_notification *notification,
+		int64_t *ts)
+{
+	if (likely(!bt_notification_get_sort_key(notification, ts, NULL))) {
+		return 0;
+	}
+
+	return get_event_notification_clock_ts(notification, ts);
+}
+
+/*
+ * Replace an upstream's notification by the next one of its iterator
+ * and update its sort key.
+ */
+static
+enum bt_notification_iterator_status muxer_upstream_advance(
+		struct muxer_upstream *upstream)
+{
+	enum bt_notification_iterator_status ret;
+
+	BT_PUT(upstream->notification);
+	ret = bt_notification_iterator_next(upstream->iterator);
+	if (ret == BT_NOTIFICATION_ITERATOR_STATUS_END) {
+		upstream->end_reached = true;
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_OK;
+		goto end;
+	} else if (ret != BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+		goto end;
+	}
+
+	upstream->notification = bt_notification_iterator_get_notification(
+			upstream->iterator);
+	if (!upstream->notification) {
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_ERROR;
+		goto end;
+	}
+
+	if (bt_notification_get_type(upstream->notification) ==
+			BT_NOTIFICATION_TYPE_EVENT) {
+		int64_t ts;
+
+		if (!get_event_notification_ts(upstream->notification, &ts)) {
+			upstream->ts = ts;
+		}
+	}
+end:
+	return ret;
+}
+
+/*
+ * Returns true if the notification of upstream a must be delivered
+ * before the one of upstream b. Exhausted upstreams lose every match
+ * and ties are broken by upstream index so that the order is stable
+ * from one run to the next.
+ */
+static inline
+bool muxer_upstream_is_before(struct muxer_iterator *muxer_it,
+		guint a, guint b)
+{
+	struct muxer_upstream *upstream_a = &g_array_index(muxer_it->upstreams,
+			struct muxer_upstream, a);
+	struct muxer_upstream *upstream_b = &g_array_index(muxer_it->upstreams,
+			struct muxer_upstream, b);
+
+	if (unlikely(upstream_a->end_reached)) {
+		return false;
+	}
+	if (unlikely(upstream_b->end_reached)) {
+		return true;
+	}
+	if (upstream_a->ts != upstream_b->ts) {
+		return upstream_a->ts < upstream_b->ts;
+	}
+	return a < b;
+}
+
+/* Play the matches of the subtree rooted at node; returns its winner. */
 static
+guint muxer_tree_build(struct muxer_iterator *muxer_it, guint node)
+{
+	guint left, right;
+	guint count = muxer_it->upstreams->len;
+
+	if (node >= count) {
+		/* Leaf. */
+		return node - count;
+	}
+
+	left = muxer_tree_build(muxer_it, node << 1);
+	right = muxer_tree_build(muxer_it, (node << 1) + 1);
+	if (muxer_upstream_is_before(muxer_it, left, right)) {
+		muxer_it->tree[node] = right;
+		return left;
+	} else {
+		muxer_it->tree[node] = left;
+		return right;
+	}
+}
+
+/* Replay the matches on the path from an upstream's leaf to the root. */
+static
+void muxer_tree_replay(struct muxer_iterator *muxer_it, guint winner)
+{
+	guint node = (muxer_it->upstreams->len + winner) >> 1;
+
+	for (; node > 0; node >>= 1) {
+		guint loser = muxer_it->tree[node];
+
+		if (muxer_upstream_is_before(muxer_it, loser, winner)) {
+			muxer_it->tree[node] = winner;
+			winner = loser;
+		}
+	}
+	muxer_it->tree[0] = winner;
+}
+
+BT_HIDDEN
 enum bt_notification_iterator_status muxer_iterator_next(
 		struct bt_notification_iterator *iterator)
 {
-	return BT_NOTIFICATION_ITERATOR_STATUS_OK;
+	enum bt_notification_iterator_status ret =
+			BT_NOTIFICATION_ITERATOR_STATUS_OK;
+	struct muxer_iterator *muxer_it;
+	struct muxer_upstream *winner;
+	guint count;
+
+	muxer_it = bt_notification_iterator_get_private_data(iterator);
+	assert(muxer_it);
+	count = muxer_it->upstreams->len;
+	if (count == 0) {
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_END;
+		goto end;
+	}
+
+	if (unlikely(!muxer_it->started)) {
+		guint i;
+
+		/*
+		 * Fetch a first notification from every upstream. After
+		 * an upstream returned AGAIN, only the upstreams which
+		 * still have none are advanced on the next call.
+		 */
+		for (i = 0; i < count; i++) {
+			struct muxer_upstream *upstream = &g_array_index(
+					muxer_it->upstreams,
+					struct muxer_upstream, i);
+
+			if (upstream->notification || upstream->end_reached) {
+				continue;
+			}
+
+			ret = muxer_upstream_advance(upstream);
+			if (ret) {
+				goto end;
+			}
+		}
+		muxer_it->tree[0] = muxer_tree_build(muxer_it, 1);
+		muxer_it->started = true;
+	} else {
+		guint last = muxer_it->tree[0];
+
+		/* Refill the leaf which provided the last notification. */
+		winner = &g_array_index(muxer_it->upstreams,
+				struct muxer_upstream, last);
+		if (!winner->end_reached && !winner->notification) {
+			ret = muxer_upstream_advance(winner);
+			if (ret) {
+				goto end;
+			}
+		}
+		muxer_tree_replay(muxer_it, last);
+	}
+
+	winner = &g_array_index(muxer_it->upstreams, struct muxer_upstream,
+			muxer_it->tree[0]);
+	if (winner->end_reached) {
+		/* The best candidate is exhausted: all upstreams are. */
+		BT_PUT(muxer_it->current_notification);
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_END;
+		goto end;
+	}
+
+	BT_MOVE(muxer_it->current_notification, winner->notification);
+end:
+	return ret;
 }
 
 /* Initialize plug-in entry points. */
@@ -110,3 +563,7 @@ BT_PLUGIN_FILTER_COMPONENT_CLASS_DESCRIPTION(muxer,
 	"Time-correlate multiple traces.");
 BT_PLUGIN_FILTER_COMPONENT_CLASS_INIT_METHOD(muxer, muxer_component_init);
 BT_PLUGIN_FILTER_COMPONENT_CLASS_DESTROY_METHOD(muxer, destroy_muxer);
+BT_PLUGIN_FILTER_COMPONENT_CLASS_NOTIFICATION_ITERATOR_INIT_METHOD(muxer,
+	muxer_iterator_init);
+BT_PLUGIN_FILTER_COMPONENT_CLASS_NOTIFICATION_ITERATOR_DESTROY_METHOD(muxer,
+	muxer_iterator_destroy);
@@ -28,10 +28,73 @@
  */
 
 #include <stdbool.h>
+#include <stdint.h>
+#include <glib.h>
 #include <babeltrace/babeltrace-internal.h>
+#include <babeltrace/component/component.h>
+#include <babeltrace/component/notification/notification.h>
+#include <babeltrace/component/notification/iterator.h>
 
 struct muxer {
-	GHashTable *trace_clocks;
+	/* Number of input ports, including the default one. */
+	uint64_t input_port_count;
 };
 
+struct muxer_upstream {
+	struct bt_notification_iterator *iterator;
+	/* Next notification to be delivered from this upstream iterator. */
+	struct bt_notification *notification;
+	/*
+	 * Sort key of the notification, in ns from Epoch. Notifications
+	 * which are not associated to a clock value inherit the key of
+	 * the last notification received from the same upstream
+	 * iterator so that they are delivered in their original order.
+	 */
+	int64_t ts;
+	bool end_reached;
+};
+
+struct muxer_iterator {
+	/* Array of struct muxer_upstream. */
+	GArray *upstreams;
+	/*
+	 * Loser tree over the upstream iterators.
+	 *
+	 * tree[0] is the index of the upstream holding the earliest
+	 * notification. tree[i], for 0 < i < upstreams->len, is the index
+	 * of the upstream which lost the match played at internal node
+	 * i. The leaf of upstream n is node (upstreams->len + n) and the
+	 * parent of node i is node (i / 2).
+	 *
+	 * Replacing the winner only replays the matches on the path from
+	 * its leaf to the root: one comparison per level, against the
+	 * two comparisons per level of a binary heap's sift-down.
+	 */
+	guint *tree;
+	bool started;
+	struct bt_notification *current_notification;
+};
+
+BT_HIDDEN
+enum bt_component_status muxer_component_init(
+		struct bt_component *component, struct bt_value *params,
+		void *init_method_data);
+
+BT_HIDDEN
+enum bt_notification_iterator_status muxer_iterator_init(
+		struct bt_component *component,
+		struct bt_notification_iterator *iterator,
+		void *init_method_data);
+
+BT_HIDDEN
+void muxer_iterator_destroy(struct bt_notification_iterator *iterator);
+
+BT_HIDDEN
+struct bt_notification *muxer_iterator_get(
+		struct bt_notification_iterator *iterator);
+
+BT_HIDDEN
+enum bt_notification_iterator_status muxer_iterator_next(
+		struct bt_notification_iterator *iterator);
+
 #endif /* BABELTRACE_PLUGIN_MUXER_H */
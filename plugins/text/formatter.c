@@ -0,0 +1,334 @@
+/*
+ * BabelTrace - CTF Text Output Plug-in, Parallel Formatting
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * Author: agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <assert.h>
+#include <pthread.h>
+#include <glib.h>
+#include <babeltrace/ref.h>
+#include <babeltrace/component/notification/event.h>
+#include "text.h"
+#include "formatter.h"
+
+/* Notifications formatted by one thread for each batch. */
+#define TEXT_FORMATTER_CHUNK_SIZE	256
+
+struct text_formatter {
+	struct text_formatter_pool *pool;
+	pthread_t thread;
+	bool thread_started;
+	/*
+	 * Copy of the sink with its own mutable state: output, plans,
+	 * string and time cache. Its options are borrowed from the sink.
+	 */
+	struct text_component clone;
+	/* Current chunk */
+	struct bt_notification **notifications;
+	size_t count;
+	enum bt_component_status status;
+};
+
+struct text_formatter_pool {
+	struct text_component *text;
+	/* Index 0 is used by the sink's thread. */
+	struct text_formatter *formatters;
+	unsigned int nr_formatters;
+	struct bt_notification **batch;
+	size_t batch_size;
+	pthread_mutex_t lock;
+	/* Signaled when a new batch is ready, or to quit. */
+	pthread_cond_t job_cond;
+	/* Signaled when the last worker is done with its chunk. */
+	pthread_cond_t done_cond;
+	uint64_t generation;
+	unsigned int pending;
+	bool quit;
+};
+
+static
+void format_chunk(struct text_formatter *formatter)
+{
+	size_t i;
+
+	formatter->status = BT_COMPONENT_STATUS_OK;
+	for (i = 0; i < formatter->count; i++) {
+		formatter->status = text_handle_notification(&formatter->clone,
+			formatter->notifications[i]);
+		if (formatter->status != BT_COMPONENT_STATUS_OK) {
+			break;
+		}
+	}
+}
+
+static
+void *formatter_thread(void *data)
+{
+	struct text_formatter *formatter = data;
+	struct text_formatter_pool *pool = formatter->pool;
+	uint64_t generation = 0;
+
+	pthread_mutex_lock(&pool->lock);
+	for (;;) {
+		while (!pool->quit && pool->generation == generation) {
+			pthread_cond_wait(&pool->job_cond, &pool->lock);
+		}
+		if (pool->quit) {
+			break;
+		}
+		generation = pool->generation;
+		pthread_mutex_unlock(&pool->lock);
+
+		format_chunk(formatter);
+
+		pthread_mutex_lock(&pool->lock);
+		if (--pool->pending == 0) {
+			pthread_cond_signal(&pool->done_cond);
+		}
+	}
+	pthread_mutex_unlock(&pool->lock);
+	return NULL;
+}
+
+static
+int init_clone(struct text_component *clone, struct text_component *text)
+{
+	*clone = *text;
+	clone->input_iterator = NULL;
+	clone->plugin_opt_map = NULL;
+	clone->plans = NULL;
+	clone->formatters = NULL;
+	clone->string = NULL;
+	memset(&clone->output, 0, sizeof(clone->output));
+	clone->time_cache.valid = false;
+	clone->string = g_string_new("");
+	if (!clone->string) {
+		goto error;
+	}
+	if (text_output_init(&clone->output, NULL)) {
+		goto error;
+	}
+	clone->plans = text_print_plans_create(clone);
+	if (!clone->plans) {
+		goto error;
+	}
+	return 0;
+error:
+	return -1;
+}
+
+static
+void fini_clone(struct text_component *clone)
+{
+	text_output_fini(&clone->output);
+	text_print_plans_destroy(clone->plans);
+	if (clone->string) {
+		(void) g_string_free(clone->string, TRUE);
+	}
+}
+
+BT_HIDDEN
+struct text_formatter_pool *text_formatter_pool_create(
+		struct text_component *text, unsigned int threads)
+{
+	struct text_formatter_pool *pool;
+	unsigned int i;
+
+	assert(threads > 0);
+	pool = g_new0(struct text_formatter_pool, 1);
+	if (!pool) {
+		goto end;
+	}
+	pool->text = text;
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->job_cond, NULL);
+	pthread_cond_init(&pool->done_cond, NULL);
+	pool->batch_size = (size_t) threads * TEXT_FORMATTER_CHUNK_SIZE;
+	pool->batch = g_new0(struct bt_notification *, pool->batch_size);
+	if (!pool->batch) {
+		goto error;
+	}
+	pool->formatters = g_new0(struct text_formatter, threads);
+	if (!pool->formatters) {
+		goto error;
+	}
+	pool->nr_formatters = threads;
+
+	/* The formatter threads share the notifications with this one. */
+	bt_ref_enable_thread_safety();
+
+	for (i = 0; i < threads; i++) {
+		struct text_formatter *formatter = &pool->formatters[i];
+
+		formatter->pool = pool;
+		if (init_clone(&formatter->clone, text)) {
+			goto error;
+		}
+		if (i == 0) {
+			continue;
+		}
+		if (pthread_create(&formatter->thread, NULL,
+				formatter_thread, formatter)) {
+			fprintf(text->err,
+				"[error] Cannot create formatter thread\n");
+			goto error;
+		}
+		formatter->thread_started = true;
+	}
+end:
+	return pool;
+error:
+	text_formatter_pool_destroy(pool);
+	return NULL;
+}
+
+BT_HIDDEN
+void text_formatter_pool_destroy(struct text_formatter_pool *pool)
+{
+	unsigned int i;
+
+	if (!pool) {
+		return;
+	}
+
+	pthread_mutex_lock(&pool->lock);
+	pool->quit = true;
+	pthread_cond_broadcast(&pool->job_cond);
+	pthread_mutex_unlock(&pool->lock);
+
+	for (i = 0; i < pool->nr_formatters; i++) {
+		struct text_formatter *formatter = &pool->formatters[i];
+
+		if (formatter->thread_started) {
+			(void) pthread_join(formatter->thread, NULL);
+		}
+		fini_clone(&formatter->clone);
+	}
+
+	pthread_cond_destroy(&pool->done_cond);
+	pthread_cond_destroy(&pool->job_cond);
+	pthread_mutex_destroy(&pool->lock);
+	g_free(pool->formatters);
+	g_free(pool->batch);
+	g_free(pool);
+}
+
+BT_HIDDEN
+struct bt_notification **text_formatter_pool_batch(
+		struct text_formatter_pool *pool)
+{
+	return pool->batch;
+}
+
+BT_HIDDEN
+size_t text_formatter_pool_batch_size(struct text_formatter_pool *pool)
+{
+	return pool->batch_size;
+}
+
+/*
+ * Gives the formatter the delta state the sink has before its chunk,
+ * then advances the sink's state past the chunk, as if it had printed
+ * it.
+ */
+static
+void hand_over_deltas(struct text_component *text,
+		struct text_formatter *formatter)
+{
+	struct text_component *clone = &formatter->clone;
+	size_t i;
+
+	clone->last_cycles_timestamp = text->last_cycles_timestamp;
+	clone->delta_cycles = text->delta_cycles;
+	clone->last_real_timestamp = text->last_real_timestamp;
+	clone->delta_real_timestamp = text->delta_real_timestamp;
+
+	for (i = 0; i < formatter->count; i++) {
+		struct bt_notification *notification =
+			formatter->notifications[i];
+		struct bt_ctf_event *event;
+
+		if (bt_notification_get_type(notification) !=
+				BT_NOTIFICATION_TYPE_EVENT) {
+			continue;
+		}
+		event = bt_notification_event_get_event(notification);
+		if (!event) {
+			continue;
+		}
+		/* The formatter reports errors when printing the event. */
+		(void) text_update_deltas(text, event);
+		bt_put(event);
+	}
+}
+
+BT_HIDDEN
+enum bt_component_status text_formatter_pool_format(
+		struct text_formatter_pool *pool, size_t count)
+{
+	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
+	struct text_component *text = pool->text;
+	size_t chunk_size, offset = 0, i;
+
+	assert(count <= pool->batch_size);
+	/* Spread evenly, so that a short batch still uses every thread. */
+	chunk_size = (count + pool->nr_formatters - 1) / pool->nr_formatters;
+	for (i = 0; i < pool->nr_formatters; i++) {
+		struct text_formatter *formatter = &pool->formatters[i];
+
+		formatter->notifications = &pool->batch[offset];
+		formatter->count = MIN(chunk_size, count - offset);
+		offset += formatter->count;
+		hand_over_deltas(text, formatter);
+	}
+
+	pthread_mutex_lock(&pool->lock);
+	pool->pending = pool->nr_formatters - 1;
+	pool->generation++;
+	pthread_cond_broadcast(&pool->job_cond);
+	pthread_mutex_unlock(&pool->lock);
+
+	format_chunk(&pool->formatters[0]);
+
+	pthread_mutex_lock(&pool->lock);
+	while (pool->pending > 0) {
+		pthread_cond_wait(&pool->done_cond, &pool->lock);
+	}
+	pthread_mutex_unlock(&pool->lock);
+
+	for (i = 0; i < pool->nr_formatters; i++) {
+		struct text_output *out = &pool->formatters[i].clone.output;
+
+		if (ret == BT_COMPONENT_STATUS_OK) {
+			text_output_write(&text->output, out->buf, out->len);
+			ret = pool->formatters[i].status;
+		}
+		out->len = 0;
+	}
+
+	for (i = 0; i < count; i++) {
+		BT_PUT(pool->batch[i]);
+	}
+	return ret;
+}
@@ -0,0 +1,67 @@
+#ifndef BABELTRACE_PLUGIN_TEXT_FORMATTER_H
+#define BABELTRACE_PLUGIN_TEXT_FORMATTER_H
+
+/*
+ * BabelTrace - CTF Text Output Plug-in, Parallel Formatting
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * Author: agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stddef.h>
+#include <babeltrace/babeltrace-internal.h>
+#include <babeltrace/component/component.h>
+#include <babeltrace/component/notification/notification.h>
+
+struct text_component;
+struct text_formatter_pool;
+
+/*
+ * Formats notifications on "threads" threads (the calling one included),
+ * each into its own memory output. The sink's output gets the results in
+ * the notifications' order, so that it is the same as the serial one.
+ */
+BT_HIDDEN
+struct text_formatter_pool *text_formatter_pool_create(
+		struct text_component *text, unsigned int threads);
+
+BT_HIDDEN
+void text_formatter_pool_destroy(struct text_formatter_pool *pool);
+
+/* Array of text_formatter_pool_batch_size() notifications to fill. */
+BT_HIDDEN
+struct bt_notification **text_formatter_pool_batch(
+		struct text_formatter_pool *pool);
+
+BT_HIDDEN
+size_t text_formatter_pool_batch_size(struct text_formatter_pool *pool);
+
+/*
+ * Formats the first "count" notifications of the batch, appending them
+ * to the sink's output, and puts them. On error, the output stops after
+ * what the failing notification printed, like in serial mode.
+ */
+BT_HIDDEN
+enum bt_component_status text_formatter_pool_format(
+		struct text_formatter_pool *pool, size_t count);
+
+#endif /* BABELTRACE_PLUGIN_TEXT_FORMATTER_H */
@@ -0,0 +1,196 @@
+/*
+ * BabelTrace - CTF Text Output Plug-in, Output Buffer
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * Author: agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <assert.h>
+#include <glib.h>
+#include "output.h"
+
+BT_HIDDEN
+int text_output_init(struct text_output *out, FILE *fp)
+{
+	out->fp = fp;
+	out->len = 0;
+	out->error = false;
+	out->capacity = TEXT_OUTPUT_BUF_SIZE;
+	out->buf = g_malloc(out->capacity);
+	return out->buf ? 0 : -1;
+}
+
+BT_HIDDEN
+void text_output_fini(struct text_output *out)
+{
+	if (!out->buf) {
+		return;
+	}
+
+	(void) text_output_flush(out);
+	g_free(out->buf);
+	out->buf = NULL;
+}
+
+BT_HIDDEN
+int text_output_flush(struct text_output *out)
+{
+	if (!out->fp) {
+		/* Kept until the owner takes it. */
+		return 0;
+	}
+
+	if (out->len > 0) {
+		if (fwrite(out->buf, 1, out->len, out->fp) != out->len) {
+			out->error = true;
+		}
+		out->len = 0;
+	}
+
+	if (fflush(out->fp)) {
+		out->error = true;
+	}
+
+	return out->error ? -1 : 0;
+}
+
+BT_HIDDEN
+void text_output_make_room(struct text_output *out, size_t len)
+{
+	if (out->fp) {
+		(void) text_output_flush(out);
+		assert(len <= out->capacity);
+		return;
+	}
+
+	while (len > out->capacity - out->len) {
+		out->capacity *= 2;
+	}
+	out->buf = g_realloc(out->buf, out->capacity);
+}
+
+BT_HIDDEN
+void text_output_write_slow(struct text_output *out, const char *data,
+		size_t len)
+{
+	if (!out->fp) {
+		text_output_make_room(out, len);
+		memcpy(&out->buf[out->len], data, len);
+		out->len += len;
+		return;
+	}
+
+	(void) text_output_flush(out);
+	if (len >= out->capacity) {
+		/* Not worth copying. */
+		if (fwrite(data, 1, len, out->fp) != len) {
+			out->error = true;
+		}
+		return;
+	}
+
+	memcpy(out->buf, data, len);
+	out->len = len;
+}
+
+BT_HIDDEN
+void text_output_uint(struct text_output *out, uint64_t value,
+		unsigned int min_width)
+{
+	char digits[20];
+	char *p = &digits[sizeof(digits)];
+	size_t len;
+	char *dst;
+
+	do {
+		*--p = '0' + (value % 10);
+		value /= 10;
+	} while (value);
+
+	len = &digits[sizeof(digits)] - p;
+	if (min_width > 64) {
+		min_width = 64;
+	}
+	dst = text_output_reserve(out, MAX(len, min_width));
+	if (len < min_width) {
+		memset(dst, '0', min_width - len);
+		dst += min_width - len;
+		text_output_commit(out, min_width - len);
+	}
+
+	memcpy(dst, p, len);
+	text_output_commit(out, len);
+}
+
+BT_HIDDEN
+void text_output_int(struct text_output *out, int64_t value)
+{
+	if (value < 0) {
+		text_output_putc(out, '-');
+		/* Also valid for INT64_MIN. */
+		text_output_uint(out, -(uint64_t) value, 0);
+	} else {
+		text_output_uint(out, value, 0);
+	}
+}
+
+BT_HIDDEN
+void text_output_hex(struct text_output *out, uint64_t value)
+{
+	static const char hex_digits[] = "0123456789ABCDEF";
+	char digits[16];
+	char *p = &digits[sizeof(digits)];
+
+	do {
+		*--p = hex_digits[value & 0xf];
+		value >>= 4;
+	} while (value);
+
+	text_output_write(out, p, &digits[sizeof(digits)] - p);
+}
+
+BT_HIDDEN
+void text_output_oct(struct text_output *out, uint64_t value)
+{
+	char digits[22];
+	char *p = &digits[sizeof(digits)];
+
+	do {
+		*--p = '0' + (value & 0x7);
+		value >>= 3;
+	} while (value);
+
+	text_output_write(out, p, &digits[sizeof(digits)] - p);
+}
+
+BT_HIDDEN
+void text_output_double(struct text_output *out, double value)
+{
+	/* "%g" prints at most 6 significant digits and a 3-digit exponent. */
+	const size_t max_len = 32;
+	char *dst = text_output_reserve(out, max_len);
+	int len;
+
+	len = snprintf(dst, max_len, "%g", value);
+	assert(len > 0 && len < max_len);
+	text_output_commit(out, len);
+}
@@ -0,0 +1,148 @@
+#ifndef BABELTRACE_PLUGIN_TEXT_OUTPUT_H
+#define BABELTRACE_PLUGIN_TEXT_OUTPUT_H
+
+/*
+ * BabelTrace - CTF Text Output Plug-in, Output Buffer
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * Author: agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <babeltrace/babeltrace-internal.h>
+
+/*
+ * Size of the output buffer, and of the writes to its file; initial
+ * size of a memory output.
+ */
+#define TEXT_OUTPUT_BUF_SIZE	(64 * 1024)
+
+/*
+ * Output buffer formatting without allocations nor stdio locking,
+ * written to its file in large chunks. Without a file, the buffer
+ * grows to keep everything written to it.
+ */
+struct text_output {
+	/* NULL for a memory output */
+	FILE *fp;
+	char *buf;
+	size_t len;
+	size_t capacity;
+	/* A write to the file failed. */
+	bool error;
+};
+
+/* "fp" is NULL for a memory output. */
+BT_HIDDEN
+int text_output_init(struct text_output *out, FILE *fp);
+
+/* Flushes the buffer, then frees it. */
+BT_HIDDEN
+void text_output_fini(struct text_output *out);
+
+BT_HIDDEN
+int text_output_flush(struct text_output *out);
+
+/*
+ * Makes room for "len" bytes at the end of the buffer: flushes it to
+ * the file, or grows a memory output.
+ */
+BT_HIDDEN
+void text_output_make_room(struct text_output *out, size_t len);
+
+BT_HIDDEN
+void text_output_write_slow(struct text_output *out, const char *data,
+		size_t len);
+
+/* Decimal, zero-padded to "min_width" digits. */
+BT_HIDDEN
+void text_output_uint(struct text_output *out, uint64_t value,
+		unsigned int min_width);
+
+BT_HIDDEN
+void text_output_int(struct text_output *out, int64_t value);
+
+/* Uppercase hexadecimal, without prefix. */
+BT_HIDDEN
+void text_output_hex(struct text_output *out, uint64_t value);
+
+/* Octal, without prefix. */
+BT_HIDDEN
+void text_output_oct(struct text_output *out, uint64_t value);
+
+/* Same as printf's "%g". */
+BT_HIDDEN
+void text_output_double(struct text_output *out, double value);
+
+static inline
+void text_output_write(struct text_output *out, const char *data,
+		size_t len)
+{
+	if (likely(len <= out->capacity - out->len)) {
+		memcpy(&out->buf[out->len], data, len);
+		out->len += len;
+		return;
+	}
+
+	text_output_write_slow(out, data, len);
+}
+
+static inline
+void text_output_puts(struct text_output *out, const char *str)
+{
+	text_output_write(out, str, strlen(str));
+}
+
+static inline
+void text_output_putc(struct text_output *out, char c)
+{
+	if (unlikely(out->len == out->capacity)) {
+		text_output_make_room(out, 1);
+	}
+
+	out->buf[out->len++] = c;
+}
+
+/*
+ * Returns room for "len" bytes (at most TEXT_OUTPUT_BUF_SIZE for a file
+ * output) at the end of the buffer; text_output_commit() appends what was written.
+ */
+static inline
+char *text_output_reserve(struct text_output *out, size_t len)
+{
+	if (unlikely(len > out->capacity - out->len)) {
+		text_output_make_room(out, len);
+	}
+
+	return &out->buf[out->len];
+}
+
+static inline
+void text_output_commit(struct text_output *out, size_t len)
+{
+	out->len += len;
+}
+
+#endif /* BABELTRACE_PLUGIN_TEXT_OUTPUT_H */
@@ -38,7 +38,9 @@
 #include <babeltrace/ctf-ir/trace.h>
 #include <babeltrace/bitfield.h>
 #include <babeltrace/common-internal.h>
+#include <babeltrace/compiler.h>
 #include <inttypes.h>
+#include <time.h>
 #include "text.h"
 
 #define NSEC_PER_SEC 1000000000LL
@@ -67,18 +69,15 @@ struct timestamp {
 	uint64_t clock_value;	/* In cycles. */
 };
 
-static
-enum bt_component_status print_field(struct text_component *text,
-		struct bt_ctf_field *field, bool print_names,
-		GQuark *filters_fields, int filter_array_len);
-
 static
 void print_name_equal(struct text_component *text, const char *name)
 {
 	if (text->use_colors) {
-		fprintf(text->out, "%s%s%s = ", COLOR_NAME, name, COLOR_RST);
+		text_output_puts(&text->output, COLOR_NAME);
+		text_output_puts(&text->output, name);
+		text_output_puts(&text->output, COLOR_RST " = ");
 	} else {
-		fputs(name, text->out);
+		text_output_puts(&text->output, name);
 	}
 }
 
@@ -86,11 +85,30 @@ static
 void print_field_name_equal(struct text_component *text, const char *name)
 {
 	if (text->use_colors) {
-		fprintf(text->out, "%s%s%s = ", COLOR_FIELD_NAME, name,
-			COLOR_RST);
+		text_output_puts(&text->output, COLOR_FIELD_NAME);
+		text_output_puts(&text->output, name);
+		text_output_puts(&text->output, COLOR_RST " = ");
 	} else {
-		fputs(name, text->out);
+		text_output_puts(&text->output, name);
+	}
+}
+
+static inline
+void update_cycles_delta(struct text_component *text, uint64_t cycles)
+{
+	if (text->last_cycles_timestamp != -1ULL) {
+		text->delta_cycles = cycles - text->last_cycles_timestamp;
+	}
+	text->last_cycles_timestamp = cycles;
+}
+
+static inline
+void update_real_delta(struct text_component *text, int64_t ts_nsec)
+{
+	if (text->last_real_timestamp != -1ULL) {
+		text->delta_real_timestamp = ts_nsec - text->last_real_timestamp;
 	}
+	text->last_real_timestamp = ts_nsec;
 }
 
 static
@@ -104,22 +122,74 @@ void print_timestamp_cycles(struct text_component *text,
 
 	clock_value = bt_ctf_event_get_clock_value(event, clock_class);
 	if (!clock_value) {
-	        fputs("????????????????????", text->out);
+	        text_output_puts(&text->output, "????????????????????");
 		return;
 	}
 
 	ret = bt_ctf_clock_value_get_value(clock_value, &cycles);
 	bt_put(clock_value);
 	if (ret) {
-	        fprintf(text->out, "Error");
+	        text_output_puts(&text->output, "Error");
 		return;
 	}
-	fprintf(text->out, "%020" PRIu64, cycles);
+	text_output_uint(&text->output, cycles, 20);
 
-	if (text->last_cycles_timestamp != -1ULL) {
-		text->delta_cycles = cycles - text->last_cycles_timestamp;
+	update_cycles_delta(text, cycles);
+}
+
+/*
+ * Renders the date (if needed) and time of a second since the epoch in
+ * the time cache, unless it's already there: converting to broken-down
+ * time is expensive, and consecutive events mostly share their second.
+ */
+static
+int format_wall_second(struct text_component *text, uint64_t sec)
+{
+	struct text_time_cache *cache = &text->time_cache;
+	struct tm tm;
+	time_t time_s = (time_t) sec;
+	size_t len = 0;
+	int ret;
+
+	if (cache->valid && cache->sec == sec) {
+		return 0;
 	}
-	text->last_cycles_timestamp = cycles;
+
+	cache->valid = false;
+	if (!text->options.clock_gmt) {
+		struct tm *res;
+
+		res = localtime_r(&time_s, &tm);
+		if (!res) {
+			fprintf(stderr, "[warning] Unable to get localtime.\n");
+			return -1;
+		}
+	} else {
+		struct tm *res;
+
+		res = gmtime_r(&time_s, &tm);
+		if (!res) {
+			fprintf(stderr, "[warning] Unable to get gmtime.\n");
+			return -1;
+		}
+	}
+	if (text->options.clock_date) {
+		/* Print date and time */
+		len = strftime(cache->str, 26, "%F ", &tm);
+		if (!len) {
+			fprintf(stderr, "[warning] Unable to print ascii time.\n");
+			return -1;
+		}
+	}
+	ret = snprintf(&cache->str[len], sizeof(cache->str) - len,
+			"%02d:%02d:%02d.", tm.tm_hour, tm.tm_min, tm.tm_sec);
+	if (ret < 0 || ret >= sizeof(cache->str) - len) {
+		return -1;
+	}
+	cache->len = len + ret;
+	cache->sec = sec;
+	cache->valid = true;
+	return 0;
 }
 
 static
@@ -136,21 +206,18 @@ void print_timestamp_wall(struct text_component *text,
 
 	clock_value = bt_ctf_event_get_clock_value(event, clock_class);
 	if (!clock_value) {
-		fputs("??:??:??.?????????", text->out);
+		text_output_puts(&text->output, "??:??:??.?????????");
 		return;
 	}
 
 	ret = bt_ctf_clock_value_get_value_ns_from_epoch(clock_value, &ts_nsec);
 	bt_put(clock_value);
 	if (ret) {
-	        fprintf(text->out, "Error");
+	        text_output_puts(&text->output, "Error");
 		return;
 	}
 
-	if (text->last_real_timestamp != -1ULL) {
-		text->delta_real_timestamp = ts_nsec - text->last_real_timestamp;
-	}
-	text->last_real_timestamp = ts_nsec;
+	update_real_delta(text, ts_nsec);
 
 	ts_sec += ts_nsec / NSEC_PER_SEC;
 	ts_nsec = ts_nsec % NSEC_PER_SEC;
@@ -181,97 +248,47 @@ void print_timestamp_wall(struct text_component *text,
 	}
 
 	if (!text->options.clock_seconds) {
-		struct tm tm;
-		time_t time_s = (time_t) ts_sec_abs;
-
 		if (is_negative) {
 			fprintf(stderr, "[warning] Fallback to [sec.ns] to print negative time value. Use --clock-seconds.\n");
 			goto seconds;
 		}
 
-		if (!text->options.clock_gmt) {
-			struct tm *res;
-
-			res = localtime_r(&time_s, &tm);
-			if (!res) {
-				fprintf(stderr, "[warning] Unable to get localtime.\n");
-				goto seconds;
-			}
-		} else {
-			struct tm *res;
-
-			res = gmtime_r(&time_s, &tm);
-			if (!res) {
-				fprintf(stderr, "[warning] Unable to get gmtime.\n");
-				goto seconds;
-			}
-		}
-		if (text->options.clock_date) {
-			char timestr[26];
-			size_t res;
-
-			/* Print date and time */
-			res = strftime(timestr, sizeof(timestr),
-					"%F ", &tm);
-			if (!res) {
-				fprintf(stderr, "[warning] Unable to print ascii time.\n");
-				goto seconds;
-			}
-			fprintf(text->out, "%s", timestr);
+		if (format_wall_second(text, ts_sec_abs)) {
+			goto seconds;
 		}
+
 		/* Print time in HH:MM:SS.ns */
-		fprintf(text->out, "%02d:%02d:%02d.%09" PRIu64,
-				tm.tm_hour, tm.tm_min, tm.tm_sec, ts_nsec_abs);
+		text_output_write(&text->output, text->time_cache.str,
+			text->time_cache.len);
+		text_output_uint(&text->output, ts_nsec_abs, 9);
 		goto end;
 	}
 seconds:
-	fprintf(text->out, "%s%" PRId64 ".%09" PRIu64,
-			is_negative ? "-" : "", ts_sec_abs, ts_nsec_abs);
+	if (is_negative) {
+		text_output_putc(&text->output, '-');
+	}
+	text_output_uint(&text->output, ts_sec_abs, 0);
+	text_output_putc(&text->output, '.');
+	text_output_uint(&text->output, ts_nsec_abs, 9);
 end:
 	return;
 }
 
 static
 enum bt_component_status print_event_timestamp(struct text_component *text,
+		struct bt_ctf_clock_class *clock_class,
 		struct bt_ctf_event *event, bool *start_line)
 {
 	bool print_names = text->options.print_header_field_names;
 	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
-	struct bt_ctf_stream *stream = NULL;
-	struct bt_ctf_stream_class *stream_class = NULL;
-	struct bt_ctf_trace *trace = NULL;
-	struct bt_ctf_clock_class *clock_class = NULL;
-	FILE *out = text->out;
-
-	stream = bt_ctf_event_get_stream(event);
-	if (!stream) {
-		ret = BT_COMPONENT_STATUS_ERROR;
-		goto end;
-	}
-
-	stream_class = bt_ctf_stream_get_class(stream);
-	if (!stream_class) {
-		ret = BT_COMPONENT_STATUS_ERROR;
-		goto end;
-	}
-	trace = bt_ctf_stream_class_get_trace(stream_class);
-	if (!trace) {
-		ret = BT_COMPONENT_STATUS_ERROR;
-		goto end;
-	}
-	clock_class = bt_ctf_trace_get_clock_class(trace, 0);
-	if (!clock_class) {
-		ret = BT_COMPONENT_STATUS_ERROR;
-		goto end;
-	}
 
 	if (print_names) {
 		print_name_equal(text, "timestamp");
 	} else {
-		fputs("[", out);
+		text_output_puts(&text->output, "[");
 	}
 	if (text->use_colors) {
-		fputs(COLOR_TIMESTAMP, text->out);
+		text_output_puts(&text->output, COLOR_TIMESTAMP);
 	}
 	if (text->options.print_timestamp_cycles) {
 		print_timestamp_cycles(text, clock_class, event);
@@ -279,24 +296,26 @@ enum bt_component_status print_event_timestamp(struct text_component *text,
 		print_timestamp_wall(text, clock_class, event);
 	}
 	if (text->use_colors) {
-		fputs(COLOR_RST, text->out);
+		text_output_puts(&text->output, COLOR_RST);
 	}
 
 	if (!print_names)
-		fputs("] ", out);
+		text_output_puts(&text->output, "] ");
 
 	if (text->options.print_delta_field) {
 		if (print_names) {
-			fputs(", ", text->out);
+			text_output_puts(&text->output, ", ");
 			print_name_equal(text, "delta");
 		} else {
-			fputs("(", text->out);
+			text_output_puts(&text->output, "(");
 		}
 		if (text->options.print_timestamp_cycles) {
 			if (text->delta_cycles == -1ULL) {
-				fputs("+??????????\?\?) ", text->out); /* Not a trigraph. */
+				text_output_puts(&text->output, "+??????????\?\?) "); /* Not a trigraph. */
 			} else {
-				fprintf(text->out, "+%012" PRIu64, text->delta_cycles);
+				text_output_putc(&text->output, '+');
+				text_output_uint(&text->output, text->delta_cycles,
+					12);
 			}
 		} else {
 			if (text->delta_real_timestamp != -1ULL) {
@@ -305,272 +324,174 @@ enum bt_component_status print_event_timestamp(struct text_component *text,
 				delta = text->delta_real_timestamp;
 				delta_sec = delta / NSEC_PER_SEC;
 				delta_nsec = delta % NSEC_PER_SEC;
-				fprintf(text->out, "+%" PRIu64 ".%09" PRIu64,
-					delta_sec, delta_nsec);
+				text_output_putc(&text->output, '+');
+				text_output_uint(&text->output, delta_sec, 0);
+				text_output_putc(&text->output, '.');
+				text_output_uint(&text->output, delta_nsec, 9);
 			} else {
-				fputs("+?.?????????", text->out);
+				text_output_puts(&text->output, "+?.?????????");
 			}
 		}
 		if (!print_names) {
-			fputs(") ", text->out);
+			text_output_puts(&text->output, ") ");
 		}
 	}
 	*start_line = !print_names;
-
-end:
-	bt_put(stream);
-	bt_put(clock_class);
-	bt_put(stream_class);
-	bt_put(trace);
 	return ret;
 }
 
-static
-enum bt_component_status print_event_header(struct text_component *text,
-		struct bt_ctf_event *event)
-{
-	bool print_names = text->options.print_header_field_names;
-	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
-	struct bt_ctf_event_class *event_class = NULL;
-	struct bt_ctf_stream_class *stream_class = NULL;
-	struct bt_ctf_trace *trace_class = NULL;
-
-	event_class = bt_ctf_event_get_class(event);
-	if (!event_class) {
-		ret = BT_COMPONENT_STATUS_ERROR;
-		goto end;
-	}
-	stream_class = bt_ctf_event_class_get_stream_class(event_class);
-	if (!stream_class) {
-		ret = BT_COMPONENT_STATUS_ERROR;
-		goto end;
-	}
-	trace_class = bt_ctf_stream_class_get_trace(stream_class);
-	if (!trace_class) {
-		ret = BT_COMPONENT_STATUS_ERROR;
-		goto end;
-	}
-	if (!text->start_line) {
-		fputs(", ", text->out);
-	}
-	text->start_line = false;
-	ret = print_event_timestamp(text, event, &text->start_line);
-	if (ret != BT_COMPONENT_STATUS_OK) {
-		goto end;
-	}
-	if (text->options.print_trace_field) {
-		const char *name;
+/*
+ * Printing plans
+ *
+ * The first time a field type is printed, the decisions which only
+ * depend on the type and on the sink's options (field names and
+ * separators to print, filtered fields, colors, integer base, string
+ * arrays, and so on) are made once and recorded in a plan. Printing a
+ * field then executes the plan of its type. Likewise, everything an
+ * event's header shows after its timestamp only depends on its class
+ * and is rendered once per event class.
+ */
 
-		name = bt_ctf_trace_get_name(trace_class);
-		if (name) {
-			if (!text->start_line) {
-				fputs(", ", text->out);
-			}
-			text->start_line = false;
-			if (print_names) {
-				print_name_equal(text, "trace");
-			}
-			fprintf(text->out, "%s", name);
-		}
-	}
-	if (text->options.print_trace_hostname_field) {
-		struct bt_value *hostname_str;
+struct print_plan;
 
-		hostname_str = bt_ctf_trace_get_environment_field_value_by_name(trace_class,
-				"hostname");
-		if (hostname_str) {
-			const char *str;
+typedef enum bt_component_status (*print_plan_method)(
+		struct text_component *text, struct print_plan *plan,
+		struct bt_ctf_field *field);
 
-			if (!text->start_line) {
-				fputs(", ", text->out);
-			}
-			text->start_line = false;
-			if (print_names) {
-				print_name_equal(text, "trace:hostname");
-			}
-			if (bt_value_string_get(hostname_str, &str)
-					== BT_VALUE_STATUS_OK) {
-				fprintf(text->out, "%s", str);
-			}
-			bt_put(hostname_str);
-		}
-	}
-	if (text->options.print_trace_domain_field) {
-		struct bt_value *domain_str;
+struct print_plan_field {
+	/* Separator and field name */
+	GString *prefix;
+	/* Index of the field in its structure */
+	int index;
+	/* Owned by the plan cache */
+	struct print_plan *plan;
+};
 
-		domain_str = bt_ctf_trace_get_environment_field_value_by_name(trace_class,
-				"domain");
-		if (domain_str) {
-			const char *str;
+struct print_plan {
+	print_plan_method print;
+	struct bt_ctf_field_type *type;
+	bool print_names;
+	/* Colors of the value; empty strings without colors */
+	const char *color;
+	const char *color_rst;
+	union {
+		struct {
+			bool is_signed;
+			enum bt_ctf_integer_base base;
+			enum bt_ctf_string_encoding encoding;
+			int size;
+		} integer;
+		struct {
+			/* Owned by the plan cache */
+			struct print_plan *container;
+		} enumeration;
+		struct {
+			/* Array of struct print_plan_field, printed ones only */
+			GArray *fields;
+		} structure;
+		struct {
+			/* Owned by the plan cache */
+			struct print_plan *element;
+			bool is_string;
+			int64_t length;
+		} array;
+	} u;
+};
 
-			if (!text->start_line) {
-				fputs(", ", text->out);
-			}
-			text->start_line = false;
-			if (print_names) {
-				print_name_equal(text, "trace:domain");
-			}
-			if (bt_value_string_get(domain_str, &str)
-					== BT_VALUE_STATUS_OK) {
-				fprintf(text->out, "%s", str);
-			}
-			bt_put(domain_str);
-		}
-	}
-	if (text->options.print_trace_procname_field) {
-		struct bt_value *procname_str;
+struct event_class_plan {
+	struct bt_ctf_event_class *event_class;
+	struct bt_ctf_clock_class *clock_class;
+	/* What the header shows after the timestamp, up to the event's name */
+	GString *header;
+};
 
-		procname_str = bt_ctf_trace_get_environment_field_value_by_name(trace_class,
-				"procname");
-		if (procname_str) {
-			const char *str;
+enum print_plan_scope {
+	PRINT_PLAN_SCOPE_PACKET_CONTEXT,
+	PRINT_PLAN_SCOPE_EVENT_HEADER,
+	PRINT_PLAN_SCOPE_STREAM_EVENT_CONTEXT,
+	PRINT_PLAN_SCOPE_EVENT_CONTEXT,
+	PRINT_PLAN_SCOPE_EVENT_PAYLOAD,
+	PRINT_PLAN_SCOPE_LEN,
+};
 
-			if (!text->start_line) {
-				fputs(", ", text->out);
-			}
-			text->start_line = false;
-			if (print_names) {
-				print_name_equal(text, "trace:procname");
-			}
-			if (bt_value_string_get(procname_str, &str)
-					== BT_VALUE_STATUS_OK) {
-				fprintf(text->out, "%s", str);
-			}
-			bt_put(procname_str);
-		}
-	}
-	if (text->options.print_trace_vpid_field) {
-		struct bt_value *vpid_value;
+struct text_print_plans {
+	/*
+	 * struct bt_ctf_field_type * to struct print_plan *, indexed by
+	 * plan_cache_index().
+	 */
+	GHashTable *types[4];
+	/* struct bt_ctf_event_class * to struct event_class_plan * */
+	GHashTable *event_classes;
+	/* Separator and name printed before each scope */
+	GString *scope_prefixes[PRINT_PLAN_SCOPE_LEN];
+};
 
-		vpid_value = bt_ctf_trace_get_environment_field_value_by_name(trace_class,
-				"vpid");
-		if (vpid_value) {
-			int64_t value;
+static
+unsigned int plan_cache_index(bool print_names, bool filtered)
+{
+	return (print_names ? 1 : 0) | (filtered ? 2 : 0);
+}
 
-			if (!text->start_line) {
-				fputs(", ", text->out);
-			}
-			text->start_line = false;
-			if (print_names) {
-				print_name_equal(text, "trace:vpid");
-			}
-			if (bt_value_integer_get(vpid_value, &value)
-					== BT_VALUE_STATUS_OK) {
-				fprintf(text->out, "(%" PRId64 ")", value);
-			}
-			bt_put(vpid_value);
-		}
+/* Same as print_name_equal(), into a string. */
+static
+void append_name_equal(struct text_component *text, GString *str,
+		const char *color, const char *name)
+{
+	if (text->use_colors) {
+		g_string_append_printf(str, "%s%s%s = ", color, name,
+			COLOR_RST);
+	} else {
+		g_string_append(str, name);
 	}
-	if (text->options.print_loglevel_field) {
-		struct bt_value *loglevel_str, *loglevel_value;
+}
 
-		loglevel_str = bt_ctf_event_class_get_attribute_value_by_name(event_class,
-				"loglevel_string");
-		loglevel_value = bt_ctf_event_class_get_attribute_value_by_name(event_class,
-				"loglevel");
-		if (loglevel_str || loglevel_value) {
-			bool has_str = false;
+static
+enum bt_component_status print_plan_struct(struct text_component *text,
+		struct print_plan *plan, struct bt_ctf_field *_struct);
 
-			if (!text->start_line) {
-				fputs(", ", text->out);
-			}
-			text->start_line = false;
-			if (print_names) {
-				print_name_equal(text, "loglevel");
-			}
-			if (loglevel_str) {
-				const char *str;
+static
+void print_plan_destroy(void *data)
+{
+	struct print_plan *plan = data;
 
-				if (bt_value_string_get(loglevel_str, &str)
-						== BT_VALUE_STATUS_OK) {
-					fprintf(text->out, "%s", str);
-					has_str = true;
-				}
-			}
-			if (loglevel_value) {
-				int64_t value;
+	if (plan->print == print_plan_struct && plan->u.structure.fields) {
+		guint i;
 
-				if (bt_value_integer_get(loglevel_value, &value)
-						== BT_VALUE_STATUS_OK) {
-					fprintf(text->out, "%s(%" PRId64 ")",
-						has_str ? " " : "", value);
-				}
-			}
-			bt_put(loglevel_str);
-			bt_put(loglevel_value);
+		for (i = 0; i < plan->u.structure.fields->len; i++) {
+			g_string_free(g_array_index(plan->u.structure.fields,
+				struct print_plan_field, i).prefix, TRUE);
 		}
+		g_array_free(plan->u.structure.fields, TRUE);
 	}
-	if (text->options.print_emf_field) {
-		struct bt_value *uri_str;
+	bt_put(plan->type);
+	g_free(plan);
+}
 
-		uri_str = bt_ctf_event_class_get_attribute_value_by_name(event_class,
-				"model.emf.uri");
-		if (uri_str) {
-			if (!text->start_line) {
-				fputs(", ", text->out);
-			}
-			text->start_line = false;
-			if (print_names) {
-				print_name_equal(text, "model.emf.uri");
-			}
-			if (uri_str) {
-				const char *str;
+static
+void event_class_plan_destroy(void *data)
+{
+	struct event_class_plan *plan = data;
 
-				if (bt_value_string_get(uri_str, &str)
-						== BT_VALUE_STATUS_OK) {
-					fprintf(text->out, "%s", str);
-				}
-			}
-			bt_put(uri_str);
-		}
-	}
-	if (!text->start_line) {
-		fputs(", ", text->out);
-	}
-	text->start_line = false;
-	if (print_names) {
-		print_name_equal(text, "name");
+	if (plan->header) {
+		g_string_free(plan->header, TRUE);
 	}
-	if (text->use_colors) {
-		fputs(COLOR_EVENT_NAME, text->out);
-	}
-	fputs(bt_ctf_event_class_get_name(event_class), text->out);
-	if (text->use_colors) {
-		fputs(COLOR_RST, text->out);
-	}
-end:
-	bt_put(trace_class);
-	bt_put(stream_class);
-	bt_put(event_class);
-	return ret;
+	bt_put(plan->clock_class);
+	bt_put(plan->event_class);
+	g_free(plan);
 }
 
 static
-enum bt_component_status print_integer(struct text_component *text,
-		struct bt_ctf_field *field)
+enum bt_component_status print_plan_integer(struct text_component *text,
+		struct print_plan *plan, struct bt_ctf_field *field)
 {
 	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
-	struct bt_ctf_field_type *field_type = NULL;
-	enum bt_ctf_integer_base base;
-	enum bt_ctf_string_encoding encoding;
-	int signedness;
 	union {
 		uint64_t u;
 		int64_t s;
 	} v;
-	bool rst_color = false;
+	int len = plan->u.integer.size;
 
-	field_type = bt_ctf_field_get_type(field);
-	if (!field_type) {
-		ret = BT_COMPONENT_STATUS_ERROR;
-		goto end;
-	}
-	signedness = bt_ctf_field_type_integer_get_signed(field_type);
-	if (signedness < 0) {
-		ret = BT_COMPONENT_STATUS_ERROR;
-		goto end;
-	}
-	if (!signedness) {
+	if (!plan->u.integer.is_signed) {
 		if (bt_ctf_field_unsigned_integer_get_value(field, &v.u) < 0) {
 			ret = BT_COMPONENT_STATUS_ERROR;
 			goto end;
@@ -582,83 +503,52 @@ enum bt_component_status print_integer(struct text_component *text,
 		}
 	}
 
-	encoding = bt_ctf_field_type_integer_get_encoding(field_type);
-	switch (encoding) {
-	case BT_CTF_STRING_ENCODING_UTF8:
-	case BT_CTF_STRING_ENCODING_ASCII:
+	if (plan->u.integer.encoding == BT_CTF_STRING_ENCODING_UTF8 ||
+			plan->u.integer.encoding ==
+				BT_CTF_STRING_ENCODING_ASCII) {
 		g_string_append_c(text->string, (int) v.u);
 		goto end;
-	case BT_CTF_STRING_ENCODING_NONE:
-	case BT_CTF_STRING_ENCODING_UNKNOWN:
-		break;
-	default:
-		ret = BT_COMPONENT_STATUS_ERROR;
-		goto end;
-	}
-
-	if (text->use_colors) {
-		fputs(COLOR_NUMBER_VALUE, text->out);
-		rst_color = true;
 	}
 
-	base = bt_ctf_field_type_integer_get_base(field_type);
-	switch (base) {
+	text_output_puts(&text->output, plan->color);
+	switch (plan->u.integer.base) {
 	case BT_CTF_INTEGER_BASE_BINARY:
 	{
-		int bitnr, len;
+		int bitnr;
 
-		len = bt_ctf_field_type_integer_get_size(field_type);
-		if (len < 0) {
-			ret = BT_COMPONENT_STATUS_ERROR;
-			goto end;
-		}
-		fprintf(text->out, "0b");
+		text_output_puts(&text->output, "0b");
 		v.u = _bt_piecewise_lshift(v.u, 64 - len);
 		for (bitnr = 0; bitnr < len; bitnr++) {
-			fprintf(text->out, "%u", (v.u & (1ULL << 63)) ? 1 : 0);
+			text_output_putc(&text->output,
+				(v.u & (1ULL << 63)) ? '1' : '0');
 			v.u = _bt_piecewise_lshift(v.u, 1);
 		}
 		break;
 	}
 	case BT_CTF_INTEGER_BASE_OCTAL:
 	{
-		if (signedness) {
-			int len;
-
-			len = bt_ctf_field_type_integer_get_size(field_type);
-			if (len < 0) {
-				ret = BT_COMPONENT_STATUS_ERROR;
-				goto end;
-			}
-			if (len < 64) {
-			        size_t rounded_len;
+		if (plan->u.integer.is_signed && len < 64) {
+			size_t rounded_len;
 
-				assert(len != 0);
-				/* Round length to the nearest 3-bit */
-				rounded_len = (((len - 1) / 3) + 1) * 3;
-				v.u &= ((uint64_t) 1 << rounded_len) - 1;
-			}
+			assert(len != 0);
+			/* Round length to the nearest 3-bit */
+			rounded_len = (((len - 1) / 3) + 1) * 3;
+			v.u &= ((uint64_t) 1 << rounded_len) - 1;
 		}
 
-		fprintf(text->out, "0%" PRIo64, v.u);
+		text_output_putc(&text->output, '0');
+		text_output_oct(&text->output, v.u);
 		break;
 	}
 	case BT_CTF_INTEGER_BASE_DECIMAL:
-		if (!signedness) {
-			fprintf(text->out, "%" PRIu64, v.u);
+		if (!plan->u.integer.is_signed) {
+			text_output_uint(&text->output, v.u, 0);
 		} else {
-			fprintf(text->out, "%" PRId64, v.s);
+			text_output_int(&text->output, v.s);
 		}
 		break;
 	case BT_CTF_INTEGER_BASE_HEXADECIMAL:
 	{
-		int len;
-
-		len = bt_ctf_field_type_integer_get_size(field_type);
-		if (len < 0) {
-			ret = BT_COMPONENT_STATUS_ERROR;
-			goto end;
-		}
 		if (len < 64) {
 			/* Round length to the nearest nibble */
 			uint8_t rounded_len = ((len + 3) & ~0x3);
@@ -666,54 +556,35 @@ enum bt_component_status print_integer(struct text_component *text,
 			v.u &= ((uint64_t) 1 << rounded_len) - 1;
 		}
 
-		fprintf(text->out, "0x%" PRIX64, v.u);
+		text_output_puts(&text->output, "0x");
+		text_output_hex(&text->output, v.u);
 		break;
 	}
 	default:
-		ret = BT_COMPONENT_STATUS_ERROR;
-		goto end;
+		/* Rejected when the plan is created. */
+		assert(false);
 	}
+	text_output_puts(&text->output, plan->color_rst);
 end:
-	if (rst_color) {
-		fputs(COLOR_RST, text->out);
-	}
-	bt_put(field_type);
 	return ret;
 }
 
 static
-enum bt_component_status print_enum(struct text_component *text,
-		struct bt_ctf_field *field)
+enum bt_component_status print_plan_enum(struct text_component *text,
+		struct print_plan *plan, struct bt_ctf_field *field)
 {
 	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
 	struct bt_ctf_field *container_field = NULL;
-	struct bt_ctf_field_type *enumeration_field_type = NULL;
-	struct bt_ctf_field_type *container_field_type = NULL;
+	struct print_plan *container_plan = plan->u.enumeration.container;
 	struct bt_ctf_field_type_enumeration_mapping_iterator *iter = NULL;
 	int nr_mappings = 0;
-	int is_signed;
 
-	enumeration_field_type = bt_ctf_field_get_type(field);
-	if (!enumeration_field_type) {
-		ret = BT_COMPONENT_STATUS_ERROR;
-		goto end;
-	}
 	container_field = bt_ctf_field_enumeration_get_container(field);
 	if (!container_field) {
 		ret = BT_COMPONENT_STATUS_ERROR;
 		goto end;
 	}
-	container_field_type = bt_ctf_field_get_type(container_field);
-	if (!container_field_type) {
-		ret = BT_COMPONENT_STATUS_ERROR;
-		goto end;
-	}
-	is_signed = bt_ctf_field_type_integer_get_signed(container_field_type);
-	if (is_signed < 0) {
-		ret = BT_COMPONENT_STATUS_ERROR;
-		goto end;
-	}
-	if (is_signed) {
+	if (container_plan->u.integer.is_signed) {
 		int64_t value;
 
 		if (bt_ctf_field_signed_integer_get_value(container_field,
@@ -722,7 +593,7 @@ enum bt_component_status print_enum(struct text_component *text,
 			goto end;
 		}
 		iter = bt_ctf_field_type_enumeration_find_mappings_by_signed_value(
-				enumeration_field_type, value);
+				plan->type, value);
 	} else {
 		uint64_t value;
 
@@ -732,13 +603,13 @@ enum bt_component_status print_enum(struct text_component *text,
 			goto end;
 		}
 		iter = bt_ctf_field_type_enumeration_find_mappings_by_unsigned_value(
-				enumeration_field_type, value);
+				plan->type, value);
 	}
 	if (!iter) {
 		ret = BT_COMPONENT_STATUS_ERROR;
 		goto end;
 	}
-	fprintf(text->out, "( ");
+	text_output_puts(&text->output, "( ");
 	for (;;) {
 		const char *mapping_name;
 
@@ -748,228 +619,131 @@ enum bt_component_status print_enum(struct text_component *text,
 			goto end;
 		}
 		if (nr_mappings++)
-			fprintf(text->out, ", ");
-		if (text->use_colors) {
-			fputs(COLOR_ENUM_MAPPING_NAME, text->out);
-		}
+			text_output_puts(&text->output, ", ");
+		text_output_puts(&text->output, plan->color);
 		// TODO: escape string
-		fprintf(text->out, "\"%s\"", mapping_name);
-		if (text->use_colors) {
-			fputs(COLOR_RST, text->out);
-		}
+		text_output_putc(&text->output, '"');
+		text_output_puts(&text->output, mapping_name);
+		text_output_putc(&text->output, '"');
+		text_output_puts(&text->output, plan->color_rst);
 		if (bt_ctf_field_type_enumeration_mapping_iterator_next(iter) < 0) {
 			break;
 		}
 	}
 	if (!nr_mappings) {
 		if (text->use_colors) {
-			fputs(COLOR_UNKNOWN, text->out);
-		}
-		fprintf(text->out, "<unknown>");
-		if (text->use_colors) {
-			fputs(COLOR_RST, text->out);
+			text_output_puts(&text->output, COLOR_UNKNOWN);
 		}
+		text_output_puts(&text->output, "<unknown>");
+		text_output_puts(&text->output, plan->color_rst);
 	}
-	fprintf(text->out, " : container = ");
-	ret = print_integer(text, container_field);
+	text_output_puts(&text->output, " : container = ");
+	ret = container_plan->print(text, container_plan, container_field);
 	if (ret != BT_COMPONENT_STATUS_OK) {
 		goto end;
 	}
-	fprintf(text->out, " )");
+	text_output_puts(&text->output, " )");
 end:
 	bt_put(iter);
-	bt_put(container_field_type);
 	bt_put(container_field);
-	bt_put(enumeration_field_type);
 	return ret;
 }
 
 static
-int filter_field_name(struct text_component *text, const char *field_name,
-		GQuark *filter_fields, int filter_array_len)
+enum bt_component_status print_plan_float(struct text_component *text,
+		struct print_plan *plan, struct bt_ctf_field *field)
 {
-	int i;
-	GQuark field_quark = g_quark_try_string(field_name);
-
-	if (!field_quark || text->options.verbose) {
-		return 1;
-	}
+	double v;
 
-	for (i = 0; i < filter_array_len; i++) {
-		if (field_quark == filter_fields[i]) {
-			return 0;
-		}
+	if (bt_ctf_field_floating_point_get_value(field, &v)) {
+		return BT_COMPONENT_STATUS_ERROR;
 	}
-	return 1;
+	text_output_puts(&text->output, plan->color);
+	text_output_double(&text->output, v);
+	text_output_puts(&text->output, plan->color_rst);
+	return BT_COMPONENT_STATUS_OK;
 }
 
 static
-enum bt_component_status print_struct_field(struct text_component *text,
-		struct bt_ctf_field *_struct,
-		struct bt_ctf_field_type *struct_type,
-		int i, bool print_names, int *nr_printed_fields,
-		GQuark *filter_fields, int filter_array_len)
+enum bt_component_status print_plan_string(struct text_component *text,
+		struct print_plan *plan, struct bt_ctf_field *field)
 {
-	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
-	const char *field_name;
-	struct bt_ctf_field *field = NULL;
-	struct bt_ctf_field_type *field_type = NULL;;
-
-	field = bt_ctf_field_structure_get_field_by_index(_struct, i);
-	if (!field) {
-		ret = BT_COMPONENT_STATUS_ERROR;
-		goto end;
-	}
-	if (bt_ctf_field_type_structure_get_field(struct_type,
-			&field_name, &field_type, i) < 0) {
-		ret = BT_COMPONENT_STATUS_ERROR;
-		goto end;
-	}
-
-	if (filter_fields && !filter_field_name(text, field_name,
-				filter_fields, filter_array_len)) {
-		ret = BT_COMPONENT_STATUS_OK;
-		goto end;
-	}
-
-	if (*nr_printed_fields > 0) {
-		fprintf(text->out, ", ");
-	} else {
-		fprintf(text->out, " ");
-	}
-	if (print_names) {
-		print_field_name_equal(text, rem_(field_name));
-	}
-	ret = print_field(text, field, print_names, NULL, 0);
-	*nr_printed_fields += 1;
-end:
-	bt_put(field_type);
-	bt_put(field);
-	return ret;
+	text_output_puts(&text->output, plan->color);
+	// TODO: escape the string value
+	text_output_putc(&text->output, '"');
+	text_output_puts(&text->output, bt_ctf_field_string_get_value(field));
+	text_output_putc(&text->output, '"');
+	text_output_puts(&text->output, plan->color_rst);
+	return BT_COMPONENT_STATUS_OK;
 }
 
 static
-enum bt_component_status print_struct(struct text_component *text,
-		struct bt_ctf_field *_struct, bool print_names,
-		GQuark *filter_fields, int filter_array_len)
+enum bt_component_status print_plan_struct(struct text_component *text,
+		struct print_plan *plan, struct bt_ctf_field *_struct)
 {
 	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
-	struct bt_ctf_field_type *struct_type = NULL;
-	int nr_fields, i, nr_printed_fields;
+	GArray *fields = plan->u.structure.fields;
+	guint i;
 
-	struct_type = bt_ctf_field_get_type(_struct);
-	if (!struct_type) {
-		ret = BT_COMPONENT_STATUS_ERROR;
-		goto end;
-	}
-	nr_fields = bt_ctf_field_type_structure_get_field_count(struct_type);
-	if (nr_fields < 0) {
-		ret = BT_COMPONENT_STATUS_ERROR;
-		goto end;
-	}
-	fprintf(text->out, "{");
+	text_output_putc(&text->output, '{');
 	text->depth++;
-	nr_printed_fields = 0;
-	for (i = 0; i < nr_fields; i++) {
-		ret = print_struct_field(text, _struct, struct_type, i,
-				print_names, &nr_printed_fields, filter_fields,
-				filter_array_len);
+	for (i = 0; i < fields->len; i++) {
+		struct print_plan_field *plan_field =
+			&g_array_index(fields, struct print_plan_field, i);
+		struct bt_ctf_field *field;
+
+		field = bt_ctf_field_structure_get_field_by_index(_struct,
+			plan_field->index);
+		if (!field) {
+			ret = BT_COMPONENT_STATUS_ERROR;
+			goto end;
+		}
+		text_output_write(&text->output, plan_field->prefix->str,
+			plan_field->prefix->len);
+		ret = plan_field->plan->print(text, plan_field->plan, field);
+		bt_put(field);
 		if (ret != BT_COMPONENT_STATUS_OK) {
 			goto end;
 		}
 	}
 	text->depth--;
-	fprintf(text->out, " }");
-end:
-	bt_put(struct_type);
-	return ret;
-}
-
-static
-enum bt_component_status print_array_field(struct text_component *text,
-		struct bt_ctf_field *array, uint64_t i,
-		bool is_string, bool print_names)
-{
-	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
-	struct bt_ctf_field *field = NULL;
-
-	if (!is_string) {
-		if (i != 0) {
-			fprintf(text->out, ", ");
-		} else {
-			fprintf(text->out, " ");
-		}
-	}
-	field = bt_ctf_field_array_get_field(array, i);
-	if (!field) {
-		ret = BT_COMPONENT_STATUS_ERROR;
-		goto end;
-	}
-	ret = print_field(text, field, print_names, NULL, 0);
+	text_output_puts(&text->output, " }");
 end:
-	bt_put(field);
 	return ret;
 }
 
 static
-enum bt_component_status print_array(struct text_component *text,
-		struct bt_ctf_field *array, bool print_names)
+enum bt_component_status print_plan_array_elements(
+		struct text_component *text, struct print_plan *plan,
+		struct bt_ctf_field *field, uint64_t len, bool is_sequence)
 {
 	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
-	struct bt_ctf_field_type *array_type = NULL, *field_type = NULL;
-	enum bt_ctf_type_id type_id;
-	int64_t len;
+	struct print_plan *element_plan = plan->u.array.element;
+	bool is_string = plan->u.array.is_string;
 	uint64_t i;
-	bool is_string = false;
-
-	array_type = bt_ctf_field_get_type(array);
-	if (!array_type) {
-		ret = BT_COMPONENT_STATUS_ERROR;
-		goto end;
-	}
-	field_type = bt_ctf_field_type_array_get_element_type(array_type);
-	if (!field_type) {
-		ret = BT_COMPONENT_STATUS_ERROR;
-		goto end;
-	}
-	len = bt_ctf_field_type_array_get_length(array_type);
-	if (len < 0) {
-		ret = BT_COMPONENT_STATUS_ERROR;
-		goto end;
-	}
-	type_id = bt_ctf_field_type_get_type_id(field_type);
-	if (type_id == BT_CTF_TYPE_ID_INTEGER) {
-		enum bt_ctf_string_encoding encoding;
-
-		encoding = bt_ctf_field_type_integer_get_encoding(field_type);
-		if (encoding == BT_CTF_STRING_ENCODING_UTF8
-				|| encoding == BT_CTF_STRING_ENCODING_ASCII) {
-			int integer_len, integer_alignment;
-
-			integer_len = bt_ctf_field_type_integer_get_size(field_type);
-			if (integer_len < 0) {
-				return BT_COMPONENT_STATUS_ERROR;
-			}
-			integer_alignment = bt_ctf_field_type_get_alignment(field_type);
-			if (integer_alignment < 0) {
-				return BT_COMPONENT_STATUS_ERROR;
-			}
-			if (integer_len == CHAR_BIT
-					&& integer_alignment == CHAR_BIT) {
-				is_string = true;
-			}
-		}
-	}
 
 	if (is_string) {
 		g_string_assign(text->string, "");
 	} else {
-		fprintf(text->out, "[");
+		text_output_putc(&text->output, '[');
 	}
 
 	text->depth++;
 	for (i = 0; i < len; i++) {
-		ret = print_array_field(text, array, i, is_string, print_names);
+		struct bt_ctf_field *element;
+
+		if (!is_string) {
+			text_output_puts(&text->output, i != 0 ? ", " : " ");
+		}
+		element = is_sequence ?
+			bt_ctf_field_sequence_get_field(field, i) :
+			bt_ctf_field_array_get_field(field, i);
+		if (!element) {
+			ret = BT_COMPONENT_STATUS_ERROR;
+			goto end;
+		}
+		ret = element_plan->print(text, element_plan, element);
+		bt_put(element);
 		if (ret != BT_COMPONENT_STATUS_OK) {
 			goto end;
 		}
@@ -977,156 +751,83 @@ enum bt_component_status print_array(struct text_component *text,
 	text->depth--;
 
 	if (is_string) {
-		if (text->use_colors) {
-			fputs(COLOR_STRING_VALUE, text->out);
-		}
+		text_output_puts(&text->output, plan->color);
 		// TODO: escape string
-		fprintf(text->out, "\"%s\"", text->string->str);
-		if (text->use_colors) {
-			fputs(COLOR_RST, text->out);
-		}
+		text_output_putc(&text->output, '"');
+		text_output_puts(&text->output, text->string->str);
+		text_output_putc(&text->output, '"');
+		text_output_puts(&text->output, plan->color_rst);
 	} else {
-		fprintf(text->out, " ]");
+		text_output_puts(&text->output, " ]");
 	}
 end:
-	bt_put(field_type);
-	bt_put(array_type);
 	return ret;
 }
 
 static
-enum bt_component_status print_sequence_field(struct text_component *text,
-		struct bt_ctf_field *seq, uint64_t i,
-		bool is_string, bool print_names)
+enum bt_component_status print_plan_array(struct text_component *text,
+		struct print_plan *plan, struct bt_ctf_field *array)
 {
-	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
-	struct bt_ctf_field *field = NULL;
-
-	if (!is_string) {
-		if (i != 0) {
-			fprintf(text->out, ", ");
-		} else {
-			fprintf(text->out, " ");
-		}
-	}
-	field = bt_ctf_field_sequence_get_field(seq, i);
-	if (!field) {
-		ret = BT_COMPONENT_STATUS_ERROR;
-		goto end;
-	}
-	ret = print_field(text, field, print_names, NULL, 0);
-end:
-	bt_put(field);
-	return ret;
+	return print_plan_array_elements(text, plan, array,
+		plan->u.array.length, false);
 }
 
 static
-enum bt_component_status print_sequence(struct text_component *text,
-		struct bt_ctf_field *seq, bool print_names)
+enum bt_component_status print_plan_sequence(struct text_component *text,
+		struct print_plan *plan, struct bt_ctf_field *seq)
 {
-	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
-	struct bt_ctf_field_type *seq_type = NULL, *field_type = NULL;
-	struct bt_ctf_field *length_field = NULL;
-	enum bt_ctf_type_id type_id;
+	enum bt_component_status ret;
+	struct bt_ctf_field *length_field;
 	uint64_t len;
-	uint64_t i;
-	bool is_string = false;
 
-	seq_type = bt_ctf_field_get_type(seq);
-	if (!seq_type) {
-		ret = BT_COMPONENT_STATUS_ERROR;
-		goto end;
-	}
 	length_field = bt_ctf_field_sequence_get_length(seq);
 	if (!length_field) {
-		ret = BT_COMPONENT_STATUS_ERROR;
-		goto end;
+		return BT_COMPONENT_STATUS_ERROR;
 	}
 	if (bt_ctf_field_unsigned_integer_get_value(length_field, &len) < 0) {
 		ret = BT_COMPONENT_STATUS_ERROR;
 		goto end;
 	}
-	field_type = bt_ctf_field_type_sequence_get_element_type(seq_type);
-	if (!field_type) {
-		ret = BT_COMPONENT_STATUS_ERROR;
-		goto end;
-	}
-	type_id = bt_ctf_field_type_get_type_id(field_type);
-	if (type_id == BT_CTF_TYPE_ID_INTEGER) {
-		enum bt_ctf_string_encoding encoding;
-
-		encoding = bt_ctf_field_type_integer_get_encoding(field_type);
-		if (encoding == BT_CTF_STRING_ENCODING_UTF8
-				|| encoding == BT_CTF_STRING_ENCODING_ASCII) {
-			int integer_len, integer_alignment;
-
-			integer_len = bt_ctf_field_type_integer_get_size(field_type);
-			if (integer_len < 0) {
-				ret = BT_COMPONENT_STATUS_ERROR;
-				goto end;
-			}
-			integer_alignment = bt_ctf_field_type_get_alignment(field_type);
-			if (integer_alignment < 0) {
-				ret = BT_COMPONENT_STATUS_ERROR;
-				goto end;
-			}
-			if (integer_len == CHAR_BIT
-					&& integer_alignment == CHAR_BIT) {
-				is_string = true;
-			}
-		}
-	}
-
-	if (is_string) {
-		g_string_assign(text->string, "");
-	} else {
-		fprintf(text->out, "[");
-	}
-
-	text->depth++;
-	for (i = 0; i < len; i++) {
-		ret = print_sequence_field(text, seq, i,
-			is_string, print_names);
-		if (ret != BT_COMPONENT_STATUS_OK) {
-			goto end;
-		}
-	}
-	text->depth--;
-
-	if (is_string) {
-		if (text->use_colors) {
-			fputs(COLOR_STRING_VALUE, text->out);
-		}
-		// TODO: escape string
-		fprintf(text->out, "\"%s\"", text->string->str);
-		if (text->use_colors) {
-			fputs(COLOR_RST, text->out);
-		}
-	} else {
-		fprintf(text->out, " ]");
-	}
+	ret = print_plan_array_elements(text, plan, seq, len, true);
 end:
 	bt_put(length_field);
-	bt_put(field_type);
-	bt_put(seq_type);
 	return ret;
 }
 
 static
-enum bt_component_status print_variant(struct text_component *text,
-		struct bt_ctf_field *variant, bool print_names)
+struct print_plan *get_print_plan(struct text_component *text,
+		struct bt_ctf_field_type *type, bool print_names,
+		GQuark *filter_fields, int filter_array_len);
+
+static
+enum bt_component_status print_plan_variant(struct text_component *text,
+		struct print_plan *plan, struct bt_ctf_field *variant)
 {
 	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
 	struct bt_ctf_field *field = NULL;
+	struct bt_ctf_field_type *field_type = NULL;
+	struct print_plan *field_plan;
 
 	field = bt_ctf_field_variant_get_current_field(variant);
 	if (!field) {
 		ret = BT_COMPONENT_STATUS_ERROR;
 		goto end;
 	}
-	fprintf(text->out, "{ ");
+	/* The chosen field's type depends on the tag. */
+	field_type = bt_ctf_field_get_type(field);
+	if (!field_type) {
+		ret = BT_COMPONENT_STATUS_ERROR;
+		goto end;
+	}
+	field_plan = get_print_plan(text, field_type, plan->print_names,
+		NULL, 0);
+	if (!field_plan) {
+		ret = BT_COMPONENT_STATUS_ERROR;
+		goto end;
+	}
+	text_output_puts(&text->output, "{ ");
 	text->depth++;
-	if (print_names) {
+	if (plan->print_names) {
 		int iter_ret;
 		struct bt_ctf_field *tag_field = NULL;
 		const char *tag_choice;
@@ -1158,126 +859,625 @@ enum bt_component_status print_variant(struct text_component *text,
 		bt_put(tag_field);
 		bt_put(iter);
 	}
-	ret = print_field(text, field, print_names, NULL, 0);
+	ret = field_plan->print(text, field_plan, field);
 	if (ret != BT_COMPONENT_STATUS_OK) {
 		goto end;
 	}
 	text->depth--;
-	fprintf(text->out, " }");
+	text_output_puts(&text->output, " }");
 end:
+	bt_put(field_type);
 	bt_put(field);
 	return ret;
 }
 
 static
-enum bt_component_status print_field(struct text_component *text,
-		struct bt_ctf_field *field, bool print_names,
+int filter_field_name(struct text_component *text, const char *field_name,
 		GQuark *filter_fields, int filter_array_len)
 {
-	enum bt_ctf_type_id type_id;
-
-	type_id = bt_ctf_field_get_type_id(field);
-	switch (type_id) {
-	case CTF_TYPE_INTEGER:
-		return print_integer(text, field);
-	case CTF_TYPE_FLOAT:
-	{
-		double v;
+	int i;
+	GQuark field_quark = g_quark_try_string(field_name);
 
-		if (bt_ctf_field_floating_point_get_value(field, &v)) {
-			return BT_COMPONENT_STATUS_ERROR;
-		}
-		if (text->use_colors) {
-			fputs(COLOR_NUMBER_VALUE, text->out);
-		}
-		fprintf(text->out, "%g", v);
-		if (text->use_colors) {
-			fputs(COLOR_RST, text->out);
-		}
-		return BT_COMPONENT_STATUS_OK;
+	if (!field_quark || text->options.verbose) {
+		return 1;
 	}
-	case CTF_TYPE_ENUM:
-		return print_enum(text, field);
-	case CTF_TYPE_STRING:
-		if (text->use_colors) {
-			fputs(COLOR_STRING_VALUE, text->out);
-		}
-		// TODO: escape the string value
-		fprintf(text->out, "\"%s\"",
-			bt_ctf_field_string_get_value(field));
-		if (text->use_colors) {
-			fputs(COLOR_RST, text->out);
+
+	for (i = 0; i < filter_array_len; i++) {
+		if (field_quark == filter_fields[i]) {
+			return 0;
 		}
-		return BT_COMPONENT_STATUS_OK;
-	case CTF_TYPE_STRUCT:
-		return print_struct(text, field, print_names, filter_fields,
-				filter_array_len);
-	case CTF_TYPE_UNTAGGED_VARIANT:
-	case CTF_TYPE_VARIANT:
-		return print_variant(text, field, print_names);
-	case CTF_TYPE_ARRAY:
-		return print_array(text, field, print_names);
-	case CTF_TYPE_SEQUENCE:
-		return print_sequence(text, field, print_names);
-	default:
-		fprintf(text->err, "[error] Unknown type id: %d\n", (int) type_id);
-		return BT_COMPONENT_STATUS_ERROR;
 	}
+	return 1;
 }
 
 static
-enum bt_component_status print_stream_packet_context(struct text_component *text,
-		struct bt_ctf_event *event)
+int init_print_plan_integer(struct print_plan *plan,
+		struct bt_ctf_field_type *type)
 {
-	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
-	struct bt_ctf_packet *packet = NULL;
-	struct bt_ctf_field *main_field = NULL;
+	int signedness = bt_ctf_field_type_integer_get_signed(type);
 
-	packet = bt_ctf_event_get_packet(event);
-	if (!packet) {
-		ret = BT_COMPONENT_STATUS_ERROR;
-		goto end;
-	}
-	main_field = bt_ctf_packet_get_context(packet);
-	if (!main_field) {
-		goto end;
+	if (signedness < 0) {
+		return -1;
 	}
-	if (!text->start_line) {
-		fputs(", ", text->out);
+	plan->u.integer.is_signed = signedness;
+	plan->u.integer.size = bt_ctf_field_type_integer_get_size(type);
+	plan->u.integer.encoding = bt_ctf_field_type_integer_get_encoding(type);
+	plan->u.integer.base = bt_ctf_field_type_integer_get_base(type);
+	switch (plan->u.integer.encoding) {
+	case BT_CTF_STRING_ENCODING_UTF8:
+	case BT_CTF_STRING_ENCODING_ASCII:
+	case BT_CTF_STRING_ENCODING_NONE:
+	case BT_CTF_STRING_ENCODING_UNKNOWN:
+		break;
+	default:
+		return -1;
 	}
-	text->start_line = false;
-	if (text->options.print_scope_field_names) {
-		print_name_equal(text, "stream.packet.context");
+	switch (plan->u.integer.base) {
+	case BT_CTF_INTEGER_BASE_DECIMAL:
+		break;
+	case BT_CTF_INTEGER_BASE_BINARY:
+	case BT_CTF_INTEGER_BASE_OCTAL:
+	case BT_CTF_INTEGER_BASE_HEXADECIMAL:
+		if (plan->u.integer.size < 0) {
+			return -1;
+		}
+		break;
+	default:
+		return -1;
 	}
-	ret = print_field(text, main_field,
-			text->options.print_context_field_names,
-			stream_packet_context_quarks,
-			STREAM_PACKET_CONTEXT_QUARKS_LEN);
-end:
-	bt_put(main_field);
-	bt_put(packet);
-	return ret;
+	return 0;
 }
 
 static
-enum bt_component_status print_event_header_raw(struct text_component *text,
-		struct bt_ctf_event *event)
+int init_print_plan_struct(struct text_component *text,
+		struct print_plan *plan, struct bt_ctf_field_type *type,
+		GQuark *filter_fields, int filter_array_len)
 {
-	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
-	struct bt_ctf_field *main_field = NULL;
+	int ret = 0;
+	int nr_fields, i;
 
-	main_field = bt_ctf_event_get_header(event);
-	if (!main_field) {
+	nr_fields = bt_ctf_field_type_structure_get_field_count(type);
+	if (nr_fields < 0) {
+		return -1;
+	}
+	plan->u.structure.fields = g_array_new(FALSE, TRUE,
+		sizeof(struct print_plan_field));
+	if (!plan->u.structure.fields) {
+		return -1;
+	}
+	for (i = 0; i < nr_fields; i++) {
+		struct print_plan_field plan_field = { 0 };
+		const char *field_name;
+		struct bt_ctf_field_type *field_type = NULL;
+
+		if (bt_ctf_field_type_structure_get_field(type,
+				&field_name, &field_type, i) < 0) {
+			return -1;
+		}
+		if (filter_fields && !filter_field_name(text, field_name,
+					filter_fields, filter_array_len)) {
+			bt_put(field_type);
+			continue;
+		}
+		plan_field.index = i;
+		plan_field.plan = get_print_plan(text, field_type,
+			plan->print_names, NULL, 0);
+		bt_put(field_type);
+		if (!plan_field.plan) {
+			return -1;
+		}
+		plan_field.prefix = g_string_new(
+			plan->u.structure.fields->len > 0 ? ", " : " ");
+		if (plan->print_names) {
+			append_name_equal(text, plan_field.prefix,
+				COLOR_FIELD_NAME, rem_(field_name));
+		}
+		g_array_append_val(plan->u.structure.fields, plan_field);
+	}
+	return ret;
+}
+
+/*
+ * Returns whether the elements of an array or sequence type are the
+ * characters of a string.
+ */
+static
+int is_string_element_type(struct bt_ctf_field_type *field_type)
+{
+	enum bt_ctf_string_encoding encoding;
+	int integer_len, integer_alignment;
+
+	if (bt_ctf_field_type_get_type_id(field_type) !=
+			BT_CTF_TYPE_ID_INTEGER) {
+		return 0;
+	}
+	encoding = bt_ctf_field_type_integer_get_encoding(field_type);
+	if (encoding != BT_CTF_STRING_ENCODING_UTF8
+			&& encoding != BT_CTF_STRING_ENCODING_ASCII) {
+		return 0;
+	}
+	integer_len = bt_ctf_field_type_integer_get_size(field_type);
+	if (integer_len < 0) {
+		return -1;
+	}
+	integer_alignment = bt_ctf_field_type_get_alignment(field_type);
+	if (integer_alignment < 0) {
+		return -1;
+	}
+	return integer_len == CHAR_BIT && integer_alignment == CHAR_BIT;
+}
+
+static
+int init_print_plan_array(struct text_component *text,
+		struct print_plan *plan, struct bt_ctf_field_type *type,
+		bool is_sequence)
+{
+	int ret = -1;
+	int is_string;
+	struct bt_ctf_field_type *element_type;
+
+	element_type = is_sequence ?
+		bt_ctf_field_type_sequence_get_element_type(type) :
+		bt_ctf_field_type_array_get_element_type(type);
+	if (!element_type) {
+		goto end;
+	}
+	if (!is_sequence) {
+		plan->u.array.length = bt_ctf_field_type_array_get_length(type);
+		if (plan->u.array.length < 0) {
+			goto end;
+		}
+	}
+	is_string = is_string_element_type(element_type);
+	if (is_string < 0) {
+		goto end;
+	}
+	plan->u.array.is_string = is_string;
+	plan->u.array.element = get_print_plan(text, element_type,
+		plan->print_names, NULL, 0);
+	if (!plan->u.array.element) {
+		goto end;
+	}
+	if (is_string && text->use_colors) {
+		plan->color = COLOR_STRING_VALUE;
+	}
+	ret = 0;
+end:
+	bt_put(element_type);
+	return ret;
+}
+
+static
+struct print_plan *create_print_plan(struct text_component *text,
+		struct bt_ctf_field_type *type, bool print_names,
+		GQuark *filter_fields, int filter_array_len)
+{
+	struct print_plan *plan;
+	struct bt_ctf_field_type *container_type;
+	int ret = 0;
+
+	plan = g_new0(struct print_plan, 1);
+	if (!plan) {
+		goto error;
+	}
+	plan->type = bt_get(type);
+	plan->print_names = print_names;
+	plan->color = "";
+	plan->color_rst = text->use_colors ? COLOR_RST : "";
+
+	switch (bt_ctf_field_type_get_type_id(type)) {
+	case CTF_TYPE_INTEGER:
+		plan->print = print_plan_integer;
+		if (text->use_colors) {
+			plan->color = COLOR_NUMBER_VALUE;
+		}
+		ret = init_print_plan_integer(plan, type);
+		break;
+	case CTF_TYPE_FLOAT:
+		plan->print = print_plan_float;
+		if (text->use_colors) {
+			plan->color = COLOR_NUMBER_VALUE;
+		}
+		break;
+	case CTF_TYPE_ENUM:
+		plan->print = print_plan_enum;
+		if (text->use_colors) {
+			plan->color = COLOR_ENUM_MAPPING_NAME;
+		}
+		container_type = bt_ctf_field_type_enumeration_get_container_type(
+			type);
+		if (!container_type) {
+			goto error;
+		}
+		plan->u.enumeration.container = get_print_plan(text,
+			container_type, print_names, NULL, 0);
+		bt_put(container_type);
+		if (!plan->u.enumeration.container) {
+			goto error;
+		}
+		break;
+	case CTF_TYPE_STRING:
+		plan->print = print_plan_string;
+		if (text->use_colors) {
+			plan->color = COLOR_STRING_VALUE;
+		}
+		break;
+	case CTF_TYPE_STRUCT:
+		plan->print = print_plan_struct;
+		ret = init_print_plan_struct(text, plan, type, filter_fields,
+			filter_array_len);
+		break;
+	case CTF_TYPE_UNTAGGED_VARIANT:
+	case CTF_TYPE_VARIANT:
+		plan->print = print_plan_variant;
+		break;
+	case CTF_TYPE_ARRAY:
+		plan->print = print_plan_array;
+		ret = init_print_plan_array(text, plan, type, false);
+		break;
+	case CTF_TYPE_SEQUENCE:
+		plan->print = print_plan_sequence;
+		ret = init_print_plan_array(text, plan, type, true);
+		break;
+	default:
+		fprintf(text->err, "[error] Unknown type id: %d\n",
+			(int) bt_ctf_field_type_get_type_id(type));
+		goto error;
+	}
+	if (ret) {
+		goto error;
+	}
+	return plan;
+error:
+	if (plan) {
+		print_plan_destroy(plan);
+	}
+	return NULL;
+}
+
+static
+struct print_plan *get_print_plan(struct text_component *text,
+		struct bt_ctf_field_type *type, bool print_names,
+		GQuark *filter_fields, int filter_array_len)
+{
+	GHashTable *cache = text->plans->types[plan_cache_index(print_names,
+		filter_fields != NULL)];
+	struct print_plan *plan;
+
+	plan = g_hash_table_lookup(cache, type);
+	if (likely(plan)) {
+		return plan;
+	}
+	plan = create_print_plan(text, type, print_names, filter_fields,
+		filter_array_len);
+	if (plan) {
+		g_hash_table_insert(cache, type, plan);
+	}
+	return plan;
+}
+
+static
+void append_env_field(struct text_component *text, GString *header,
+		struct bt_ctf_trace *trace, const char *env_name,
+		const char *display_name, bool is_integer, bool *start_line)
+{
+	struct bt_value *value;
+
+	value = bt_ctf_trace_get_environment_field_value_by_name(trace,
+		env_name);
+	if (!value) {
+		return;
+	}
+	if (!*start_line) {
+		g_string_append(header, ", ");
+	}
+	*start_line = false;
+	if (text->options.print_header_field_names) {
+		append_name_equal(text, header, COLOR_NAME, display_name);
+	}
+	if (is_integer) {
+		int64_t v;
+
+		if (bt_value_integer_get(value, &v) == BT_VALUE_STATUS_OK) {
+			g_string_append_printf(header, "(%" PRId64 ")", v);
+		}
+	} else {
+		const char *str;
+
+		if (bt_value_string_get(value, &str) == BT_VALUE_STATUS_OK) {
+			g_string_append(header, str);
+		}
+	}
+	bt_put(value);
+}
+
+/*
+ * Renders the part of an event's header which follows its timestamp:
+ * it only depends on the event's class and on the sink's options.
+ */
+static
+int render_event_header(struct text_component *text, GString *header,
+		struct bt_ctf_event_class *event_class,
+		struct bt_ctf_trace *trace_class)
+{
+	bool print_names = text->options.print_header_field_names;
+	/* As left by print_event_timestamp() */
+	bool start_line = !print_names;
+
+	if (text->options.print_trace_field) {
+		const char *name;
+
+		name = bt_ctf_trace_get_name(trace_class);
+		if (name) {
+			if (!start_line) {
+				g_string_append(header, ", ");
+			}
+			start_line = false;
+			if (print_names) {
+				append_name_equal(text, header, COLOR_NAME,
+					"trace");
+			}
+			g_string_append(header, name);
+		}
+	}
+	if (text->options.print_trace_hostname_field) {
+		append_env_field(text, header, trace_class, "hostname",
+			"trace:hostname", false, &start_line);
+	}
+	if (text->options.print_trace_domain_field) {
+		append_env_field(text, header, trace_class, "domain",
+			"trace:domain", false, &start_line);
+	}
+	if (text->options.print_trace_procname_field) {
+		append_env_field(text, header, trace_class, "procname",
+			"trace:procname", false, &start_line);
+	}
+	if (text->options.print_trace_vpid_field) {
+		append_env_field(text, header, trace_class, "vpid",
+			"trace:vpid", true, &start_line);
+	}
+	if (text->options.print_loglevel_field) {
+		struct bt_value *loglevel_str, *loglevel_value;
+
+		loglevel_str = bt_ctf_event_class_get_attribute_value_by_name(event_class,
+				"loglevel_string");
+		loglevel_value = bt_ctf_event_class_get_attribute_value_by_name(event_class,
+				"loglevel");
+		if (loglevel_str || loglevel_value) {
+			bool has_str = false;
+
+			if (!start_line) {
+				g_string_append(header, ", ");
+			}
+			start_line = false;
+			if (print_names) {
+				append_name_equal(text, header, COLOR_NAME,
+					"loglevel");
+			}
+			if (loglevel_str) {
+				const char *str;
+
+				if (bt_value_string_get(loglevel_str, &str)
+						== BT_VALUE_STATUS_OK) {
+					g_string_append(header, str);
+					has_str = true;
+				}
+			}
+			if (loglevel_value) {
+				int64_t value;
+
+				if (bt_value_integer_get(loglevel_value, &value)
+						== BT_VALUE_STATUS_OK) {
+					g_string_append_printf(header,
+						"%s(%" PRId64 ")",
+						has_str ? " " : "", value);
+				}
+			}
+			bt_put(loglevel_str);
+			bt_put(loglevel_value);
+		}
+	}
+	if (text->options.print_emf_field) {
+		struct bt_value *uri_str;
+
+		uri_str = bt_ctf_event_class_get_attribute_value_by_name(event_class,
+				"model.emf.uri");
+		if (uri_str) {
+			const char *str;
+
+			if (!start_line) {
+				g_string_append(header, ", ");
+			}
+			start_line = false;
+			if (print_names) {
+				append_name_equal(text, header, COLOR_NAME,
+					"model.emf.uri");
+			}
+			if (bt_value_string_get(uri_str, &str)
+					== BT_VALUE_STATUS_OK) {
+				g_string_append(header, str);
+			}
+			bt_put(uri_str);
+		}
+	}
+	if (!start_line) {
+		g_string_append(header, ", ");
+	}
+	if (print_names) {
+		append_name_equal(text, header, COLOR_NAME, "name");
+	}
+	if (text->use_colors) {
+		g_string_append(header, COLOR_EVENT_NAME);
+	}
+	g_string_append(header, bt_ctf_event_class_get_name(event_class));
+	if (text->use_colors) {
+		g_string_append(header, COLOR_RST);
+	}
+	return 0;
+}
+
+static
+struct event_class_plan *create_event_class_plan(struct text_component *text,
+		struct bt_ctf_event_class *event_class)
+{
+	struct event_class_plan *plan;
+	struct bt_ctf_stream_class *stream_class = NULL;
+	struct bt_ctf_trace *trace_class = NULL;
+
+	plan = g_new0(struct event_class_plan, 1);
+	if (!plan) {
+		goto error;
+	}
+	plan->event_class = bt_get(event_class);
+	stream_class = bt_ctf_event_class_get_stream_class(event_class);
+	if (!stream_class) {
+		goto error;
+	}
+	trace_class = bt_ctf_stream_class_get_trace(stream_class);
+	if (!trace_class) {
+		goto error;
+	}
+	plan->clock_class = bt_ctf_trace_get_clock_class(trace_class, 0);
+	if (!plan->clock_class) {
+		goto error;
+	}
+	plan->header = g_string_new("");
+	if (!plan->header) {
+		goto error;
+	}
+	if (render_event_header(text, plan->header, event_class,
+			trace_class)) {
+		goto error;
+	}
+end:
+	bt_put(trace_class);
+	bt_put(stream_class);
+	return plan;
+error:
+	if (plan) {
+		event_class_plan_destroy(plan);
+		plan = NULL;
+	}
+	goto end;
+}
+
+static
+struct event_class_plan *get_event_class_plan(struct text_component *text,
+		struct bt_ctf_event *event)
+{
+	struct bt_ctf_event_class *event_class;
+	struct event_class_plan *plan;
+
+	event_class = bt_ctf_event_get_class(event);
+	if (!event_class) {
+		return NULL;
+	}
+	plan = g_hash_table_lookup(text->plans->event_classes, event_class);
+	if (unlikely(!plan)) {
+		plan = create_event_class_plan(text, event_class);
+		if (plan) {
+			g_hash_table_insert(text->plans->event_classes,
+				event_class, plan);
+		}
+	}
+	bt_put(event_class);
+	return plan;
+}
+
+static
+enum bt_component_status print_event_header(struct text_component *text,
+		struct bt_ctf_event *event)
+{
+	enum bt_component_status ret;
+	struct event_class_plan *plan;
+
+	plan = get_event_class_plan(text, event);
+	if (!plan) {
+		ret = BT_COMPONENT_STATUS_ERROR;
 		goto end;
 	}
-	if (!text->start_line) {
-		fputs(", ", text->out);
+	text->start_line = false;
+	ret = print_event_timestamp(text, plan->clock_class, event,
+		&text->start_line);
+	if (ret != BT_COMPONENT_STATUS_OK) {
+		goto end;
 	}
+	text_output_write(&text->output, plan->header->str,
+		plan->header->len);
 	text->start_line = false;
-	if (text->options.print_scope_field_names) {
-		print_name_equal(text, "stream.event.header");
+end:
+	return ret;
+}
+
+static
+enum bt_component_status print_scope(struct text_component *text,
+		struct bt_ctf_field *main_field, enum print_plan_scope scope,
+		bool print_names, GQuark *filter_fields, int filter_array_len)
+{
+	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
+	struct bt_ctf_field_type *main_type;
+	struct print_plan *plan;
+	GString *prefix = text->plans->scope_prefixes[scope];
+
+	main_type = bt_ctf_field_get_type(main_field);
+	if (!main_type) {
+		ret = BT_COMPONENT_STATUS_ERROR;
+		goto end;
+	}
+	plan = get_print_plan(text, main_type, print_names, filter_fields,
+		filter_array_len);
+	bt_put(main_type);
+	if (!plan) {
+		ret = BT_COMPONENT_STATUS_ERROR;
+		goto end;
 	}
-	ret = print_field(text, main_field,
+	/* The event's name was printed before. */
+	text_output_write(&text->output, prefix->str, prefix->len);
+	text->start_line = false;
+	ret = plan->print(text, plan, main_field);
+end:
+	return ret;
+}
+
+static
+enum bt_component_status print_stream_packet_context(struct text_component *text,
+		struct bt_ctf_event *event)
+{
+	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
+	struct bt_ctf_packet *packet = NULL;
+	struct bt_ctf_field *main_field = NULL;
+
+	packet = bt_ctf_event_get_packet(event);
+	if (!packet) {
+		ret = BT_COMPONENT_STATUS_ERROR;
+		goto end;
+	}
+	main_field = bt_ctf_packet_get_context(packet);
+	if (!main_field) {
+		goto end;
+	}
+	ret = print_scope(text, main_field, PRINT_PLAN_SCOPE_PACKET_CONTEXT,
+			text->options.print_context_field_names,
+			stream_packet_context_quarks,
+			STREAM_PACKET_CONTEXT_QUARKS_LEN);
+end:
+	bt_put(main_field);
+	bt_put(packet);
+	return ret;
+}
+
+static
+enum bt_component_status print_event_header_raw(struct text_component *text,
+		struct bt_ctf_event *event)
+{
+	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
+	struct bt_ctf_field *main_field = NULL;
+
+	main_field = bt_ctf_event_get_header(event);
+	if (!main_field) {
+		goto end;
+	}
+	ret = print_scope(text, main_field, PRINT_PLAN_SCOPE_EVENT_HEADER,
 			text->options.print_header_field_names, NULL, 0);
 end:
 	bt_put(main_field);
@@ -1295,14 +1495,8 @@ enum bt_component_status print_stream_event_context(struct text_component *text,
 	if (!main_field) {
 		goto end;
 	}
-	if (!text->start_line) {
-		fputs(", ", text->out);
-	}
-	text->start_line = false;
-	if (text->options.print_scope_field_names) {
-		print_name_equal(text, "stream.event.context");
-	}
-	ret = print_field(text, main_field,
+	ret = print_scope(text, main_field,
+			PRINT_PLAN_SCOPE_STREAM_EVENT_CONTEXT,
 			text->options.print_context_field_names, NULL, 0);
 end:
 	bt_put(main_field);
@@ -1320,14 +1514,7 @@ enum bt_component_status print_event_context(struct text_component *text,
 	if (!main_field) {
 		goto end;
 	}
-	if (!text->start_line) {
-		fputs(", ", text->out);
-	}
-	text->start_line = false;
-	if (text->options.print_scope_field_names) {
-		print_name_equal(text, "event.context");
-	}
-	ret = print_field(text, main_field,
+	ret = print_scope(text, main_field, PRINT_PLAN_SCOPE_EVENT_CONTEXT,
 			text->options.print_context_field_names, NULL, 0);
 end:
 	bt_put(main_field);
@@ -1345,20 +1532,120 @@ enum bt_component_status print_event_payload(struct text_component *text,
 	if (!main_field) {
 		goto end;
 	}
-	if (!text->start_line) {
-		fputs(", ", text->out);
-	}
-	text->start_line = false;
-	if (text->options.print_scope_field_names) {
-		print_name_equal(text, "event.fields");
-	}
-	ret = print_field(text, main_field,
+	ret = print_scope(text, main_field, PRINT_PLAN_SCOPE_EVENT_PAYLOAD,
 			text->options.print_payload_field_names, NULL, 0);
 end:
 	bt_put(main_field);
 	return ret;
 }
 
+BT_HIDDEN
+struct text_print_plans *text_print_plans_create(struct text_component *text)
+{
+	static const char *scope_names[] = {
+		[PRINT_PLAN_SCOPE_PACKET_CONTEXT] = "stream.packet.context",
+		[PRINT_PLAN_SCOPE_EVENT_HEADER] = "stream.event.header",
+		[PRINT_PLAN_SCOPE_STREAM_EVENT_CONTEXT] = "stream.event.context",
+		[PRINT_PLAN_SCOPE_EVENT_CONTEXT] = "event.context",
+		[PRINT_PLAN_SCOPE_EVENT_PAYLOAD] = "event.fields",
+	};
+	struct text_print_plans *plans;
+	int i;
+
+	plans = g_new0(struct text_print_plans, 1);
+	if (!plans) {
+		goto error;
+	}
+	for (i = 0; i < BT_ARRAY_SIZE(plans->types); i++) {
+		plans->types[i] = g_hash_table_new_full(g_direct_hash,
+			g_direct_equal, NULL, print_plan_destroy);
+		if (!plans->types[i]) {
+			goto error;
+		}
+	}
+	plans->event_classes = g_hash_table_new_full(g_direct_hash,
+		g_direct_equal, NULL, event_class_plan_destroy);
+	if (!plans->event_classes) {
+		goto error;
+	}
+	for (i = 0; i < PRINT_PLAN_SCOPE_LEN; i++) {
+		plans->scope_prefixes[i] = g_string_new(", ");
+		if (!plans->scope_prefixes[i]) {
+			goto error;
+		}
+		if (text->options.print_scope_field_names) {
+			append_name_equal(text, plans->scope_prefixes[i],
+				COLOR_NAME, scope_names[i]);
+		}
+	}
+	return plans;
+error:
+	text_print_plans_destroy(plans);
+	return NULL;
+}
+
+BT_HIDDEN
+void text_print_plans_destroy(struct text_print_plans *plans)
+{
+	int i;
+
+	if (!plans) {
+		return;
+	}
+	/* Plans refer to each other: destroy them all at once. */
+	for (i = 0; i < BT_ARRAY_SIZE(plans->types); i++) {
+		if (plans->types[i]) {
+			g_hash_table_destroy(plans->types[i]);
+		}
+	}
+	if (plans->event_classes) {
+		g_hash_table_destroy(plans->event_classes);
+	}
+	for (i = 0; i < PRINT_PLAN_SCOPE_LEN; i++) {
+		if (plans->scope_prefixes[i]) {
+			g_string_free(plans->scope_prefixes[i], TRUE);
+		}
+	}
+	g_free(plans);
+}
+
+BT_HIDDEN
+enum bt_component_status text_update_deltas(struct text_component *text,
+		struct bt_ctf_event *event)
+{
+	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
+	struct event_class_plan *plan;
+	struct bt_ctf_clock_value *clock_value;
+
+	plan = get_event_class_plan(text, event);
+	if (!plan) {
+		ret = BT_COMPONENT_STATUS_ERROR;
+		goto end;
+	}
+	clock_value = bt_ctf_event_get_clock_value(event, plan->clock_class);
+	if (!clock_value) {
+		goto end;
+	}
+	/* Same updates as when printing the timestamp */
+	if (text->options.print_timestamp_cycles) {
+		uint64_t cycles;
+
+		if (!bt_ctf_clock_value_get_value(clock_value, &cycles)) {
+			update_cycles_delta(text, cycles);
+		}
+	} else {
+		int64_t ts_nsec;
+
+		if (!bt_ctf_clock_value_get_value_ns_from_epoch(clock_value,
+				&ts_nsec)) {
+			update_real_delta(text, ts_nsec);
+		}
+	}
+	bt_put(clock_value);
+end:
+	return ret;
+}
+
 BT_HIDDEN
 enum bt_component_status text_print_event(struct text_component *text,
 		struct bt_ctf_event *event)
@@ -1396,7 +1683,7 @@ enum bt_component_status text_print_event(struct text_component *text,
 		goto end;
 	}
 
-	fputc('\n', text->out);
+	text_output_putc(&text->output, '\n');
 end:
 	return ret;
 }
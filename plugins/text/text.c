@@ -41,8 +41,10 @@
 #include <plugins-common.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <unistd.h>
 #include <glib.h>
 #include "text.h"
+#include "formatter.h"
 #include <assert.h>
 
 static
@@ -71,12 +73,17 @@ const char *plugin_options[] = {
 	"field-trace:vpid",
 	"field-loglevel",
 	"field-emf",
+	"threads",
 };
 
 static
 void destroy_text_data(struct text_component *text)
 {
 	bt_put(text->input_iterator);
+	/* Joins the formatter threads, which borrow the sink's options. */
+	text_formatter_pool_destroy(text->formatters);
+	text_output_fini(&text->output);
+	text_print_plans_destroy(text->plans);
 	(void) g_string_free(text->string, TRUE);
 	g_free(text->options.output_path);
 	g_free(text->options.debug_info_dir);
@@ -113,8 +120,9 @@ void destroy_text(struct bt_component *component)
 	destroy_text_data(data);
 }
 
-static
-enum bt_component_status handle_notification(struct text_component *text,
+BT_HIDDEN
+enum bt_component_status text_handle_notification(
+		struct text_component *text,
 		struct bt_notification *notification)
 {
 	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
@@ -126,10 +134,10 @@ enum bt_component_status handle_notification(struct text_component *text,
 
 	switch (bt_notification_get_type(notification)) {
 	case BT_NOTIFICATION_TYPE_PACKET_BEGIN:
-		puts("<packet>");
+		text_output_puts(&text->output, "<packet>\n");
 		break;
 	case BT_NOTIFICATION_TYPE_PACKET_END:
-		puts("</packet>");
+		text_output_puts(&text->output, "</packet>\n");
 		break;
 	case BT_NOTIFICATION_TYPE_EVENT:
 	{
@@ -148,10 +156,10 @@ enum bt_component_status handle_notification(struct text_component *text,
 		break;
 	}
 	case BT_NOTIFICATION_TYPE_STREAM_END:
-		puts("</stream>");
+		text_output_puts(&text->output, "</stream>\n");
 		break;
 	default:
-		puts("Unhandled notification type");
+		text_output_puts(&text->output, "Unhandled notification type\n");
 	}
 end:
 	return ret;
@@ -180,42 +188,68 @@ enum bt_component_status text_new_connection(struct bt_port *own_port,
 	return ret;
 }
 
+/* Number of notifications pulled from the input iterator at once. */
+#define TEXT_NOTIFICATION_BATCH_SIZE	64
+
 static
 enum bt_component_status run(struct bt_component *component)
 {
-	enum bt_component_status ret;
-	struct bt_notification *notification = NULL;
-	struct bt_notification_iterator *it;
+	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
+	struct bt_notification *local[TEXT_NOTIFICATION_BATCH_SIZE];
+	struct bt_notification **notifications = local;
+	size_t batch_size = BT_ARRAY_SIZE(local);
+	enum bt_notification_iterator_status it_ret;
+	size_t count = 0, i;
 	struct text_component *text = bt_component_get_private_data(component);
 
-	it = text->input_iterator;
-
-	if (likely(text->processed_first_event)) {
-		enum bt_notification_iterator_status it_ret;
-
-		it_ret = bt_notification_iterator_next(it);
-		switch (it_ret) {
-		case BT_NOTIFICATION_ITERATOR_STATUS_ERROR:
-			ret = BT_COMPONENT_STATUS_ERROR;
-			goto end;
-		case BT_NOTIFICATION_ITERATOR_STATUS_END:
-			ret = BT_COMPONENT_STATUS_END;
-			BT_PUT(text->input_iterator);
-			goto end;
-		default:
-			break;
-		}
+	if (text->formatters) {
+		notifications = text_formatter_pool_batch(text->formatters);
+		batch_size = text_formatter_pool_batch_size(text->formatters);
 	}
-	notification = bt_notification_iterator_get_notification(it);
-	if (!notification) {
+
+	it_ret = bt_notification_iterator_next_batch(text->input_iterator,
+			notifications, batch_size, &count);
+	switch (it_ret) {
+	case BT_NOTIFICATION_ITERATOR_STATUS_OK:
+		break;
+	case BT_NOTIFICATION_ITERATOR_STATUS_END:
+		ret = BT_COMPONENT_STATUS_END;
+		BT_PUT(text->input_iterator);
+		goto end;
+	case BT_NOTIFICATION_ITERATOR_STATUS_AGAIN:
+		ret = BT_COMPONENT_STATUS_AGAIN;
+		goto end;
+	default:
 		ret = BT_COMPONENT_STATUS_ERROR;
 		goto end;
 	}
 
-	ret = handle_notification(text, notification);
-	text->processed_first_event = true;
+	if (text->formatters) {
+		ret = text_formatter_pool_format(text->formatters, count);
+		goto flush;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (ret == BT_COMPONENT_STATUS_OK) {
+			ret = text_handle_notification(text, notifications[i]);
+		}
+		bt_put(notifications[i]);
+	}
+
+flush:
+
+	/* Otherwise, the buffer is flushed when full. */
+	if (text->line_buffered) {
+		(void) text_output_flush(&text->output);
+	}
 end:
-	bt_put(notification);
+	if (text->output.error) {
+		fprintf(text->err, "[error] Cannot write output\n");
+		ret = BT_COMPONENT_STATUS_ERROR;
+	} else if (ret == BT_COMPONENT_STATUS_END &&
+			text_output_flush(&text->output)) {
+		ret = BT_COMPONENT_STATUS_ERROR;
+	}
 	return ret;
 }
 
@@ -449,6 +483,27 @@ enum bt_component_status apply_params(struct text_component *text,
 	}
 	text->options.verbose = value;
 
+	text->options.threads = 1;	/* Default. */
+	if (bt_value_map_has_key(params, "threads")) {
+		struct bt_value *threads_value;
+		int64_t threads;
+
+		threads_value = bt_value_map_get(params, "threads");
+		if (!threads_value) {
+			goto end;
+		}
+
+		if (bt_value_integer_get(threads_value, &threads) ||
+				threads < 1 || threads > 256) {
+			fprintf(text->err,
+				"[warning] The \"threads\" parameter must be an integer between 1 and 256\n");
+		} else {
+			text->options.threads = threads;
+		}
+
+		bt_put(threads_value);
+	}
+
 	/* Names. */
 	ret = apply_one_string("name-default", params, &str);
 	if (ret != BT_COMPONENT_STATUS_OK) {
@@ -723,6 +778,11 @@ enum bt_component_status text_component_init(
 
 	text->out = stdout;
 	text->err = stderr;
+	if (text_output_init(&text->output, text->out)) {
+		ret = BT_COMPONENT_STATUS_NOMEM;
+		goto error;
+	}
+	text->line_buffered = isatty(fileno(text->out));
 
 	text->delta_cycles = -1ULL;
 	text->last_cycles_timestamp = -1ULL;
@@ -737,6 +797,21 @@ enum bt_component_status text_component_init(
 
 	set_use_colors(text);
 
+	text->plans = text_print_plans_create(text);
+	if (!text->plans) {
+		ret = BT_COMPONENT_STATUS_NOMEM;
+		goto error;
+	}
+
+	if (text->options.threads > 1) {
+		text->formatters = text_formatter_pool_create(text,
+			text->options.threads);
+		if (!text->formatters) {
+			ret = BT_COMPONENT_STATUS_ERROR;
+			goto error;
+		}
+	}
+
 	ret = bt_component_set_private_data(component, text);
 	if (ret != BT_COMPONENT_STATUS_OK) {
 		goto error;
@@ -30,6 +30,7 @@
 #include <stdbool.h>
 #include <babeltrace/babeltrace-internal.h>
 #include <babeltrace/component/component.h>
+#include "output.h"
 
 enum text_default {
 	TEXT_DEFAULT_UNSET,
@@ -72,13 +73,35 @@ struct text_options {
 	bool debug_info_full_path;
 	enum text_color_option color;
 	bool verbose;
+	/* Formatting threads; 1 formats in the sink's thread only. */
+	unsigned int threads;
+};
+
+struct text_print_plans;
+struct text_formatter_pool;
+
+/* Rendering of the second of the last timestamp printed as wall time */
+struct text_time_cache {
+	bool valid;
+	uint64_t sec;
+	/* "[YYYY-MM-DD ]HH:MM:SS." */
+	char str[48];
+	size_t len;
 };
 
 struct text_component {
 	struct text_options options;
 	struct bt_notification_iterator *input_iterator;
 	FILE *out, *err;
-	bool processed_first_event; /* Should be per-iterator. */
+	/* Buffer in front of "out" */
+	struct text_output output;
+	/* Flush the output after each batch of notifications */
+	bool line_buffered;
+	struct text_time_cache time_cache;
+	/* Cached printing decisions, see print.c */
+	struct text_print_plans *plans;
+	/* NULL when formatting serially */
+	struct text_formatter_pool *formatters;
 	int depth;	/* nesting, used for tabulation alignment. */
 	bool start_line;
 	GString *string;
@@ -104,8 +127,28 @@ enum stream_packet_context_quarks_enum {
 
 GQuark stream_packet_context_quarks[STREAM_PACKET_CONTEXT_QUARKS_LEN];
 
+/* Needs the sink's options to be set. */
+BT_HIDDEN
+struct text_print_plans *text_print_plans_create(struct text_component *text);
+
+BT_HIDDEN
+void text_print_plans_destroy(struct text_print_plans *plans);
+
 BT_HIDDEN
 enum bt_component_status text_print_event(struct text_component *text,
 		struct bt_ctf_event *event);
 
+/*
+ * Updates the delta state as printing the event's timestamp would,
+ * without printing anything.
+ */
+BT_HIDDEN
+enum bt_component_status text_update_deltas(struct text_component *text,
+		struct bt_ctf_event *event);
+
+BT_HIDDEN
+enum bt_component_status text_handle_notification(
+		struct text_component *text,
+		struct bt_notification *notification);
+
 #endif /* BABELTRACE_PLUGIN_TEXT_H */
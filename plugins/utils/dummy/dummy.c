@@ -130,6 +130,9 @@ enum bt_component_status dummy_consume(struct bt_component *component)
 			g_ptr_array_remove_index(dummy->iterators, i);
 			i--;
 			continue;
+		case BT_NOTIFICATION_ITERATOR_STATUS_AGAIN:
+			/* Nothing from this one yet: try it next time. */
+			continue;
 		default:
 			break;
 		}
@@ -56,9 +56,24 @@ void trimmer_iterator_destroy(struct bt_notification_iterator *it)
 
 	bt_put(it_data->current_notification);
 	bt_put(it_data->input_iterator);
+	if (it_data->streams) {
+		g_hash_table_destroy(it_data->streams);
+	}
+	if (it_data->closing_notifications) {
+		g_queue_free_full(it_data->closing_notifications, bt_put);
+	}
 	g_free(it_data);
 }
 
+static
+void destroy_trimmer_stream(gpointer data)
+{
+	struct trimmer_stream *trim_stream = data;
+
+	bt_put(trim_stream->open_packet);
+	g_free(trim_stream);
+}
+
 BT_HIDDEN
 enum bt_notification_iterator_status trimmer_iterator_init(
 		struct bt_component *component,
@@ -70,6 +85,7 @@ enum bt_notification_iterator_status trimmer_iterator_init(
 	enum bt_notification_iterator_status it_ret;
 	struct bt_port *input_port = NULL;
 	struct bt_connection *connection = NULL;
+	struct trimmer *trimmer = bt_component_get_private_data(component);
 	struct trimmer_iterator *it_data = g_new0(struct trimmer_iterator, 1);
 
 	if (!it_data) {
@@ -77,6 +93,19 @@ enum bt_notification_iterator_status trimmer_iterator_init(
 		goto end;
 	}
 
+	it_data->streams = g_hash_table_new_full(g_direct_hash,
+			g_direct_equal, bt_put, destroy_trimmer_stream);
+	if (!it_data->streams) {
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_NOMEM;
+		goto end;
+	}
+
+	it_data->closing_notifications = g_queue_new();
+	if (!it_data->closing_notifications) {
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_NOMEM;
+		goto end;
+	}
+
 	/* Create a new iterator on the upstream component. */
 	input_port = bt_component_filter_get_default_input_port(component);
 	assert(input_port);
@@ -90,6 +119,28 @@ enum bt_notification_iterator_status trimmer_iterator_init(
 		goto end;
 	}
 
+	/*
+	 * Skip everything preceding the range's beginning upstream, when
+	 * supported, rather than decoding and discarding it here. A lazy
+	 * beginning is only known once the first event is read.
+	 */
+	assert(trimmer);
+	if (trimmer->begin.set) {
+		it_ret = bt_notification_iterator_seek_time(
+				it_data->input_iterator,
+				BT_NOTIFICATION_ITERATOR_SEEK_ORIGIN_EPOCH,
+				trimmer->begin.value);
+		switch (it_ret) {
+		case BT_NOTIFICATION_ITERATOR_STATUS_OK:
+		case BT_NOTIFICATION_ITERATOR_STATUS_UNSUPPORTED:
+			break;
+		default:
+			printf_error("Failed to seek input iterator to the range's beginning");
+			ret = it_ret;
+			goto end;
+		}
+	}
+
 	it_ret = bt_notification_iterator_set_private_data(iterator, it_data);
 	if (it_ret) {
 		goto end;
@@ -185,12 +236,13 @@ static
 enum bt_notification_iterator_status
 evaluate_event_notification(struct bt_notification *notification,
 		struct trimmer_bound *begin, struct trimmer_bound *end,
-		bool *_event_in_range)
+		bool *_event_in_range, bool *_past_end)
 {
 	int64_t ts;
 	int clock_ret;
 	struct bt_ctf_event *event = NULL;
 	bool in_range = true;
+	bool past_end = false;
 	struct bt_ctf_clock_class *clock_class = NULL;
 	struct bt_ctf_trace *trace = NULL;
 	struct bt_ctf_stream *stream = NULL;
@@ -252,6 +304,7 @@ evaluate_event_notification(struct bt_notification *notification,
 	}
 	if (end->set && ts > end->value) {
 		in_range = false;
+		past_end = true;
 	}
 end:
 	bt_put(event);
@@ -261,6 +314,7 @@ end:
 	bt_put(stream_class);
 	bt_put(clock_value);
 	*_event_in_range = in_range;
+	*_past_end = past_end;
 	return ret;
 }
 
@@ -312,12 +366,13 @@ static
 enum bt_notification_iterator_status evaluate_packet_notification(
 		struct bt_notification *notification,
 		struct trimmer_bound *begin, struct trimmer_bound *end,
-		bool *_packet_in_range)
+		bool *_packet_in_range, bool *_past_end)
 {
         enum bt_notification_iterator_status ret =
 			BT_NOTIFICATION_ITERATOR_STATUS_OK;
 	int64_t begin_ns, pkt_begin_ns, end_ns, pkt_end_ns;
 	bool in_range = true;
+	bool past_end = false;
 	struct bt_ctf_packet *packet = NULL;
 	struct bt_ctf_field *packet_context = NULL,
 			*timestamp_begin = NULL,
@@ -370,8 +425,14 @@ enum bt_notification_iterator_status evaluate_packet_notification(
 	 * packet.
 	 */
 	in_range = (pkt_end_ns >= begin_ns) && (pkt_begin_ns <= end_ns);
+
+	/* A packet beginning after the range's end ends the stream's range. */
+	past_end = bt_notification_get_type(notification) ==
+			BT_NOTIFICATION_TYPE_PACKET_BEGIN &&
+			pkt_begin_ns > end_ns;
 end:
 	*_packet_in_range = in_range;
+	*_past_end = past_end;
 	bt_put(packet);
 	bt_put(packet_context);
 	bt_put(timestamp_begin);
@@ -384,23 +445,24 @@ static
 enum bt_notification_iterator_status evaluate_notification(
 		struct bt_notification *notification,
 		struct trimmer_bound *begin, struct trimmer_bound *end,
-		bool *in_range)
+		bool *in_range, bool *past_end)
 {
 	enum bt_notification_type type;
 	enum bt_notification_iterator_status ret =
 			BT_NOTIFICATION_ITERATOR_STATUS_OK;
 
 	*in_range = true;
+	*past_end = false;
 	type = bt_notification_get_type(notification);
 	switch (type) {
 	case BT_NOTIFICATION_TYPE_EVENT:
 	        ret = evaluate_event_notification(notification, begin,
-				end, in_range);
+				end, in_range, past_end);
 		break;
 	case BT_NOTIFICATION_TYPE_PACKET_BEGIN:
 	case BT_NOTIFICATION_TYPE_PACKET_END:
 	        ret = evaluate_packet_notification(notification, begin,
-				end, in_range);
+				end, in_range, past_end);
 		break;
 	default:
 		/* Accept all other notifications. */
@@ -409,6 +471,169 @@ enum bt_notification_iterator_status evaluate_notification(
 	return ret;
 }
 
+static
+struct bt_ctf_stream *get_notification_stream(
+		struct bt_notification *notification)
+{
+	struct bt_ctf_stream *stream = NULL;
+
+	switch (bt_notification_get_type(notification)) {
+	case BT_NOTIFICATION_TYPE_EVENT:
+	{
+		struct bt_ctf_event *event;
+
+		event = bt_notification_event_get_event(notification);
+		stream = bt_ctf_event_get_stream(event);
+		bt_put(event);
+		break;
+	}
+	case BT_NOTIFICATION_TYPE_PACKET_BEGIN:
+	{
+		struct bt_ctf_packet *packet;
+
+		packet = bt_notification_packet_begin_get_packet(notification);
+		stream = bt_ctf_packet_get_stream(packet);
+		bt_put(packet);
+		break;
+	}
+	case BT_NOTIFICATION_TYPE_PACKET_END:
+	{
+		struct bt_ctf_packet *packet;
+
+		packet = bt_notification_packet_end_get_packet(notification);
+		stream = bt_ctf_packet_get_stream(packet);
+		bt_put(packet);
+		break;
+	}
+	case BT_NOTIFICATION_TYPE_STREAM_END:
+		stream = bt_notification_stream_end_get_stream(notification);
+		break;
+	default:
+		break;
+	}
+
+	return stream;
+}
+
+/*
+ * Track the packets forwarded for each stream and whether the stream
+ * passed the range's end.
+ */
+static
+enum bt_notification_iterator_status update_stream_state(
+		struct trimmer_iterator *trim_it,
+		struct bt_notification *notification, bool in_range,
+		bool past_end)
+{
+	enum bt_notification_iterator_status ret =
+			BT_NOTIFICATION_ITERATOR_STATUS_OK;
+	enum bt_notification_type type;
+	struct trimmer_stream *trim_stream;
+	struct bt_ctf_stream *stream;
+
+	stream = get_notification_stream(notification);
+	if (!stream) {
+		goto end;
+	}
+
+	type = bt_notification_get_type(notification);
+	trim_stream = g_hash_table_lookup(trim_it->streams, stream);
+	if (!trim_stream) {
+		if (type == BT_NOTIFICATION_TYPE_STREAM_END) {
+			goto end;
+		}
+
+		trim_stream = g_new0(struct trimmer_stream, 1);
+		if (!trim_stream) {
+			ret = BT_NOTIFICATION_ITERATOR_STATUS_NOMEM;
+			goto end;
+		}
+
+		g_hash_table_insert(trim_it->streams, bt_get(stream),
+				trim_stream);
+		trim_it->streams_before_end++;
+	}
+
+	switch (type) {
+	case BT_NOTIFICATION_TYPE_PACKET_BEGIN:
+		if (in_range) {
+			bt_put(trim_stream->open_packet);
+			trim_stream->open_packet =
+				bt_notification_packet_begin_get_packet(
+					notification);
+		}
+		break;
+	case BT_NOTIFICATION_TYPE_PACKET_END:
+		if (in_range) {
+			BT_PUT(trim_stream->open_packet);
+		}
+		break;
+	case BT_NOTIFICATION_TYPE_STREAM_END:
+		if (!trim_stream->passed_end) {
+			trim_it->streams_before_end--;
+		}
+		g_hash_table_remove(trim_it->streams, stream);
+		goto end;
+	default:
+		break;
+	}
+
+	if (past_end && !trim_stream->passed_end) {
+		trim_stream->passed_end = true;
+		trim_it->streams_before_end--;
+	}
+end:
+	bt_put(stream);
+	return ret;
+}
+
+/*
+ * Queue the notifications ending the tracked streams (and their open
+ * packets) so that the input iterator does not need to be pulled
+ * anymore.
+ */
+static
+enum bt_notification_iterator_status close_streams(
+		struct trimmer_iterator *trim_it)
+{
+	enum bt_notification_iterator_status ret =
+			BT_NOTIFICATION_ITERATOR_STATUS_OK;
+	GHashTableIter iter;
+	gpointer key, value;
+
+	g_hash_table_iter_init(&iter, trim_it->streams);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		struct bt_ctf_stream *stream = key;
+		struct trimmer_stream *trim_stream = value;
+		struct bt_notification *notification;
+
+		if (trim_stream->open_packet) {
+			notification = bt_notification_packet_end_create(
+					trim_stream->open_packet);
+			if (!notification) {
+				ret = BT_NOTIFICATION_ITERATOR_STATUS_NOMEM;
+				goto end;
+			}
+			g_queue_push_tail(trim_it->closing_notifications,
+					notification);
+		}
+
+		notification = bt_notification_stream_end_create(stream);
+		if (!notification) {
+			ret = BT_NOTIFICATION_ITERATOR_STATUS_NOMEM;
+			goto end;
+		}
+		g_queue_push_tail(trim_it->closing_notifications,
+				notification);
+	}
+
+	g_hash_table_remove_all(trim_it->streams);
+	trim_it->streams_before_end = 0;
+	trim_it->end_reached = true;
+end:
+	return ret;
+}
+
 BT_HIDDEN
 enum bt_notification_iterator_status trimmer_iterator_next(
 		struct bt_notification_iterator *iterator)
@@ -432,8 +657,13 @@ enum bt_notification_iterator_status trimmer_iterator_next(
 	source_it = trim_it->input_iterator;
 	assert(source_it);
 
+	if (trim_it->end_reached) {
+		goto deliver_closing_notification;
+	}
+
 	while (!notification_in_range) {
 		struct bt_notification *notification;
+		bool past_end;
 
 		ret = bt_notification_iterator_next(source_it);
 		if (ret != BT_NOTIFICATION_ITERATOR_STATUS_OK) {
@@ -449,7 +679,13 @@ enum bt_notification_iterator_status trimmer_iterator_next(
 
 	        ret = evaluate_notification(notification,
 				&trimmer->begin, &trimmer->end,
-				&notification_in_range);
+				&notification_in_range, &past_end);
+		if (ret == BT_NOTIFICATION_ITERATOR_STATUS_OK &&
+				(trimmer->end.set || trimmer->end.lazy)) {
+			ret = update_stream_state(trim_it, notification,
+					notification_in_range, past_end);
+		}
+
 		if (notification_in_range) {
 			BT_MOVE(trim_it->current_notification, notification);
 		} else {
@@ -459,6 +695,29 @@ enum bt_notification_iterator_status trimmer_iterator_next(
 		if (ret != BT_NOTIFICATION_ITERATOR_STATUS_OK) {
 			break;
 		}
+
+		if (past_end && trim_it->streams_before_end == 0) {
+			/* Every stream passed the range's end: stop pulling. */
+			ret = close_streams(trim_it);
+			if (ret != BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+				goto end;
+			}
+			goto deliver_closing_notification;
+		}
+	}
+	goto end;
+
+deliver_closing_notification:
+	{
+		struct bt_notification *notification =
+			g_queue_pop_head(trim_it->closing_notifications);
+
+		if (!notification) {
+			ret = BT_NOTIFICATION_ITERATOR_STATUS_END;
+			goto end;
+		}
+
+		BT_MOVE(trim_it->current_notification, notification);
 	}
 end:
 	bt_put(component);
@@ -469,9 +728,37 @@ BT_HIDDEN
 enum bt_notification_iterator_status trimmer_iterator_seek_time(
 		struct bt_notification_iterator *iterator, int64_t time)
 {
+	struct trimmer_iterator *trim_it;
+	struct bt_component *component;
+	struct trimmer *trimmer;
 	enum bt_notification_iterator_status ret;
 
-	ret = BT_NOTIFICATION_ITERATOR_STATUS_OK;
+	trim_it = bt_notification_iterator_get_private_data(iterator);
+	assert(trim_it);
+	component = bt_notification_iterator_get_component(iterator);
+	assert(component);
+	trimmer = bt_component_get_private_data(component);
+	assert(trimmer);
+
+	/* Nothing precedes the range's beginning. */
+	if (trimmer->begin.set && time < trimmer->begin.value) {
+		time = trimmer->begin.value;
+	}
+
+	ret = bt_notification_iterator_seek_time(trim_it->input_iterator,
+			BT_NOTIFICATION_ITERATOR_SEEK_ORIGIN_EPOCH, time);
+	if (ret != BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+		goto end;
+	}
+
+	BT_PUT(trim_it->current_notification);
+	g_hash_table_remove_all(trim_it->streams);
+	trim_it->streams_before_end = 0;
+	while (!g_queue_is_empty(trim_it->closing_notifications)) {
+		bt_put(g_queue_pop_head(trim_it->closing_notifications));
+	}
+	trim_it->end_reached = false;
 end:
+	bt_put(component);
 	return ret;
 }
@@ -28,6 +28,7 @@
  */
 
 #include "trimmer.h"
+#include <glib.h>
 #include <babeltrace/component/notification/notification.h>
 #include <babeltrace/component/notification/iterator.h>
 
@@ -35,6 +36,26 @@ struct trimmer_iterator {
 	/* Input iterator associated with this output iterator. */
 	struct bt_notification_iterator *input_iterator;
 	struct bt_notification *current_notification;
+	/*
+	 * bt_ctf_stream -> struct trimmer_stream (owned by this), only
+	 * tracked when the range has an end.
+	 */
+	GHashTable *streams;
+	/* Number of tracked streams which did not pass the range's end. */
+	uint64_t streams_before_end;
+	/*
+	 * Notifications closing the tracked streams, delivered instead of
+	 * pulling from the input iterator once all of them passed the
+	 * range's end.
+	 */
+	GQueue *closing_notifications;
+	bool end_reached;
+};
+
+struct trimmer_stream {
+	/* Last forwarded packet which was not ended yet (NULL if none). */
+	struct bt_ctf_packet *open_packet;
+	bool passed_end;
 };
 
 BT_HIDDEN
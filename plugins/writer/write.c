@@ -35,6 +35,9 @@
 #include <babeltrace/ctf-ir/fields.h>
 #include <babeltrace/ctf-writer/stream-class.h>
 #include <babeltrace/ctf-writer/stream.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
 
 #include "writer.h"
 
@@ -327,9 +330,11 @@ enum bt_component_status copy_event_classes(FILE *err,
 			fprintf(err, "[error] %s in %s:%d\n", __func__,
 					__FILE__, __LINE__);
 			ret = BT_COMPONENT_STATUS_ERROR;
+			bt_put(writer_event_class);
 			bt_put(event_class);
 			goto end;
 		}
+		bt_put(writer_event_class);
 		bt_put(event_class);
 	}
 
@@ -539,12 +544,172 @@ struct bt_ctf_stream_class *insert_new_stream_class(
 		goto end;
 	}
 	g_hash_table_insert(writer_component->stream_class_map,
-			(gpointer) stream_class, writer_stream_class);
+			(gpointer) stream_class, bt_get(writer_stream_class));
 
 end:
 	return writer_stream_class;
 }
 
+/*
+ * Returns the largest alignment of "type" and of the fields or elements
+ * it contains, or a negative value on error.
+ */
+static
+int get_max_alignment(struct bt_ctf_field_type *type)
+{
+	struct bt_ctf_field_type *child;
+	const char *name;
+	int max, count, i, ret;
+
+	if (!type) {
+		/* Absent scope */
+		return 1;
+	}
+
+	max = bt_ctf_field_type_get_alignment(type);
+	if (max < 0) {
+		return -1;
+	}
+
+	switch (bt_ctf_field_type_get_type_id(type)) {
+	case BT_CTF_TYPE_ID_STRUCT:
+		count = bt_ctf_field_type_structure_get_field_count(type);
+		for (i = 0; i < count; i++) {
+			if (bt_ctf_field_type_structure_get_field(type, &name,
+					&child, i)) {
+				return -1;
+			}
+			ret = get_max_alignment(child);
+			bt_put(child);
+			if (ret < 0) {
+				return -1;
+			}
+			max = MAX(max, ret);
+		}
+		break;
+	case BT_CTF_TYPE_ID_VARIANT:
+		count = bt_ctf_field_type_variant_get_field_count(type);
+		for (i = 0; i < count; i++) {
+			if (bt_ctf_field_type_variant_get_field(type, &name,
+					&child, i)) {
+				return -1;
+			}
+			ret = get_max_alignment(child);
+			bt_put(child);
+			if (ret < 0) {
+				return -1;
+			}
+			max = MAX(max, ret);
+		}
+		break;
+	case BT_CTF_TYPE_ID_ARRAY:
+		child = bt_ctf_field_type_array_get_element_type(type);
+		ret = get_max_alignment(child);
+		bt_put(child);
+		if (ret < 0) {
+			return -1;
+		}
+		max = MAX(max, ret);
+		break;
+	case BT_CTF_TYPE_ID_SEQUENCE:
+		child = bt_ctf_field_type_sequence_get_element_type(type);
+		ret = get_max_alignment(child);
+		bt_put(child);
+		if (ret < 0) {
+			return -1;
+		}
+		max = MAX(max, ret);
+		break;
+	default:
+		break;
+	}
+
+	return max;
+}
+
+/* Folds the alignment of "type" into "max", then puts "type". */
+static
+int add_max_alignment(int max, struct bt_ctf_field_type *type)
+{
+	int alignment = get_max_alignment(type);
+
+	bt_put(type);
+	if (max < 0 || alignment < 0) {
+		return -1;
+	}
+	return MAX(max, alignment);
+}
+
+/*
+ * Returns the largest alignment of the events' fields of "stream_class"
+ * if "writer_stream_class" encodes its events exactly like the reader's
+ * packets do (same event class IDs, field types and byte order), so that
+ * those packets may be copied as is. Returns 0 otherwise.
+ */
+static
+unsigned int get_passthrough_alignment(struct bt_ctf_writer *ctf_writer,
+		struct bt_ctf_stream_class *stream_class,
+		struct bt_ctf_stream_class *writer_stream_class)
+{
+	struct bt_ctf_trace *trace, *writer_trace;
+	int max = 1, count, i;
+
+	trace = bt_ctf_stream_class_get_trace(stream_class);
+	writer_trace = bt_ctf_writer_get_trace(ctf_writer);
+	if (!trace || !writer_trace || bt_ctf_trace_get_byte_order(trace) !=
+			bt_ctf_trace_get_byte_order(writer_trace)) {
+		max = 0;
+		goto end;
+	}
+
+	count = bt_ctf_stream_class_get_event_class_count(stream_class);
+	if (count < 0 || count != bt_ctf_stream_class_get_event_class_count(
+			writer_stream_class)) {
+		max = 0;
+		goto end;
+	}
+
+	for (i = 0; i < count && max > 0; i++) {
+		struct bt_ctf_event_class *event_class, *writer_event_class;
+
+		event_class = bt_ctf_stream_class_get_event_class(
+				stream_class, i);
+		if (!event_class) {
+			max = 0;
+			goto end;
+		}
+		writer_event_class = bt_ctf_stream_class_get_event_class_by_id(
+				writer_stream_class,
+				bt_ctf_event_class_get_id(event_class));
+		if (!writer_event_class || strcmp(
+				bt_ctf_event_class_get_name(event_class),
+				bt_ctf_event_class_get_name(writer_event_class))) {
+			max = 0;
+		} else {
+			max = add_max_alignment(max,
+				bt_ctf_event_class_get_context_type(
+					event_class));
+			max = add_max_alignment(max,
+				bt_ctf_event_class_get_payload_type(
+					event_class));
+		}
+		bt_put(writer_event_class);
+		bt_put(event_class);
+	}
+
+	max = add_max_alignment(max,
+		bt_ctf_stream_class_get_event_header_type(stream_class));
+	max = add_max_alignment(max,
+		bt_ctf_stream_class_get_event_context_type(stream_class));
+	if (max < 0) {
+		max = 0;
+	}
+end:
+	bt_put(writer_trace);
+	bt_put(trace);
+	return max;
+}
+
 static
 struct bt_ctf_stream *insert_new_stream(
 		struct writer_component *writer_component,
@@ -585,7 +750,11 @@ struct bt_ctf_stream *insert_new_stream(
 	}
 
 	g_hash_table_insert(writer_component->stream_map, (gpointer) stream,
-			writer_stream);
+			bt_get(writer_stream));
+	g_hash_table_insert(writer_component->passthrough_map,
+			(gpointer) stream,
+			GUINT_TO_POINTER(get_passthrough_alignment(ctf_writer,
+				stream_class, writer_stream_class)));
 
 	bt_ctf_writer_flush_metadata(ctf_writer);
 
@@ -644,7 +813,7 @@ struct bt_ctf_writer *insert_new_writer(
 	}
 
 	g_hash_table_insert(writer_component->trace_map, (gpointer) trace,
-			ctf_writer);
+			bt_get(ctf_writer));
 
 end:
 	return ctf_writer;
@@ -736,6 +905,8 @@ enum bt_component_status writer_new_packet(
 {
 	struct bt_ctf_stream *stream, *writer_stream;
 	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
+	const char *path;
+	uint64_t offset, size, data_offset, event_count;
 
 	stream = bt_ctf_packet_get_stream(packet);
 	if (!stream) {
@@ -754,6 +925,20 @@ enum bt_component_status writer_new_packet(
 		goto end_put;
 	}
 
+	/*
+	 * The events of a packet read from a file are only kept until it
+	 * ends: if they all came through, the packet's event bytes are
+	 * copied, otherwise they are encoded then.
+	 */
+	if (!bt_ctf_packet_get_origin(packet, &path, &offset, &size,
+				&data_offset, &event_count) &&
+			g_hash_table_lookup(writer_component->passthrough_map,
+				stream)) {
+		g_hash_table_insert(writer_component->packet_events_map,
+				stream, g_ptr_array_new_with_free_func(
+					(GDestroyNotify) bt_put));
+	}
+
 	bt_put(writer_stream);
 
 end_put:
@@ -895,6 +1080,14 @@ enum bt_component_status copy_packet_context(FILE *err,
 			goto end_put_writer_packet_context;
 		}
 
+		/* Computed by the writer when the packet is flushed. */
+		if (!strcmp(field_name, "content_size") ||
+				!strcmp(field_name, "packet_size")) {
+			bt_put(field_type);
+			bt_put(field);
+			continue;
+		}
+
 		ret = copy_packet_context_field(err, field, field_name,
 				writer_packet_context, writer_packet_context_type);
 		bt_put(field_type);
@@ -927,60 +1120,89 @@ end:
 	return ret;
 }
 
-BT_HIDDEN
-enum bt_component_status writer_close_packet(
-		struct writer_component *writer_component,
-		struct bt_ctf_packet *packet)
+/*
+ * Flushes the packet of "writer_stream" with the events of "packet"
+ * copied from its origin file, "received_count" events of which were
+ * received. Returns 1 if the events must be encoded instead (some of
+ * them were not received, or they can't be moved to their new place in
+ * the packet), 0 once it is flushed, and -1 on error.
+ */
+static
+int copy_packet_as_is(struct writer_component *writer_component,
+		struct bt_ctf_packet *packet, struct bt_ctf_stream *stream,
+		struct bt_ctf_stream *writer_stream, uint64_t received_count)
 {
-	struct bt_ctf_stream *stream, *writer_stream;
-	enum bt_component_status ret;
-
-	stream = bt_ctf_packet_get_stream(packet);
-	if (!stream) {
-		ret = BT_COMPONENT_STATUS_ERROR;
-		fprintf(writer_component->err, "[error] %s in %s:%d\n",
-				__func__, __FILE__, __LINE__);
+	const char *path;
+	uint64_t offset, size, data_offset, event_count, content_size;
+	struct bt_ctf_field *packet_context, *field = NULL;
+	unsigned int alignment;
+	long page_size;
+	off_t map_offset;
+	size_t map_len;
+	void *addr;
+	int fd, ret;
+
+	if (bt_ctf_packet_get_origin(packet, &path, &offset, &size,
+				&data_offset, &event_count) ||
+			event_count != received_count) {
+		ret = 1;
 		goto end;
 	}
 
-	writer_stream = lookup_stream(writer_component, stream);
-	if (!writer_stream) {
-		ret = BT_COMPONENT_STATUS_ERROR;
-		fprintf(writer_component->err, "[error] %s in %s:%d\n",
-				__func__, __FILE__, __LINE__);
-		goto end_put;
+	content_size = size * CHAR_BIT;
+	packet_context = bt_ctf_packet_get_context(packet);
+	if (packet_context) {
+		field = bt_ctf_field_structure_get_field(packet_context,
+				"content_size");
+		bt_put(packet_context);
+	}
+	if (field) {
+		ret = bt_ctf_field_unsigned_integer_get_value(field,
+				&content_size);
+		bt_put(field);
+		if (ret) {
+			ret = 1;
+			goto end;
+		}
+	}
+	if (content_size < data_offset || content_size > size * CHAR_BIT) {
+		ret = 1;
+		goto end;
 	}
 
-	if (!bt_get(writer_stream)) {
-		fprintf(writer_component->err,
-				"[error] Failed to get reference on writer stream\n");
-		fprintf(writer_component->err, "[error] %s in %s:%d\n",
-				__func__, __FILE__, __LINE__);
-		ret = BT_COMPONENT_STATUS_ERROR;
-		goto end_put;
+	fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		fprintf(writer_component->err, "[error] Failed to open %s\n",
+				path);
+		ret = -1;
+		goto end;
 	}
 
-	ret = copy_packet_context(writer_component->err, packet, writer_stream);
-	if (ret != BT_COMPONENT_STATUS_OK) {
-		ret = BT_COMPONENT_STATUS_ERROR;
-		fprintf(writer_component->err, "[error] %s in %s:%d\n",
-				__func__, __FILE__, __LINE__);
-		goto end_put;
+	/* The mapping remains valid once the file is closed. */
+	page_size = sysconf(_SC_PAGE_SIZE);
+	map_offset = offset - offset % page_size;
+	map_len = offset - map_offset + size;
+	addr = mmap(NULL, map_len, PROT_READ, MAP_PRIVATE, fd, map_offset);
+	if (close(fd)) {
+		perror("close");
+	}
+	if (addr == MAP_FAILED) {
+		fprintf(writer_component->err, "[error] Failed to map %s\n",
+				path);
+		ret = -1;
+		goto end;
 	}
 
-	ret = bt_ctf_stream_flush(writer_stream);
+	alignment = GPOINTER_TO_UINT(g_hash_table_lookup(
+			writer_component->passthrough_map, stream));
+	ret = bt_ctf_stream_flush_encoded_events(writer_stream,
+			(const uint8_t *) addr + (offset - map_offset),
+			data_offset, content_size, alignment);
 	if (ret < 0) {
 		fprintf(writer_component->err,
 				"[error] Failed to flush packet\n");
-		ret = BT_COMPONENT_STATUS_ERROR;
 	}
-
-	ret = BT_COMPONENT_STATUS_OK;
-
-	bt_put(writer_stream);
-
-end_put:
-	bt_put(stream);
+	munmap(addr, map_len);
 end:
 	return ret;
 }
@@ -1039,8 +1261,8 @@ end:
 	return writer_event;
 }
 
-BT_HIDDEN
-enum bt_component_status writer_output_event(
+static
+enum bt_component_status append_event_copy(
 		struct writer_component *writer_component,
 		struct bt_ctf_event *event)
 {
@@ -1150,3 +1372,125 @@ end_put_event_class:
 end:
 	return ret;
 }
+
+BT_HIDDEN
+enum bt_component_status writer_output_event(
+		struct writer_component *writer_component,
+		struct bt_ctf_event *event)
+{
+	enum bt_component_status ret;
+	struct bt_ctf_stream *stream;
+	GPtrArray *events;
+
+	stream = bt_ctf_event_get_stream(event);
+	if (!stream) {
+		fprintf(writer_component->err, "[error] %s in %s:%d\n", __func__,
+				__FILE__, __LINE__);
+		return BT_COMPONENT_STATUS_ERROR;
+	}
+
+	/* See writer_close_packet(). */
+	events = g_hash_table_lookup(writer_component->packet_events_map,
+			stream);
+	if (events) {
+		g_ptr_array_add(events, bt_get(event));
+		ret = BT_COMPONENT_STATUS_OK;
+	} else {
+		ret = append_event_copy(writer_component, event);
+	}
+
+	bt_put(stream);
+	return ret;
+}
+
+BT_HIDDEN
+enum bt_component_status writer_close_packet(
+		struct writer_component *writer_component,
+		struct bt_ctf_packet *packet)
+{
+	struct bt_ctf_stream *stream, *writer_stream;
+	GPtrArray *events = NULL;
+	enum bt_component_status ret;
+	unsigned int i;
+	int int_ret;
+
+	stream = bt_ctf_packet_get_stream(packet);
+	if (!stream) {
+		ret = BT_COMPONENT_STATUS_ERROR;
+		fprintf(writer_component->err, "[error] %s in %s:%d\n",
+				__func__, __FILE__, __LINE__);
+		goto end;
+	}
+
+	events = g_hash_table_lookup(writer_component->packet_events_map,
+			stream);
+	if (events) {
+		g_hash_table_steal(writer_component->packet_events_map,
+				stream);
+	}
+
+	writer_stream = lookup_stream(writer_component, stream);
+	if (!writer_stream) {
+		ret = BT_COMPONENT_STATUS_ERROR;
+		fprintf(writer_component->err, "[error] %s in %s:%d\n",
+				__func__, __FILE__, __LINE__);
+		goto end_put;
+	}
+
+	if (!bt_get(writer_stream)) {
+		fprintf(writer_component->err,
+				"[error] Failed to get reference on writer stream\n");
+		fprintf(writer_component->err, "[error] %s in %s:%d\n",
+				__func__, __FILE__, __LINE__);
+		ret = BT_COMPONENT_STATUS_ERROR;
+		goto end_put;
+	}
+
+	ret = copy_packet_context(writer_component->err, packet, writer_stream);
+	if (ret != BT_COMPONENT_STATUS_OK) {
+		ret = BT_COMPONENT_STATUS_ERROR;
+		fprintf(writer_component->err, "[error] %s in %s:%d\n",
+				__func__, __FILE__, __LINE__);
+		goto end_put_writer_stream;
+	}
+
+	if (events) {
+		int_ret = copy_packet_as_is(writer_component, packet, stream,
+				writer_stream, events->len);
+		if (int_ret < 0) {
+			ret = BT_COMPONENT_STATUS_ERROR;
+			goto end_put_writer_stream;
+		} else if (int_ret == 0) {
+			ret = BT_COMPONENT_STATUS_OK;
+			goto end_put_writer_stream;
+		}
+
+		/* A boundary or trimmed packet: encode its events. */
+		for (i = 0; i < events->len; i++) {
+			ret = append_event_copy(writer_component,
+					g_ptr_array_index(events, i));
+			if (ret != BT_COMPONENT_STATUS_OK) {
+				goto end_put_writer_stream;
+			}
+		}
+	}
+
+	ret = bt_ctf_stream_flush(writer_stream);
+	if (ret < 0) {
+		fprintf(writer_component->err,
+				"[error] Failed to flush packet\n");
+		ret = BT_COMPONENT_STATUS_ERROR;
+	}
+
+	ret = BT_COMPONENT_STATUS_OK;
+
+end_put_writer_stream:
+	bt_put(writer_stream);
+end_put:
+	bt_put(stream);
+end:
+	if (events) {
+		g_ptr_array_unref(events);
+	}
+	return ret;
+}
@@ -47,6 +47,8 @@ static
 void destroy_writer_component_data(struct writer_component *writer_component)
 {
 	bt_put(writer_component->input_iterator);
+	g_hash_table_destroy(writer_component->packet_events_map);
+	g_hash_table_destroy(writer_component->passthrough_map);
 	g_hash_table_destroy(writer_component->stream_map);
 	g_hash_table_destroy(writer_component->stream_class_map);
 	g_hash_table_destroy(writer_component->trace_map);
@@ -113,6 +115,11 @@ struct writer_component *create_writer_component(void)
 			g_direct_equal, NULL, (GDestroyNotify) unref_stream_class);
 	writer_component->stream_map = g_hash_table_new_full(g_direct_hash,
 			g_direct_equal, NULL, (GDestroyNotify) unref_stream);
+	writer_component->passthrough_map = g_hash_table_new(g_direct_hash,
+			g_direct_equal);
+	writer_component->packet_events_map = g_hash_table_new_full(
+			g_direct_hash, g_direct_equal, NULL,
+			(GDestroyNotify) g_ptr_array_unref);
 
 end:
 	return writer_component;
@@ -211,6 +218,7 @@ static
 enum bt_component_status run(struct bt_component *component)
 {
 	enum bt_component_status ret;
+	enum bt_notification_iterator_status it_ret;
 	struct bt_notification *notification = NULL;
 	struct bt_notification_iterator *it;
 	struct writer_component *writer_component =
@@ -219,20 +227,30 @@ enum bt_component_status run(struct bt_component *component)
 	it = writer_component->input_iterator;
 	assert(it);
 
-	notification = bt_notification_iterator_get_notification(it);
-	if (!notification) {
+	it_ret = bt_notification_iterator_next(it);
+	switch (it_ret) {
+	case BT_NOTIFICATION_ITERATOR_STATUS_OK:
+		break;
+	case BT_NOTIFICATION_ITERATOR_STATUS_END:
+		ret = BT_COMPONENT_STATUS_END;
+		BT_PUT(writer_component->input_iterator);
+		goto end;
+	case BT_NOTIFICATION_ITERATOR_STATUS_AGAIN:
+		ret = BT_COMPONENT_STATUS_AGAIN;
+		goto end;
+	default:
 		ret = BT_COMPONENT_STATUS_ERROR;
 		goto end;
 	}
 
-	ret = bt_notification_iterator_next(it);
-	if (ret != BT_COMPONENT_STATUS_OK) {
+	notification = bt_notification_iterator_get_notification(it);
+	if (!notification) {
+		ret = BT_COMPONENT_STATUS_ERROR;
 		goto end;
 	}
 
 	ret = handle_notification(writer_component, notification);
 end:
-	bt_put(it);
 	bt_put(notification);
 	return ret;
 }
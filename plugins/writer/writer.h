@@ -43,6 +43,19 @@ struct writer_component {
 	GHashTable *stream_map;
 	/* Map between reader and writer stream class. */
 	GHashTable *stream_class_map;
+	/*
+	 * Map between reader stream and the largest alignment of its
+	 * events' fields, or 0 if the writer stream encodes them
+	 * differently, so that its packets cannot be copied as is.
+	 */
+	GHashTable *passthrough_map;
+	/*
+	 * Map between reader stream and the events (GPtrArray of
+	 * references) received for its current packet, if the packet has
+	 * an origin which may be copied as is: if all its events come
+	 * through, the packet's bytes are copied instead of encoding them.
+	 */
+	GHashTable *packet_events_map;
 	FILE *err;
 	struct bt_notification_iterator *input_iterator;
 };
@@ -0,0 +1,420 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <babeltrace/plugin/plugin-dev.h>
+#include <babeltrace/component/component.h>
+#include <babeltrace/component/component-class.h>
+#include <babeltrace/component/connection.h>
+#include <babeltrace/component/graph.h>
+#include <babeltrace/component/port.h>
+#include <babeltrace/component/notification/iterator.h>
+#include <babeltrace/component/notification/notification.h>
+#include <babeltrace/component/notification/event.h>
+#include <babeltrace/ctf-ir/trace.h>
+#include <babeltrace/ctf-ir/event-class.h>
+#include <babeltrace/ctf-ir/event.h>
+#include <babeltrace/ctf-ir/stream-class.h>
+#include <babeltrace/values.h>
+#include <babeltrace/ref.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "counter.h"
+
+struct counter {
+	/* Number of notifications to deliver */
+	int64_t count;
+	/*
+	 * If not 0, the iterator returns AGAIN once before each
+	 * notification whose timestamp is a multiple of it.
+	 */
+	int64_t again_period;
+	/* Sort key timestamp of the first notification and increment */
+	int64_t first;
+	int64_t step;
+	/* Sort key tie-breaker of all the notifications */
+	int64_t id;
+};
+
+struct counter_iterator {
+	struct bt_ctf_trace *trace;
+	struct bt_ctf_event_class *event_class;
+	struct bt_notification *current;
+	int64_t next;
+	bool again_returned;
+};
+
+static int64_t get_integer_param(struct bt_value *params, const char *key)
+{
+	struct bt_value *value;
+	int64_t ret = 0;
+
+	value = bt_value_map_get(params, key);
+	if (value) {
+		(void) bt_value_integer_get(value, &ret);
+		bt_put(value);
+	}
+
+	return ret;
+}
+
+static enum bt_component_status counter_init(struct bt_component *component,
+		struct bt_value *params, void *init_method_data)
+{
+	struct counter *counter = calloc(1, sizeof(*counter));
+
+	if (!counter) {
+		return BT_COMPONENT_STATUS_NOMEM;
+	}
+
+	counter->count = get_integer_param(params, "count");
+	counter->again_period = get_integer_param(params, "again-period");
+	counter->first = get_integer_param(params, "first");
+	counter->step = get_integer_param(params, "step");
+	if (counter->step == 0) {
+		counter->step = 1;
+	}
+	counter->id = get_integer_param(params, "id");
+	return bt_component_set_private_data(component, counter);
+}
+
+static void counter_destroy(struct bt_component *component)
+{
+	free(bt_component_get_private_data(component));
+}
+
+static void counter_iterator_destroy(
+		struct bt_notification_iterator *iterator)
+{
+	struct counter_iterator *counter_it =
+		bt_notification_iterator_get_private_data(iterator);
+
+	if (!counter_it) {
+		return;
+	}
+
+	bt_put(counter_it->current);
+	bt_put(counter_it->event_class);
+	bt_put(counter_it->trace);
+	free(counter_it);
+}
+
+static enum bt_notification_iterator_status counter_iterator_init(
+		struct bt_component *component,
+		struct bt_notification_iterator *iterator,
+		void *init_method_data)
+{
+	enum bt_notification_iterator_status ret =
+		BT_NOTIFICATION_ITERATOR_STATUS_OK;
+	struct counter_iterator *counter_it;
+	struct bt_ctf_stream_class *stream_class = NULL;
+
+	counter_it = calloc(1, sizeof(*counter_it));
+	if (!counter_it) {
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_NOMEM;
+		goto end;
+	}
+
+	ret = bt_notification_iterator_set_private_data(iterator, counter_it);
+	if (ret) {
+		free(counter_it);
+		goto end;
+	}
+
+	/*
+	 * The notifications are events, without a packet, since the
+	 * muxer only orders event notifications.
+	 */
+	counter_it->trace = bt_ctf_trace_create();
+	stream_class = bt_ctf_stream_class_create("counter");
+	counter_it->event_class = bt_ctf_event_class_create("tick");
+	if (!counter_it->trace || !stream_class || !counter_it->event_class ||
+			bt_ctf_stream_class_add_event_class(stream_class,
+				counter_it->event_class) ||
+			bt_ctf_trace_set_byte_order(counter_it->trace,
+				BT_CTF_BYTE_ORDER_LITTLE_ENDIAN) ||
+			bt_ctf_trace_add_stream_class(counter_it->trace,
+				stream_class)) {
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_ERROR;
+		goto end;
+	}
+end:
+	bt_put(stream_class);
+	return ret;
+}
+
+static struct bt_notification *counter_iterator_get(
+		struct bt_notification_iterator *iterator)
+{
+	struct counter_iterator *counter_it =
+		bt_notification_iterator_get_private_data(iterator);
+
+	return bt_get(counter_it->current);
+}
+
+static enum bt_notification_iterator_status counter_iterator_next(
+		struct bt_notification_iterator *iterator)
+{
+	enum bt_notification_iterator_status ret =
+		BT_NOTIFICATION_ITERATOR_STATUS_OK;
+	struct counter_iterator *counter_it =
+		bt_notification_iterator_get_private_data(iterator);
+	struct bt_component *component =
+		bt_notification_iterator_get_component(iterator);
+	struct counter *counter = bt_component_get_private_data(component);
+	struct bt_ctf_event *event = NULL;
+
+	BT_PUT(counter_it->current);
+	if (counter_it->next >= counter->count) {
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_END;
+		goto end;
+	}
+
+	if (counter->again_period > 0 && counter_it->next > 0 &&
+			counter_it->next % counter->again_period == 0 &&
+			!counter_it->again_returned) {
+		counter_it->again_returned = true;
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_AGAIN;
+		goto end;
+	}
+
+	counter_it->again_returned = false;
+	event = bt_ctf_event_create(counter_it->event_class);
+	if (!event) {
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_ERROR;
+		goto end;
+	}
+
+	counter_it->current = bt_notification_event_create(event);
+	if (!counter_it->current ||
+			bt_notification_set_sort_key(counter_it->current,
+				counter->first + counter_it->next * counter->step,
+				counter->id)) {
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_ERROR;
+		goto end;
+	}
+
+	counter_it->next++;
+end:
+	bt_put(event);
+	bt_put(component);
+	return ret;
+}
+
+/* Same notifications as counter_iterator_next(), several at once. */
+static enum bt_notification_iterator_status counter_iterator_next_batch(
+		struct bt_notification_iterator *iterator,
+		struct bt_notification **notifications, size_t capacity,
+		size_t *count)
+{
+	enum bt_notification_iterator_status ret =
+		BT_NOTIFICATION_ITERATOR_STATUS_OK;
+	struct counter_iterator *counter_it =
+		bt_notification_iterator_get_private_data(iterator);
+
+	for (*count = 0; *count < capacity; (*count)++) {
+		ret = counter_iterator_next(iterator);
+		if (ret != BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+			break;
+		}
+
+		notifications[*count] = counter_it->current;
+		counter_it->current = NULL;
+	}
+
+	return ret;
+}
+
+static void check_notification(struct checker *checker,
+		int64_t timestamp, uint64_t tie_break)
+{
+	if (timestamp != checker->expected) {
+		checker->out_of_order++;
+	}
+
+	if (checker->consumed > 0) {
+		if (timestamp < checker->last_timestamp) {
+			checker->unsorted++;
+		} else if (timestamp == checker->last_timestamp) {
+			checker->ties++;
+			if (tie_break < checker->last_tie_break) {
+				checker->unstable++;
+			}
+		}
+	}
+
+	checker->expected = timestamp + 1;
+	checker->last_timestamp = timestamp;
+	checker->last_tie_break = tie_break;
+	checker->consumed++;
+}
+
+static enum bt_component_status checker_init(struct bt_component *component,
+		struct bt_value *params, void *init_method_data)
+{
+	struct checker *checker = calloc(1, sizeof(*checker));
+
+	if (!checker) {
+		return BT_COMPONENT_STATUS_NOMEM;
+	}
+
+	checker->again = get_integer_param(params, "again");
+	checker->again_timeout = get_integer_param(params, "again-timeout");
+	checker->batch = get_integer_param(params, "batch");
+	if (checker->batch > CHECKER_MAX_BATCH) {
+		checker->batch = CHECKER_MAX_BATCH;
+	}
+	return bt_component_set_private_data(component, checker);
+}
+
+static void checker_destroy(struct bt_component *component)
+{
+	struct checker *checker = bt_component_get_private_data(component);
+
+	bt_put(checker->iterator);
+	free(checker);
+}
+
+static enum bt_component_status checker_new_connection(
+		struct bt_port *own_port, struct bt_connection *connection)
+{
+	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
+	struct bt_component *component = bt_port_get_component(own_port);
+	struct checker *checker = bt_component_get_private_data(component);
+
+	assert(!checker->iterator);
+	checker->iterator =
+		bt_connection_create_notification_iterator(connection);
+	if (!checker->iterator) {
+		ret = BT_COMPONENT_STATUS_ERROR;
+	}
+
+	bt_put(component);
+	return ret;
+}
+
+static enum bt_component_status checker_consume(
+		struct bt_component *component)
+{
+	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
+	struct checker *checker = bt_component_get_private_data(component);
+	struct bt_notification *notifications[CHECKER_MAX_BATCH];
+	enum bt_notification_iterator_status it_ret;
+	size_t count = 0, i;
+
+	if (checker->again > 0) {
+		checker->again--;
+		ret = BT_COMPONENT_STATUS_AGAIN;
+		if (checker->again_timeout > 0) {
+			struct bt_graph *graph = bt_component_get_graph(component);
+
+			if (bt_graph_set_ready_timeout(graph, component,
+					checker->again_timeout) !=
+					BT_GRAPH_STATUS_OK) {
+				ret = BT_COMPONENT_STATUS_ERROR;
+			}
+			bt_put(graph);
+		}
+		goto end;
+	}
+
+	if (checker->batch > 0) {
+		it_ret = bt_notification_iterator_next_batch(checker->iterator,
+			notifications, checker->batch, &count);
+	} else {
+		it_ret = bt_notification_iterator_next(checker->iterator);
+	}
+
+	switch (it_ret) {
+	case BT_NOTIFICATION_ITERATOR_STATUS_OK:
+		break;
+	case BT_NOTIFICATION_ITERATOR_STATUS_AGAIN:
+		checker->upstream_again++;
+		ret = BT_COMPONENT_STATUS_AGAIN;
+		goto end;
+	case BT_NOTIFICATION_ITERATOR_STATUS_END:
+		checker->end_reached = true;
+		ret = BT_COMPONENT_STATUS_END;
+		goto end;
+	default:
+		ret = BT_COMPONENT_STATUS_ERROR;
+		goto end;
+	}
+
+	if (checker->batch == 0) {
+		notifications[0] = bt_notification_iterator_get_notification(
+			checker->iterator);
+		count = 1;
+	}
+
+	if (count > checker->largest_batch) {
+		checker->largest_batch = count;
+	}
+
+	for (i = 0; i < count; i++) {
+		int64_t timestamp;
+		uint64_t tie_break;
+
+		if (!notifications[i] ||
+				bt_notification_get_sort_key(notifications[i],
+					&timestamp, &tie_break)) {
+			ret = BT_COMPONENT_STATUS_ERROR;
+		} else {
+			check_notification(checker, timestamp, tie_break);
+		}
+		bt_put(notifications[i]);
+	}
+end:
+	return ret;
+}
+
+BT_PLUGIN(test_graph);
+BT_PLUGIN_DESCRIPTION("Babeltrace plugin with components to test graphs");
+BT_PLUGIN_AUTHOR("Janine Sutto");
+BT_PLUGIN_LICENSE("Beerware");
+
+BT_PLUGIN_SOURCE_COMPONENT_CLASS(counter, counter_iterator_get,
+	counter_iterator_next);
+BT_PLUGIN_SOURCE_COMPONENT_CLASS_DESCRIPTION(counter,
+	"Delivers \"count\" event notifications ordered by sort key.");
+BT_PLUGIN_SOURCE_COMPONENT_CLASS_INIT_METHOD(counter, counter_init);
+BT_PLUGIN_SOURCE_COMPONENT_CLASS_DESTROY_METHOD(counter, counter_destroy);
+BT_PLUGIN_SOURCE_COMPONENT_CLASS_NOTIFICATION_ITERATOR_INIT_METHOD(counter,
+	counter_iterator_init);
+BT_PLUGIN_SOURCE_COMPONENT_CLASS_NOTIFICATION_ITERATOR_DESTROY_METHOD(counter,
+	counter_iterator_destroy);
+
+BT_PLUGIN_SOURCE_COMPONENT_CLASS(batch_counter, counter_iterator_get,
+	counter_iterator_next);
+BT_PLUGIN_SOURCE_COMPONENT_CLASS_DESCRIPTION(batch_counter,
+	"Same as counter, with a batch next method.");
+BT_PLUGIN_SOURCE_COMPONENT_CLASS_INIT_METHOD(batch_counter, counter_init);
+BT_PLUGIN_SOURCE_COMPONENT_CLASS_DESTROY_METHOD(batch_counter,
+	counter_destroy);
+BT_PLUGIN_SOURCE_COMPONENT_CLASS_NOTIFICATION_ITERATOR_INIT_METHOD(
+	batch_counter, counter_iterator_init);
+BT_PLUGIN_SOURCE_COMPONENT_CLASS_NOTIFICATION_ITERATOR_DESTROY_METHOD(
+	batch_counter, counter_iterator_destroy);
+BT_PLUGIN_SOURCE_COMPONENT_CLASS_NOTIFICATION_ITERATOR_NEXT_BATCH_METHOD(
+	batch_counter, counter_iterator_next_batch);
+
+BT_PLUGIN_SINK_COMPONENT_CLASS(checker, checker_consume);
+BT_PLUGIN_SINK_COMPONENT_CLASS_DESCRIPTION(checker,
+	"Checks the order of the notifications of a counter source.");
+BT_PLUGIN_SINK_COMPONENT_CLASS_INIT_METHOD(checker, checker_init);
+BT_PLUGIN_SINK_COMPONENT_CLASS_DESTROY_METHOD(checker, checker_destroy);
+BT_PLUGIN_SINK_COMPONENT_CLASS_NEW_CONNECTION_METHOD(checker,
+	checker_new_connection);
@@ -0,0 +1,73 @@
+#ifndef TEST_GRAPH_PLUGINS_COUNTER_H
+#define TEST_GRAPH_PLUGINS_COUNTER_H
+
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct bt_notification_iterator;
+
+/* Largest number of notifications a checker gets at once */
+#define CHECKER_MAX_BATCH	64
+
+/*
+ * Private data of a "checker" sink component, read back by test_graph.
+ *
+ * The "counter" source delivers "count" notifications whose sort key
+ * timestamps are "first", "first" + "step", ... (0, 1, 2, ... by
+ * default) and whose tie-breaker is "id". The checker counts the
+ * notifications which do not follow the previous one by 1, and the
+ * ones which come before it in sort key order. The "batch_counter"
+ * source delivers the same notifications through a batch method.
+ */
+struct checker {
+	struct bt_notification_iterator *iterator;
+	/* Number of times the sink returns AGAIN before consuming */
+	int64_t again;
+	/*
+	 * If not 0, the sink sets a readiness timeout of this many
+	 * milliseconds when it returns AGAIN
+	 */
+	int64_t again_timeout;
+	/*
+	 * If not 0, number of notifications to get at once with
+	 * bt_notification_iterator_next_batch()
+	 */
+	int64_t batch;
+	/* Timestamp of the next expected notification */
+	int64_t expected;
+	uint64_t consumed;
+	/* Largest number of notifications gotten at once */
+	uint64_t largest_batch;
+	uint64_t out_of_order;
+	/* Sort key of the last notification */
+	int64_t last_timestamp;
+	uint64_t last_tie_break;
+	/* Notifications with a smaller timestamp than the previous one */
+	uint64_t unsorted;
+	/* Notifications with the same timestamp as the previous one */
+	uint64_t ties;
+	/* Ties with a smaller tie-breaker than the previous notification */
+	uint64_t unstable;
+	/* Number of times the iterator returned AGAIN */
+	uint64_t upstream_again;
+	bool end_reached;
+};
+
+#endif /* TEST_GRAPH_PLUGINS_COUNTER_H */
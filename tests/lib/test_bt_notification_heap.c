@@ -28,7 +28,7 @@
 #include <babeltrace/component/notification/notification.h>
 #include <babeltrace/component/notification/notification-internal.h>
 
-#define NR_TESTS 7
+#define NR_TESTS 10
 
 struct dummy_notification {
 	struct bt_notification parent;
@@ -195,6 +195,69 @@ int main(int argc, char **argv)
 	pass("Popped remaining 15 000 notifications from heap in ascending order");
 
 	ok(!bt_notification_heap_peek(heap), "No notifications left in heap");
+	BT_PUT(heap);
+
+	heap = bt_notification_heap_create_sort_key();
+	ok(heap, "Created a notification heap ordered by sort keys");
+
+	/* Insert 10 000 notifications with random sort keys. */
+	for (i = 0; i < 10000; i++) {
+		int ret;
+		struct bt_notification *notification =
+				dummy_notification_create(0);
+
+		if (!notification) {
+			diag("Dummy notification creation failed");
+			goto end;
+		}
+
+		/* Few distinct timestamps to exercise the tie-breaker. */
+		ret = bt_notification_set_sort_key(notification,
+				(int64_t) (rand() % 100) - 50, rand());
+		if (ret) {
+			diag("Failed to set the sort key of notification %i", i);
+			bt_put(notification);
+			goto end;
+		}
+
+		ret = bt_notification_heap_insert(heap, notification);
+		if (ret) {
+			diag("Failed to insert notification %i in heap", i);
+			goto end;
+		}
+		bt_put(notification);
+	}
+	pass("Inserted 10 000 notifications with random sort keys in notification heap");
+
+	/* Pop all notifications, making sure the sort keys are ascending */
+	{
+		bool ascending = true;
+		int64_t last_ts = INT64_MIN;
+		uint64_t last_tie_break = 0;
+
+		for (i = 0; i < 10000; i++) {
+			struct bt_notification *pop_notification;
+			int64_t ts;
+			uint64_t tie_break;
+
+			pop_notification = bt_notification_heap_pop(heap);
+			if (!pop_notification) {
+				fail("Failed to pop a notification");
+				goto end;
+			}
+
+			(void) bt_notification_get_sort_key(pop_notification,
+					&ts, &tie_break);
+			if (ts < last_ts || (ts == last_ts &&
+					tie_break < last_tie_break)) {
+				ascending = false;
+			}
+			last_ts = ts;
+			last_tie_break = tie_break;
+			bt_put(pop_notification);
+		}
+		ok(ascending, "Notification heap provided notifications in ascending sort key order");
+	}
 end:
 	bt_put(heap);
 	return exit_status();
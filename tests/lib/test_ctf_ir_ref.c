@@ -32,9 +32,12 @@
 #include <babeltrace/object-internal.h>
 #include <babeltrace/compat/stdlib.h>
 #include <assert.h>
+#include <pthread.h>
 #include "common.h"
 
-#define NR_TESTS 41
+#define NR_TESTS 43
+#define NR_REF_THREADS 4
+#define NR_REF_ITERATIONS 100000
 
 struct user {
 	struct bt_ctf_writer *writer;
@@ -615,6 +618,42 @@ static void test_put_order(void)
 	test_put_order_permute(array, USER_NR_ELEMENTS, USER_NR_ELEMENTS);
 }
 
+static void *get_put_thread(void *data)
+{
+	int i;
+
+	for (i = 0; i < NR_REF_ITERATIONS; i++) {
+		bt_put(bt_get(data));
+	}
+
+	return NULL;
+}
+
+static void test_thread_safe_ref_count(void)
+{
+	int i;
+	int ret = 0;
+	pthread_t threads[NR_REF_THREADS];
+	struct bt_ctf_trace *tc = bt_ctf_trace_create();
+
+	assert(tc);
+	bt_ref_enable_thread_safety();
+
+	for (i = 0; i < NR_REF_THREADS; i++) {
+		ret |= pthread_create(&threads[i], NULL, get_put_thread, tc);
+	}
+
+	ok(!ret, "Threads sharing a trace are created");
+
+	for (i = 0; i < NR_REF_THREADS; i++) {
+		pthread_join(threads[i], NULL);
+	}
+
+	ok(bt_object_get_ref_count(tc) == 1,
+		"Concurrent gets and puts leave the reference count unchanged");
+	BT_PUT(tc);
+}
+
 /**
  * The objective of this test is to implement and expand upon the scenario
  * described in the reference counting documentation and ensure that any node of
@@ -631,6 +670,7 @@ int main(int argc, char **argv)
 
 	test_example_scenario();
 	test_put_order();
+	test_thread_safe_ref_count();
 
 	return exit_status();
 }
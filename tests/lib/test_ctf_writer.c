@@ -60,7 +60,7 @@
 #define DEFAULT_CLOCK_TIME 0
 #define DEFAULT_CLOCK_VALUE 0
 
-#define NR_TESTS 602
+#define NR_TESTS 629
 
 static int64_t current_time = 42;
 
@@ -2836,6 +2836,729 @@ void test_create_writer_vs_non_writer_mode(void)
 	recursive_rmdir(trace_path);
 }
 
+static
+void test_event_recycling(void)
+{
+	int ret;
+	uint64_t value;
+	struct bt_ctf_trace *trace;
+	struct bt_ctf_stream_class *sc;
+	struct bt_ctf_stream *stream;
+	struct bt_ctf_event_class *ec;
+	struct bt_ctf_field_type *empty_struct_ft, *uint_ft, *seq_ft;
+	struct bt_ctf_event *event;
+	struct bt_ctf_field *held, *other, *length, *seq, *elem, *other_elem;
+
+	empty_struct_ft = bt_ctf_field_type_structure_create();
+	assert(empty_struct_ft);
+	uint_ft = bt_ctf_field_type_integer_create(8);
+	assert(uint_ft);
+	seq_ft = bt_ctf_field_type_sequence_create(uint_ft, "len");
+	assert(seq_ft);
+	ec = bt_ctf_event_class_create("recycled");
+	assert(ec);
+	ret = bt_ctf_event_class_add_field(ec, uint_ft, "a");
+	assert(!ret);
+	ret = bt_ctf_event_class_add_field(ec, uint_ft, "len");
+	assert(!ret);
+	ret = bt_ctf_event_class_add_field(ec, seq_ft, "seq");
+	assert(!ret);
+	trace = bt_ctf_trace_create();
+	assert(trace);
+	sc = bt_ctf_stream_class_create("recycling_sc");
+	assert(sc);
+	ret = bt_ctf_stream_class_set_event_header_type(sc, empty_struct_ft);
+	assert(!ret);
+	ret = bt_ctf_stream_class_add_event_class(sc, ec);
+	assert(!ret);
+	ret = bt_ctf_trace_add_stream_class(trace, sc);
+	assert(!ret);
+	stream = bt_ctf_stream_create(sc, NULL);
+	assert(stream);
+
+	/* A payload member held by a user outlives its event */
+	event = bt_ctf_event_create(ec);
+	assert(event);
+	held = bt_ctf_event_get_payload(event, "a");
+	assert(held);
+	ret = bt_ctf_field_unsigned_integer_set_value(held, 42);
+	assert(!ret);
+	BT_PUT(event);
+	event = bt_ctf_event_create(ec);
+	assert(event);
+	ok(!bt_ctf_field_unsigned_integer_get_value(held, &value) &&
+		value == 42,
+		"A payload member held by a user is not reset when its event is recycled");
+	other = bt_ctf_event_get_payload(event, "a");
+	ok(other && other != held,
+		"A recycled event does not share a payload member held by a user");
+	ok(bt_ctf_field_unsigned_integer_get_value(other, &value) < 0,
+		"A recycled event's payload member is unset");
+	BT_PUT(other);
+
+	/* Setting a sequence's length again gives it new elements */
+	length = bt_ctf_event_get_payload(event, "len");
+	assert(length);
+	seq = bt_ctf_event_get_payload(event, "seq");
+	assert(seq);
+	ret = bt_ctf_field_unsigned_integer_set_value(length, 2);
+	assert(!ret);
+	ret = bt_ctf_field_sequence_set_length(seq, length);
+	assert(!ret);
+	elem = bt_ctf_field_sequence_get_field(seq, 0);
+	assert(elem);
+	ret = bt_ctf_field_unsigned_integer_set_value(elem, 7);
+	assert(!ret);
+	ret = bt_ctf_field_unsigned_integer_set_value(length, 3);
+	assert(!ret);
+	ok(!bt_ctf_field_sequence_set_length(seq, length),
+		"Set the length of a sequence again");
+	ok(!bt_ctf_field_unsigned_integer_get_value(elem, &value) &&
+		value == 7,
+		"Setting the length of a sequence again does not reset an element held by a user");
+	other_elem = bt_ctf_field_sequence_get_field(seq, 0);
+	ok(other_elem && other_elem != elem &&
+		bt_ctf_field_unsigned_integer_get_value(other_elem,
+			&value) < 0,
+		"Setting the length of a sequence again gives it new elements");
+	ret = bt_ctf_field_unsigned_integer_set_value(other_elem, 9);
+	assert(!ret);
+	BT_PUT(other_elem);
+	BT_PUT(seq);
+	BT_PUT(length);
+
+	/* The elements of a recycled sequence are reset */
+	BT_PUT(event);
+	event = bt_ctf_event_create(ec);
+	assert(event);
+	seq = bt_ctf_event_get_payload(event, "seq");
+	assert(seq);
+	length = bt_ctf_field_sequence_get_length(seq);
+	ok(!length, "A recycled sequence has no length");
+	BT_PUT(length);
+	length = bt_ctf_event_get_payload(event, "len");
+	assert(length);
+	ret = bt_ctf_field_unsigned_integer_set_value(length, 1);
+	assert(!ret);
+	ret = bt_ctf_field_sequence_set_length(seq, length);
+	assert(!ret);
+	other_elem = bt_ctf_field_sequence_get_field(seq, 0);
+	ok(other_elem && bt_ctf_field_unsigned_integer_get_value(other_elem,
+			&value) < 0,
+		"The elements of a recycled sequence are unset");
+	ok(!bt_ctf_field_unsigned_integer_get_value(elem, &value) &&
+		value == 7,
+		"An element held by a user is not reset when its event is recycled");
+
+	bt_put(other_elem);
+	bt_put(elem);
+	bt_put(seq);
+	bt_put(length);
+	bt_put(held);
+	bt_put(event);
+	bt_put(stream);
+	bt_put(sc);
+	bt_put(trace);
+	bt_put(ec);
+	bt_put(seq_ft);
+	bt_put(uint_ft);
+	bt_put(empty_struct_ft);
+}
+
+static
+struct bt_ctf_field_type *create_aligned_integer_type(unsigned int size,
+		unsigned int alignment, int is_signed)
+{
+	struct bt_ctf_field_type *type;
+	int ret;
+
+	type = bt_ctf_field_type_integer_create(size);
+	assert(type);
+	ret = bt_ctf_field_type_set_alignment(type, alignment);
+	assert(!ret);
+	ret = bt_ctf_field_type_integer_set_signed(type, is_signed);
+	assert(!ret);
+	return type;
+}
+
+static
+void add_aligned_integer_field(struct bt_ctf_field_type *structure,
+		const char *name, unsigned int size, unsigned int alignment,
+		int is_signed)
+{
+	struct bt_ctf_field_type *type;
+	int ret;
+
+	type = create_aligned_integer_type(size, alignment, is_signed);
+	ret = bt_ctf_field_type_structure_add_field(structure, type, name);
+	assert(!ret);
+	bt_put(type);
+}
+
+/*
+ * Creates a stream class whose events have no timestamp: its packet
+ * context only has the members which the writer sets.
+ */
+static
+struct bt_ctf_stream_class *create_timeless_stream_class(const char *name)
+{
+	struct bt_ctf_stream_class *stream_class;
+	struct bt_ctf_field_type *packet_context_type, *event_header_type;
+	int ret;
+
+	stream_class = bt_ctf_stream_class_create(name);
+	assert(stream_class);
+	packet_context_type = bt_ctf_field_type_structure_create();
+	assert(packet_context_type);
+	add_aligned_integer_field(packet_context_type, "content_size", 64, 8, 0);
+	add_aligned_integer_field(packet_context_type, "packet_size", 64, 8, 0);
+	add_aligned_integer_field(packet_context_type, "events_discarded", 32,
+		8, 0);
+	ret = bt_ctf_stream_class_set_packet_context_type(stream_class,
+		packet_context_type);
+	assert(!ret);
+	event_header_type = bt_ctf_field_type_structure_create();
+	assert(event_header_type);
+	add_aligned_integer_field(event_header_type, "id", 32, 8, 0);
+	ret = bt_ctf_stream_class_set_event_header_type(stream_class,
+		event_header_type);
+	assert(!ret);
+	bt_put(event_header_type);
+	bt_put(packet_context_type);
+	return stream_class;
+}
+
+static
+void set_structure_integer(struct bt_ctf_field *structure, const char *name,
+		int64_t value)
+{
+	struct bt_ctf_field *field;
+	struct bt_ctf_field_type *type;
+	int ret;
+
+	field = bt_ctf_field_structure_get_field(structure, name);
+	assert(field);
+	type = bt_ctf_field_get_type(field);
+	assert(type);
+	if (bt_ctf_field_type_get_type_id(type) == BT_CTF_TYPE_ID_ENUM) {
+		struct bt_ctf_field *container =
+			bt_ctf_field_enumeration_get_container(field);
+
+		assert(container);
+		BT_MOVE(field, container);
+		BT_PUT(type);
+		type = bt_ctf_field_get_type(field);
+	}
+
+	if (bt_ctf_field_type_integer_get_signed(type)) {
+		ret = bt_ctf_field_signed_integer_set_value(field, value);
+	} else {
+		ret = bt_ctf_field_unsigned_integer_set_value(field, value);
+	}
+	assert(!ret);
+	bt_put(type);
+	bt_put(field);
+}
+
+static
+void append_run_event(struct bt_ctf_stream *stream,
+		struct bt_ctf_event_class *event_class, int64_t base)
+{
+	struct bt_ctf_event *event;
+	struct bt_ctf_field *payload, *string;
+	int ret;
+
+	event = bt_ctf_event_create(event_class);
+	assert(event);
+	payload = bt_ctf_event_get_payload_field(event);
+	assert(payload);
+	set_structure_integer(payload, "u8", base + 1);
+	set_structure_integer(payload, "u16", base * 3 + 0x1234);
+	set_structure_integer(payload, "u32_byte_aligned", base + 0x89abcdef);
+	set_structure_integer(payload, "u64", base * 0x100000001 + 7);
+	set_structure_integer(payload, "s32", -base - 2);
+	set_structure_integer(payload, "enum16", base % 2 ? 1 : 300);
+	set_structure_integer(payload, "bits3", base % 8);
+	set_structure_integer(payload, "u8_after_bits", base + 9);
+	set_structure_integer(payload, "s16_word_aligned", -base * 5);
+	set_structure_integer(payload, "u32_big_endian", base + 0x01020304);
+	set_structure_integer(payload, "u64_after_string", base + 11);
+	string = bt_ctf_field_structure_get_field(payload, "str");
+	assert(string);
+	ret = bt_ctf_field_string_set_value(string, base % 2 ? "odd" : "ev");
+	assert(!ret);
+	ret = bt_ctf_stream_append_event(stream, event);
+	assert(!ret);
+	bt_put(string);
+	bt_put(payload);
+	bt_put(event);
+}
+
+/*
+ * Packets which the writer produced before it serialized the events as
+ * they were appended and before it serialized structures with plans.
+ */
+static const uint8_t run_packets[] = {
+	0xc1, 0x1f, 0xfc, 0xc1, 0x00, 0x00, 0x00, 0x00,
+	0xef, 0xbe, 0x88, 0x05, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x88, 0x05, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x01, 0x00, 0x34, 0x12, 0xef, 0xcd, 0xab, 0x89,
+	0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0xfe, 0xff, 0xff, 0xff, 0x2c, 0x01, 0x00, 0x09,
+	0x00, 0x00, 0x01, 0x02, 0x03, 0x04, 0x65, 0x76,
+	0x00, 0x0b, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x02, 0x00, 0x37, 0x12, 0xf0, 0xcd, 0xab, 0x89,
+	0x08, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+	0xfd, 0xff, 0xff, 0xff, 0x01, 0x00, 0x01, 0x0a,
+	0xfb, 0xff, 0x01, 0x02, 0x03, 0x05, 0x6f, 0x64,
+	0x64, 0x00, 0x0c, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x03, 0x00, 0x3a, 0x12, 0xf1, 0xcd, 0xab, 0x89,
+	0x09, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+	0xfc, 0xff, 0xff, 0xff, 0x2c, 0x01, 0x02, 0x0b,
+	0xf6, 0xff, 0x01, 0x02, 0x03, 0x06, 0x65, 0x76,
+	0x00, 0x0d, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0xc1, 0x1f, 0xfc, 0xc1, 0x00, 0x00, 0x00,
+	0x00, 0xef, 0xbe, 0x08, 0x04, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x08, 0x04, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x04, 0x00, 0x3d, 0x12, 0xf2, 0xcd, 0xab,
+	0x89, 0x0a, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00,
+	0x00, 0xfb, 0xff, 0xff, 0xff, 0x01, 0x00, 0x03,
+	0x0c, 0xf1, 0xff, 0x01, 0x02, 0x03, 0x07, 0x6f,
+	0x64, 0x64, 0x00, 0x0e, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x05, 0x00, 0x40, 0x12, 0xf3, 0xcd, 0xab,
+	0x89, 0x0b, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00,
+	0x00, 0xfa, 0xff, 0xff, 0xff, 0x2c, 0x01, 0x04,
+	0x0d, 0xec, 0xff, 0x01, 0x02, 0x03, 0x08, 0x65,
+	0x76, 0x00, 0x0f, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00,
+};
+
+static
+void test_run_serialization(void)
+{
+	int ret, i, fd;
+	char trace_path[] = "/tmp/ctfwriter_XXXXXX";
+	char stream_path[sizeof(trace_path) + 7];
+	uint8_t buf[sizeof(run_packets)];
+	ssize_t len;
+	struct bt_ctf_writer *writer;
+	struct bt_ctf_trace *trace;
+	struct bt_ctf_stream_class *stream_class;
+	struct bt_ctf_stream *stream;
+	struct bt_ctf_event_class *event_class;
+	struct bt_ctf_field_type *packet_header_type, *payload_type, *type,
+		*container_type;
+	struct bt_ctf_field *packet_header;
+
+	if (!bt_mkdtemp(trace_path)) {
+		perror("# perror");
+	}
+
+	writer = bt_ctf_writer_create(trace_path);
+	assert(writer);
+	trace = bt_ctf_writer_get_trace(writer);
+	assert(trace);
+	ret = bt_ctf_trace_set_byte_order(trace,
+		BT_CTF_BYTE_ORDER_LITTLE_ENDIAN);
+	assert(!ret);
+
+	packet_header_type = bt_ctf_field_type_structure_create();
+	assert(packet_header_type);
+	add_aligned_integer_field(packet_header_type, "magic", 32, 8, 0);
+	add_aligned_integer_field(packet_header_type, "stream_id", 32, 8, 0);
+	add_aligned_integer_field(packet_header_type, "custom", 16, 8, 0);
+	ret = bt_ctf_trace_set_packet_header_type(trace, packet_header_type);
+	assert(!ret);
+
+	stream_class = create_timeless_stream_class("runs");
+
+	/*
+	 * Integer runs broken by members of other alignments, by an
+	 * enumeration, by a bit field, by a member in the other byte
+	 * order and by a string.
+	 */
+	payload_type = bt_ctf_field_type_structure_create();
+	assert(payload_type);
+	add_aligned_integer_field(payload_type, "u8", 8, 8, 0);
+	add_aligned_integer_field(payload_type, "u16", 16, 16, 0);
+	add_aligned_integer_field(payload_type, "u32_byte_aligned", 32, 8, 0);
+	add_aligned_integer_field(payload_type, "u64", 64, 64, 0);
+	add_aligned_integer_field(payload_type, "s32", 32, 32, 1);
+	container_type = create_aligned_integer_type(16, 16, 0);
+	type = bt_ctf_field_type_enumeration_create(container_type);
+	assert(type);
+	ret = bt_ctf_field_type_enumeration_add_mapping_unsigned(type,
+		"one", 1, 1);
+	assert(!ret);
+	ret = bt_ctf_field_type_enumeration_add_mapping_unsigned(type,
+		"many", 2, 1000);
+	assert(!ret);
+	ret = bt_ctf_field_type_structure_add_field(payload_type, type,
+		"enum16");
+	assert(!ret);
+	BT_PUT(type);
+	BT_PUT(container_type);
+	add_aligned_integer_field(payload_type, "bits3", 3, 1, 0);
+	add_aligned_integer_field(payload_type, "u8_after_bits", 8, 8, 0);
+	add_aligned_integer_field(payload_type, "s16_word_aligned", 16, 32, 1);
+	type = create_aligned_integer_type(32, 8, 0);
+	ret = bt_ctf_field_type_set_byte_order(type,
+		BT_CTF_BYTE_ORDER_BIG_ENDIAN);
+	assert(!ret);
+	ret = bt_ctf_field_type_structure_add_field(payload_type, type,
+		"u32_big_endian");
+	assert(!ret);
+	BT_PUT(type);
+	type = bt_ctf_field_type_string_create();
+	assert(type);
+	ret = bt_ctf_field_type_structure_add_field(payload_type, type,
+		"str");
+	assert(!ret);
+	BT_PUT(type);
+	add_aligned_integer_field(payload_type, "u64_after_string", 64, 8, 0);
+	event_class = bt_ctf_event_class_create("run");
+	assert(event_class);
+	ret = bt_ctf_event_class_set_payload_type(event_class, payload_type);
+	assert(!ret);
+	ret = bt_ctf_stream_class_add_event_class(stream_class, event_class);
+	assert(!ret);
+	stream = bt_ctf_writer_create_stream(writer, stream_class);
+	assert(stream);
+
+	for (i = 0; i < 3; i++) {
+		append_run_event(stream, event_class, i);
+	}
+
+	ok(bt_ctf_stream_flush(stream),
+		"Flushing a packet whose header is not set fails");
+	packet_header = bt_ctf_stream_get_packet_header(stream);
+	assert(packet_header);
+	set_structure_integer(packet_header, "custom", 0xbeef);
+	ok(!bt_ctf_stream_flush(stream),
+		"Flushing the packet again once its header is set succeeds");
+	append_run_event(stream, event_class, 3);
+	append_run_event(stream, event_class, 4);
+	ok(!bt_ctf_stream_flush(stream), "Flush a second packet");
+
+	BT_PUT(stream);
+	BT_PUT(writer);
+	strcpy(stream_path, trace_path);
+	strcat(stream_path, "/runs_0");
+	fd = open(stream_path, O_RDONLY);
+	len = fd < 0 ? -1 : read(fd, buf, sizeof(buf));
+	ok(len == sizeof(run_packets) && !memcmp(buf, run_packets, len),
+		"Events with runs of integers are serialized as before");
+	if (fd >= 0) {
+		close(fd);
+	}
+
+	bt_put(packet_header);
+	bt_put(event_class);
+	bt_put(payload_type);
+	bt_put(packet_header_type);
+	bt_put(stream_class);
+	bt_put(trace);
+	recursive_rmdir(trace_path);
+}
+
+/*
+ * Creates a writer of one "copy" stream whose packets have a fixed-size
+ * header and context of COPY_EVENTS_OFFSET bits.
+ */
+#define COPY_EVENTS_OFFSET	(80 + 160)
+
+static
+struct bt_ctf_writer *create_copy_writer(char *trace_path,
+		struct bt_ctf_stream **stream,
+		struct bt_ctf_event_class **event_class)
+{
+	int ret;
+	struct bt_ctf_writer *writer;
+	struct bt_ctf_trace *trace;
+	struct bt_ctf_stream_class *stream_class;
+	struct bt_ctf_field_type *packet_header_type, *payload_type;
+	struct bt_ctf_field *packet_header;
+
+	if (!bt_mkdtemp(trace_path)) {
+		perror("# perror");
+	}
+
+	writer = bt_ctf_writer_create(trace_path);
+	assert(writer);
+	trace = bt_ctf_writer_get_trace(writer);
+	assert(trace);
+	ret = bt_ctf_trace_set_byte_order(trace,
+		BT_CTF_BYTE_ORDER_LITTLE_ENDIAN);
+	assert(!ret);
+	packet_header_type = bt_ctf_field_type_structure_create();
+	assert(packet_header_type);
+	add_aligned_integer_field(packet_header_type, "magic", 32, 8, 0);
+	add_aligned_integer_field(packet_header_type, "stream_id", 32, 8, 0);
+	add_aligned_integer_field(packet_header_type, "custom", 16, 8, 0);
+	ret = bt_ctf_trace_set_packet_header_type(trace, packet_header_type);
+	assert(!ret);
+	stream_class = create_timeless_stream_class("copy");
+	payload_type = bt_ctf_field_type_structure_create();
+	assert(payload_type);
+	add_aligned_integer_field(payload_type, "value", 32, 32, 0);
+	add_aligned_integer_field(payload_type, "small", 8, 8, 0);
+	*event_class = bt_ctf_event_class_create("copy");
+	assert(*event_class);
+	ret = bt_ctf_event_class_set_payload_type(*event_class, payload_type);
+	assert(!ret);
+	ret = bt_ctf_stream_class_add_event_class(stream_class, *event_class);
+	assert(!ret);
+	*stream = bt_ctf_writer_create_stream(writer, stream_class);
+	assert(*stream);
+	packet_header = bt_ctf_stream_get_packet_header(*stream);
+	assert(packet_header);
+	set_structure_integer(packet_header, "custom", 0xc0de);
+	bt_put(packet_header);
+	bt_put(payload_type);
+	bt_put(stream_class);
+	bt_put(packet_header_type);
+	bt_put(trace);
+	return writer;
+}
+
+static
+void append_copy_events(struct bt_ctf_stream *stream,
+		struct bt_ctf_event_class *event_class, int64_t base)
+{
+	struct bt_ctf_event *event;
+	struct bt_ctf_field *payload;
+	int64_t i;
+	int ret;
+
+	for (i = 0; i < 5; i++) {
+		event = bt_ctf_event_create(event_class);
+		assert(event);
+		payload = bt_ctf_event_get_payload_field(event);
+		assert(payload);
+		set_structure_integer(payload, "value", base + i * 0x01010101);
+		set_structure_integer(payload, "small", (base + i) % 256);
+		ret = bt_ctf_stream_append_event(stream, event);
+		assert(!ret);
+		bt_put(payload);
+		bt_put(event);
+	}
+}
+
+/* Reads the whole "copy" stream file of a trace; returns its size. */
+static
+ssize_t read_copy_stream(const char *trace_path, uint8_t *buf, size_t len)
+{
+	char stream_path[PATH_MAX];
+	ssize_t ret = -1;
+	int fd;
+
+	snprintf(stream_path, sizeof(stream_path), "%s/copy_0", trace_path);
+	fd = open(stream_path, O_RDONLY);
+	if (fd >= 0) {
+		ret = read(fd, buf, len);
+		close(fd);
+	}
+
+	return ret;
+}
+
+static
+void test_flush_encoded_events(void)
+{
+	int ret;
+	char source_path[] = "/tmp/ctfwriter_XXXXXX";
+	char copy_path[] = "/tmp/ctfwriter_XXXXXX";
+	uint8_t source[8192], copy[16384];
+	ssize_t source_len, copy_len;
+	uint64_t content_size = 0;
+	struct bt_ctf_writer *writer;
+	struct bt_ctf_stream *stream;
+	struct bt_ctf_event_class *event_class;
+
+	/* A source packet... */
+	writer = create_copy_writer(source_path, &stream, &event_class);
+	append_copy_events(stream, event_class, 0);
+	ret = bt_ctf_stream_flush(stream);
+	assert(!ret);
+	BT_PUT(stream);
+	BT_PUT(event_class);
+	BT_PUT(writer);
+	source_len = read_copy_stream(source_path, source, sizeof(source));
+	assert(source_len > 0);
+	/* Little-endian content_size, after the 80-bit packet header */
+	for (ret = 7; ret >= 0; ret--) {
+		content_size = (content_size << 8) | source[10 + ret];
+	}
+
+	/* ...copied into an equivalent stream. */
+	writer = create_copy_writer(copy_path, &stream, &event_class);
+	ok(bt_ctf_stream_flush_encoded_events(NULL, source,
+		COPY_EVENTS_OFFSET, content_size, 32) < 0,
+		"bt_ctf_stream_flush_encoded_events handles NULL correctly");
+	append_copy_events(stream, event_class, 1000);
+	ok(bt_ctf_stream_flush_encoded_events(stream, source,
+		COPY_EVENTS_OFFSET, content_size, 32) == 0,
+		"Flush a packet with encoded events instead of the appended ones");
+	append_copy_events(stream, event_class, 0);
+	ok(bt_ctf_stream_flush_encoded_events(stream, source,
+		COPY_EVENTS_OFFSET + 8, content_size, 32) == 1,
+		"Encoded events cannot move by less than their alignment");
+	ok(bt_ctf_stream_flush(stream) == 0,
+		"Flush the appended events once the encoded ones are refused");
+	BT_PUT(stream);
+	BT_PUT(event_class);
+	BT_PUT(writer);
+	copy_len = read_copy_stream(copy_path, copy, sizeof(copy));
+	ok(copy_len == 2 * source_len && !memcmp(copy, source, source_len),
+		"The encoded events replace the appended ones");
+	ok(copy_len == 2 * source_len &&
+		!memcmp(&copy[source_len], source, source_len),
+		"The appended events are kept when the encoded ones are refused");
+	recursive_rmdir(source_path);
+	recursive_rmdir(copy_path);
+}
+
+static
+void test_frozen_event_copy(void)
+{
+	int ret;
+	uint64_t value;
+	const char *string_value;
+	char trace_path[] = "/tmp/ctfwriter_XXXXXX";
+	struct bt_ctf_writer *writer;
+	struct bt_ctf_stream_class *stream_class;
+	struct bt_ctf_stream *stream;
+	struct bt_ctf_event_class *event_class;
+	struct bt_ctf_field_type *payload_type, *inner_type, *string_type;
+	struct bt_ctf_event *event;
+	struct bt_ctf_field *payload, *copy, *inner, *inner_copy, *member,
+		*member_copy, *field;
+
+	if (!bt_mkdtemp(trace_path)) {
+		perror("# perror");
+	}
+
+	writer = bt_ctf_writer_create(trace_path);
+	assert(writer);
+	stream_class = create_timeless_stream_class("frozen_copy");
+	string_type = bt_ctf_field_type_string_create();
+	assert(string_type);
+	inner_type = bt_ctf_field_type_structure_create();
+	assert(inner_type);
+	add_aligned_integer_field(inner_type, "a", 32, 8, 0);
+	ret = bt_ctf_field_type_structure_add_field(inner_type, string_type,
+		"b");
+	assert(!ret);
+	payload_type = bt_ctf_field_type_structure_create();
+	assert(payload_type);
+	add_aligned_integer_field(payload_type, "outer", 32, 8, 0);
+	ret = bt_ctf_field_type_structure_add_field(payload_type, inner_type,
+		"inner");
+	assert(!ret);
+	event_class = bt_ctf_event_class_create("nested");
+	assert(event_class);
+	ret = bt_ctf_event_class_set_payload_type(event_class, payload_type);
+	assert(!ret);
+	ret = bt_ctf_stream_class_add_event_class(stream_class, event_class);
+	assert(!ret);
+	stream = bt_ctf_writer_create_stream(writer, stream_class);
+	assert(stream);
+
+	/* Appending the event freezes it */
+	event = bt_ctf_event_create(event_class);
+	assert(event);
+	payload = bt_ctf_event_get_payload_field(event);
+	assert(payload);
+	set_structure_integer(payload, "outer", 1);
+	inner = bt_ctf_field_structure_get_field(payload, "inner");
+	assert(inner);
+	set_structure_integer(inner, "a", 2);
+	field = bt_ctf_field_structure_get_field(inner, "b");
+	assert(field);
+	ret = bt_ctf_field_string_set_value(field, "two");
+	assert(!ret);
+	BT_PUT(field);
+	ret = bt_ctf_stream_append_event(stream, event);
+	assert(!ret);
+
+	copy = bt_ctf_field_copy(payload);
+	ok(copy, "Copy the payload of a frozen event");
+	inner_copy = bt_ctf_field_structure_get_field(copy, "inner");
+	member_copy = bt_ctf_field_structure_get_field(inner_copy, "a");
+	ok(member_copy && !bt_ctf_field_unsigned_integer_set_value(
+		member_copy, 20),
+		"A nested member of the copy of a frozen payload can be modified");
+	member = bt_ctf_field_structure_get_field(inner, "a");
+	assert(member);
+	ok(member != member_copy &&
+		!bt_ctf_field_unsigned_integer_get_value(member, &value) &&
+		value == 2,
+		"Modifying a nested member of a copy leaves the original untouched");
+	BT_PUT(member);
+	field = bt_ctf_field_structure_get_field(copy, "outer");
+	ok(field && !bt_ctf_field_unsigned_integer_get_value(field, &value) &&
+		value == 1,
+		"The copy of a frozen payload has the values of the original");
+	BT_PUT(field);
+
+	/* Recycle the original event while the copy is alive */
+	BT_PUT(inner);
+	BT_PUT(payload);
+	BT_PUT(event);
+	event = bt_ctf_event_create(event_class);
+	assert(event);
+	payload = bt_ctf_event_get_payload_field(event);
+	assert(payload);
+	set_structure_integer(payload, "outer", 100);
+	inner = bt_ctf_field_structure_get_field(payload, "inner");
+	assert(inner);
+	set_structure_integer(inner, "a", 200);
+	field = bt_ctf_field_structure_get_field(inner, "b");
+	assert(field);
+	ret = bt_ctf_field_string_set_value(field, "x");
+	assert(!ret);
+	BT_PUT(field);
+	ret = bt_ctf_stream_append_event(stream, event);
+	assert(!ret);
+	field = bt_ctf_field_structure_get_field(copy, "outer");
+	ok(field && !bt_ctf_field_unsigned_integer_get_value(field, &value) &&
+		value == 1,
+		"Recycling the original event leaves the copy's members untouched");
+	BT_PUT(field);
+	field = bt_ctf_field_structure_get_field(inner_copy, "b");
+	string_value = bt_ctf_field_string_get_value(field);
+	ok(string_value && !strcmp(string_value, "two"),
+		"Recycling the original event leaves the copy's nested members untouched");
+	BT_PUT(field);
+	ok(!bt_ctf_field_unsigned_integer_get_value(member_copy, &value) &&
+		value == 20,
+		"The modified member of the copy keeps its value");
+	ok(!bt_ctf_stream_flush(stream),
+		"Flush a stream after recycling an event which has a copy");
+
+	bt_put(member_copy);
+	bt_put(inner_copy);
+	bt_put(copy);
+	bt_put(inner);
+	bt_put(payload);
+	bt_put(event);
+	bt_put(stream);
+	bt_put(event_class);
+	bt_put(payload_type);
+	bt_put(inner_type);
+	bt_put(string_type);
+	bt_put(stream_class);
+	bt_put(writer);
+	recursive_rmdir(trace_path);
+}
+
 static
 void test_clock_utils(void)
 {
@@ -3516,6 +4239,13 @@ int main(int argc, char **argv)
 
 	test_instanciate_event_before_stream(writer, clock);
 
+	test_event_recycling();
+
+	test_run_serialization();
+	test_flush_encoded_events();
+
+	test_frozen_event_copy();
+
 	append_simple_event(stream_class, stream1, clock);
 
 	packet_resize_test(stream_class, stream1, clock);
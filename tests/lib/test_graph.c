@@ -0,0 +1,715 @@
+/*
+ * test_graph.c
+ *
+ * Component graph test
+ *
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <babeltrace/plugin/plugin.h>
+#include <babeltrace/component/component.h>
+#include <babeltrace/component/component-class.h>
+#include <babeltrace/component/component-source.h>
+#include <babeltrace/component/component-filter.h>
+#include <babeltrace/component/component-sink.h>
+#include <babeltrace/component/connection.h>
+#include <babeltrace/component/graph.h>
+#include <babeltrace/component/port.h>
+#include <babeltrace/ref.h>
+#include <babeltrace/values.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <assert.h>
+#include <unistd.h>
+#include <glib.h>
+#include "tap/tap.h"
+#include "test-graph-plugins/counter.h"
+
+#define NR_TESTS	37
+
+/* Upper bound of the runs of a graph returning AGAIN, not to hang */
+#define MAX_RUNS	1000
+
+static struct bt_plugin *plugin;
+static struct bt_plugin *muxer_plugin;
+
+static struct bt_component *create_plugin_component(
+		struct bt_plugin *comp_plugin, const char *class_name,
+		enum bt_component_class_type type, const char *name,
+		struct bt_value *params)
+{
+	struct bt_component_class *comp_class;
+	struct bt_component *component;
+
+	comp_class = bt_plugin_get_component_class_by_name_and_type(
+		comp_plugin, class_name, type);
+	assert(comp_class);
+	component = bt_component_create(comp_class, name, params);
+	assert(component);
+	bt_put(comp_class);
+	return component;
+}
+
+static struct bt_component *create_component(const char *class_name,
+		enum bt_component_class_type type, const char *name,
+		const char *key, int64_t value, const char *key2,
+		int64_t value2)
+{
+	struct bt_component *component;
+	struct bt_value *params = bt_value_map_create();
+
+	assert(params);
+	if (key) {
+		(void) bt_value_map_insert_integer(params, key, value);
+	}
+	if (key2) {
+		(void) bt_value_map_insert_integer(params, key2, value2);
+	}
+
+	component = create_plugin_component(plugin, class_name, type, name,
+		params);
+	bt_put(params);
+	return component;
+}
+
+static void connect_ports(struct bt_graph *graph, struct bt_port *upstream,
+		struct bt_port *downstream)
+{
+	struct bt_connection *connection;
+
+	assert(upstream && downstream);
+	connection = bt_graph_connect(graph, upstream, downstream);
+	assert(connection);
+	bt_put(connection);
+	bt_put(upstream);
+	bt_put(downstream);
+}
+
+/*
+ * Adds a "counter" source delivering "count" notifications, with an
+ * AGAIN before every "again_period" notifications, connected to a new
+ * "checker" sink which returns AGAIN "again" times before consuming.
+ */
+static struct bt_component *add_counter_checker(struct bt_graph *graph,
+		const char *name, int64_t count, int64_t again_period,
+		int64_t again)
+{
+	struct bt_component *source, *sink;
+
+	source = create_component("counter", BT_COMPONENT_CLASS_TYPE_SOURCE,
+		name, "count", count, "again-period", again_period);
+	sink = create_component("checker", BT_COMPONENT_CLASS_TYPE_SINK,
+		name, "again", again, NULL, 0);
+	connect_ports(graph, bt_component_source_get_default_output_port(source),
+		bt_component_sink_get_default_input_port(sink));
+	bt_put(source);
+	return sink;
+}
+
+/*
+ * Adds a source of class source_class delivering "count" notifications,
+ * with an AGAIN before every "again_period" notifications, connected to
+ * a new "checker" sink which gets "batch" notifications at once.
+ */
+static struct bt_component *add_batch_checker(struct bt_graph *graph,
+		const char *source_class, const char *name, int64_t count,
+		int64_t again_period, int64_t batch)
+{
+	struct bt_component *source, *sink;
+
+	source = create_component(source_class, BT_COMPONENT_CLASS_TYPE_SOURCE,
+		name, "count", count, "again-period", again_period);
+	sink = create_component("checker", BT_COMPONENT_CLASS_TYPE_SINK,
+		name, "batch", batch, NULL, 0);
+	connect_ports(graph, bt_component_source_get_default_output_port(source),
+		bt_component_sink_get_default_input_port(sink));
+	bt_put(source);
+	return sink;
+}
+
+static struct checker *get_checker(struct bt_component *sink)
+{
+	return bt_component_get_private_data(sink);
+}
+
+/* Runs a graph until it does not return AGAIN; returns the number of runs. */
+static int run_graph(struct bt_graph *graph, enum bt_graph_status *status)
+{
+	int runs = 0;
+
+	do {
+		*status = bt_graph_run(graph, NULL);
+		runs++;
+	} while (*status == BT_GRAPH_STATUS_AGAIN && runs < MAX_RUNS);
+
+	return runs;
+}
+
+static void test_sink_again(void)
+{
+	struct bt_graph *graph = bt_graph_create();
+	struct bt_component *sink;
+	enum bt_graph_status status;
+
+	assert(graph);
+	sink = add_counter_checker(graph, "single", 5, 0, 2);
+	status = bt_graph_run(graph, NULL);
+	ok(status == BT_GRAPH_STATUS_AGAIN,
+		"bt_graph_run() returns AGAIN when its only sink returns AGAIN");
+	status = bt_graph_run(graph, NULL);
+	ok(status == BT_GRAPH_STATUS_AGAIN,
+		"bt_graph_run() retries a sink which returned AGAIN");
+	status = bt_graph_run(graph, NULL);
+	ok(status == BT_GRAPH_STATUS_END,
+		"bt_graph_run() runs the graph to completion once the sink is ready");
+	ok(get_checker(sink)->consumed == 5 &&
+		get_checker(sink)->out_of_order == 0,
+		"the sink which returned AGAIN gets all the notifications in order");
+	bt_put(sink);
+	bt_put(graph);
+}
+
+static void test_waiting_sink(void)
+{
+	struct bt_graph *graph = bt_graph_create();
+	struct bt_component *waiting_sink, *sink;
+	enum bt_graph_status status;
+
+	assert(graph);
+	waiting_sink = add_counter_checker(graph, "waiting", 5, 0, 3);
+	sink = add_counter_checker(graph, "ready", 20, 0, 0);
+	status = bt_graph_run(graph, NULL);
+	ok(status == BT_GRAPH_STATUS_END,
+		"bt_graph_run() does not return AGAIN while another sink makes progress");
+	ok(get_checker(waiting_sink)->consumed == 5 &&
+		get_checker(waiting_sink)->end_reached,
+		"a sink which returned AGAIN is retried while the others are consumed");
+	ok(get_checker(sink)->consumed == 20 &&
+		get_checker(sink)->end_reached,
+		"the other sink is consumed to completion");
+	bt_put(waiting_sink);
+	bt_put(sink);
+	bt_put(graph);
+}
+
+static void test_upstream_again(void)
+{
+	struct bt_graph *graph = bt_graph_create();
+	struct bt_component *sink;
+	enum bt_graph_status status;
+	struct checker *checker;
+	int runs;
+
+	assert(graph);
+	sink = add_counter_checker(graph, "again", 20, 7, 0);
+	checker = get_checker(sink);
+	runs = run_graph(graph, &status);
+	ok(status == BT_GRAPH_STATUS_END && runs == 3,
+		"a graph whose source returns AGAIN is run to completion");
+	ok(checker->upstream_again == 2,
+		"the sink gets every AGAIN of its iterator");
+	ok(checker->consumed == 20 && checker->out_of_order == 0,
+		"no notification is lost or reordered by an AGAIN");
+	bt_put(sink);
+	bt_put(graph);
+}
+
+static void test_prefetch(void)
+{
+	struct bt_graph *graph = bt_graph_create();
+	struct bt_component *sink;
+	enum bt_graph_status status;
+	struct checker *checker;
+
+	assert(graph);
+	ok(bt_graph_set_notification_queue_capacity(NULL, 4) ==
+		BT_GRAPH_STATUS_INVALID,
+		"bt_graph_set_notification_queue_capacity() handles NULL correctly");
+	ok(bt_graph_set_notification_queue_capacity(graph, 4) ==
+		BT_GRAPH_STATUS_OK,
+		"bt_graph_set_notification_queue_capacity() succeeds");
+	sink = add_counter_checker(graph, "prefetched", 1000, 0, 0);
+	checker = get_checker(sink);
+	status = bt_graph_run(graph, NULL);
+	ok(status == BT_GRAPH_STATUS_END,
+		"a graph with notification queues is run to completion");
+	ok(checker->consumed == 1000 && checker->out_of_order == 0,
+		"the notifications of a queue are consumed in order");
+	bt_put(sink);
+	bt_put(graph);
+}
+
+static void test_prefetch_upstream_again(void)
+{
+	struct bt_graph *graph = bt_graph_create();
+	struct bt_component *sink;
+	enum bt_graph_status status;
+	struct checker *checker;
+
+	assert(graph);
+	(void) bt_graph_set_notification_queue_capacity(graph, 4);
+	sink = add_counter_checker(graph, "prefetched-again", 1000, 100, 0);
+	checker = get_checker(sink);
+	(void) run_graph(graph, &status);
+	ok(status == BT_GRAPH_STATUS_END,
+		"an AGAIN does not end the notifications of a queue");
+	ok(checker->upstream_again == 9,
+		"the sink gets every AGAIN of its prefetched iterator");
+	ok(checker->consumed == 1000 && checker->out_of_order == 0,
+		"no prefetched notification is lost or reordered by an AGAIN");
+	bt_put(sink);
+	bt_put(graph);
+}
+
+static void test_batch(const char *source_class, const char *kind)
+{
+	struct bt_graph *graph = bt_graph_create();
+	struct bt_component *sink;
+	enum bt_graph_status status;
+	struct checker *checker;
+
+	assert(graph);
+	sink = add_batch_checker(graph, source_class, source_class, 100, 30,
+		16);
+	checker = get_checker(sink);
+	(void) run_graph(graph, &status);
+	ok(status == BT_GRAPH_STATUS_END && checker->consumed == 100 &&
+		checker->out_of_order == 0 && checker->largest_batch == 16,
+		"the notifications of a %s source are consumed in order in batches",
+		kind);
+	ok(checker->upstream_again == 3,
+		"a batch of a %s source ends before an AGAIN, which follows",
+		kind);
+	bt_put(sink);
+	bt_put(graph);
+}
+
+static void test_prefetch_batch(void)
+{
+	struct bt_graph *graph = bt_graph_create();
+	struct bt_component *sink;
+	enum bt_graph_status status;
+	struct checker *checker;
+
+	assert(graph);
+	(void) bt_graph_set_notification_queue_capacity(graph, 4);
+	sink = add_batch_checker(graph, "batch_counter", "prefetched-batch",
+		1000, 100, 16);
+	checker = get_checker(sink);
+	(void) run_graph(graph, &status);
+	ok(status == BT_GRAPH_STATUS_END && checker->consumed == 1000 &&
+		checker->out_of_order == 0 && checker->upstream_again == 9,
+		"the notifications of a queue are consumed in order in batches");
+	bt_put(sink);
+	bt_put(graph);
+}
+
+/* Sources of test_muxer(), one per input port of the muxer */
+static const struct {
+	int64_t count;
+	int64_t first;
+	int64_t step;
+} muxed_counters[] = {
+	{ 10, 0, 2 },
+	/* Same timestamps as the first one */
+	{ 10, 0, 2 },
+	{ 10, 1, 2 },
+	/* Ends before the others */
+	{ 3, 0, 1 },
+};
+
+#define MUXED_COUNTER_COUNT \
+	(sizeof(muxed_counters) / sizeof(muxed_counters[0]))
+
+/*
+ * Adds a "counter" source connected to the input port of the muxer at
+ * index i; its notifications' tie-breaker is i.
+ */
+static void add_muxed_counter(struct bt_graph *graph,
+		struct bt_component *muxer, int i)
+{
+	struct bt_component *source;
+	struct bt_value *params = bt_value_map_create();
+	struct bt_port *muxer_port;
+	char name[32];
+
+	assert(params);
+	(void) bt_value_map_insert_integer(params, "count",
+		muxed_counters[i].count);
+	(void) bt_value_map_insert_integer(params, "first",
+		muxed_counters[i].first);
+	(void) bt_value_map_insert_integer(params, "step",
+		muxed_counters[i].step);
+	(void) bt_value_map_insert_integer(params, "id", i);
+	snprintf(name, sizeof(name), "muxed-%d", i);
+	source = create_plugin_component(plugin, "counter",
+		BT_COMPONENT_CLASS_TYPE_SOURCE, name, params);
+	if (i == 0) {
+		muxer_port = bt_component_filter_get_default_input_port(muxer);
+	} else {
+		snprintf(name, sizeof(name), "input-%d", i);
+		muxer_port = bt_component_filter_get_input_port(muxer, name);
+	}
+
+	connect_ports(graph, bt_component_source_get_default_output_port(source),
+		muxer_port);
+	bt_put(source);
+	bt_put(params);
+}
+
+static void test_muxer(void)
+{
+	struct bt_graph *graph = bt_graph_create();
+	struct bt_component *muxer, *sink;
+	struct bt_value *params = bt_value_map_create();
+	enum bt_graph_status status;
+	struct checker *checker;
+	uint64_t total = 0;
+	int i;
+
+	assert(graph && params);
+	(void) bt_value_map_insert_integer(params, "input-port-count",
+		MUXED_COUNTER_COUNT);
+	muxer = create_plugin_component(muxer_plugin, "muxer",
+		BT_COMPONENT_CLASS_TYPE_FILTER, "muxer", params);
+	for (i = 0; i < MUXED_COUNTER_COUNT; i++) {
+		add_muxed_counter(graph, muxer, i);
+		total += muxed_counters[i].count;
+	}
+
+	/* The muxer's iterator is created once all its inputs are connected. */
+	sink = create_component("checker", BT_COMPONENT_CLASS_TYPE_SINK,
+		"muxed", NULL, 0, NULL, 0);
+	connect_ports(graph, bt_component_filter_get_default_output_port(muxer),
+		bt_component_sink_get_default_input_port(sink));
+	checker = get_checker(sink);
+	status = bt_graph_run(graph, NULL);
+	ok(status == BT_GRAPH_STATUS_END,
+		"a graph with a muxer of several sources is run to completion");
+	ok(checker->consumed == total && checker->end_reached,
+		"the muxer delivers the notifications of all its upstreams");
+	ok(checker->unsorted == 0,
+		"the muxer delivers the notifications in sort key order");
+	/* 10 equal pairs, and the 3 of the short source matching the others */
+	ok(checker->ties == 13,
+		"the muxer delivers the notifications with equal timestamps");
+	ok(checker->unstable == 0,
+		"the muxer breaks timestamp ties by upstream order");
+	bt_put(sink);
+	bt_put(muxer);
+	bt_put(params);
+	bt_put(graph);
+}
+
+static void test_ready_timeout(void)
+{
+	struct bt_graph *graph = bt_graph_create();
+	struct bt_component *source, *sink;
+	enum bt_graph_status status;
+	gint64 start;
+
+	assert(graph);
+	source = create_component("counter", BT_COMPONENT_CLASS_TYPE_SOURCE,
+		"timeout", "count", 5, NULL, 0);
+	sink = create_component("checker", BT_COMPONENT_CLASS_TYPE_SINK,
+		"timeout", "again", 3, "again-timeout", 10);
+	connect_ports(graph, bt_component_source_get_default_output_port(source),
+		bt_component_sink_get_default_input_port(sink));
+	start = g_get_monotonic_time();
+	status = bt_graph_run(graph, NULL);
+	ok(status == BT_GRAPH_STATUS_END && get_checker(sink)->consumed == 5,
+		"bt_graph_run() waits for the readiness timeout of a sink instead of returning AGAIN");
+	ok(g_get_monotonic_time() - start >= 30000,
+		"a sink is not consumed again before its readiness timeout expires");
+	bt_put(source);
+	bt_put(sink);
+	bt_put(graph);
+}
+
+static void make_pipe(int fds[2])
+{
+	int ret = pipe(fds);
+
+	assert(!ret);
+}
+
+static void write_byte(int fd)
+{
+	ssize_t ret = write(fd, "x", 1);
+
+	assert(ret == 1);
+}
+
+static void add_ready_fd(struct bt_graph *graph,
+		struct bt_component *component, int fd)
+{
+	enum bt_graph_status status =
+		bt_graph_add_ready_fd(graph, component, fd);
+
+	assert(status == BT_GRAPH_STATUS_OK);
+}
+
+struct delayed_write {
+	int fd;
+	gulong delay_us;
+};
+
+static gpointer delayed_write_thread(gpointer data)
+{
+	struct delayed_write *dw = data;
+
+	g_usleep(dw->delay_us);
+	write_byte(dw->fd);
+	return NULL;
+}
+
+static void test_ready_fd(void)
+{
+	struct bt_graph *graph = bt_graph_create();
+	struct bt_component *sink;
+	enum bt_graph_status status;
+	struct delayed_write dw;
+	GThread *thread;
+	int fds[2];
+
+	assert(graph);
+	make_pipe(fds);
+	sink = add_counter_checker(graph, "fd", 5, 0, 2);
+	add_ready_fd(graph, sink, fds[0]);
+	dw.fd = fds[1];
+	dw.delay_us = 20000;
+	thread = g_thread_new("writer", delayed_write_thread, &dw);
+	status = bt_graph_run(graph, NULL);
+	g_thread_join(thread);
+	ok(status == BT_GRAPH_STATUS_END && get_checker(sink)->consumed == 5,
+		"bt_graph_run() waits for the readiness file descriptor of a sink");
+	status = bt_graph_remove_ready_fd(graph, fds[0]);
+	ok(status == BT_GRAPH_STATUS_OK &&
+		bt_graph_remove_ready_fd(graph, fds[0]) ==
+			BT_GRAPH_STATUS_INVALID,
+		"a readiness file descriptor is removed once");
+	close(fds[0]);
+	close(fds[1]);
+	bt_put(sink);
+	bt_put(graph);
+}
+
+static void test_upstream_ready_fd(void)
+{
+	struct bt_graph *graph = bt_graph_create();
+	struct bt_component *source, *sink;
+	enum bt_graph_status status;
+	int fds[2];
+
+	assert(graph);
+	make_pipe(fds);
+	write_byte(fds[1]);
+	source = create_component("counter", BT_COMPONENT_CLASS_TYPE_SOURCE,
+		"upstream-fd", "count", 20, "again-period", 7);
+	sink = create_component("checker", BT_COMPONENT_CLASS_TYPE_SINK,
+		"upstream-fd", NULL, 0, NULL, 0);
+	connect_ports(graph, bt_component_source_get_default_output_port(source),
+		bt_component_sink_get_default_input_port(sink));
+	add_ready_fd(graph, source, fds[0]);
+	status = bt_graph_run(graph, NULL);
+	ok(status == BT_GRAPH_STATUS_END &&
+		get_checker(sink)->consumed == 20 &&
+		get_checker(sink)->upstream_again == 2,
+		"the readiness file descriptor of a source wakes up the sinks it feeds");
+	close(fds[0]);
+	close(fds[1]);
+	bt_put(source);
+	bt_put(sink);
+	bt_put(graph);
+}
+
+static void test_only_ready_sinks(void)
+{
+	struct bt_graph *graph = bt_graph_create();
+	struct bt_component *sink_a, *sink_b;
+	enum bt_component_status status;
+	int fds_a[2], fds_b[2];
+	int i;
+
+	assert(graph);
+	make_pipe(fds_a);
+	make_pipe(fds_b);
+	sink_a = add_counter_checker(graph, "a", 5, 0, 1);
+	sink_b = add_counter_checker(graph, "b", 5, 0, 1);
+	add_ready_fd(graph, sink_a, fds_a[0]);
+	add_ready_fd(graph, sink_b, fds_b[0]);
+	write_byte(fds_a[1]);
+
+	/* Never blocks: B is left waiting once A reached its end. */
+	for (i = 0; i < MAX_RUNS; i++) {
+		status = bt_graph_consume(graph);
+		if (status != BT_COMPONENT_STATUS_OK &&
+				status != BT_COMPONENT_STATUS_AGAIN) {
+			break;
+		}
+	}
+
+	ok(status == BT_COMPONENT_STATUS_AGAIN &&
+		get_checker(sink_a)->end_reached &&
+		get_checker(sink_b)->consumed == 0,
+		"bt_graph_consume() only consumes the sinks whose readiness sources are ready");
+	write_byte(fds_b[1]);
+	ok(bt_graph_run(graph, NULL) == BT_GRAPH_STATUS_END &&
+		get_checker(sink_b)->consumed == 5,
+		"a sink is consumed once its readiness source is ready");
+	close(fds_a[0]);
+	close(fds_a[1]);
+	close(fds_b[0]);
+	close(fds_b[1]);
+	bt_put(sink_a);
+	bt_put(sink_b);
+	bt_put(graph);
+}
+
+struct waker {
+	struct bt_graph *graph;
+	struct bt_component *component;
+	volatile gint done;
+};
+
+static gpointer waker_thread(gpointer data)
+{
+	struct waker *waker = data;
+
+	while (!g_atomic_int_get(&waker->done)) {
+		(void) bt_graph_wake_up(waker->graph, waker->component);
+		g_usleep(5000);
+	}
+
+	return NULL;
+}
+
+static void test_ready_wake_up(void)
+{
+	struct bt_graph *graph = bt_graph_create();
+	struct bt_component *sink;
+	enum bt_graph_status status;
+	struct waker waker;
+	GThread *thread;
+
+	assert(graph);
+	sink = add_counter_checker(graph, "wake-up", 5, 0, 3);
+	status = bt_graph_add_ready_wake_up(graph, sink);
+	assert(status == BT_GRAPH_STATUS_OK);
+	waker.graph = graph;
+	waker.component = sink;
+	waker.done = 0;
+	thread = g_thread_new("waker", waker_thread, &waker);
+	status = bt_graph_run(graph, NULL);
+	g_atomic_int_set(&waker.done, 1);
+	g_thread_join(thread);
+	ok(status == BT_GRAPH_STATUS_END && get_checker(sink)->consumed == 5 &&
+		bt_graph_remove_ready_wake_up(graph, sink) ==
+			BT_GRAPH_STATUS_OK,
+		"bt_graph_wake_up() from another thread wakes up a waiting sink");
+	bt_put(sink);
+	bt_put(graph);
+}
+
+static void test_ready_invalid(void)
+{
+	struct bt_graph *graph = bt_graph_create();
+	struct bt_component *sink, *orphan;
+	int fds[2];
+
+	assert(graph);
+	make_pipe(fds);
+	sink = add_counter_checker(graph, "invalid", 1, 0, 0);
+	orphan = create_component("checker", BT_COMPONENT_CLASS_TYPE_SINK,
+		"orphan", NULL, 0, NULL, 0);
+	add_ready_fd(graph, sink, fds[0]);
+	ok(bt_graph_add_ready_fd(NULL, sink, fds[1]) ==
+			BT_GRAPH_STATUS_INVALID &&
+		bt_graph_add_ready_fd(graph, NULL, fds[1]) ==
+			BT_GRAPH_STATUS_INVALID &&
+		bt_graph_add_ready_fd(graph, sink, -1) ==
+			BT_GRAPH_STATUS_INVALID &&
+		bt_graph_add_ready_fd(graph, sink, fds[0]) ==
+			BT_GRAPH_STATUS_INVALID &&
+		bt_graph_add_ready_fd(graph, orphan, fds[1]) ==
+			BT_GRAPH_STATUS_INVALID &&
+		bt_graph_set_ready_timeout(graph, orphan, 1) ==
+			BT_GRAPH_STATUS_INVALID &&
+		bt_graph_set_ready_timeout(graph, sink, UINT64_MAX) ==
+			BT_GRAPH_STATUS_INVALID &&
+		bt_graph_remove_ready_wake_up(graph, sink) ==
+			BT_GRAPH_STATUS_INVALID &&
+		bt_graph_wake_up(NULL, sink) == BT_GRAPH_STATUS_INVALID,
+		"the readiness source functions reject invalid arguments");
+	close(fds[0]);
+	close(fds[1]);
+	bt_put(orphan);
+	bt_put(sink);
+	bt_put(graph);
+}
+
+int main(int argc, char **argv)
+{
+	int ret;
+	struct bt_plugin **plugins, **muxer_plugins;
+	char *plugin_path;
+
+	if (argc != 3) {
+		puts("Usage: test_graph plugin_directory muxer_plugin_directory");
+		ret = 1;
+		goto end;
+	}
+
+	plugin_path = g_build_filename(argv[1], "plugin-counter.so", NULL);
+	plugins = bt_plugin_create_all_from_file(plugin_path);
+	g_free(plugin_path);
+	plugin_path = g_build_filename(argv[2],
+		"libbabeltrace-plugin-muxer.so", NULL);
+	muxer_plugins = bt_plugin_create_all_from_file(plugin_path);
+	g_free(plugin_path);
+	plan_tests(NR_TESTS);
+	ok(plugins && plugins[0] && muxer_plugins && muxer_plugins[0],
+		"the test and muxer plugins can be loaded");
+	if (!plugins || !plugins[0] || !muxer_plugins || !muxer_plugins[0]) {
+		ret = exit_status();
+		goto end;
+	}
+
+	plugin = plugins[0];
+	free(plugins);
+	muxer_plugin = muxer_plugins[0];
+	free(muxer_plugins);
+	test_sink_again();
+	test_waiting_sink();
+	test_upstream_again();
+	test_prefetch();
+	test_prefetch_upstream_again();
+	test_batch("counter", "single-step");
+	test_batch("batch_counter", "batch");
+	test_prefetch_batch();
+	test_muxer();
+	test_ready_timeout();
+	test_ready_fd();
+	test_upstream_ready_fd();
+	test_only_ready_sinks();
+	test_ready_wake_up();
+	test_ready_invalid();
+	BT_PUT(muxer_plugin);
+	BT_PUT(plugin);
+	ret = exit_status();
+end:
+	return ret;
+}